@@ -0,0 +1,212 @@
+<?php
+################################################################################
+# Copyright 2013-2016 Aerospike, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+#
+# Sweeps the memory used by getMany() over batch sizes and record shapes, and
+# by a scan of each shape, with aerospike.memory_profiling on. Each measure
+# runs in its own process so that its peaks are not those of another.
+#
+################################################################################
+require_once(realpath(__DIR__ . '/../examples_util.php'));
+
+function parse_args() {
+    $shortopts  = "";
+    $shortopts .= "h::";  /* Optional host */
+    $shortopts .= "p::";  /* Optional port */
+    $shortopts .= "r::";  /* Optionally number of records of each shape */
+
+    $longopts  = array(
+        "host::",         /* Optional host */
+        "port::",         /* Optional port */
+        "records::",      /* Optionally number of records of each shape */
+        "batch-sizes::",  /* Optionally comma separated batch sizes */
+        "shapes::",       /* Optionally comma separated record shapes */
+        "no-load",        /* Do not write the records */
+        "measure::",      /* Internal: shape:batch size measured by a child */
+        "help",           /* Usage */
+    );
+    $options = getopt($shortopts, $longopts);
+    return $options;
+}
+
+/*
+ * The bins of a record of the given shape.
+ */
+function shape_bins($shape, $i) {
+    $bins = array();
+    switch ($shape) {
+        case "flat":
+            for ($b = 0; $b < 5; $b++) {
+                $bins["i$b"] = $i * 10 + $b;
+                $bins["s$b"] = str_repeat(chr(97 + $b), 20);
+            }
+            break;
+        case "wide":
+            for ($b = 0; $b < 100; $b++) {
+                $bins["b$b"] = str_repeat("x", 10);
+            }
+            break;
+        case "map":
+            $map = array();
+            for ($m = 0; $m < 10; $m++) {
+                for ($n = 0; $n < 10; $n++) {
+                    $map["k$m"]["k$n"] = array("id" => $m * 10 + $n, "name" => "name-$m-$n");
+                }
+            }
+            $bins["map"] = $map;
+            break;
+        case "list":
+            $bins["list"] = range($i, $i + 999);
+            break;
+        default:
+            return null;
+    }
+    return $bins;
+}
+
+function record_keys($db, $shape, $start, $count) {
+    $keys = array();
+    for ($i = $start; $i < $start + $count; $i++) {
+        $keys[] = $db->initKey("test", "memory_$shape", $i);
+    }
+    return $keys;
+}
+
+/*
+ * Measures one shape and batch size (0 for a scan) in this process, and prints
+ * the memory profile of the command as JSON.
+ */
+function measure($db, $shape, $batch_size, $records) {
+    ini_set("aerospike.memory_profiling", "1");
+    $read = 0;
+    if ($batch_size > 0) {
+        $command = "batch";
+        for ($start = 0; $start < $records; $start += $batch_size) {
+            $keys = record_keys($db, $shape, $start, min($batch_size, $records - $start));
+            $status = $db->getMany($keys, $result);
+            if ($status !== Aerospike::OK) {
+                return $status;
+            }
+            $read += count($result);
+            unset($result);
+        }
+    } else {
+        $command = "scan";
+        $status = $db->scan("test", "memory_$shape", function ($record) use (&$read) {
+            $read++;
+        });
+        if ($status !== Aerospike::OK) {
+            return $status;
+        }
+    }
+    $stats = $db->getStats();
+    if (!isset($stats["memory"]["commands"][$command])) {
+        return Aerospike::ERR_CLIENT;
+    }
+    $profile = $stats["memory"]["commands"][$command];
+    $profile["records"] = $read;
+    $profile["static_pool_bytes"] = $stats["memory"]["static_pool_bytes"];
+    echo json_encode($profile) . "\n";
+    return Aerospike::OK;
+}
+
+$args = parse_args();
+if (isset($args["help"])) {
+    echo "php memory-sweep.php [-hHOST] [-pPORT] [-rRECORDS]\n";
+    echo " or\n";
+    echo "php memory-sweep.php [--host=HOST] [--port=PORT] [--records=RECORDS]\n";
+    echo "                     [--batch-sizes=1,10,100,1000,5000] [--shapes=flat,wide,map,list]\n";
+    echo "                     [--no-load]\n";
+    exit(1);
+}
+$addr = (isset($args["h"])) ? (string) $args["h"] : ((isset($args["host"])) ? (string) $args["host"] : "localhost");
+$port = (isset($args["p"])) ? (integer) $args["p"] : ((isset($args["port"])) ? (integer) $args["port"] : 3000);
+$records = (isset($args["r"])) ? (integer) $args["r"] : ((isset($args["records"])) ? (integer) $args["records"] : 5000);
+$batch_sizes = array_map('intval', explode(",", isset($args["batch-sizes"]) ? $args["batch-sizes"] : "1,10,100,1000,5000"));
+$shapes = explode(",", isset($args["shapes"]) ? $args["shapes"] : "flat,wide,map,list");
+
+$config = array("hosts" => array(array("addr" => $addr, "port" => $port)));
+$db = new Aerospike($config, false);
+if (!$db->isConnected()) {
+    echo fail("Could not connect to host $addr:$port [{$db->errorno()}]: {$db->error()}");
+    exit(1);
+}
+
+if (isset($args["measure"])) {
+    list($shape, $batch_size) = explode(":", $args["measure"]);
+    $status = measure($db, $shape, (integer) $batch_size, $records);
+    $db->close();
+    exit(($status === Aerospike::OK) ? 0 : 1);
+}
+
+foreach ($shapes as $shape) {
+    if (shape_bins($shape, 0) === null) {
+        echo fail("Unknown shape $shape");
+        exit(1);
+    }
+}
+
+if (!isset($args["no-load"])) {
+    foreach ($shapes as $shape) {
+        echo colorize("Writing $records records of shape $shape ≻", 'black', true);
+        for ($i = 0; $i < $records; $i++) {
+            $key = $db->initKey("test", "memory_$shape", $i);
+            if ($db->put($key, shape_bins($shape, $i)) !== Aerospike::OK) {
+                echo standard_fail($db);
+                exit(1);
+            }
+        }
+        echo success();
+    }
+}
+$db->close();
+
+$php = escapeshellarg(PHP_BINARY);
+$script = escapeshellarg(__FILE__);
+$format = "%-6s %-6s %8s %12s %12s %14s %12s\n";
+$static_pool_bytes = 0;
+printf($format, "shape", "batch", "records", "bytes/rec", "peak/rec", "c-heap/rec", "peak max");
+foreach ($shapes as $shape) {
+    foreach (array_merge($batch_sizes, array(0)) as $batch_size) {
+        if ($batch_size > $records) {
+            continue;
+        }
+        $output = array();
+        exec("$php $script --host=" . escapeshellarg($addr) . " --port=$port --records=$records" .
+            " --measure=$shape:$batch_size", $output, $exit_code);
+        $profile = ($exit_code === 0 && $output) ? json_decode(end($output), true) : null;
+        $label = ($batch_size > 0) ? (string) $batch_size : "scan";
+        if (!$profile || !$profile["records"]) {
+            printf($format, $shape, $label, "failed", "-", "-", "-", "-");
+            continue;
+        }
+        /*
+         * A scan is a single command, the batches are records / batch size
+         * commands, so the per record figures are of one command.
+         */
+        $static_pool_bytes = $profile["static_pool_bytes"];
+        $per_command = ($batch_size > 0) ? $batch_size : $profile["records"];
+        printf($format, $shape, $label, $profile["records"],
+            (int) ($profile["bytes_avg"] / $per_command),
+            (int) ($profile["peak_avg"] / $per_command),
+            isset($profile["heap_peak_avg"]) ? (int) ($profile["heap_peak_avg"] / $per_command) : "-",
+            sprintf("%.1fMB", $profile["peak_max"] / 1048576));
+    }
+}
+if ($static_pool_bytes) {
+    echo colorize("Each command also reserves $static_pool_bytes bytes of stack for its conversions\n", 'black', false);
+}
+?>
@@ -0,0 +1,836 @@
+<?php
+################################################################################
+# Copyright 2013-2016 Aerospike, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+#
+# A single node mock of an Aerospike server, for running the performance
+# scripts and the tests without a cluster. It keeps the records in memory and
+# speaks the wire protocol of the server for the single record commands
+# (get, exists, put, remove, operate without CDT operations), the batch index
+# reads and the scans, and a subset of the info protocol including the
+# commands used by the client to discover the partition map.
+#
+# Responses can be delayed, with a jitter, and errors injected, so that the
+# behavior of the client under a slow or failing server can be measured.
+# Queries, UDFs, CDT operations, security and LDT commands are answered with
+# a parameter error.
+#
+################################################################################
+
+define("PROTO_VERSION", 2);
+define("PROTO_TYPE_INFO", 1);
+define("PROTO_TYPE_MSG", 3);
+define("PROTO_TYPE_COMPRESSED", 4);
+
+define("FIELD_NAMESPACE", 0);
+define("FIELD_SETNAME", 1);
+define("FIELD_KEY", 2);
+define("FIELD_DIGEST", 4);
+define("FIELD_INDEX_RANGE", 22);
+define("FIELD_UDF_PACKAGE_NAME", 30);
+define("FIELD_BATCH_INDEX", 41);
+define("FIELD_BATCH_INDEX_WITH_SET", 42);
+
+define("INFO1_READ", 1);
+define("INFO1_GET_ALL", 2);
+define("INFO1_BATCH_INDEX", 8);
+define("INFO1_NOBINDATA", 32);
+define("INFO2_WRITE", 1);
+define("INFO2_DELETE", 2);
+define("INFO2_GENERATION", 4);
+define("INFO2_GENERATION_GT", 8);
+define("INFO2_CREATE_ONLY", 32);
+define("INFO2_RESPOND_ALL_OPS", 128);
+define("INFO3_LAST", 1);
+define("INFO3_UPDATE_ONLY", 8);
+define("INFO3_CREATE_OR_REPLACE", 16);
+define("INFO3_REPLACE_ONLY", 32);
+
+define("OP_READ", 1);
+define("OP_WRITE", 2);
+define("OP_INCR", 5);
+define("OP_APPEND", 9);
+define("OP_PREPEND", 10);
+define("OP_TOUCH", 11);
+
+define("PARTICLE_NULL", 0);
+define("PARTICLE_INTEGER", 1);
+define("PARTICLE_FLOAT", 2);
+define("PARTICLE_STRING", 3);
+define("PARTICLE_BLOB", 4);
+
+define("RESULT_OK", 0);
+define("RESULT_NOT_FOUND", 2);
+define("RESULT_GENERATION", 3);
+define("RESULT_PARAMETER", 4);
+define("RESULT_EXISTS", 5);
+define("RESULT_BIN_TYPE", 12);
+
+define("N_PARTITIONS", 4096);
+define("CITRUSLEAF_EPOCH", 1262304000);
+define("TTL_NEVER_EXPIRE", 0xFFFFFFFF);
+define("TTL_DONT_UPDATE", 0xFFFFFFFE);
+
+function parse_args() {
+    $longopts  = array(
+        "host::",           /* Optional address to listen on */
+        "port::",           /* Optional port to listen on */
+        "namespaces::",     /* Optional comma separated namespaces */
+        "latency-ms::",     /* Optional delay of the responses */
+        "jitter-ms::",      /* Optional random extra delay of the responses */
+        "error-rate::",     /* Optional ratio of commands failed with error-code */
+        "error-code::",     /* Optional status of the injected errors */
+        "drop-rate::",      /* Optional ratio of commands never answered */
+        "owned::",          /* Optional ratio of the partitions owned by the node */
+        "regen-every::",    /* Optionally bump the partition generation every N seconds */
+        "stats-every::",    /* Optionally print the statistics every N seconds */
+        "help",             /* Usage */
+    );
+    return getopt("", $longopts);
+}
+
+function option($args, $name, $default) {
+    return isset($args[$name]) ? $args[$name] : $default;
+}
+
+$args = parse_args();
+if (isset($args["help"])) {
+    echo "php mock-server.php [--host=ADDR] [--port=PORT] [--namespaces=NS,...]\n";
+    echo "    [--latency-ms=MS] [--jitter-ms=MS] [--error-rate=RATIO] [--error-code=STATUS]\n";
+    echo "    [--drop-rate=RATIO] [--owned=RATIO] [--regen-every=SECONDS] [--stats-every=SECONDS]\n";
+    exit(1);
+}
+
+/*
+ * Big endian helpers. The integers of PHP are 64 bits wide on the platforms
+ * the extension supports.
+ */
+function be16($data, $offset) {
+    $v = unpack("n", substr($data, $offset, 2));
+    return $v[1];
+}
+
+function be32($data, $offset) {
+    $v = unpack("N", substr($data, $offset, 4));
+    return $v[1];
+}
+
+function be64($data, $offset) {
+    $v = unpack("N2", substr($data, $offset, 8));
+    return ($v[1] << 32) | $v[2];
+}
+
+function pack64($value) {
+    return pack("NN", ($value >> 32) & 0xFFFFFFFF, $value & 0xFFFFFFFF);
+}
+
+function is_little_endian() {
+    static $little = null;
+    if ($little === null) {
+        $little = (pack("S", 1) === "\x01\x00");
+    }
+    return $little;
+}
+
+function unpack_double($bytes) {
+    $v = unpack("d", is_little_endian() ? strrev($bytes) : $bytes);
+    return $v[1];
+}
+
+function pack_double($value) {
+    $bytes = pack("d", $value);
+    return is_little_endian() ? strrev($bytes) : $bytes;
+}
+
+function proto($type, $payload) {
+    $size = strlen($payload);
+    return pack("CCnN", PROTO_VERSION, $type, ($size >> 32) & 0xFFFF, $size & 0xFFFFFFFF) . $payload;
+}
+
+function field($type, $data) {
+    return pack("NC", strlen($data) + 1, $type) . $data;
+}
+
+function op($op, $particle, $name, $value) {
+    return pack("NCCCC", 4 + strlen($name) + strlen($value), $op, $particle, 0, strlen($name)) . $name . $value;
+}
+
+function msg($info3, $result, $generation, $void_time, $index, $fields, $ops) {
+    return pack("CCCCCCNNNnn", 22, 0, 0, $info3, 0, $result, $generation, $void_time,
+        $index, count($fields), count($ops)) . implode("", $fields) . implode("", $ops);
+}
+
+/*
+ * Parses the fields then the operations of a message, starting at offset.
+ */
+function parse_fields_ops($data, $offset, $n_fields, $n_ops, &$fields, &$ops) {
+    $fields = array();
+    for ($i = 0; $i < $n_fields; $i++) {
+        $size = be32($data, $offset);
+        $fields[ord($data[$offset + 4])] = substr($data, $offset + 5, $size - 1);
+        $offset += 4 + $size;
+    }
+    $ops = array();
+    for ($i = 0; $i < $n_ops; $i++) {
+        $size = be32($data, $offset);
+        $name_len = ord($data[$offset + 7]);
+        $ops[] = array(
+            "op" => ord($data[$offset + 4]),
+            "particle" => ord($data[$offset + 5]),
+            "name" => substr($data, $offset + 8, $name_len),
+            "value" => (string) substr($data, $offset + 8 + $name_len, $size - 4 - $name_len));
+        $offset += 4 + $size;
+    }
+    return $offset;
+}
+
+class MockServer
+{
+    public $host;
+    public $port;
+    public $regen_every;
+    private $namespaces;
+    private $node;
+    private $latency_ms;
+    private $jitter_ms;
+    private $error_rate;
+    private $error_code;
+    private $drop_rate;
+    private $owned;
+    private $records = array();
+    private $stats = array("connections" => 0, "info" => 0, "reads" => 0, "writes" => 0,
+        "batch_keys" => 0, "scans" => 0, "unsupported" => 0, "injected_errors" => 0,
+        "dropped" => 0);
+    private $partition_generation = 1;
+    private $regenerated_at;
+
+    public function __construct($args) {
+        $this->port = (int) option($args, "port", 3000);
+        $this->host = (string) option($args, "host", "127.0.0.1");
+        $this->namespaces = explode(",", option($args, "namespaces", "test"));
+        $this->latency_ms = (float) option($args, "latency-ms", 0);
+        $this->jitter_ms = (float) option($args, "jitter-ms", 0);
+        $this->error_rate = (float) option($args, "error-rate", 0);
+        $this->error_code = (int) option($args, "error-code", 9);
+        $this->drop_rate = (float) option($args, "drop-rate", 0);
+        $this->owned = (float) option($args, "owned", 1);
+        $this->regen_every = (int) option($args, "regen-every", 0);
+        $this->node = sprintf("BB9%012X", $this->port);
+        $this->regenerated_at = time();
+        foreach ($this->namespaces as $ns) {
+            $this->records[$ns] = array();
+        }
+    }
+
+    /*
+     * Bitmap of the partitions owned by the node, the first ones of the
+     * namespace.
+     */
+    private function partition_bitmap() {
+        $owned = (int) round(N_PARTITIONS * max(0, min(1, $this->owned)));
+        $bitmap = str_repeat("\x00", N_PARTITIONS / 8);
+        for ($i = 0; $i < $owned; $i++) {
+            $bitmap[$i >> 3] = chr(ord($bitmap[$i >> 3]) | (0x80 >> ($i & 7)));
+        }
+        return base64_encode($bitmap);
+    }
+
+    private function count_records($ns, $set = null) {
+        if ($set === null) {
+            return count($this->records[$ns]);
+        }
+        $n = 0;
+        foreach ($this->records[$ns] as $record) {
+            if ($record["set"] === $set) {
+                $n++;
+            }
+        }
+        return $n;
+    }
+
+    private function info_value($name) {
+        $ns_list = implode(";", $this->namespaces);
+        switch ($name) {
+            case "node":
+                return $this->node;
+            case "features":
+                return "float;geo;batch-index;pipelining;replicas-master;udf";
+            case "partition-generation":
+                return (string) $this->partition_generation;
+            case "services":
+            case "services-alternate":
+                return "";
+            case "peers-generation":
+                return "1";
+            case "peers-clear-std":
+            case "peers-clear-alt":
+                return "1," . $this->port . ",[]";
+            case "replicas-master":
+            case "replicas-prole":
+                $value = "";
+                foreach ($this->namespaces as $ns) {
+                    $value .= $ns . ":" . $this->partition_bitmap() . ";";
+                }
+                return $value;
+            case "replicas-all":
+                $value = "";
+                foreach ($this->namespaces as $ns) {
+                    $value .= $ns . ":1," . $this->partition_bitmap() . ";";
+                }
+                return $value;
+            case "namespaces":
+                return $ns_list;
+            case "build":
+                return "3.15.0.1";
+            case "version":
+                return "Aerospike Community Edition build 3.15.0.1";
+            case "edition":
+                return "Aerospike Community Edition";
+            case "service":
+                return $this->host . ":" . $this->port;
+            case "cluster-name":
+                return "null";
+            case "udf-list":
+            case "sindex":
+                return "";
+            case "statistics":
+                $value = "objects=" . array_sum(array_map("count", $this->records)) .
+                    ";heap_allocated_kbytes=" . (int) (memory_get_usage() / 1024);
+                foreach ($this->stats as $stat => $count) {
+                    $value .= ";mock_" . $stat . "=" . $count;
+                }
+                return $value;
+            case "sets":
+                $value = "";
+                foreach ($this->namespaces as $ns) {
+                    $sets = array();
+                    foreach ($this->records[$ns] as $record) {
+                        $sets[(string) $record["set"]] = true;
+                    }
+                    foreach (array_keys($sets) as $set) {
+                        $value .= "ns=$ns:set=$set:objects=" . $this->count_records($ns, $set) .
+                            ":tombstones=0:memory_data_bytes=0:truncate_lut=0:stop-writes-count=0:set-enable-xdr=use-default:disable-eviction=false;";
+                    }
+                }
+                return $value;
+            case "bins":
+                $value = "";
+                foreach ($this->namespaces as $ns) {
+                    $value .= "$ns:bin_names=0,bin_names_quota=32768;";
+                }
+                return $value;
+        }
+        if (strpos($name, "namespace/") === 0) {
+            $ns = substr($name, strlen("namespace/"));
+            if (!isset($this->records[$ns])) {
+                return "type=unknown";
+            }
+            return "objects=" . $this->count_records($ns) .
+                ";replication-factor=1;memory-size=1073741824;default-ttl=0;storage-engine=memory";
+        }
+        return "ERROR::unsupported command";
+    }
+
+    public function info($payload) {
+        $this->stats["info"]++;
+        $response = "";
+        foreach (explode("\n", $payload) as $name) {
+            if ($name === "") {
+                continue;
+            }
+            $response .= $name . "\t" . $this->info_value($name) . "\n";
+        }
+        return proto(PROTO_TYPE_INFO, $response);
+    }
+
+    private function void_time($record) {
+        return $record["void_time"] ? $record["void_time"] - CITRUSLEAF_EPOCH : 0;
+    }
+
+    private function &find($ns, $digest) {
+        $none = null;
+        if (!isset($this->records[$ns][$digest])) {
+            return $none;
+        }
+        $record = &$this->records[$ns][$digest];
+        if ($record["void_time"] && $record["void_time"] <= time()) {
+            unset($this->records[$ns][$digest]);
+            return $none;
+        }
+        return $record;
+    }
+
+    private function bins_ops($record, $names, $no_bin_data) {
+        $ops = array();
+        if ($no_bin_data) {
+            return $ops;
+        }
+        foreach ($record["bins"] as $name => $bin) {
+            if ($names === null || in_array((string) $name, $names, true)) {
+                $ops[] = op(OP_READ, $bin[0], (string) $name, $bin[1]);
+            }
+        }
+        return $ops;
+    }
+
+    private function reply($result, $record = null, $ops = array()) {
+        return proto(PROTO_TYPE_MSG, msg(0, $result,
+            $record ? $record["generation"] : 0, $record ? $this->void_time($record) : 0, 0,
+            array(), $ops));
+    }
+
+    private function apply_ttl(&$record, $ttl) {
+        if ($ttl == TTL_DONT_UPDATE) {
+            return;
+        }
+        $record["void_time"] = ($ttl == 0 || $ttl == TTL_NEVER_EXPIRE) ? 0 : time() + $ttl;
+    }
+
+    /*
+     * Applies a write operation to the bins of a record.
+     *
+     * @return the result code of the operation.
+     */
+    private function apply_write_op(&$bins, $op) {
+        $name = $op["name"];
+        $current = isset($bins[$name]) ? $bins[$name] : null;
+        switch ($op["op"]) {
+            case OP_WRITE:
+                if ($op["particle"] == PARTICLE_NULL) {
+                    unset($bins[$name]);
+                } else {
+                    $bins[$name] = array($op["particle"], $op["value"]);
+                }
+                return RESULT_OK;
+            case OP_INCR:
+                if ($op["particle"] == PARTICLE_INTEGER) {
+                    if ($current && $current[0] != PARTICLE_INTEGER) {
+                        return RESULT_BIN_TYPE;
+                    }
+                    $sum = ($current ? be64($current[1], 0) : 0) + be64($op["value"], 0);
+                    $bins[$name] = array(PARTICLE_INTEGER, pack64($sum));
+                } else if ($op["particle"] == PARTICLE_FLOAT) {
+                    if ($current && $current[0] != PARTICLE_FLOAT) {
+                        return RESULT_BIN_TYPE;
+                    }
+                    $sum = ($current ? unpack_double($current[1]) : 0) + unpack_double($op["value"]);
+                    $bins[$name] = array(PARTICLE_FLOAT, pack_double($sum));
+                } else {
+                    return RESULT_PARAMETER;
+                }
+                return RESULT_OK;
+            case OP_APPEND:
+            case OP_PREPEND:
+                if ($current && $current[0] != $op["particle"]) {
+                    return RESULT_BIN_TYPE;
+                }
+                $value = $current ? $current[1] : "";
+                $value = ($op["op"] == OP_APPEND) ? $value . $op["value"] : $op["value"] . $value;
+                $bins[$name] = array($op["particle"], $value);
+                return RESULT_OK;
+            case OP_TOUCH:
+                return RESULT_OK;
+        }
+        return RESULT_PARAMETER;
+    }
+
+    private function record_command($header, $fields, $ops) {
+        $ns = isset($fields[FIELD_NAMESPACE]) ? $fields[FIELD_NAMESPACE] : "";
+        if (!isset($this->records[$ns]) || !isset($fields[FIELD_DIGEST]) ||
+            isset($fields[FIELD_UDF_PACKAGE_NAME])) {
+            $this->stats["unsupported"]++;
+            return $this->reply(RESULT_PARAMETER);
+        }
+        $digest = $fields[FIELD_DIGEST];
+        $record = &$this->find($ns, $digest);
+
+        if (!($header["info2"] & INFO2_WRITE)) {
+            $this->stats["reads"]++;
+            if (!$record) {
+                return $this->reply(RESULT_NOT_FOUND);
+            }
+            $names = null;
+            if (!($header["info1"] & INFO1_GET_ALL) && count($ops)) {
+                $names = array();
+                foreach ($ops as $op) {
+                    if ($op["op"] != OP_READ) {
+                        $this->stats["unsupported"]++;
+                        return $this->reply(RESULT_PARAMETER);
+                    }
+                    $names[] = $op["name"];
+                }
+            }
+            return $this->reply(RESULT_OK, $record,
+                $this->bins_ops($record, $names, $header["info1"] & INFO1_NOBINDATA));
+        }
+
+        $this->stats["writes"]++;
+        if ($header["info2"] & INFO2_DELETE) {
+            if (!$record) {
+                return $this->reply(RESULT_NOT_FOUND);
+            }
+            unset($this->records[$ns][$digest]);
+            return $this->reply(RESULT_OK);
+        }
+
+        if ($record) {
+            if (($header["info2"] & INFO2_CREATE_ONLY)) {
+                return $this->reply(RESULT_EXISTS);
+            }
+            if ((($header["info2"] & INFO2_GENERATION) && $header["generation"] != $record["generation"]) ||
+                (($header["info2"] & INFO2_GENERATION_GT) && $header["generation"] <= $record["generation"])) {
+                return $this->reply(RESULT_GENERATION);
+            }
+            $updated = $record;
+        } else {
+            if (($header["info3"] & (INFO3_UPDATE_ONLY | INFO3_REPLACE_ONLY))) {
+                return $this->reply(RESULT_NOT_FOUND);
+            }
+            foreach ($ops as $op) {
+                if ($op["op"] == OP_TOUCH) {
+                    return $this->reply(RESULT_NOT_FOUND);
+                }
+            }
+            $updated = array("set" => isset($fields[FIELD_SETNAME]) ? $fields[FIELD_SETNAME] : null,
+                "key" => null, "generation" => 0, "void_time" => 0, "bins" => array());
+        }
+        if ($header["info3"] & (INFO3_CREATE_OR_REPLACE | INFO3_REPLACE_ONLY)) {
+            $updated["bins"] = array();
+        }
+        if (isset($fields[FIELD_KEY])) {
+            $updated["key"] = $fields[FIELD_KEY];
+        }
+
+        $reads = array();
+        foreach ($ops as $op) {
+            if ($op["op"] == OP_READ) {
+                if ($op["name"] === "") {
+                    foreach ($this->bins_ops($updated, null, false) as $bin_op) {
+                        $reads[] = $bin_op;
+                    }
+                } else if (isset($updated["bins"][$op["name"]])) {
+                    $bin = $updated["bins"][$op["name"]];
+                    $reads[] = op(OP_READ, $bin[0], $op["name"], $bin[1]);
+                } else if ($header["info2"] & INFO2_RESPOND_ALL_OPS) {
+                    $reads[] = op(OP_READ, PARTICLE_NULL, $op["name"], "");
+                }
+                continue;
+            }
+            $result = $this->apply_write_op($updated["bins"], $op);
+            if ($result != RESULT_OK) {
+                if ($result == RESULT_PARAMETER) {
+                    $this->stats["unsupported"]++;
+                }
+                return $this->reply($result);
+            }
+            if ($header["info2"] & INFO2_RESPOND_ALL_OPS) {
+                $reads[] = op(OP_READ, PARTICLE_NULL, $op["name"], "");
+            }
+        }
+
+        $updated["generation"]++;
+        $this->apply_ttl($updated, $header["record_ttl"]);
+        if (count($updated["bins"])) {
+            $this->records[$ns][$digest] = $updated;
+        } else {
+            unset($this->records[$ns][$digest]);
+        }
+        return $this->reply(RESULT_OK, $updated, $reads);
+    }
+
+    /*
+     * Answers a batch index read, one message per key followed by the last
+     * message.
+     */
+    private function batch_command($header, $fields) {
+        $with_set = isset($fields[FIELD_BATCH_INDEX_WITH_SET]);
+        $data = $with_set ? $fields[FIELD_BATCH_INDEX_WITH_SET] : $fields[FIELD_BATCH_INDEX];
+        $n_keys = be32($data, 0);
+        $offset = 5;
+        $response = "";
+        $read_attr = 0;
+        $ns = "";
+        $names = null;
+
+        for ($i = 0; $i < $n_keys; $i++) {
+            $index = be32($data, $offset);
+            $digest = substr($data, $offset + 4, 20);
+            $repeat = ord($data[$offset + 24]);
+            $offset += 25;
+            if (!$repeat) {
+                $read_attr = ord($data[$offset]);
+                $n_fields = be16($data, $offset + 1);
+                $n_ops = be16($data, $offset + 3);
+                $offset = parse_fields_ops($data, $offset + 5, $n_fields, $n_ops, $key_fields, $key_ops);
+                $ns = isset($key_fields[FIELD_NAMESPACE]) ? $key_fields[FIELD_NAMESPACE] : "";
+                $names = null;
+                if (!($read_attr & INFO1_GET_ALL) && count($key_ops)) {
+                    $names = array();
+                    foreach ($key_ops as $op) {
+                        $names[] = $op["name"];
+                    }
+                }
+            }
+            $this->stats["batch_keys"]++;
+            $record = isset($this->records[$ns]) ? $this->find($ns, $digest) : null;
+            if (!$record) {
+                $response .= msg(0, RESULT_NOT_FOUND, 0, 0, $index, array(), array());
+                continue;
+            }
+            $ops = $this->bins_ops($record, $names, $read_attr & INFO1_NOBINDATA);
+            $response .= msg(0, RESULT_OK, $record["generation"], $this->void_time($record),
+                $index, array(), $ops);
+        }
+
+        $response .= msg(INFO3_LAST, RESULT_OK, 0, 0, 0, array(), array());
+        return proto(PROTO_TYPE_MSG, $response);
+    }
+
+    /*
+     * Answers a scan of a namespace or a set, in chunks of about 128KB
+     * followed by the last message.
+     */
+    private function scan_command($header, $fields, $ops) {
+        $this->stats["scans"]++;
+        $ns = $fields[FIELD_NAMESPACE];
+        $set = isset($fields[FIELD_SETNAME]) ? $fields[FIELD_SETNAME] : null;
+        if (!isset($this->records[$ns]) || ($header["info2"] & INFO2_WRITE)) {
+            $this->stats["unsupported"]++;
+            return proto(PROTO_TYPE_MSG, msg(INFO3_LAST, RESULT_PARAMETER, 0, 0, 0, array(), array()));
+        }
+        $names = null;
+        if (count($ops)) {
+            $names = array();
+            foreach ($ops as $op) {
+                $names[] = $op["name"];
+            }
+        }
+
+        $response = "";
+        $chunk = "";
+        foreach (array_keys($this->records[$ns]) as $digest) {
+            $record = $this->find($ns, $digest);
+            if (!$record || ($set !== null && $set !== "" && $record["set"] !== $set)) {
+                continue;
+            }
+            $record_fields = array(field(FIELD_NAMESPACE, $ns));
+            if ($record["set"] !== null) {
+                $record_fields[] = field(FIELD_SETNAME, $record["set"]);
+            }
+            $record_fields[] = field(FIELD_DIGEST, $digest);
+            if ($record["key"] !== null) {
+                $record_fields[] = field(FIELD_KEY, $record["key"]);
+            }
+            $chunk .= msg(0, RESULT_OK, $record["generation"], $this->void_time($record), 0,
+                $record_fields, $this->bins_ops($record, $names, $header["info1"] & INFO1_NOBINDATA));
+            if (strlen($chunk) > 131072) {
+                $response .= proto(PROTO_TYPE_MSG, $chunk);
+                $chunk = "";
+            }
+        }
+        $chunk .= msg(INFO3_LAST, RESULT_OK, 0, 0, 0, array(), array());
+        return $response . proto(PROTO_TYPE_MSG, $chunk);
+    }
+
+    /*
+     * Answers a message, or returns null if it is to be dropped.
+     */
+    public function message($payload) {
+        $header = unpack("Cheader_sz/Cinfo1/Cinfo2/Cinfo3/Cunused/Cresult/Ngeneration/Nrecord_ttl/Ntimeout/nn_fields/nn_ops",
+            substr($payload, 0, 22));
+        parse_fields_ops($payload, $header["header_sz"], $header["n_fields"], $header["n_ops"], $fields, $ops);
+
+        if ($this->drop_rate > 0 && mt_rand() / mt_getrandmax() < $this->drop_rate) {
+            $this->stats["dropped"]++;
+            return null;
+        }
+        $multi = isset($fields[FIELD_BATCH_INDEX]) || isset($fields[FIELD_BATCH_INDEX_WITH_SET]) ||
+            !isset($fields[FIELD_DIGEST]);
+        if ($this->error_rate > 0 && mt_rand() / mt_getrandmax() < $this->error_rate) {
+            $this->stats["injected_errors"]++;
+            return proto(PROTO_TYPE_MSG, msg($multi ? INFO3_LAST : 0, $this->error_code, 0, 0, 0,
+                array(), array()));
+        }
+
+        if (isset($fields[FIELD_BATCH_INDEX]) || isset($fields[FIELD_BATCH_INDEX_WITH_SET])) {
+            return $this->batch_command($header, $fields);
+        }
+        if (isset($fields[FIELD_INDEX_RANGE])) {
+            $this->stats["unsupported"]++;
+            return proto(PROTO_TYPE_MSG, msg(INFO3_LAST, RESULT_PARAMETER, 0, 0, 0, array(), array()));
+        }
+        if (!isset($fields[FIELD_DIGEST]) && isset($fields[FIELD_NAMESPACE])) {
+            return $this->scan_command($header, $fields, $ops);
+        }
+        return $this->record_command($header, $fields, $ops);
+    }
+
+    /*
+     * Answers a complete proto message, or returns null if it is dropped.
+     */
+    public function handle($type, $payload) {
+        switch ($type) {
+            case PROTO_TYPE_INFO:
+                return $this->info($payload);
+            case PROTO_TYPE_MSG:
+                return $this->message($payload);
+            case PROTO_TYPE_COMPRESSED:
+                $inner = gzuncompress(substr($payload, 8));
+                if ($inner !== false && strlen($inner) >= 8) {
+                    return $this->handle(ord($inner[1]), substr($inner, 8));
+                }
+                break;
+        }
+        $this->stats["unsupported"]++;
+        return proto(PROTO_TYPE_MSG, msg(INFO3_LAST, RESULT_PARAMETER, 0, 0, 0, array(), array()));
+    }
+
+    public function delay() {
+        $delay_ms = $this->latency_ms;
+        if ($this->jitter_ms > 0) {
+            $delay_ms += $this->jitter_ms * mt_rand() / mt_getrandmax();
+        }
+        return $delay_ms / 1000;
+    }
+
+    public function tick() {
+        if ($this->regen_every > 0 && time() - $this->regenerated_at >= $this->regen_every) {
+            $this->partition_generation++;
+            $this->regenerated_at = time();
+        }
+    }
+
+    public function connected() {
+        $this->stats["connections"]++;
+    }
+
+    public function print_stats() {
+        $line = date("H:i:s") . " records=" . array_sum(array_map("count", $this->records));
+        foreach ($this->stats as $stat => $count) {
+            $line .= " $stat=$count";
+        }
+        echo $line . " memory=" . memory_get_usage() . "\n";
+    }
+}
+
+$server = new MockServer($args);
+$stats_every = (int) option($args, "stats-every", 0);
+$listen = "tcp://" . $server->host . ":" . $server->port;
+$socket = stream_socket_server($listen, $errno, $errstr);
+if (!$socket) {
+    echo "Unable to listen on $listen: [$errno] $errstr\n";
+    exit(1);
+}
+stream_set_blocking($socket, 0);
+echo "Mock Aerospike server listening on $listen\n";
+
+/*
+ * Connections: their socket, the bytes received not yet handled, and the
+ * responses waiting for their delay or to be written. The responses of a
+ * connection are sent in order.
+ */
+$connections = array();
+$stats_at = time();
+while (true) {
+    $now = microtime(true);
+    $timeout = null;
+    foreach ($connections as $id => &$conn) {
+        while (count($conn["pending"]) && $conn["pending"][0][0] <= $now) {
+            $response = array_shift($conn["pending"]);
+            $conn["out"] .= $response[1];
+        }
+        if (count($conn["pending"])) {
+            $wait = $conn["pending"][0][0] - $now;
+            $timeout = ($timeout === null) ? $wait : min($timeout, $wait);
+        }
+    }
+    unset($conn);
+    if ($stats_every > 0 || $server->regen_every > 0) {
+        $timeout = ($timeout === null) ? 1 : min($timeout, 1);
+    }
+
+    $read = array($socket);
+    $write = array();
+    foreach ($connections as $id => $conn) {
+        $read[] = $conn["socket"];
+        if ($conn["out"] !== "") {
+            $write[] = $conn["socket"];
+        }
+    }
+    $except = null;
+    $sec = ($timeout === null) ? null : (int) $timeout;
+    $usec = ($timeout === null) ? null : (int) (($timeout - (int) $timeout) * 1000000);
+    if (false === @stream_select($read, $write, $except, $sec, $usec)) {
+        continue;
+    }
+
+    $server->tick();
+    if ($stats_every > 0 && time() - $stats_at >= $stats_every) {
+        $server->print_stats();
+        $stats_at = time();
+    }
+
+    foreach ($read as $readable) {
+        if ($readable === $socket) {
+            $client = @stream_socket_accept($socket, 0);
+            if ($client) {
+                stream_set_blocking($client, 0);
+                $connections[(int) $client] = array("socket" => $client, "in" => "",
+                    "out" => "", "pending" => array(), "due" => 0);
+                $server->connected();
+            }
+            continue;
+        }
+        $id = (int) $readable;
+        $data = fread($readable, 1048576);
+        if ($data === false || ($data === "" && feof($readable))) {
+            fclose($readable);
+            unset($connections[$id]);
+            continue;
+        }
+        $conn = &$connections[$id];
+        $conn["in"] .= $data;
+        while (strlen($conn["in"]) >= 8) {
+            $size = (be16($conn["in"], 2) << 32) | be32($conn["in"], 4);
+            if (strlen($conn["in"]) < 8 + $size) {
+                break;
+            }
+            $type = ord($conn["in"][1]);
+            $payload = (string) substr($conn["in"], 8, $size);
+            $conn["in"] = (string) substr($conn["in"], 8 + $size);
+            $response = $server->handle($type, $payload);
+            if ($response === null) {
+                continue;
+            }
+            $conn["due"] = max($conn["due"], microtime(true) + $server->delay());
+            $conn["pending"][] = array($conn["due"], $response);
+        }
+        unset($conn);
+    }
+
+    foreach ($write as $writable) {
+        $id = (int) $writable;
+        if (!isset($connections[$id])) {
+            continue;
+        }
+        $written = @fwrite($writable, $connections[$id]["out"]);
+        if ($written === false) {
+            fclose($writable);
+            unset($connections[$id]);
+            continue;
+        }
+        $connections[$id]["out"] = (string) substr($connections[$id]["out"], $written);
+    }
+}
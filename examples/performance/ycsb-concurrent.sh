@@ -0,0 +1,82 @@
+#!/bin/bash
+
+help() {
+    cat << EOB
+Usage: ycsb-concurrent.sh [-c WORKERS] [-h HOST] [-p PORT] [-r RECORDS] [-n OPERATIONS] [-l] [-W WORKLOAD] LOG_PATH [-- WORKER OPTIONS]
+   -h HOST      the IP address of the server. default: 127.0.0.1
+   -p PORT      the port of the server. default: 3000
+   -c WORKERS   the number of concurrent workers. default: 4
+   -r RECORDS   the number of records of the data set. default: 100000
+   -n NUM       the number of operations per-worker. default: 50000
+   -l           load the records before running the workload
+   -W WORKLOAD  the YCSB core workload, one of a b c d e f. default: a
+Options after -- are given to every ycsb-worker.php (see php ycsb-worker.php --help).
+Example: ./ycsb-concurrent.sh -h 192.168.119.3 -c 8 -l -W b run.log -- --distribution=hotspot --batch-size=10
+EOB
+}
+
+concurrent=4
+host="127.0.0.1"
+port="3000"
+records="100000"
+num="50000"
+load=0
+workload="a"
+OPTIND=1
+while getopts "c:h:p:r:n:lW:" opt; do
+    case "$opt" in
+        c)  concurrent=$OPTARG
+            ;;
+        h)  host=$OPTARG
+            ;;
+        p)  port=$OPTARG
+            ;;
+        r)  records=$OPTARG
+            ;;
+        n)  num=$OPTARG
+            ;;
+        l)  load=1
+            ;;
+        W)  workload=$OPTARG
+            ;;
+        '?')
+            help
+            exit 1
+            ;;
+    esac
+done
+shift "$(($OPTIND-1))" # shift off the options
+log=$1
+shift
+if [ "$1" == "--" ]; then
+    shift
+fi
+
+if [ ! $log ]; then
+    help
+    exit 2
+fi
+
+run_phase() {
+    phase=$1
+    shift
+    phase_log="$log.$phase"
+    if [ -f $phase_log ]; then
+        rm $phase_log
+    fi
+    touch $phase_log
+    for((i=0; i<$concurrent; i++))
+    do
+        /usr/bin/env php "./ycsb-worker.php" "--host=$host" "--port=$port" "--records=$records" \
+            "--num-ops=$num" "--workload=$workload" "--phase=$phase" "--worker=$i" \
+            "--workers=$concurrent" "$@" "$phase_log" &
+    done
+    wait;
+    echo "--- $phase phase of workload $workload ---"
+    /usr/bin/env php "./ycsb-summary.php" "$phase_log"
+}
+
+if [ $load -eq 1 ]; then
+    run_phase load "$@"
+fi
+run_phase run "$@"
@@ -0,0 +1,89 @@
+<?php
+################################################################################
+# Copyright 2013-2016 Aerospike, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+#
+# Latency histograms in microseconds, in the manner of HdrHistogram: values
+# below 2048us are counted exactly, larger values in buckets of 1/1024th of
+# their power of two, which keeps three significant digits. A histogram is a
+# sparse array of counts by bucket, so that the histograms of the workers can
+# be logged as JSON and merged by summing their counts.
+#
+################################################################################
+
+define("HIST_SUB_BUCKETS", 1024);
+
+function hist_bucket($us) {
+    $us = (int) $us;
+    if ($us < 2 * HIST_SUB_BUCKETS) {
+        return max(0, $us);
+    }
+    $msb = 0;
+    for ($v = $us; $v > 1; $v >>= 1) {
+        $msb++;
+    }
+    $shift = $msb - 10;
+    return 2 * HIST_SUB_BUCKETS + ($shift - 1) * HIST_SUB_BUCKETS + (($us >> $shift) - HIST_SUB_BUCKETS);
+}
+
+/*
+ * The highest value counted in a bucket.
+ */
+function hist_value($bucket) {
+    if ($bucket < 2 * HIST_SUB_BUCKETS) {
+        return $bucket;
+    }
+    $shift = (int) (($bucket - 2 * HIST_SUB_BUCKETS) / HIST_SUB_BUCKETS) + 1;
+    $sub = ($bucket - 2 * HIST_SUB_BUCKETS) % HIST_SUB_BUCKETS + HIST_SUB_BUCKETS;
+    return (($sub + 1) << $shift) - 1;
+}
+
+function hist_record(&$hist, $us) {
+    $bucket = hist_bucket($us);
+    if (isset($hist[$bucket])) {
+        $hist[$bucket]++;
+    } else {
+        $hist[$bucket] = 1;
+    }
+}
+
+function hist_merge(&$into, $hist) {
+    foreach ($hist as $bucket => $count) {
+        $into[$bucket] = (isset($into[$bucket]) ? $into[$bucket] : 0) + $count;
+    }
+}
+
+/*
+ * The values at the given percentiles (0-100) of a histogram.
+ */
+function hist_percentiles($hist, $percentiles) {
+    ksort($hist);
+    $total = array_sum($hist);
+    $values = array();
+    foreach ($percentiles as $percentile) {
+        $rank = max(1, (int) ceil($total * $percentile / 100));
+        $seen = 0;
+        $values[(string) $percentile] = 0;
+        foreach ($hist as $bucket => $count) {
+            $seen += $count;
+            if ($seen >= $rank) {
+                $values[(string) $percentile] = hist_value($bucket);
+                break;
+            }
+        }
+    }
+    return $values;
+}
+?>
@@ -0,0 +1,75 @@
+<?php
+################################################################################
+# Copyright 2013-2016 Aerospike, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+#
+# Merges the lines logged by the ycsb-worker.php processes of a phase and
+# reports the throughput, the latency percentiles of each type of operation
+# and the memory used per worker.
+#
+################################################################################
+
+require_once __DIR__ . "/ycsb-histogram.php";
+
+if (!isset($argv[1])) {
+    echo "php ycsb-summary.php LOGFILE\n";
+    exit(1);
+}
+
+$ops = array();
+$workers = 0;
+$max_runtime = 0;
+$memory_peaks = array();
+$maxrss = array();
+foreach (explode("\n", file_get_contents($argv[1])) as $line) {
+    $line = trim($line);
+    if ($line == '') continue;
+    $worker = json_decode($line, true);
+    $workers++;
+    $max_runtime = max($max_runtime, $worker["runtime"]);
+    $memory_peaks[] = $worker["memory_peak"];
+    $maxrss[] = $worker["maxrss_kb"];
+    foreach ($worker["ops"] as $type => $stats) {
+        if (!isset($ops[$type])) {
+            $ops[$type] = array("count" => 0, "failed" => 0, "hist" => array());
+        }
+        $ops[$type]["count"] += $stats["count"];
+        $ops[$type]["failed"] += $stats["failed"];
+        hist_merge($ops[$type]["hist"], $stats["hist"]);
+    }
+}
+if (!$workers) {
+    echo "No worker logged to {$argv[1]}\n";
+    exit(2);
+}
+
+$total = 0;
+printf("%-12s %10s %8s %10s %10s %10s %10s %10s\n", "operation", "count", "failed",
+    "ops/sec", "p50(us)", "p99(us)", "p99.9(us)", "max(us)");
+ksort($ops);
+foreach ($ops as $type => $stats) {
+    $total += $stats["count"];
+    $p = hist_percentiles($stats["hist"], array(50, 99, 99.9, 100));
+    printf("%-12s %10d %8d %10.0f %10d %10d %10d %10d\n", $type, $stats["count"], $stats["failed"],
+        $max_runtime > 0 ? $stats["count"] / $max_runtime : 0,
+        $p["50"], $p["99"], $p["99.9"], $p["100"]);
+}
+$tps = $max_runtime > 0 ? $total / $max_runtime : 0;
+echo "$total operations by $workers workers in {$max_runtime}s, combined to {$tps}ops/sec\n";
+printf("Peak PHP memory per worker: min %dKB, avg %dKB, max %dKB\n", min($memory_peaks) / 1024,
+    array_sum($memory_peaks) / $workers / 1024, max($memory_peaks) / 1024);
+printf("Max resident set size per worker: min %dKB, avg %dKB, max %dKB\n", min($maxrss),
+    array_sum($maxrss) / $workers, max($maxrss));
+?>
@@ -0,0 +1,359 @@
+<?php
+################################################################################
+# Copyright 2013-2016 Aerospike, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+#
+# A worker of the YCSB-like benchmark, launched by ycsb-concurrent.sh. The load
+# phase writes the worker's share of the records, the run phase executes one
+# of the core workloads A to F. The worker appends to the log file one JSON
+# line with its counts, latency histograms and memory usage, which are merged
+# by ycsb-summary.php.
+#
+################################################################################
+
+require_once __DIR__ . "/ycsb-histogram.php";
+
+$workloads = array(
+    /* read, update, insert, scan, read-modify-write proportions, key distribution */
+    "a" => array("read" => 0.5, "update" => 0.5, "distribution" => "zipfian"),
+    "b" => array("read" => 0.95, "update" => 0.05, "distribution" => "zipfian"),
+    "c" => array("read" => 1.0, "distribution" => "zipfian"),
+    "d" => array("read" => 0.95, "insert" => 0.05, "distribution" => "latest"),
+    "e" => array("scan" => 0.95, "insert" => 0.05, "distribution" => "zipfian"),
+    "f" => array("read" => 0.5, "rmw" => 0.5, "distribution" => "zipfian"),
+);
+
+$profiles = array(
+    /* field count, field length */
+    "small" => array(1, 100),
+    "default" => array(10, 100),
+    "large" => array(10, 1000),
+    "wide" => array(100, 10),
+);
+
+function parse_args() {
+    $longopts  = array(
+        "host::",             /* Optional host */
+        "port::",             /* Optional port */
+        "namespace::",        /* Optional namespace */
+        "set::",              /* Optional set */
+        "phase::",            /* Optionally load or run */
+        "workload::",         /* Optionally a to f */
+        "records::",          /* Optionally number of records loaded */
+        "num-ops::",          /* Optionally number of operations of the worker */
+        "duration::",         /* Optionally maximum seconds of the run */
+        "distribution::",     /* Optionally uniform, zipfian, hotspot or latest */
+        "hot-fraction::",     /* Optionally fraction of the keys in the hot set */
+        "hot-ops::",          /* Optionally fraction of the operations on the hot set */
+        "profile::",          /* Optionally small, default, large or wide records */
+        "field-count::",      /* Optionally number of bins of a record */
+        "field-length::",     /* Optionally length of the bins of a record */
+        "batch-size::",       /* Optionally read this many keys with getMany() */
+        "max-scan-length::",  /* Optionally maximum records of a short scan */
+        "scan-mode::",        /* Optionally batch or query for the short scans */
+        "full-scans::",       /* Optionally proportion of scans of the whole set */
+        "ops-per-request::",  /* Optionally construct the client again every N operations */
+        "persistent::",       /* Optionally 0 to not use persistent connections */
+        "worker::",           /* Index of the worker */
+        "workers::",          /* Number of workers */
+        "help",               /* Usage */
+    );
+    global $argv;
+    $options = getopt("", $longopts);
+    $options['_args'] = array_values(array_filter(array_slice($argv, 1), function ($arg) {
+        return strpos($arg, "--") !== 0;
+    }));
+    return $options;
+}
+
+function option($args, $name, $default) {
+    return isset($args[$name]) ? $args[$name] : $default;
+}
+
+$args = parse_args();
+if (isset($args["help"]) || !isset($args["_args"][0])) {
+    echo "php ycsb-worker.php [--host=HOST] [--port=PORT] [--namespace=NS] [--set=SET]\n";
+    echo "    [--phase=load|run] [--workload=a|b|c|d|e|f] [--records=N] [--num-ops=N] [--duration=SECONDS]\n";
+    echo "    [--distribution=uniform|zipfian|hotspot|latest] [--hot-fraction=F] [--hot-ops=F]\n";
+    echo "    [--profile=small|default|large|wide] [--field-count=N] [--field-length=N]\n";
+    echo "    [--batch-size=N] [--max-scan-length=N] [--scan-mode=batch|query] [--full-scans=F]\n";
+    echo "    [--ops-per-request=N] [--persistent=0|1] [--worker=I] [--workers=N] LOGFILE\n";
+    exit(1);
+}
+
+$addr = (string) option($args, "host", "127.0.0.1");
+$port = (int) option($args, "port", 3000);
+$ns = (string) option($args, "namespace", "test");
+$set = (string) option($args, "set", "ycsb");
+$phase = (string) option($args, "phase", "run");
+$workload_name = strtolower(option($args, "workload", "a"));
+if (!isset($workloads[$workload_name])) {
+    echo "Unknown workload $workload_name\n";
+    exit(1);
+}
+$workload = $workloads[$workload_name];
+$records = (int) option($args, "records", 100000);
+$total_ops = (int) option($args, "num-ops", 100000);
+$duration = (float) option($args, "duration", 0);
+$distribution = (string) option($args, "distribution", $workload["distribution"]);
+$hot_fraction = (float) option($args, "hot-fraction", 0.2);
+$hot_ops = (float) option($args, "hot-ops", 0.8);
+$profile = (string) option($args, "profile", "default");
+if (!isset($profiles[$profile])) {
+    echo "Unknown record profile $profile\n";
+    exit(1);
+}
+$field_count = (int) option($args, "field-count", $profiles[$profile][0]);
+$field_length = (int) option($args, "field-length", $profiles[$profile][1]);
+$batch_size = max(1, (int) option($args, "batch-size", 1));
+$max_scan_length = max(1, (int) option($args, "max-scan-length", 100));
+$scan_mode = (string) option($args, "scan-mode", "batch");
+$full_scans = (float) option($args, "full-scans", 0);
+$ops_per_request = (int) option($args, "ops-per-request", 0);
+$persistent = (bool) option($args, "persistent", 1);
+$worker = (int) option($args, "worker", 0);
+$workers = max(1, (int) option($args, "workers", 1));
+$log = $args["_args"][0];
+$pid = getmypid();
+echo "ycsb-worker.php $phase of workload $workload_name launched with process ID $pid\n";
+
+function rand01() {
+    return mt_rand() / (mt_getrandmax() + 1);
+}
+
+/*
+ * Spreads the popular items of a zipfian distribution over the key space,
+ * with a 32 bit FNV-1a hash.
+ */
+function fnv_hash($value) {
+    $hash = 0x811C9DC5;
+    for ($i = 0; $i < 4; $i++) {
+        $hash ^= ($value >> ($i * 8)) & 0xFF;
+        $hash = ($hash * 16777619) & 0xFFFFFFFF;
+    }
+    return $hash;
+}
+
+/*
+ * The zipfian generator of YCSB (Gray et al., "Quickly Generating
+ * Billion-Record Synthetic Databases"), item 0 being the most popular.
+ */
+class ZipfianGenerator
+{
+    const THETA = 0.99;
+    private $items;
+    private $zetan;
+    private $alpha;
+    private $eta;
+
+    public function __construct($items) {
+        $this->items = max(2, $items);
+        $this->zetan = 0;
+        for ($i = 1; $i <= $this->items; $i++) {
+            $this->zetan += 1 / pow($i, self::THETA);
+        }
+        $zeta2 = 1 + 1 / pow(2, self::THETA);
+        $this->alpha = 1 / (1 - self::THETA);
+        $this->eta = (1 - pow(2 / $this->items, 1 - self::THETA)) / (1 - $zeta2 / $this->zetan);
+    }
+
+    public function next() {
+        $u = rand01();
+        $uz = $u * $this->zetan;
+        if ($uz < 1) {
+            return 0;
+        }
+        if ($uz < 1 + pow(0.5, self::THETA)) {
+            return 1;
+        }
+        return min($this->items - 1,
+            (int) ($this->items * pow($this->eta * $u - $this->eta + 1, $this->alpha)));
+    }
+}
+
+/*
+ * Picks the key of an operation among the known records.
+ */
+function next_key($known) {
+    global $distribution, $hot_fraction, $hot_ops, $zipfian;
+    switch ($distribution) {
+        case "uniform":
+            return mt_rand(0, $known - 1);
+        case "hotspot":
+            $hot = max(1, (int) ($known * $hot_fraction));
+            if (rand01() < $hot_ops || $hot >= $known) {
+                return mt_rand(0, $hot - 1);
+            }
+            return mt_rand($hot, $known - 1);
+        case "latest":
+            return max(0, $known - 1 - $zipfian->next());
+        default:
+            return fnv_hash($zipfian->next()) % $known;
+    }
+}
+
+function record_bins($n) {
+    global $field_count, $field_length;
+    $bins = array("k" => $n);
+    for ($i = 0; $i < $field_count; $i++) {
+        $bins["field$i"] = str_repeat(chr(97 + ($n + $i) % 26), $field_length);
+    }
+    return $bins;
+}
+
+function connect() {
+    global $addr, $port, $persistent;
+    $config = array("hosts" => array(array("addr" => $addr, "port" => $port)));
+    return new Aerospike($config, $persistent);
+}
+
+$stats = array();
+function count_op($type, $elapsed, $status) {
+    global $stats;
+    if (!isset($stats[$type])) {
+        $stats[$type] = array("count" => 0, "failed" => 0, "hist" => array());
+    }
+    $stats[$type]["count"]++;
+    if ($status !== Aerospike::OK) {
+        $stats[$type]["failed"]++;
+    }
+    hist_record($stats[$type]["hist"], $elapsed * 1000000);
+}
+
+function log_worker($runtime) {
+    global $log, $pid, $worker, $phase, $workload_name, $stats;
+    $usage = function_exists("getrusage") ? getrusage() : array();
+    file_put_contents($log, json_encode(array(
+        "pid" => $pid,
+        "worker" => $worker,
+        "phase" => $phase,
+        "workload" => $workload_name,
+        "runtime" => $runtime,
+        "memory_peak" => memory_get_peak_usage(true),
+        "maxrss_kb" => isset($usage["ru_maxrss"]) ? $usage["ru_maxrss"] : 0,
+        "ops" => $stats)) . "\n", FILE_APPEND | LOCK_EX);
+}
+
+$db = connect();
+if (!$db->isConnected()) {
+    echo "Unable to connect to $addr:$port: [{$db->errorno()}] {$db->error()}\n";
+    log_worker(0);
+    exit(1);
+}
+
+$begin = microtime(true);
+if ($phase == "load") {
+    if ($worker == 0 && $scan_mode == "query") {
+        $db->addIndex($ns, $set, "k", "ycsb_k_idx", Aerospike::INDEX_TYPE_DEFAULT, Aerospike::INDEX_NUMERIC);
+    }
+    for ($n = $worker; $n < $records; $n += $workers) {
+        $start = microtime(true);
+        $status = $db->put($db->initKey($ns, $set, $n), record_bins($n));
+        count_op("insert", microtime(true) - $start, $status);
+    }
+    log_worker(microtime(true) - $begin);
+    exit(0);
+}
+
+$zipfian = new ZipfianGenerator($records);
+$inserted = 0;
+$proportions = array();
+$cumulative = 0;
+foreach (array("read", "update", "insert", "scan", "rmw") as $type) {
+    if (isset($workload[$type])) {
+        $cumulative += $workload[$type] * (1 - $full_scans);
+        $proportions[$type] = $cumulative;
+        $last_type = $type;
+    }
+}
+
+for ($num_ops = 0; $num_ops < $total_ops; $num_ops++) {
+    if ($duration > 0 && microtime(true) - $begin >= $duration) {
+        break;
+    }
+    if ($ops_per_request > 0 && $num_ops > 0 && ($num_ops % $ops_per_request) == 0) {
+        /* A new request of a PHP-FPM worker, reusing the persistent connections */
+        $db = null;
+        $db = connect();
+    }
+    $known = $records + $inserted * $workers;
+    $type = ($full_scans > 0) ? "full-scan" : $last_type;
+    $draw = rand01();
+    foreach ($proportions as $candidate => $threshold) {
+        if ($draw < $threshold) {
+            $type = $candidate;
+            break;
+        }
+    }
+
+    $start = microtime(true);
+    switch ($type) {
+        case "read":
+            if ($batch_size > 1) {
+                $keys = array();
+                for ($i = 0; $i < $batch_size; $i++) {
+                    $keys[] = $db->initKey($ns, $set, next_key($known));
+                }
+                $status = $db->getMany($keys, $recs);
+                $type = "batch-read";
+            } else {
+                $status = $db->get($db->initKey($ns, $set, next_key($known)), $rec);
+            }
+            break;
+        case "update":
+            $n = next_key($known);
+            $field = "field" . mt_rand(0, $field_count - 1);
+            $status = $db->put($db->initKey($ns, $set, $n),
+                array($field => str_repeat(chr(97 + mt_rand(0, 25)), $field_length)));
+            break;
+        case "insert":
+            /* The workers insert interleaved keys after the loaded records */
+            $n = $records + $inserted * $workers + $worker;
+            $status = $db->put($db->initKey($ns, $set, $n), record_bins($n));
+            $inserted++;
+            break;
+        case "scan":
+            $first = next_key($known);
+            $length = mt_rand(1, $max_scan_length);
+            if ($scan_mode == "query") {
+                $where = Aerospike::predicateBetween("k", $first, $first + $length - 1);
+                $status = $db->query($ns, $set, $where, function ($record) {
+                });
+            } else {
+                $keys = array();
+                for ($i = 0; $i < $length; $i++) {
+                    $keys[] = $db->initKey($ns, $set, $first + $i);
+                }
+                $status = $db->getMany($keys, $recs);
+            }
+            break;
+        case "rmw":
+            $key = $db->initKey($ns, $set, next_key($known));
+            $status = $db->get($key, $rec);
+            if ($status === Aerospike::OK) {
+                $field = "field" . mt_rand(0, $field_count - 1);
+                $status = $db->put($key, array($field => str_repeat(chr(97 + mt_rand(0, 25)), $field_length)));
+            }
+            break;
+        default:
+            $status = $db->scan($ns, $set, function ($record) {
+            });
+            break;
+    }
+    count_op($type, microtime(true) - $start, $status);
+}
+log_worker(microtime(true) - $begin);
+$db->close();
+?>
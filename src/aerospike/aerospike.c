@@ -126,6 +126,19 @@ PHP_INI_BEGIN()
     STD_PHP_INI_ENTRY("aerospike.max_threads", "300", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateLong, max_threads, zend_aerospike_globals, aerospike_globals)
     STD_PHP_INI_ENTRY("aerospike.thread_pool_size", "16", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateLong, thread_pool_size, zend_aerospike_globals, aerospike_globals)
     STD_PHP_INI_ENTRY("aerospike.compression_threshold", "0", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateLong, compression_threshold, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.read_hedge_delay", "0", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateLong, read_hedge_delay, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.slowlog_threshold_ms", "0", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateLong, slowlog_threshold_ms, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.slowlog_file", NULL, PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateString, slowlog_file, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.async_threads", "16", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateLong, async_threads, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.near_cache_size", "0", PHP_INI_SYSTEM, OnUpdateLong, near_cache_size, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.near_cache_slot_size", "4096", PHP_INI_SYSTEM, OnUpdateLong, near_cache_slot_size, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.near_cache_fresh_ms", "1000", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateLong, near_cache_fresh_ms, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.near_cache_sets", NULL, PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateString, near_cache_sets, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.increment_buffer_max_keys", "1000", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateLong, increment_buffer_max_keys, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.increment_buffer_max_age_ms", "1000", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateLong, increment_buffer_max_age_ms, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.session_compression_threshold", "0", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateLong, session_compression_threshold, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.session_generation_check", "0", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateBool, session_generation_check, zend_aerospike_globals, aerospike_globals)
+    STD_PHP_INI_ENTRY("aerospike.memory_profiling", "0", PHP_INI_PERDIR|PHP_INI_SYSTEM|PHP_INI_USER, OnUpdateBool, memory_profiling, zend_aerospike_globals, aerospike_globals)
 PHP_INI_END()
 
 ZEND_DECLARE_MODULE_GLOBALS(aerospike)
@@ -198,6 +211,26 @@ static void shm_key_hashtable_dtor(
     }
 }
 
+/* Session save path cache destruction */
+static void session_cache_hashtable_dtor(
+    #if PHP_VERSION_ID < 70000
+        void
+    #else
+        zval
+    #endif
+    *hashtable_element)
+{
+    aerospike_session_cache_entry *entry_p =
+    #if PHP_VERSION_ID < 70000
+        *(aerospike_session_cache_entry **) hashtable_element;
+    #else
+        Z_PTR_P(hashtable_element);
+    #endif
+    if (entry_p) {
+        pefree(entry_p, 1);
+    }
+}
+
 /* Triggered at the beginning of a thread */
 static void aerospike_globals_ctor(zend_aerospike_globals *globals TSRMLS_DC)
 {
@@ -218,11 +251,33 @@ static void aerospike_globals_ctor(zend_aerospike_globals *globals TSRMLS_DC)
     } else {
         AEROSPIKE_G(shm_key_ref_count)++;
     }
+    AEROSPIKE_G(session_cache_g) = (HashTable *)pemalloc(sizeof(HashTable), 1);
+    zend_hash_init(AEROSPIKE_G(session_cache_g), 16, NULL, &session_cache_hashtable_dtor, 1);
+    AEROSPIKE_G(async_notify_fd) = -1;
+    AEROSPIKE_G(async_notify_write_fd) = -1;
+    AEROSPIKE_G(async_notify_pid) = 0;
+    AEROSPIKE_G(async_watched_g) = NULL;
+    AEROSPIKE_G(async_flights_g) = NULL;
+    AEROSPIKE_G(counters_objects_g) = NULL;
+    AEROSPIKE_G(memory_span_g).command = -1;
 }
 
 /* Triggered at the end of a thread */
 static void aerospike_globals_dtor(zend_aerospike_globals *globals TSRMLS_DC)
 {
+    if (globals->async_notify_fd >= 0) {
+        close(globals->async_notify_fd);
+        if (globals->async_notify_write_fd != globals->async_notify_fd) {
+            close(globals->async_notify_write_fd);
+        }
+        globals->async_notify_fd = -1;
+        globals->async_notify_write_fd = -1;
+    }
+    if (globals->session_cache_g) {
+        zend_hash_destroy(globals->session_cache_g);
+        pefree(globals->session_cache_g, 1);
+        globals->session_cache_g = NULL;
+    }
     if (globals->persistent_list_g) {
         if (AEROSPIKE_G(persistent_ref_count) == 1) {
             DEBUG_PHP_EXT_DEBUG("Ref count is working");
@@ -399,6 +454,8 @@ static zend_function_entry Aerospike_class_functions[] =
     PHP_ME(Aerospike, close, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, reconnect, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, getNodes, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, getStats, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, getSlowLog, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, info, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, infoMany, NULL, ZEND_ACC_PUBLIC)
 
@@ -431,8 +488,25 @@ static zend_function_entry Aerospike_class_functions[] =
     PHP_ME(Aerospike, removeBin, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, setDeserializer, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Aerospike, setSerializer, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Aerospike, setPolicyProfile, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, setReadMemoization, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, setIncrementBuffering, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, flush, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, touch, NULL, ZEND_ACC_PUBLIC)
 
+    /*
+     ********************************************************************
+     *  Async APIs:
+     ********************************************************************
+     */
+    PHP_ME(Aerospike, getAsync, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, putAsync, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, operateAsync, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, applyAsync, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, awaitAll, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, pollAsync, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, asyncEventStream, NULL, ZEND_ACC_PUBLIC)
+
     /*
      ********************************************************************
      *  Logging APIs:
@@ -460,7 +534,12 @@ static zend_function_entry Aerospike_class_functions[] =
     PHP_ME(Aerospike, predicateRange, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Aerospike, query, NULL, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, aggregate, arginfo_seventh_by_ref, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, aggregateStream, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, aggregateNative, arginfo_fifth_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, scan, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, scanCursor, arginfo_fourth_by_ref, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, scanToFile, NULL, ZEND_ACC_PUBLIC)
+    PHP_ME(Aerospike, loadFile, arginfo_sixth_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, scanApply, arginfo_sixth_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, queryApply, arginfo_seventh_by_ref, ZEND_ACC_PUBLIC)
     PHP_ME(Aerospike, scanInfo, arginfo_sec_by_ref, ZEND_ACC_PUBLIC)
@@ -559,6 +638,10 @@ static zend_function_entry Aerospike_class_functions[] =
     as_error_init(&error);
 
     if (intern_obj_p) {
+        aerospike_async_cancel(intern_obj_p);
+        aerospike_counters_destroy(intern_obj_p, &error TSRMLS_CC);
+        aerospike_policy_profiles_destroy(intern_obj_p);
+        aerospike_memo_destroy(intern_obj_p);
         if (intern_obj_p->is_persistent == false && intern_obj_p->as_ref_p) {
             if (intern_obj_p->as_ref_p->ref_as_p != 0) {
                 if (AEROSPIKE_OK != aerospike_close(intern_obj_p->as_ref_p->as_p, &error)) {
@@ -854,6 +937,16 @@ PHP_METHOD(Aerospike, close)
         goto exit;
     }
 
+    if (AEROSPIKE_OK != aerospike_counters_flush(aerospike_obj_p, &error TSRMLS_CC)) {
+        DEBUG_PHP_EXT_ERROR("Unable to flush the buffered increments before closing");
+        as_error_init(&error);
+    }
+
+    /*
+     * The async commands of this client use its C client handle.
+     */
+    aerospike_async_cancel(aerospike_obj_p);
+
     if (aerospike_obj_p->is_persistent == false) {
         if (AEROSPIKE_OK !=
                  (status = aerospike_close(aerospike_obj_p->as_ref_p->as_p, &error))) {
@@ -873,6 +966,7 @@ PHP_METHOD(Aerospike, close)
 
     /* Now as connection is getting closed we need to set the connection flag to false */
     aerospike_obj_p->is_conn_16 = AEROSPIKE_CONN_STATE_FALSE;
+    aerospike_memo_clear(aerospike_obj_p);
 exit:
     aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
     RETURN_LONG(status);
@@ -1077,6 +1171,7 @@ PHP_METHOD(Aerospike, put)
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_put_record);
         as_key_destroy(&as_key_for_put_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
@@ -1116,6 +1211,69 @@ exit:
 }
 /* }}} */
 
+/* {{{ proto array Aerospike::getStats( void )
+    Gets the command counters and latencies observed by this process */
+PHP_METHOD(Aerospike, getStats)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+
+    if (zend_parse_parameters_none() == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "getStats takes no parameters");
+        DEBUG_PHP_EXT_ERROR("getStats takes no parameters");
+        goto exit;
+    }
+
+    array_init(return_value);
+    aerospike_latency_stats(return_value TSRMLS_CC);
+    aerospike_near_cache_stats(return_value TSRMLS_CC);
+    aerospike_memory_stats(return_value TSRMLS_CC);
+    add_assoc_long(return_value, "log_dropped", aerospike_log_queue_dropped());
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    if (AEROSPIKE_OK != status) {
+        RETURN_NULL();
+    }
+}
+/* }}} */
+
+/* {{{ proto array Aerospike::getSlowLog( void )
+    Gets the last commands which exceeded aerospike.slowlog_threshold_ms */
+PHP_METHOD(Aerospike, getSlowLog)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+
+    if (zend_parse_parameters_none() == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "getSlowLog takes no parameters");
+        DEBUG_PHP_EXT_ERROR("getSlowLog takes no parameters");
+        goto exit;
+    }
+
+    array_init(return_value);
+    aerospike_slowlog_get(return_value TSRMLS_CC);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    if (AEROSPIKE_OK != status) {
+        RETURN_NULL();
+    }
+}
+/* }}} */
+
 /* {{{ proto int Aerospike::info( string request, string &response [, array host [, array options ]] )
     Sends an info command to a cluster node */
 PHP_METHOD(Aerospike, info)
@@ -1396,6 +1554,7 @@ PHP_METHOD(Aerospike, operate)
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_get_record);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
@@ -1478,6 +1637,7 @@ PHP_METHOD(Aerospike, operateOrdered)
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_get_record);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
@@ -1549,6 +1709,7 @@ PHP_METHOD(Aerospike, append)
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_get_record);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
@@ -1600,6 +1761,7 @@ PHP_METHOD(Aerospike, remove)
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_put_record);
         as_key_destroy(&as_key_for_put_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
@@ -1752,6 +1914,7 @@ PHP_METHOD(Aerospike, prepend)
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_get_record);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
@@ -1781,6 +1944,7 @@ PHP_METHOD(Aerospike, increment)
         zend_long            offset = 0;
     #endif
 	double double_offset = 0.0;
+	zend_uchar offset_type = IS_LONG;
 
     Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
 
@@ -1819,8 +1983,9 @@ PHP_METHOD(Aerospike, increment)
 		offset = Z_LVAL_P(offset_p);
     } else if (Z_TYPE_P(offset_p) == IS_DOUBLE) {
 		double_offset = Z_DVAL_P(offset_p);
+		offset_type = IS_DOUBLE;
 	} else if (Z_TYPE_P(offset_p) == IS_STRING) {
-		if (!is_numeric_string(Z_STRVAL_P(offset_p), Z_STRLEN_P(offset_p), &offset, &double_offset, 0)) {
+		if (!(offset_type = is_numeric_string(Z_STRVAL_P(offset_p), Z_STRLEN_P(offset_p), &offset, &double_offset, 0))) {
 			status = AEROSPIKE_ERR_PARAM;
 			PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "invalid value for increment operation");
 			DEBUG_PHP_EXT_DEBUG("Invalid value for increment operation");
@@ -1828,6 +1993,15 @@ PHP_METHOD(Aerospike, increment)
 		}
 	}
 
+    if ((!options_p) && aerospike_counters_add(aerospike_obj_p, &as_key_for_get_record,
+                bin_name_p, offset, double_offset, (IS_DOUBLE == offset_type),
+                &error TSRMLS_CC)) {
+        if (AEROSPIKE_OK != (status = error.code)) {
+            DEBUG_PHP_EXT_ERROR("Unable to flush the buffered increments");
+        }
+        goto exit;
+    }
+
     if (AEROSPIKE_OK != (status = aerospike_record_operations_general(aerospike_obj_p,
                     &as_key_for_get_record,
                     options_p,
@@ -1844,6 +2018,7 @@ PHP_METHOD(Aerospike, increment)
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_get_record);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
@@ -1911,6 +2086,7 @@ PHP_METHOD(Aerospike, touch)
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_get_record);
         as_key_destroy(&as_key_for_get_record);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
@@ -1919,6 +2095,258 @@ exit:
 }
 /* }}} */
 
+/*
+ *******************************************************************************************************
+ *  Async APIs:
+ *******************************************************************************************************
+ */
+
+/* {{{ proto Aerospike\Future Aerospike::getAsync( array key [, array select [, array options ]] )
+    Submits the read of a record and returns a future for it */
+PHP_METHOD(Aerospike, getAsync)
+{
+    as_status              status = AEROSPIKE_OK;
+    zval*                  key_record_p = NULL;
+    zval*                  bins_p = NULL;
+    zval*                  options_p = NULL;
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a|a!a!",
+                &key_record_p, &bins_p, &options_p) == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for getAsync function");
+        DEBUG_PHP_EXT_ERROR("Unable to parse php parameters for getAsync function");
+        goto exit;
+    }
+
+    status = aerospike_async_get(aerospike_obj_p, getThis(), key_record_p, bins_p,
+            options_p, &error, return_value TSRMLS_CC);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    if (status != AEROSPIKE_OK) {
+        RETURN_NULL();
+    }
+}
+/* }}} */
+
+/* {{{ proto Aerospike\Future Aerospike::putAsync( array key, array record [, int ttl=0 [, array options ]] )
+    Submits the write of a record and returns a future for it */
+PHP_METHOD(Aerospike, putAsync)
+{
+    as_status              status = AEROSPIKE_OK;
+    zval*                  key_record_p = NULL;
+    zval*                  record_p = NULL;
+    zval*                  options_p = NULL;
+    long                   ttl = AS_RECORD_NO_EXPIRE_TTL;
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "aa|la!",
+                &key_record_p, &record_p, &ttl, &options_p) == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for putAsync function");
+        DEBUG_PHP_EXT_ERROR("Unable to parse php parameters for putAsync function");
+        goto exit;
+    }
+
+    status = aerospike_async_put(aerospike_obj_p, getThis(), key_record_p, record_p,
+            (u_int32_t) ttl, options_p, &error, return_value TSRMLS_CC);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    if (status != AEROSPIKE_OK) {
+        RETURN_NULL();
+    }
+}
+/* }}} */
+
+/* {{{ proto Aerospike\Future Aerospike::operateAsync( array key, array operations [, array options ] )
+    Submits multiple operations on a record and returns a future for them */
+PHP_METHOD(Aerospike, operateAsync)
+{
+    as_status              status = AEROSPIKE_OK;
+    zval*                  key_record_p = NULL;
+    zval*                  operations_p = NULL;
+    zval*                  options_p = NULL;
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "aa|a!",
+                &key_record_p, &operations_p, &options_p) == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for operateAsync function");
+        DEBUG_PHP_EXT_ERROR("Unable to parse php parameters for operateAsync function");
+        goto exit;
+    }
+
+    status = aerospike_async_operate(aerospike_obj_p, getThis(), key_record_p,
+            operations_p, options_p, &error, return_value TSRMLS_CC);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    if (status != AEROSPIKE_OK) {
+        RETURN_NULL();
+    }
+}
+/* }}} */
+
+/* {{{ proto Aerospike\Future Aerospike::applyAsync( array key, string module, string function [, array args [, array options ]] )
+    Submits the call of a record UDF and returns a future for it */
+PHP_METHOD(Aerospike, applyAsync)
+{
+    as_status              status = AEROSPIKE_OK;
+    zval*                  key_record_p = NULL;
+    char*                  module_p = NULL;
+    char*                  function_p = NULL;
+    #if PHP_VERSION_ID < 70000
+        int                    module_len = 0;
+        int                    function_len = 0;
+    #else
+        size_t                 module_len = 0;
+        size_t                 function_len = 0;
+    #endif
+    zval*                  args_p = NULL;
+    zval*                  options_p = NULL;
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "ass|a!a!",
+                &key_record_p, &module_p, &module_len, &function_p, &function_len,
+                &args_p, &options_p) == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for applyAsync function");
+        DEBUG_PHP_EXT_ERROR("Unable to parse php parameters for applyAsync function");
+        goto exit;
+    }
+
+    if (module_len == 0 || function_len == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Expects parameter 2 and 3 to be non-empty strings");
+        goto exit;
+    }
+
+    status = aerospike_async_apply(aerospike_obj_p, getThis(), key_record_p,
+            module_p, function_p, args_p, options_p, &error, return_value TSRMLS_CC);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    if (status != AEROSPIKE_OK) {
+        RETURN_NULL();
+    }
+}
+/* }}} */
+
+/* {{{ proto int Aerospike::awaitAll( array futures [, array &results ] )
+    Waits for all the futures and gets their results, keyed as the futures */
+PHP_METHOD(Aerospike, awaitAll)
+{
+    as_status              status = AEROSPIKE_OK;
+    zval*                  futures_p = NULL;
+    zval*                  results_p = NULL;
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a|z/",
+                &futures_p, &results_p) == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for awaitAll function");
+        DEBUG_PHP_EXT_ERROR("Unable to parse php parameters for awaitAll function");
+        goto exit;
+    }
+
+    if (results_p) {
+        zval_dtor(results_p);
+        array_init(results_p);
+    }
+
+    status = aerospike_async_await_all(futures_p, results_p, &error TSRMLS_CC);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/* }}} */
+
+/* {{{ proto int Aerospike::pollAsync( void )
+    Invokes the callbacks of the futures completed, set by Aerospike\Future::then() */
+PHP_METHOD(Aerospike, pollAsync)
+{
+    long                   invoked = 0;
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+
+    if (zend_parse_parameters_none() == FAILURE) {
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for pollAsync function");
+        DEBUG_PHP_EXT_ERROR("Unable to parse php parameters for pollAsync function");
+        goto exit;
+    }
+
+    invoked = aerospike_async_poll(TSRMLS_C);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(invoked);
+}
+/* }}} */
+
+/* {{{ proto resource Aerospike::asyncEventStream( void )
+    Gets a stream which becomes readable when a future with a callback completed */
+PHP_METHOD(Aerospike, asyncEventStream)
+{
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+
+    if (zend_parse_parameters_none() == FAILURE) {
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse php parameters for asyncEventStream function");
+        DEBUG_PHP_EXT_ERROR("Unable to parse php parameters for asyncEventStream function");
+        goto exit;
+    }
+
+    aerospike_async_event_stream(return_value, &error TSRMLS_CC);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    if (AEROSPIKE_OK != error.code) {
+        RETURN_NULL();
+    }
+}
+/* }}} */
+
 /**
  ********************************************************************************************************
  * Check whether Aerospike server supports CDT feature or not.
@@ -2050,12 +2478,13 @@ PHP_METHOD(Aerospike, listAppend)
     val = (as_val*) as_record_get(&record, bin_name_p);
     if (val) {
         as_operations_add_list_append(&ops, bin_name_p, (as_val*) val);
-        status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
+        status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
                 &operate_policy, &as_key_for_list, &ops, NULL);
     }
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
     #if PHP_VERSION_ID < 70000
@@ -2173,12 +2602,13 @@ PHP_METHOD(Aerospike, listInsert)
 
     if (val) {
         as_operations_add_list_insert(&ops, bin_name_p, index, (as_val*) val);
-        status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
+        status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
                 &operate_policy, &as_key_for_list, &ops, NULL);
     }
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
 
@@ -2297,12 +2727,13 @@ PHP_METHOD(Aerospike, listSet)
     val = (as_val*) as_record_get(&record, bin_name_p);
     if (val) {
         as_operations_add_list_set(&ops, bin_name_p, index, (as_val*) val);
-        status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
+        status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
                 &operate_policy, &as_key_for_list, &ops, NULL);
     }
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
     #if PHP_VERSION_ID < 70000
@@ -2412,12 +2843,13 @@ PHP_METHOD(Aerospike, listMerge)
             goto exit;
         }
         as_operations_add_list_append_items(&ops, bin_name_p, (as_list*) args_list_p);
-        status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
+        status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
                 &operate_policy, &as_key_for_list, &ops, NULL);
     }
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
     if (args_list_p) {
@@ -2495,7 +2927,7 @@ PHP_METHOD(Aerospike, listSize)
     ZVAL_LONG(list_elements_count, 0);
 
     as_operations_add_list_size(&ops, bin_name_p);
-    if (AEROSPIKE_OK != (status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
+    if (AEROSPIKE_OK != (status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
                     &operate_policy, &as_key_for_list, &ops, &rec))) {
         goto exit;
     }
@@ -2579,11 +3011,12 @@ PHP_METHOD(Aerospike, listClear)
     }
 
     as_operations_add_list_clear(&ops, bin_name_p);
-    status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p, &error, &operate_policy,
+    status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &error, &operate_policy,
             &as_key_for_list, &ops, NULL);
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
     as_operations_destroy(&ops);
@@ -2663,11 +3096,12 @@ PHP_METHOD(Aerospike, listTrim)
     }
 
     as_operations_add_list_trim(&ops, bin_name_p, index, count);
-    status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p, &error, &operate_policy,
+    status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &error, &operate_policy,
             &as_key_for_list, &ops, NULL);
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
     as_operations_destroy(&ops);
@@ -2777,12 +3211,13 @@ PHP_METHOD(Aerospike, listInsertItems)
             goto exit;
         }
         as_operations_add_list_insert_items(&ops, bin_name_p, index, (as_list*) args_list_p);
-        status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
+        status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &error,
                 &operate_policy, &as_key_for_list, &ops, NULL);
     }
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
     if (args_list_p) {
@@ -2864,7 +3299,7 @@ PHP_METHOD(Aerospike, listGet)
     }
 
     as_operations_add_list_get(&ops, bin_name_p, index);
-    if (AEROSPIKE_OK != (status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p,
+    if (AEROSPIKE_OK != (status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p,
                     &error, &operate_policy, &as_key_for_list, &ops, &rec))) {
         goto exit;
     }
@@ -2967,7 +3402,7 @@ PHP_METHOD(Aerospike, listGetRange)
     }
 
     as_operations_add_list_get_range(&ops, bin_name_p, index, count);
-    if (AEROSPIKE_OK != (status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p,
+    if (AEROSPIKE_OK != (status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p,
             &error, &operate_policy, &as_key_for_list, &ops, &rec))) {
         goto exit;
     }
@@ -3075,7 +3510,7 @@ PHP_METHOD(Aerospike, listPop)
     }
 
     as_operations_add_list_pop(&ops, bin_name_p, index);
-    if (AEROSPIKE_OK != (status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p,
+    if (AEROSPIKE_OK != (status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p,
                     &error, &operate_policy, &as_key_for_list, &ops, &rec))) {
         goto exit;
     }
@@ -3096,6 +3531,7 @@ PHP_METHOD(Aerospike, listPop)
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
     if (rec) {
@@ -3182,7 +3618,7 @@ PHP_METHOD(Aerospike, listPopRange)
     }
 
     as_operations_add_list_pop_range(&ops, bin_name_p, index, count);
-    if (AEROSPIKE_OK != (status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p,
+    if (AEROSPIKE_OK != (status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p,
                     &error, &operate_policy, &as_key_for_list, &ops, &rec))) {
         goto exit;
     }
@@ -3203,6 +3639,7 @@ PHP_METHOD(Aerospike, listPopRange)
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
     if (rec) {
@@ -3284,11 +3721,12 @@ PHP_METHOD(Aerospike, listRemove)
     }
 
     as_operations_add_list_remove(&ops, bin_name_p, index);
-    status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p, &error, &operate_policy,
+    status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &error, &operate_policy,
             &as_key_for_list, &ops, NULL);
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
     as_operations_destroy(&ops);
@@ -3367,11 +3805,12 @@ PHP_METHOD(Aerospike, listRemoveRange)
     }
 
     as_operations_add_list_remove_range(&ops, bin_name_p, index, count);
-    status = aerospike_key_operate(aerospike_obj_p->as_ref_p->as_p, &error, &operate_policy,
+    status = aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &error, &operate_policy,
             &as_key_for_list, &ops, NULL);
 
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_list);
         as_key_destroy(&as_key_for_list);
     }
     as_operations_destroy(&ops);
@@ -3542,7 +3981,135 @@ PHP_METHOD(Aerospike, setSerializer)
 }
 /* }}} */
 
-/* {{{ proto int Aerospike::removeBin( array key, array bins [, array options ])
+/* {{{ proto int Aerospike::setPolicyProfile( string ns_or_set [, array options ] )
+    Sets the default policies applied to keys of a namespace ("ns") or of a set ("ns.set") */
+PHP_METHOD(Aerospike, setPolicyProfile)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    char*                  scope_p = NULL;
+    #if PHP_VERSION_ID < 70000
+        int                    scope_len = 0;
+    #else
+        size_t                 scope_len = 0;
+    #endif
+    zval*                  options_p = NULL;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s|a!", &scope_p, &scope_len, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse parameters for setPolicyProfile");
+        DEBUG_PHP_EXT_ERROR("Unable to parse parameters for setPolicyProfile");
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK != (status = aerospike_policy_profile_set(aerospike_obj_p, scope_p,
+                    (int) scope_len, options_p, &error TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("setPolicyProfile() function returned an error");
+        goto exit;
+    }
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/* }}} */
+
+/* {{{ proto int Aerospike::setReadMemoization( bool enable )
+    Enables or disables the memoization of get() by this object for the rest of the request */
+PHP_METHOD(Aerospike, setReadMemoization)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    zend_bool              enable = 1;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "b", &enable)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse parameters for setReadMemoization");
+        DEBUG_PHP_EXT_ERROR("Unable to parse parameters for setReadMemoization");
+        goto exit;
+    }
+
+    aerospike_memo_enable(aerospike_obj_p, enable);
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/* }}} */
+
+/* {{{ proto int Aerospike::setIncrementBuffering( bool enable )
+    Enables or disables the buffering of increment() by this object, flushing the buffered increments when disabled */
+PHP_METHOD(Aerospike, setIncrementBuffering)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    zend_bool              enable = 1;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "b", &enable)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse parameters for setIncrementBuffering");
+        DEBUG_PHP_EXT_ERROR("Unable to parse parameters for setIncrementBuffering");
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK != (status = aerospike_counters_enable(aerospike_obj_p, enable,
+                    &error TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("setIncrementBuffering() function returned an error");
+    }
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/* }}} */
+
+/* {{{ proto int Aerospike::flush( void )
+    Writes the increments buffered by this object, one operate() per record */
+PHP_METHOD(Aerospike, flush)
+{
+    as_status              status = AEROSPIKE_OK;
+    as_error               error;
+    Aerospike_object*      aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (zend_parse_parameters_none() == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse parameters for flush");
+        DEBUG_PHP_EXT_ERROR("Unable to parse parameters for flush");
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK != (status = aerospike_counters_flush(aerospike_obj_p, &error TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("flush() function returned an error");
+    }
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/* }}} */
+
+/* {{{ proto int Aerospike::removeBin( array key, array bins [, array options ])
     Removes a bin from a record */
 PHP_METHOD(Aerospike, removeBin)
 {
@@ -3588,6 +4155,9 @@ PHP_METHOD(Aerospike, removeBin)
     }
 
 exit:
+    if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_put_record);
+    }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
     aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
     RETURN_LONG(status);
@@ -4025,7 +4595,7 @@ PHP_METHOD(Aerospike, aggregate)
                 #endif
                 , namespace_p, set_p,
                 bins_ht_p, Z_ARRVAL_P(predicate_p),
-                returned_p, options_p, &aerospike_obj_p->serializer_opt TSRMLS_CC))) {
+                returned_p, NULL, options_p, &aerospike_obj_p->serializer_opt TSRMLS_CC))) {
                     DEBUG_PHP_EXT_ERROR("aggregate returned an error");
                     goto exit;
     }
@@ -4036,6 +4606,165 @@ exit:
 }
 /* }}} */
 
+/* {{{ proto int Aerospike::aggregateStream( string ns, string set, array where, string module, string function, array args, callback value_cb [, array options ] )
+    Applies a stream UDF to the records matching a query and passes each value of the stream to a callback  */
+PHP_METHOD(Aerospike, aggregateStream)
+{
+    as_status               status = AEROSPIKE_OK;
+    as_error                error;
+    zval*                   module_zval_p = NULL;
+    zval*                   function_zval_p = NULL;
+    zval*                   namespace_zval_p = NULL;
+    zval*                   set_zval_p = NULL;
+    zval*                   predicate_p = NULL;
+    zval*                   args_p = NULL;
+    zval*                   options_p = NULL;
+    Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+    userland_callback       user_func = {0};
+
+    as_error_init(&error);
+
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC,
+                "zzzzzzf|z", &namespace_zval_p, &set_zval_p, &predicate_p,
+                &module_zval_p, &function_zval_p, &args_p, &user_func.fci,
+                &user_func.fcc, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for aggregateStream()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for aggregateStream()");
+        goto exit;
+    }
+
+    if (((args_p) && (PHP_TYPE_ISNOTARR(args_p)) &&
+                (PHP_TYPE_ISNOTNULL(args_p))) || ((options_p) &&
+                    (PHP_TYPE_ISNOTARR(options_p)) &&
+                    (PHP_TYPE_ISNOTNULL(options_p))) ||
+            (PHP_TYPE_ISNOTSTR(module_zval_p)) ||
+            (PHP_TYPE_ISNOTSTR(function_zval_p)) ||
+            (PHP_TYPE_ISNOTSTR(namespace_zval_p)) ||
+            (PHP_TYPE_ISNOTSTR(set_zval_p)) ||
+            (PHP_TYPE_ISNOTARR(predicate_p))) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Input parameters (type) for aggregateStream function are not proper");
+        DEBUG_PHP_EXT_ERROR("Input parameters (type) for aggregateStream function are not proper");
+        goto exit;
+    }
+
+    if (args_p && PHP_TYPE_ISNULL(args_p)) {
+        args_p = NULL;
+    }
+
+    if (options_p && PHP_TYPE_ISNULL(options_p)) {
+        options_p = NULL;
+    }
+
+    if (Z_STRLEN_P(module_zval_p) == 0 || Z_STRLEN_P(function_zval_p) == 0 ||
+            Z_STRLEN_P(namespace_zval_p) == 0 || Z_STRLEN_P(set_zval_p) == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Expects parameter 1,2,4 and 5 to be non-empty strings");
+        goto exit;
+    }
+
+    user_func.obj = aerospike_obj_p;
+    TSRMLS_SET_CTX(user_func.ts);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_query_aggregate(aerospike_obj_p,
+                &error, Z_STRVAL_P(module_zval_p), Z_STRVAL_P(function_zval_p),
+                #if PHP_VERSION_ID < 70000
+                    &args_p
+                #else
+                    args_p
+                #endif
+                , Z_STRVAL_P(namespace_zval_p), Z_STRVAL_P(set_zval_p),
+                NULL, Z_ARRVAL_P(predicate_p), NULL, &user_func,
+                options_p, &aerospike_obj_p->serializer_opt TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("aggregateStream returned an error");
+        goto exit;
+    }
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/* }}} */
+
+/* {{{ proto int Aerospike::aggregateNative( string ns, string set, array where, array aggregates, array &returned [, array options ] )
+    Computes count, sum, min, max and histogram aggregates in the extension, without a stream UDF  */
+PHP_METHOD(Aerospike, aggregateNative)
+{
+    as_status               status = AEROSPIKE_OK;
+    as_error                error;
+    zval*                   namespace_zval_p = NULL;
+    zval*                   set_zval_p = NULL;
+    zval*                   predicate_p = NULL;
+    zval*                   aggregates_p = NULL;
+    zval*                   returned_p = NULL;
+    zval*                   options_p = NULL;
+    Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    as_error_init(&error);
+
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (FAILURE == zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC,
+                "zzzzz|z/", &namespace_zval_p, &set_zval_p, &predicate_p,
+                &aggregates_p, &returned_p, &options_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Unable to parse parameters for aggregateNative()");
+        DEBUG_PHP_EXT_ERROR("Unable to parse the parameters for aggregateNative()");
+        goto exit;
+    }
+
+    if (((options_p) && (PHP_TYPE_ISNOTARR(options_p)) &&
+                (PHP_TYPE_ISNOTNULL(options_p))) ||
+            (PHP_TYPE_ISNOTSTR(namespace_zval_p)) ||
+            (PHP_TYPE_ISNOTSTR(set_zval_p)) ||
+            (PHP_TYPE_ISNOTARR(predicate_p)) ||
+            (PHP_TYPE_ISNOTARR(aggregates_p))) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Input parameters (type) for aggregateNative function are not proper");
+        DEBUG_PHP_EXT_ERROR("Input parameters (type) for aggregateNative function are not proper");
+        goto exit;
+    }
+
+    if (options_p && PHP_TYPE_ISNULL(options_p)) {
+        options_p = NULL;
+    }
+
+    if (Z_STRLEN_P(namespace_zval_p) == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Expects parameter 1 to be a non-empty string");
+        goto exit;
+    }
+
+    zval_dtor(returned_p);
+    array_init(returned_p);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_query_aggregate_native(aerospike_obj_p->as_ref_p->as_p,
+                &error, Z_STRVAL_P(namespace_zval_p), Z_STRVAL_P(set_zval_p),
+                Z_ARRVAL_P(predicate_p), Z_ARRVAL_P(aggregates_p), returned_p,
+                options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("aggregateNative returned an error");
+        goto exit;
+    }
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/* }}} */
+
 /* {{{ proto int Aerospike::scan( string ns, string set, callback record_cb [, array select [, array options ]] )
     Returns all the records in a set to a callback method  */
 PHP_METHOD(Aerospike, scan)
@@ -4105,6 +4834,213 @@ exit:
 }
 /* }}} */
 
+/* {{{ proto int Aerospike::scanCursor( string ns, string set, callback record_cb, array &cursor [, array select [, array options ]] )
+    Scans a set node by node to a callback method, resuming from and updating a cursor  */
+PHP_METHOD(Aerospike, scanCursor)
+{
+    as_status               status = AEROSPIKE_OK;
+    as_error                error;
+    Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    char                    *ns_p = NULL;
+    #if PHP_VERSION_ID < 70000
+      int                    ns_p_length = 0;
+      int                    set_p_length = 0;
+    #else
+      size_t                 ns_p_length = 0;
+      size_t                 set_p_length = 0;
+    #endif
+    char                    *set_p = NULL;
+    zval                    *cursor_p = NULL;
+    zval                    *bins_p = NULL;
+    zval                    *options_p = NULL;
+    HashTable*              bins_ht_p = NULL;
+    userland_callback       user_func = {0};
+
+    as_error_init(&error);
+
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "ss!fz/|a!a!",
+                &ns_p, &ns_p_length, &set_p, &set_p_length,
+                &user_func.fci, &user_func.fcc, &cursor_p, &bins_p,
+                &options_p) == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        DEBUG_PHP_EXT_ERROR("Aerospike::scanCursor() unable to parse parameters");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Aerospike::scanCursor() unable to parse parameters");
+        goto exit;
+    }
+
+    if (ns_p_length == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        DEBUG_PHP_EXT_ERROR("Aerospike::scanCursor() expects namespace to be a non-empty string.");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Aerospike::scanCursor() expects namespace to be a non-empty string.");
+        goto exit;
+    }
+
+    if (PHP_TYPE_ISNOTARR(cursor_p) && PHP_TYPE_ISNOTNULL(cursor_p)) {
+        status = AEROSPIKE_ERR_PARAM;
+        DEBUG_PHP_EXT_ERROR("Aerospike::scanCursor() expects cursor to be an array or NULL.");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Aerospike::scanCursor() expects cursor to be an array or NULL.");
+        goto exit;
+    }
+
+    user_func.obj = aerospike_obj_p;
+    TSRMLS_SET_CTX(user_func.ts);
+
+    bins_ht_p = (bins_p ? Z_ARRVAL_P(bins_p) : NULL);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_scan_run_cursor(aerospike_obj_p->as_ref_p->as_p,
+                                                &error, ns_p, set_p, &user_func,
+                                                bins_ht_p, cursor_p, options_p,
+                                                &aerospike_obj_p->serializer_opt TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("scanCursor returned an error");
+        goto exit;
+    }
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/* }}} */
+
+/* {{{ proto int Aerospike::scanToFile( string ns, string set, string path, int format [, array options ] )
+    Exports all the records in a set to a file, encoding them in the extension  */
+PHP_METHOD(Aerospike, scanToFile)
+{
+    as_status               status = AEROSPIKE_OK;
+    as_error                error;
+    Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    char                    *ns_p = NULL;
+    char                    *set_p = NULL;
+    char                    *path_p = NULL;
+    #if PHP_VERSION_ID < 70000
+      int                    ns_p_length = 0;
+      int                    set_p_length = 0;
+      int                    path_p_length = 0;
+    #else
+      size_t                 ns_p_length = 0;
+      size_t                 set_p_length = 0;
+      size_t                 path_p_length = 0;
+    #endif
+    long                    format = 0;
+    zval                    *options_p = NULL;
+
+    as_error_init(&error);
+
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "ss!sl|a!",
+                &ns_p, &ns_p_length, &set_p, &set_p_length,
+                &path_p, &path_p_length, &format, &options_p) == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        DEBUG_PHP_EXT_ERROR("Aerospike::scanToFile() unable to parse parameters");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Aerospike::scanToFile() unable to parse parameters");
+        goto exit;
+    }
+
+    if (ns_p_length == 0 || path_p_length == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        DEBUG_PHP_EXT_ERROR("Aerospike::scanToFile() expects namespace and path to be non-empty strings.");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Aerospike::scanToFile() expects namespace and path to be non-empty strings.");
+        goto exit;
+    }
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_bulk_scan_to_file(aerospike_obj_p->as_ref_p->as_p,
+                                                  &error, ns_p, set_p, path_p, format,
+                                                  NULL, options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("scanToFile returned an error");
+        goto exit;
+    }
+
+exit:
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/* }}} */
+
+/* {{{ proto int Aerospike::loadFile( string path, int format, string ns, string set, string key_field, array &summary [, array options ] )
+    Writes the records of a file exported by scanToFile(), or of bins, to a set  */
+PHP_METHOD(Aerospike, loadFile)
+{
+    as_status               status = AEROSPIKE_OK;
+    as_error                error;
+    Aerospike_object*       aerospike_obj_p = PHP_AEROSPIKE_GET_OBJECT;
+
+    char                    *path_p = NULL;
+    char                    *ns_p = NULL;
+    char                    *set_p = NULL;
+    char                    *key_field_p = NULL;
+    #if PHP_VERSION_ID < 70000
+      int                    path_p_length = 0;
+      int                    ns_p_length = 0;
+      int                    set_p_length = 0;
+      int                    key_field_p_length = 0;
+    #else
+      size_t                 path_p_length = 0;
+      size_t                 ns_p_length = 0;
+      size_t                 set_p_length = 0;
+      size_t                 key_field_p_length = 0;
+    #endif
+    long                    format = 0;
+    zval                    *summary_p = NULL;
+    zval                    *options_p = NULL;
+
+    as_error_init(&error);
+
+    CHECK_AEROSPIKE_OBJECT();
+    CHECK_CONNECTED();
+
+    if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sls!s!z/|a!",
+                &path_p, &path_p_length, &format, &ns_p, &ns_p_length,
+                &set_p, &set_p_length, &key_field_p, &key_field_p_length,
+                &summary_p, &options_p) == FAILURE) {
+        status = AEROSPIKE_ERR_PARAM;
+        DEBUG_PHP_EXT_ERROR("Aerospike::loadFile() unable to parse parameters");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Aerospike::loadFile() unable to parse parameters");
+        goto exit;
+    }
+
+    if (path_p_length == 0 || ns_p_length == 0) {
+        status = AEROSPIKE_ERR_PARAM;
+        DEBUG_PHP_EXT_ERROR("Aerospike::loadFile() expects path and namespace to be non-empty strings.");
+        PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM,
+                "Aerospike::loadFile() expects path and namespace to be non-empty strings.");
+        goto exit;
+    }
+
+    if (key_field_p && key_field_p_length == 0) {
+        key_field_p = NULL;
+    }
+
+    zval_dtor(summary_p);
+    array_init(summary_p);
+
+    if (AEROSPIKE_OK !=
+            (status = aerospike_bulk_load_file(aerospike_obj_p->as_ref_p->as_p,
+                                               &error, path_p, format, ns_p, set_p,
+                                               key_field_p, summary_p, options_p TSRMLS_CC))) {
+        DEBUG_PHP_EXT_ERROR("loadFile returned an error");
+        goto exit;
+    }
+
+exit:
+    aerospike_write_invalidate_all(aerospike_obj_p);
+    aerospike_near_cache_clear();
+    PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
+    aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
+    RETURN_LONG(status);
+}
+/* }}} */
+
 /* {{{ proto in Aerospike::queryApply( string ns, string set, array where,
  * string module, string function, array args, int &job_id [, array options ] )
  * Applies a record UDF to each record of a set using a background query */
@@ -4219,6 +5155,8 @@ PHP_METHOD(Aerospike, queryApply)
     }
 
 exit:
+    aerospike_write_invalidate_all(aerospike_obj_p);
+    aerospike_near_cache_clear();
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
     aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
     RETURN_LONG(status);
@@ -4327,6 +5265,8 @@ PHP_METHOD(Aerospike, scanApply)
         goto exit;
     }
 exit:
+    aerospike_write_invalidate_all(aerospike_obj_p);
+    aerospike_near_cache_clear();
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
     aerospike_helper_set_error(Aerospike_ce, getThis() TSRMLS_CC);
     RETURN_LONG(status);
@@ -4818,6 +5758,7 @@ PHP_METHOD(Aerospike, apply)
     }
 exit:
     if (initializeKey) {
+        aerospike_write_invalidate(aerospike_obj_p, &as_key_for_apply_udf);
         as_key_destroy(&as_key_for_apply_udf);
     }
     PHP_EXT_SET_AS_ERR_IN_CLASS(&error);
@@ -6015,7 +6956,7 @@ PHP_METHOD(Aerospike, setLogHandler)
         RETURN_FALSE;
     }
 
-    as_log_set_callback((as_log_callback)&aerospike_helper_log_callback);
+    as_log_set_callback((as_log_callback)&aerospike_log_queue_callback);
     is_callback_registered = 1;
     AEROSPIKE_Z_ADDREF_P(func_call_info.function_name);
     PHP_EXT_RESET_AS_ERR_IN_CLASS();
@@ -6095,6 +7036,13 @@ PHP_MINIT_FUNCTION(aerospike)
         ZEND_INIT_MODULE_GLOBALS(aerospike, aerospike_globals_ctor, aerospike_globals_dtor);
     #endif
     REGISTER_INI_ENTRIES();
+    aerospike_log_queue_init();
+    if (SUCCESS != aerospike_async_init(TSRMLS_C)) {
+        return FAILURE;
+    }
+    if (SUCCESS != aerospike_near_cache_init(TSRMLS_C)) {
+        return FAILURE;
+    }
     /* Refer aerospike_policy.h
      * This will expose the policy values for PHP
      * as well as CSDK to PHP client.
@@ -6125,6 +7073,9 @@ PHP_MINIT_FUNCTION(aerospike)
 PHP_MSHUTDOWN_FUNCTION(aerospike)
 {
     DEBUG_PHP_EXT_DEBUG("Inside mshutdown");
+    aerospike_async_shutdown();
+    aerospike_near_cache_shutdown();
+    aerospike_slowlog_shutdown();
     UNREGISTER_INI_ENTRIES();
     #ifndef ZTS
         aerospike_globals_dtor(&aerospike_globals TSRMLS_CC);
@@ -6154,6 +7105,10 @@ PHP_RINIT_FUNCTION(aerospike)
  */
 PHP_RSHUTDOWN_FUNCTION(aerospike)
 {
+    aerospike_log_queue_drain(TSRMLS_C);
+    aerospike_counters_request_shutdown(TSRMLS_C);
+    aerospike_async_request_shutdown(TSRMLS_C);
+    aerospike_slowlog_request_shutdown(TSRMLS_C);
     #if PHP_VERSION_ID < 70000
         if (user_serializer_call_info.function_name) {
             if (1 == Z_REFCOUNT_P(user_serializer_call_info.function_name)) {
@@ -6207,8 +7162,27 @@ PHP_RSHUTDOWN_FUNCTION(aerospike)
  */
 PHP_MINFO_FUNCTION(aerospike)
 {
+    uint32_t                 command = 0;
+    aerospike_command_stats  *stats_p = NULL;
+    char                     stats_str[128];
+
     php_info_print_table_start();
     php_info_print_table_row(2, "aerospike support", "enabled");
     php_info_print_table_row(2, "aerospike version", PHP_AEROSPIKE_VERSION);
     php_info_print_table_end();
+
+    php_info_print_table_start();
+    php_info_print_table_header(2, "command", "count / errors / timeouts / avg / p99");
+    for (command = 0; command < AEROSPIKE_COMMAND_MAX; command++) {
+        stats_p = aerospike_latency_command_totals(command);
+        snprintf(stats_str, sizeof(stats_str), "%llu / %llu / %llu / %llu us / %llu us",
+                (unsigned long long) stats_p->latency.count,
+                (unsigned long long) stats_p->errors,
+                (unsigned long long) stats_p->timeouts,
+                (unsigned long long) (stats_p->latency.count ?
+                    stats_p->latency.sum_us / stats_p->latency.count : 0),
+                (unsigned long long) aerospike_latency_histogram_percentile(&stats_p->latency, 99));
+        php_info_print_table_row(2, aerospike_latency_command_name(command), stats_str);
+    }
+    php_info_print_table_end();
 }
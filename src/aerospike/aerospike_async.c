@@ -0,0 +1,1947 @@
+/*
+ *
+ * Copyright (C) 2014-2016 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#include "php.h"
+#include "php_aerospike.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_key.h"
+#include "aerospike/as_arraylist.h"
+#include "aerospike/as_error.h"
+#include "aerospike/as_operations.h"
+#include "aerospike/as_record.h"
+#include "citrusleaf/cf_clock.h"
+#include "aerospike_common.h"
+#include "aerospike_policy.h"
+
+#define AEROSPIKE_ASYNC_MAX_THREADS 256
+#define AEROSPIKE_ASYNC_FLIGHT_KEY_SIZE (sizeof(aerospike *) + AS_NAMESPACE_MAX_SIZE + AS_DIGEST_VALUE_SIZE)
+
+/*
+ *******************************************************************************************************
+ * A single record command submitted by getAsync(), putAsync(), operateAsync()
+ * or applyAsync(). Everything the command needs is prepared on the PHP thread,
+ * the worker thread only calls the C client and records the latency.
+ *
+ * The key is initialized in place as its value may point into the key
+ * itself, and its strings point into the zvals held by the Aerospike\Future.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_async_op_t {
+	struct aerospike_async_op_t *next_p;
+	aerospike_command           command;
+	Aerospike_object            *client_obj_p;
+	aerospike                   *as_p;
+	as_key                      key;
+	bool                        init_key;
+	as_policy_read              read_policy;
+	as_policy_write             write_policy;
+	as_policy_operate           operate_policy;
+	as_policy_apply             apply_policy;
+	const char                  **select_p;
+	as_record                   record;
+	bool                        init_record;
+	as_static_pool              *static_pool_p;
+	as_operations               ops;
+	bool                        init_ops;
+	as_arraylist                args;
+	as_arraylist                *args_p;
+	char                        *module_p;
+	char                        *function_p;
+	as_record                   *result_record_p;
+	as_val                      *result_val_p;
+	as_error                    error;
+	char                        node[AS_NODE_NAME_SIZE];
+	uint64_t                    elapsed_us;
+	int                         notify_fd;
+	bool                        done;
+} aerospike_async_op;
+
+/*
+ *******************************************************************************************************
+ * Per process pool of worker threads executing the submitted commands, in
+ * submission order. The threads are started by the first submitted command
+ * and joined at MSHUTDOWN.
+ *******************************************************************************************************
+ */
+static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t async_queued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t async_completed = PTHREAD_COND_INITIALIZER;
+static aerospike_async_op *async_head_p = NULL;
+static aerospike_async_op *async_tail_p = NULL;
+static aerospike_async_op **async_running_p = NULL;
+static pthread_t *async_threads_p = NULL;
+static uint32_t async_n_threads = 0;
+static bool async_stopping = false;
+
+/*
+ *******************************************************************************************************
+ * The Aerospike\Future object. It holds the client and the input zvals of
+ * its command until the command completed.
+ *
+ * A getAsync() of a record being read by a running getAsync() of the same
+ * client and bins joins it instead of being submitted: its future shares the
+ * command of the leading future, which it holds.
+ *******************************************************************************************************
+ */
+#if PHP_VERSION_ID < 70000
+typedef struct aerospike_future_object_t {
+	zend_object         std;
+	aerospike_async_op  *op_p;
+	Aerospike_object    *client_obj_p;
+	zval                *client;
+	zval                *key;
+	zval                *payload;
+	zval                *options;
+	zval                *callback;
+	zval                *leader;
+	bool                collected;
+	zend_object_handle  handle;
+	char                flight_key[AEROSPIKE_ASYNC_FLIGHT_KEY_SIZE];
+	size_t              flight_key_len;
+	char                *flight_select_p;
+	size_t              flight_select_len;
+} aerospike_future_object;
+
+#define AEROSPIKE_FUTURE_HOLD(future_p, field, zval_p) \
+	if (zval_p) { \
+		Z_ADDREF_P(zval_p); \
+		(future_p)->field = (zval_p); \
+	}
+
+#define AEROSPIKE_FUTURE_ZVAL(future_p, field) ((future_p)->field)
+
+#define AEROSPIKE_FUTURE_HOLD_LEADER(future_p, leader_p) \
+	MAKE_STD_ZVAL((future_p)->leader); \
+	Z_TYPE_P((future_p)->leader) = IS_OBJECT; \
+	Z_OBJ_HANDLE_P((future_p)->leader) = (leader_p)->handle; \
+	Z_OBJ_HT_P((future_p)->leader) = &Future_handlers; \
+	zend_objects_store_add_ref((future_p)->leader TSRMLS_CC);
+
+#define AEROSPIKE_FUTURE_RELEASE(future_p, field) \
+	if ((future_p)->field) { \
+		zval_ptr_dtor(&(future_p)->field); \
+		(future_p)->field = NULL; \
+	}
+#else
+typedef struct aerospike_future_object_t {
+	aerospike_async_op  *op_p;
+	Aerospike_object    *client_obj_p;
+	zval                client;
+	zval                key;
+	zval                payload;
+	zval                options;
+	zval                callback;
+	zval                leader;
+	bool                collected;
+	char                flight_key[AEROSPIKE_ASYNC_FLIGHT_KEY_SIZE];
+	size_t              flight_key_len;
+	char                *flight_select_p;
+	size_t              flight_select_len;
+	zend_object         std;
+} aerospike_future_object;
+
+#define AEROSPIKE_FUTURE_HOLD(future_p, field, zval_p) \
+	if (zval_p) { \
+		ZVAL_COPY(&(future_p)->field, (zval_p)); \
+	}
+
+#define AEROSPIKE_FUTURE_ZVAL(future_p, field) \
+	(Z_ISUNDEF((future_p)->field) ? NULL : &(future_p)->field)
+
+#define AEROSPIKE_FUTURE_HOLD_LEADER(future_p, leader_p) \
+	ZVAL_OBJ(&(future_p)->leader, &(leader_p)->std); \
+	Z_ADDREF((future_p)->leader);
+
+#define AEROSPIKE_FUTURE_RELEASE(future_p, field) \
+	zval_ptr_dtor(&(future_p)->field); \
+	ZVAL_UNDEF(&(future_p)->field);
+#endif
+
+static zend_class_entry *Future_ce;
+static zend_object_handlers Future_handlers;
+
+/*
+ *******************************************************************************************************
+ * Function to execute a command on a worker thread. Only the thread safe
+ * latency counters are updated here, the slow log is recorded on the PHP
+ * thread when the result is collected.
+ *******************************************************************************************************
+ */
+static void
+aerospike_async_execute(aerospike_async_op *op_p)
+{
+	uint64_t    start_us = cf_getus();
+
+	as_error_init(&op_p->error);
+
+	switch (op_p->command) {
+		case AEROSPIKE_COMMAND_GET:
+			if (op_p->select_p) {
+				aerospike_key_select(op_p->as_p, &op_p->error, &op_p->read_policy,
+						&op_p->key, op_p->select_p, &op_p->result_record_p);
+			} else {
+				aerospike_key_get(op_p->as_p, &op_p->error, &op_p->read_policy,
+						&op_p->key, &op_p->result_record_p);
+			}
+			break;
+		case AEROSPIKE_COMMAND_PUT:
+			aerospike_key_put(op_p->as_p, &op_p->error, &op_p->write_policy,
+					&op_p->key, &op_p->record);
+			break;
+		case AEROSPIKE_COMMAND_OPERATE:
+			aerospike_key_operate(op_p->as_p, &op_p->error, &op_p->operate_policy,
+					&op_p->key, &op_p->ops, &op_p->result_record_p);
+			break;
+		case AEROSPIKE_COMMAND_UDF:
+			aerospike_key_apply(op_p->as_p, &op_p->error, &op_p->apply_policy,
+					&op_p->key, op_p->module_p, op_p->function_p,
+					(as_list *) op_p->args_p, &op_p->result_val_p);
+			break;
+		default:
+			as_error_update(&op_p->error, AEROSPIKE_ERR_CLIENT, "Invalid async command");
+			break;
+	}
+
+	aerospike_latency_key_node(op_p->as_p, &op_p->key, op_p->node);
+	op_p->elapsed_us = aerospike_latency_record(aerospike_latency_node(op_p->node),
+			op_p->command, start_us, op_p->error.code);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to wake up the event loop watching the completions of a PHP
+ * thread, see aerospike_async_notify_fd(). The fd is non blocking, a full
+ * pipe already wakes the loop up.
+ *******************************************************************************************************
+ */
+static void
+aerospike_async_signal(int notify_fd)
+{
+#ifdef __linux__
+	uint64_t    one = 1;
+#else
+	char        one = 1;
+#endif
+
+	if (write(notify_fd, &one, sizeof(one)) < 0) {
+		DEBUG_PHP_EXT_DEBUG("Unable to signal an async completion");
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Worker thread of the pool. It executes the queued commands until the pool
+ * is stopped and the queue is empty.
+ *******************************************************************************************************
+ */
+static void*
+aerospike_async_worker(void *arg_p)
+{
+	uint32_t            index = (uint32_t) (uintptr_t) arg_p;
+	aerospike_async_op  *op_p = NULL;
+	int                 notify_fd = -1;
+
+	for (;;) {
+		pthread_mutex_lock(&async_lock);
+		while ((!async_head_p) && (!async_stopping)) {
+			pthread_cond_wait(&async_queued, &async_lock);
+		}
+		if (!(op_p = async_head_p)) {
+			pthread_mutex_unlock(&async_lock);
+			break;
+		}
+		if (!(async_head_p = op_p->next_p)) {
+			async_tail_p = NULL;
+		}
+		async_running_p[index] = op_p;
+		pthread_mutex_unlock(&async_lock);
+
+		aerospike_async_execute(op_p);
+
+		pthread_mutex_lock(&async_lock);
+		async_running_p[index] = NULL;
+		op_p->done = true;
+		notify_fd = op_p->notify_fd;
+		pthread_cond_broadcast(&async_completed);
+		pthread_mutex_unlock(&async_lock);
+
+		if (notify_fd >= 0) {
+			aerospike_async_signal(notify_fd);
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to start the worker threads, if not started yet. Called with
+ * async_lock held.
+ *
+ * @return AEROSPIKE_OK if at least one worker thread is running.
+ *******************************************************************************************************
+ */
+static as_status
+aerospike_async_start(long n_threads, as_error *error_p)
+{
+	uint32_t    iter = 0;
+
+	if (async_n_threads) {
+		return AEROSPIKE_OK;
+	}
+
+	if (n_threads < 1) {
+		n_threads = 1;
+	} else if (n_threads > AEROSPIKE_ASYNC_MAX_THREADS) {
+		n_threads = AEROSPIKE_ASYNC_MAX_THREADS;
+	}
+
+	async_threads_p = (pthread_t *) calloc(n_threads, sizeof(pthread_t));
+	async_running_p = (aerospike_async_op **) calloc(n_threads, sizeof(aerospike_async_op *));
+	if ((!async_threads_p) || (!async_running_p)) {
+		free(async_threads_p);
+		free(async_running_p);
+		async_threads_p = NULL;
+		async_running_p = NULL;
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to allocate the async worker threads");
+		return AEROSPIKE_ERR_CLIENT;
+	}
+
+	async_stopping = false;
+	for (iter = 0; iter < (uint32_t) n_threads; iter++) {
+		if (0 != pthread_create(&async_threads_p[iter], NULL,
+					aerospike_async_worker, (void *) (uintptr_t) iter)) {
+			break;
+		}
+		async_n_threads++;
+	}
+
+	if (!async_n_threads) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to start the async worker threads");
+		return AEROSPIKE_ERR_CLIENT;
+	}
+
+	return AEROSPIKE_OK;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to queue a prepared command for the worker threads.
+ *
+ * @return AEROSPIKE_OK if the command was queued. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+aerospike_async_submit(aerospike_async_op *op_p, as_error *error_p TSRMLS_DC)
+{
+	as_status   status = AEROSPIKE_OK;
+
+	pthread_mutex_lock(&async_lock);
+	if (AEROSPIKE_OK == (status = aerospike_async_start(AEROSPIKE_G(async_threads), error_p))) {
+		op_p->next_p = NULL;
+		if (async_tail_p) {
+			async_tail_p->next_p = op_p;
+		} else {
+			async_head_p = op_p;
+		}
+		async_tail_p = op_p;
+		pthread_cond_signal(&async_queued);
+	}
+	pthread_mutex_unlock(&async_lock);
+
+	return status;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to wait for a submitted command to complete.
+ *******************************************************************************************************
+ */
+static void
+aerospike_async_wait(aerospike_async_op *op_p)
+{
+	pthread_mutex_lock(&async_lock);
+	while (!op_p->done) {
+		pthread_cond_wait(&async_completed, &async_lock);
+	}
+	pthread_mutex_unlock(&async_lock);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to check whether a submitted command completed, without waiting.
+ *******************************************************************************************************
+ */
+static bool
+aerospike_async_is_done(aerospike_async_op *op_p)
+{
+	bool    done = false;
+
+	pthread_mutex_lock(&async_lock);
+	done = op_p->done;
+	pthread_mutex_unlock(&async_lock);
+
+	return done;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to allocate a command. The static pool is allocated by the
+ * commands which transform PHP values.
+ *******************************************************************************************************
+ */
+static aerospike_async_op*
+aerospike_async_op_new(Aerospike_object *aerospike_obj_p, aerospike_command command,
+		as_error *error_p)
+{
+	aerospike_async_op  *op_p = NULL;
+
+	if (!(op_p = (aerospike_async_op *) calloc(1, sizeof(aerospike_async_op)))) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to allocate the async command");
+		return NULL;
+	}
+
+	if (((command == AEROSPIKE_COMMAND_PUT) || (command == AEROSPIKE_COMMAND_UDF)) &&
+			!(op_p->static_pool_p = (as_static_pool *) calloc(1, sizeof(as_static_pool)))) {
+		free(op_p);
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to allocate the async command");
+		return NULL;
+	}
+
+	op_p->command = command;
+	op_p->client_obj_p = aerospike_obj_p;
+	op_p->as_p = aerospike_obj_p->as_ref_p->as_p;
+	op_p->notify_fd = -1;
+	as_error_init(&op_p->error);
+
+	return op_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to free a command which is not queued or has completed.
+ *******************************************************************************************************
+ */
+static void
+aerospike_async_op_destroy(aerospike_async_op *op_p)
+{
+	if (op_p->result_record_p) {
+		as_record_destroy(op_p->result_record_p);
+	}
+	if (op_p->result_val_p) {
+		as_val_destroy(op_p->result_val_p);
+	}
+	if (op_p->args_p) {
+		as_arraylist_destroy(op_p->args_p);
+	}
+	if (op_p->init_ops) {
+		as_operations_destroy(&op_p->ops);
+	}
+	if (op_p->static_pool_p) {
+		aerospike_helper_free_static_pool(op_p->static_pool_p);
+		free(op_p->static_pool_p);
+	}
+	if (op_p->init_record) {
+		as_record_destroy(&op_p->record);
+	}
+	if (op_p->init_key) {
+		as_key_destroy(&op_p->key);
+	}
+	free(op_p->select_p);
+	free(op_p->module_p);
+	free(op_p->function_p);
+	free(op_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Fork handlers of the pool. The worker threads do not exist in the child,
+ * so the commands queued or running in the parent are failed there and the
+ * pool is started again by the next submitted command.
+ *******************************************************************************************************
+ */
+static void
+aerospike_async_atfork_prepare(void)
+{
+	pthread_mutex_lock(&async_lock);
+}
+
+static void
+aerospike_async_atfork_parent(void)
+{
+	pthread_mutex_unlock(&async_lock);
+}
+
+static void
+aerospike_async_atfork_child(void)
+{
+	aerospike_async_op  *op_p = NULL;
+	uint32_t            iter = 0;
+
+	pthread_mutex_init(&async_lock, NULL);
+	pthread_cond_init(&async_queued, NULL);
+	pthread_cond_init(&async_completed, NULL);
+
+	for (op_p = async_head_p; op_p; op_p = op_p->next_p) {
+		as_error_update(&op_p->error, AEROSPIKE_ERR_CLIENT, "Async command lost by fork()");
+		op_p->done = true;
+	}
+	for (iter = 0; iter < async_n_threads; iter++) {
+		if ((op_p = async_running_p[iter])) {
+			as_error_update(&op_p->error, AEROSPIKE_ERR_CLIENT, "Async command lost by fork()");
+			op_p->done = true;
+		}
+	}
+
+	async_head_p = NULL;
+	async_tail_p = NULL;
+	free(async_threads_p);
+	free(async_running_p);
+	async_threads_p = NULL;
+	async_running_p = NULL;
+	async_n_threads = 0;
+	async_stopping = false;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to fetch the aerospike_future_object of an Aerospike\Future zval.
+ *******************************************************************************************************
+ */
+static aerospike_future_object*
+aerospike_future_fetch(zval *future_p TSRMLS_DC)
+{
+#if PHP_VERSION_ID < 70000
+	return (aerospike_future_object *) zend_object_store_get_object(future_p TSRMLS_CC);
+#else
+	return (aerospike_future_object *) ((char *) Z_OBJ_P(future_p) -
+			XtOffsetOf(aerospike_future_object, std));
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Function to build the key of the reads in flight of a record, the client
+ * followed by the namespace and digest of the record. The digest is computed
+ * here, before the command is submitted.
+ *
+ * @return the length of the key, 0 if the digest cannot be computed.
+ *******************************************************************************************************
+ */
+static size_t
+aerospike_async_flight_key(aerospike *as_p, as_key *as_key_p, char *flight_key)
+{
+	as_digest   *digest_p = NULL;
+	size_t      ns_len = strlen(as_key_p->ns);
+
+	if (!(digest_p = as_key_digest(as_key_p))) {
+		return 0;
+	}
+
+	memcpy(flight_key, &as_p, sizeof(aerospike *));
+	memcpy(flight_key + sizeof(aerospike *), as_key_p->ns, ns_len);
+	flight_key[sizeof(aerospike *) + ns_len] = '\0';
+	memcpy(flight_key + sizeof(aerospike *) + ns_len + 1, digest_p->value, AS_DIGEST_VALUE_SIZE);
+	return sizeof(aerospike *) + ns_len + 1 + AS_DIGEST_VALUE_SIZE;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to build the bins read by a getAsync(), "*" for all the bins, or
+ * the bin names each terminated by a NUL, in the order given.
+ *
+ * @return the selection to be freed with efree().
+ *******************************************************************************************************
+ */
+static char*
+aerospike_async_flight_select(aerospike_async_op *op_p, size_t *select_len_p)
+{
+	char        *select_p = NULL;
+	size_t      select_len = 0;
+	size_t      name_len = 0;
+	uint32_t    iter = 0;
+
+	if (!op_p->select_p) {
+		*select_len_p = 1;
+		return estrndup("*", 1);
+	}
+
+	for (iter = 0; op_p->select_p[iter]; iter++) {
+		select_len += strlen(op_p->select_p[iter]) + 1;
+	}
+	select_p = (char *) emalloc(select_len + 1);
+	select_len = 0;
+	for (iter = 0; op_p->select_p[iter]; iter++) {
+		name_len = strlen(op_p->select_p[iter]) + 1;
+		memcpy(select_p + select_len, op_p->select_p[iter], name_len);
+		select_len += name_len;
+	}
+
+	*select_len_p = select_len;
+	return select_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to find the future of the running read a getAsync() can join.
+ *
+ * @return the leading future, NULL if the read must be submitted.
+ *******************************************************************************************************
+ */
+static aerospike_future_object*
+aerospike_async_flight_find(const char *flight_key, size_t flight_key_len,
+		const char *select_p, size_t select_len TSRMLS_DC)
+{
+	aerospike_future_object *leader_p = NULL;
+#if PHP_VERSION_ID < 70000
+	aerospike_future_object **leader_pp = NULL;
+#endif
+
+	if ((!AEROSPIKE_G(async_flights_g)) || (!flight_key_len)) {
+		return NULL;
+	}
+
+#if PHP_VERSION_ID < 70000
+	if (SUCCESS != zend_hash_find(AEROSPIKE_G(async_flights_g), flight_key, flight_key_len,
+				(void **) &leader_pp)) {
+		return NULL;
+	}
+	leader_p = *leader_pp;
+#else
+	if (!(leader_p = zend_hash_str_find_ptr(AEROSPIKE_G(async_flights_g), flight_key,
+					flight_key_len))) {
+		return NULL;
+	}
+#endif
+
+	if ((leader_p->flight_select_len != select_len) ||
+			(0 != memcmp(leader_p->flight_select_p, select_p, select_len)) ||
+			aerospike_async_is_done(leader_p->op_p)) {
+		return NULL;
+	}
+
+	return leader_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to register a submitted getAsync() as the read in flight of its
+ * record, which the following getAsync() of the record can join.
+ *******************************************************************************************************
+ */
+static void
+aerospike_async_flight_add(aerospike_future_object *leader_p TSRMLS_DC)
+{
+	if (!leader_p->flight_key_len) {
+		return;
+	}
+
+	if (!AEROSPIKE_G(async_flights_g)) {
+		ALLOC_HASHTABLE(AEROSPIKE_G(async_flights_g));
+		zend_hash_init(AEROSPIKE_G(async_flights_g), 16, NULL, NULL, 0);
+	}
+
+#if PHP_VERSION_ID < 70000
+	zend_hash_update(AEROSPIKE_G(async_flights_g), leader_p->flight_key,
+			leader_p->flight_key_len, &leader_p, sizeof(aerospike_future_object *), NULL);
+#else
+	zend_hash_str_update_ptr(AEROSPIKE_G(async_flights_g), leader_p->flight_key,
+			leader_p->flight_key_len, leader_p);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Function to unregister a leading future being freed, if still registered.
+ *******************************************************************************************************
+ */
+static void
+aerospike_async_flight_remove(aerospike_future_object *leader_p TSRMLS_DC)
+{
+#if PHP_VERSION_ID < 70000
+	aerospike_future_object **found_pp = NULL;
+#endif
+
+	if ((!AEROSPIKE_G(async_flights_g)) || (!leader_p->flight_key_len)) {
+		return;
+	}
+
+#if PHP_VERSION_ID < 70000
+	if ((SUCCESS == zend_hash_find(AEROSPIKE_G(async_flights_g), leader_p->flight_key,
+				leader_p->flight_key_len, (void **) &found_pp)) && (*found_pp == leader_p)) {
+		zend_hash_del(AEROSPIKE_G(async_flights_g), leader_p->flight_key,
+				leader_p->flight_key_len);
+	}
+#else
+	if (zend_hash_str_find_ptr(AEROSPIKE_G(async_flights_g), leader_p->flight_key,
+				leader_p->flight_key_len) == leader_p) {
+		zend_hash_str_del(AEROSPIKE_G(async_flights_g), leader_p->flight_key,
+				leader_p->flight_key_len);
+	}
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Aerospike\Future object freeing up on scope termination. A future which is
+ * still running is waited for, as its command uses the zvals it holds.
+ *******************************************************************************************************
+ */
+static void
+Future_object_free_storage(zend_object *object TSRMLS_DC)
+{
+	aerospike_future_object *future_p = (aerospike_future_object *)
+		((char *) object - XtOffsetOf(aerospike_future_object, std));
+
+	if (AEROSPIKE_FUTURE_ZVAL(future_p, leader)) {
+		/*
+		 * The command is owned by the leading future.
+		 */
+		future_p->op_p = NULL;
+	} else if (future_p->op_p) {
+		aerospike_async_flight_remove(future_p TSRMLS_CC);
+		aerospike_async_wait(future_p->op_p);
+		aerospike_async_op_destroy(future_p->op_p);
+		future_p->op_p = NULL;
+	}
+	if (future_p->flight_select_p) {
+		efree(future_p->flight_select_p);
+		future_p->flight_select_p = NULL;
+	}
+
+	AEROSPIKE_FUTURE_RELEASE(future_p, leader);
+
+	AEROSPIKE_FUTURE_RELEASE(future_p, key);
+	AEROSPIKE_FUTURE_RELEASE(future_p, payload);
+	AEROSPIKE_FUTURE_RELEASE(future_p, options);
+	AEROSPIKE_FUTURE_RELEASE(future_p, callback);
+	AEROSPIKE_FUTURE_RELEASE(future_p, client);
+
+	zend_object_std_dtor(&future_p->std TSRMLS_CC);
+#if PHP_VERSION_ID < 70000
+	efree(future_p);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Aerospike\Future class new method
+ *******************************************************************************************************
+ */
+#if PHP_VERSION_ID < 70000
+static zend_object_value
+Future_object_new(zend_class_entry *ce TSRMLS_DC)
+{
+	zend_object_value           retval = {0};
+	aerospike_future_object     *future_p = ecalloc(1, sizeof(aerospike_future_object));
+
+	zend_object_std_init(&future_p->std, ce TSRMLS_CC);
+	object_properties_init(&future_p->std, ce);
+	retval.handle = zend_objects_store_put(future_p, NULL,
+			(zend_objects_free_object_storage_t) Future_object_free_storage, NULL TSRMLS_CC);
+	retval.handlers = &Future_handlers;
+	future_p->handle = retval.handle;
+	return retval;
+}
+#else
+static zend_object*
+Future_object_new(zend_class_entry *ce TSRMLS_DC)
+{
+	aerospike_future_object     *future_p = ecalloc(1,
+			sizeof(aerospike_future_object) + zend_object_properties_size(ce));
+
+	zend_object_std_init(&future_p->std, ce TSRMLS_CC);
+	object_properties_init(&future_p->std, ce);
+	future_p->std.handlers = &Future_handlers;
+	return &future_p->std;
+}
+#endif
+
+/*
+ *******************************************************************************************************
+ * Function to set the error and errorno properties of a future.
+ *******************************************************************************************************
+ */
+static void
+aerospike_future_set_error(zval *future_zval_p, as_error *error_p TSRMLS_DC)
+{
+	zend_update_property_long(Future_ce, future_zval_p, "errorno", strlen("errorno"),
+			error_p->code TSRMLS_CC);
+	zend_update_property_string(Future_ce, future_zval_p, "error", strlen("error"),
+			error_p->message TSRMLS_CC);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to convert the result of a completed command into result_p, on
+ * the PHP thread. The slow log is recorded the first time the result of a
+ * command is collected.
+ *
+ * @param future_p              The completed future.
+ * @param result_p              The zval to be set to the result: the record
+ *                              for getAsync(), the returned bins for
+ *                              operateAsync(), the UDF's return value for
+ *                              applyAsync() and NULL for putAsync().
+ *
+ * @return the status of the command.
+ *******************************************************************************************************
+ */
+static as_status
+aerospike_future_collect(aerospike_future_object *future_p, zval *result_p TSRMLS_DC)
+{
+	aerospike_async_op      *op_p = future_p->op_p;
+	foreach_callback_udata  udata;
+	as_error                error;
+	DECLARE_ZVAL(bins_p);
+
+	if (!future_p->collected) {
+		aerospike_slowlog_record(op_p->command, op_p->key.ns, op_p->key.set,
+				&op_p->key, op_p->node,
+				(op_p->command == AEROSPIKE_COMMAND_PUT) ? &op_p->record : op_p->result_record_p,
+				op_p->elapsed_us, op_p->error.code);
+		if (op_p->command != AEROSPIKE_COMMAND_GET) {
+			aerospike_write_invalidate(future_p->client_obj_p, &op_p->key);
+		}
+		future_p->collected = true;
+	}
+
+	if (!result_p) {
+		return op_p->error.code;
+	}
+
+	as_error_init(&error);
+	udata.udata_p = result_p;
+	udata.error_p = &error;
+	udata.obj = future_p->client_obj_p;
+
+	switch (op_p->command) {
+		case AEROSPIKE_COMMAND_GET:
+			array_init(result_p);
+			if ((AEROSPIKE_OK != op_p->error.code) || (!op_p->result_record_p)) {
+				break;
+			}
+#if PHP_VERSION_ID < 70000
+			MAKE_STD_ZVAL(bins_p);
+			array_init(bins_p);
+			udata.udata_p = bins_p;
+#else
+			array_init(&bins_p);
+			udata.udata_p = &bins_p;
+#endif
+			as_record_foreach(op_p->result_record_p, (as_rec_foreach_callback) AS_DEFAULT_GET,
+					&udata);
+			aerospike_get_key_meta_bins_of_record(&op_p->as_p->config,
+					op_p->result_record_p, &op_p->key, result_p,
+					AEROSPIKE_FUTURE_ZVAL(future_p, options), true TSRMLS_CC);
+#if PHP_VERSION_ID < 70000
+			add_assoc_zval(result_p, PHP_AS_RECORD_DEFINE_FOR_BINS, bins_p);
+#else
+			add_assoc_zval(result_p, PHP_AS_RECORD_DEFINE_FOR_BINS, &bins_p);
+#endif
+			break;
+		case AEROSPIKE_COMMAND_OPERATE:
+			array_init(result_p);
+			if ((AEROSPIKE_OK == op_p->error.code) && op_p->result_record_p) {
+				as_record_foreach(op_p->result_record_p, (as_rec_foreach_callback) AS_DEFAULT_GET,
+						&udata);
+			}
+			break;
+		case AEROSPIKE_COMMAND_UDF:
+			ZVAL_NULL(result_p);
+			if ((AEROSPIKE_OK == op_p->error.code) && op_p->result_val_p) {
+				AS_DEFAULT_GET(NULL, op_p->result_val_p, &udata);
+			}
+			break;
+		default:
+			ZVAL_NULL(result_p);
+			break;
+	}
+
+	return op_p->error.code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to return a Future for a command which has been submitted.
+ *******************************************************************************************************
+ */
+static void
+aerospike_future_init(zval *future_zval_p, aerospike_async_op *op_p,
+		Aerospike_object *aerospike_obj_p, zval *client_p, zval *key_p,
+		zval *payload_p, zval *options_p TSRMLS_DC)
+{
+	aerospike_future_object *future_p = NULL;
+
+	object_init_ex(future_zval_p, Future_ce);
+	future_p = aerospike_future_fetch(future_zval_p TSRMLS_CC);
+	future_p->op_p = op_p;
+	future_p->client_obj_p = aerospike_obj_p;
+	AEROSPIKE_FUTURE_HOLD(future_p, client, client_p);
+	AEROSPIKE_FUTURE_HOLD(future_p, key, key_p);
+	AEROSPIKE_FUTURE_HOLD(future_p, payload, payload_p);
+	AEROSPIKE_FUTURE_HOLD(future_p, options, options_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to prepare the key of a command from the PHP key array.
+ *******************************************************************************************************
+ */
+static as_status
+aerospike_async_key(aerospike_async_op *op_p, zval *key_p, as_error *error_p)
+{
+	int16_t     init_key = 0;
+
+	if (AEROSPIKE_OK != aerospike_transform_iterate_for_rec_key_params(Z_ARRVAL_P(key_p),
+				&op_p->key, &init_key)) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM, "Unable to parse the key parameters");
+		return AEROSPIKE_ERR_PARAM;
+	}
+	op_p->init_key = (init_key != 0);
+
+	return AEROSPIKE_OK;
+}
+
+/*
+ *******************************************************************************************************
+ * Submits a read of a record for Aerospike::getAsync(). A read of the same
+ * bins of the record by a running getAsync() of the client is joined instead,
+ * whatever its policies.
+ *
+ * @param aerospike_obj_p           The Aerospike_object of the client.
+ * @param client_p                  The client zval, held by the future.
+ * @param key_p                     The PHP key array.
+ * @param select_p                  The optional bins to be read, else NULL.
+ * @param options_p                 The optional policies, else NULL.
+ * @param error_p                   The as_error to be set to the encountered error.
+ * @param future_zval_p             The zval to be set to the Aerospike\Future.
+ *
+ * @return AEROSPIKE_OK if the command was submitted. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_async_get(Aerospike_object *aerospike_obj_p, zval *client_p,
+		zval *key_p, zval *select_p, zval *options_p, as_error *error_p,
+		zval *future_zval_p TSRMLS_DC)
+{
+	aerospike_async_op      *op_p = NULL;
+	uint32_t                n_select = 0;
+	HashPosition            pointer;
+	char                    flight_key[AEROSPIKE_ASYNC_FLIGHT_KEY_SIZE];
+	size_t                  flight_key_len = 0;
+	char                    *flight_select_p = NULL;
+	size_t                  flight_select_len = 0;
+	aerospike_future_object *future_p = NULL;
+	aerospike_future_object *leader_p = NULL;
+	DECLARE_ZVAL_P(bin_name_pp);
+
+	if (!(op_p = aerospike_async_op_new(aerospike_obj_p, AEROSPIKE_COMMAND_GET, error_p))) {
+		goto exit;
+	}
+
+	if (AEROSPIKE_OK != aerospike_async_key(op_p, key_p, error_p)) {
+		goto exit;
+	}
+
+	set_policy_for_key(aerospike_obj_p, &op_p->key, &op_p->read_policy, NULL, NULL, NULL,
+			NULL, NULL, options_p, error_p TSRMLS_CC);
+	if (AEROSPIKE_OK != error_p->code) {
+		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+		goto exit;
+	}
+
+	if (select_p) {
+		if (!(op_p->select_p = (const char **) calloc(
+						zend_hash_num_elements(Z_ARRVAL_P(select_p)) + 1, sizeof(char *)))) {
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to allocate the bins to select");
+			goto exit;
+		}
+#if PHP_VERSION_ID < 70000
+		AEROSPIKE_FOREACH_HASHTABLE(Z_ARRVAL_P(select_p), pointer, bin_name_pp) {
+#else
+		ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(select_p), bin_name_pp) {
+#endif
+			if (AEROSPIKE_Z_TYPE_P(bin_name_pp) != IS_STRING) {
+				PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM, "Bins to select must be strings");
+				goto exit;
+			}
+			op_p->select_p[n_select++] = AEROSPIKE_Z_STRVAL_P(bin_name_pp);
+#if PHP_VERSION_ID < 70000
+		}
+#else
+		} ZEND_HASH_FOREACH_END();
+#endif
+	}
+
+	flight_key_len = aerospike_async_flight_key(op_p->as_p, &op_p->key, flight_key);
+	flight_select_p = aerospike_async_flight_select(op_p, &flight_select_len);
+
+	if ((leader_p = aerospike_async_flight_find(flight_key, flight_key_len,
+					flight_select_p, flight_select_len TSRMLS_CC))) {
+		aerospike_future_init(future_zval_p, leader_p->op_p, aerospike_obj_p, client_p,
+				key_p, select_p, options_p TSRMLS_CC);
+		future_p = aerospike_future_fetch(future_zval_p TSRMLS_CC);
+		AEROSPIKE_FUTURE_HOLD_LEADER(future_p, leader_p);
+		/*
+		 * The slow log of the read is recorded by the leading future.
+		 */
+		future_p->collected = true;
+		goto exit;
+	}
+
+	if (AEROSPIKE_OK != aerospike_async_submit(op_p, error_p TSRMLS_CC)) {
+		goto exit;
+	}
+
+	aerospike_future_init(future_zval_p, op_p, aerospike_obj_p, client_p, key_p,
+			select_p, options_p TSRMLS_CC);
+	op_p = NULL;
+
+	future_p = aerospike_future_fetch(future_zval_p TSRMLS_CC);
+	memcpy(future_p->flight_key, flight_key, flight_key_len);
+	future_p->flight_key_len = flight_key_len;
+	future_p->flight_select_p = flight_select_p;
+	future_p->flight_select_len = flight_select_len;
+	flight_select_p = NULL;
+	aerospike_async_flight_add(future_p TSRMLS_CC);
+
+exit:
+	if (op_p) {
+		aerospike_async_op_destroy(op_p);
+	}
+	if (flight_select_p) {
+		efree(flight_select_p);
+	}
+
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Submits a write of a record for Aerospike::putAsync().
+ *
+ * @param aerospike_obj_p           The Aerospike_object of the client.
+ * @param client_p                  The client zval, held by the future.
+ * @param key_p                     The PHP key array.
+ * @param bins_p                    The PHP array of bins to be written.
+ * @param ttl_u32                   The ttl of the record.
+ * @param options_p                 The optional policies, else NULL.
+ * @param error_p                   The as_error to be set to the encountered error.
+ * @param future_zval_p             The zval to be set to the Aerospike\Future.
+ *
+ * @return AEROSPIKE_OK if the command was submitted. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_async_put(Aerospike_object *aerospike_obj_p, zval *client_p,
+		zval *key_p, zval *bins_p, u_int32_t ttl_u32, zval *options_p,
+		as_error *error_p, zval *future_zval_p TSRMLS_DC)
+{
+	aerospike_async_op  *op_p = NULL;
+
+	if (!(op_p = aerospike_async_op_new(aerospike_obj_p, AEROSPIKE_COMMAND_PUT, error_p))) {
+		goto exit;
+	}
+
+	if (AEROSPIKE_OK != aerospike_async_key(op_p, key_p, error_p)) {
+		goto exit;
+	}
+
+	as_record_init(&op_p->record, zend_hash_num_elements(Z_ARRVAL_P(bins_p)));
+	op_p->init_record = true;
+
+	if (AEROSPIKE_OK != aerospike_transform_key_data_prepare_put(aerospike_obj_p,
+#if PHP_VERSION_ID < 70000
+				&bins_p,
+#else
+				bins_p,
+#endif
+				&op_p->key, &op_p->record, op_p->static_pool_p, &op_p->write_policy,
+				error_p, ttl_u32, options_p, &aerospike_obj_p->serializer_opt TSRMLS_CC)) {
+		goto exit;
+	}
+
+	aerospike_write_invalidate(aerospike_obj_p, &op_p->key);
+	if (AEROSPIKE_OK != aerospike_async_submit(op_p, error_p TSRMLS_CC)) {
+		goto exit;
+	}
+
+	aerospike_future_init(future_zval_p, op_p, aerospike_obj_p, client_p, key_p,
+			bins_p, options_p TSRMLS_CC);
+	op_p = NULL;
+
+exit:
+	if (op_p) {
+		aerospike_async_op_destroy(op_p);
+	}
+
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Submits operations on a record for Aerospike::operateAsync().
+ *
+ * @param aerospike_obj_p           The Aerospike_object of the client.
+ * @param client_p                  The client zval, held by the future.
+ * @param key_p                     The PHP key array.
+ * @param operations_p              The PHP array of operations, as for operate().
+ * @param options_p                 The optional policies, else NULL.
+ * @param error_p                   The as_error to be set to the encountered error.
+ * @param future_zval_p             The zval to be set to the Aerospike\Future.
+ *
+ * @return AEROSPIKE_OK if the command was submitted. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_async_operate(Aerospike_object *aerospike_obj_p, zval *client_p,
+		zval *key_p, zval *operations_p, zval *options_p, as_error *error_p,
+		zval *future_zval_p TSRMLS_DC)
+{
+	aerospike_async_op  *op_p = NULL;
+
+	if (!(op_p = aerospike_async_op_new(aerospike_obj_p, AEROSPIKE_COMMAND_OPERATE, error_p))) {
+		goto exit;
+	}
+
+	if (AEROSPIKE_OK != aerospike_async_key(op_p, key_p, error_p)) {
+		goto exit;
+	}
+
+	as_operations_init(&op_p->ops, zend_hash_num_elements(Z_ARRVAL_P(operations_p)));
+	op_p->init_ops = true;
+
+	if ((AEROSPIKE_OK != aerospike_record_operations_operate_prepare(aerospike_obj_p,
+					&op_p->key, options_p, error_p, Z_ARRVAL_P(operations_p),
+					&op_p->ops, &op_p->operate_policy, true)) ||
+			(AEROSPIKE_OK != error_p->code)) {
+		if (AEROSPIKE_OK == error_p->code) {
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM, "Unable to parse the operations");
+		}
+		goto exit;
+	}
+
+	aerospike_write_invalidate(aerospike_obj_p, &op_p->key);
+	if (AEROSPIKE_OK != aerospike_async_submit(op_p, error_p TSRMLS_CC)) {
+		goto exit;
+	}
+
+	aerospike_future_init(future_zval_p, op_p, aerospike_obj_p, client_p, key_p,
+			operations_p, options_p TSRMLS_CC);
+	op_p = NULL;
+
+exit:
+	if (op_p) {
+		aerospike_async_op_destroy(op_p);
+	}
+
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Submits a record UDF call for Aerospike::applyAsync().
+ *
+ * @param aerospike_obj_p           The Aerospike_object of the client.
+ * @param client_p                  The client zval, held by the future.
+ * @param key_p                     The PHP key array.
+ * @param module_p                  The name of the UDF module.
+ * @param function_p                The name of the UDF function.
+ * @param args_p                    The optional PHP array of arguments, else NULL.
+ * @param options_p                 The optional policies, else NULL.
+ * @param error_p                   The as_error to be set to the encountered error.
+ * @param future_zval_p             The zval to be set to the Aerospike\Future.
+ *
+ * @return AEROSPIKE_OK if the command was submitted. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_async_apply(Aerospike_object *aerospike_obj_p, zval *client_p,
+		zval *key_p, char *module_p, char *function_p, zval *args_p,
+		zval *options_p, as_error *error_p, zval *future_zval_p TSRMLS_DC)
+{
+	aerospike_async_op  *op_p = NULL;
+	int8_t              serializer_policy = aerospike_obj_p->serializer_opt;
+
+	if (!(op_p = aerospike_async_op_new(aerospike_obj_p, AEROSPIKE_COMMAND_UDF, error_p))) {
+		goto exit;
+	}
+
+	if (AEROSPIKE_OK != aerospike_async_key(op_p, key_p, error_p)) {
+		goto exit;
+	}
+
+	set_policy_for_key(aerospike_obj_p, &op_p->key, NULL, NULL, NULL, NULL,
+			&op_p->apply_policy, &serializer_policy, options_p, error_p TSRMLS_CC);
+	if (AEROSPIKE_OK != error_p->code) {
+		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+		goto exit;
+	}
+
+	if ((!(op_p->module_p = strdup(module_p))) || (!(op_p->function_p = strdup(function_p)))) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to allocate the async command");
+		goto exit;
+	}
+
+	if (args_p) {
+		as_arraylist_init(&op_p->args, zend_hash_num_elements(Z_ARRVAL_P(args_p)), 0);
+		op_p->args_p = &op_p->args;
+		AS_LIST_PUT(aerospike_obj_p, NULL,
+#if PHP_VERSION_ID < 70000
+				&args_p,
+#else
+				args_p,
+#endif
+				op_p->args_p, op_p->static_pool_p, serializer_policy, error_p TSRMLS_CC);
+		if (AEROSPIKE_OK != error_p->code) {
+			goto exit;
+		}
+	}
+
+	aerospike_write_invalidate(aerospike_obj_p, &op_p->key);
+	if (AEROSPIKE_OK != aerospike_async_submit(op_p, error_p TSRMLS_CC)) {
+		goto exit;
+	}
+
+	aerospike_future_init(future_zval_p, op_p, aerospike_obj_p, client_p, key_p,
+			args_p, options_p TSRMLS_CC);
+	op_p = NULL;
+
+exit:
+	if (op_p) {
+		aerospike_async_op_destroy(op_p);
+	}
+
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Waits for all the futures of an array, for Aerospike::awaitAll().
+ *
+ * @param futures_p                 The PHP array of Aerospike\Future.
+ * @param results_p                 The optional initialized PHP array to be
+ *                                  populated with the results, keyed as
+ *                                  futures_p. NULL if not needed.
+ * @param error_p                   The as_error to be set to the error of the
+ *                                  first future which failed.
+ *
+ * @return AEROSPIKE_OK if all the futures succeeded. Otherwise the status of
+ * the first future which failed.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_async_await_all(zval *futures_p, zval *results_p, as_error *error_p TSRMLS_DC)
+{
+	aerospike_future_object *future_p = NULL;
+	HashTable               *futures_ht_p = Z_ARRVAL_P(futures_p);
+	as_status               status = AEROSPIKE_OK;
+	HashPosition            pointer;
+#if PHP_VERSION_ID < 70000
+	zval                    **future_pp = NULL;
+	zval                    *result_p = NULL;
+	char                    *str_key = NULL;
+	uint                    str_key_len = 0;
+	ulong                   num_key = 0;
+#else
+	zval                    *future_pp = NULL;
+	zval                    result;
+	zend_string             *str_key = NULL;
+	zend_ulong              num_key = 0;
+#endif
+
+	/* Check them all first, so that awaitAll() fails without waiting. */
+#if PHP_VERSION_ID < 70000
+	AEROSPIKE_FOREACH_HASHTABLE(futures_ht_p, pointer, future_pp) {
+		if ((Z_TYPE_PP(future_pp) != IS_OBJECT) ||
+				!instanceof_function(Z_OBJCE_PP(future_pp), Future_ce TSRMLS_CC)) {
+#else
+	ZEND_HASH_FOREACH_VAL(futures_ht_p, future_pp) {
+		if ((Z_TYPE_P(future_pp) != IS_OBJECT) ||
+				!instanceof_function(Z_OBJCE_P(future_pp), Future_ce TSRMLS_CC)) {
+#endif
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+					"awaitAll() expects an array of Aerospike\\Future");
+			return AEROSPIKE_ERR_PARAM;
+		}
+#if PHP_VERSION_ID < 70000
+	}
+#else
+	} ZEND_HASH_FOREACH_END();
+#endif
+
+#if PHP_VERSION_ID < 70000
+	AEROSPIKE_FOREACH_HASHTABLE(futures_ht_p, pointer, future_pp) {
+		future_p = aerospike_future_fetch(*future_pp TSRMLS_CC);
+		if (!future_p->op_p) {
+			continue;
+		}
+		aerospike_async_wait(future_p->op_p);
+		aerospike_future_set_error(*future_pp, &future_p->op_p->error TSRMLS_CC);
+		if (results_p) {
+			MAKE_STD_ZVAL(result_p);
+			aerospike_future_collect(future_p, result_p TSRMLS_CC);
+			if (HASH_KEY_IS_STRING == zend_hash_get_current_key_ex(futures_ht_p,
+						&str_key, &str_key_len, &num_key, 0, &pointer)) {
+				add_assoc_zval_ex(results_p, str_key, str_key_len, result_p);
+			} else {
+				add_index_zval(results_p, num_key, result_p);
+			}
+		} else {
+			aerospike_future_collect(future_p, NULL TSRMLS_CC);
+		}
+#else
+	ZEND_HASH_FOREACH_KEY_VAL(futures_ht_p, num_key, str_key, future_pp) {
+		future_p = aerospike_future_fetch(future_pp TSRMLS_CC);
+		if (!future_p->op_p) {
+			continue;
+		}
+		aerospike_async_wait(future_p->op_p);
+		aerospike_future_set_error(future_pp, &future_p->op_p->error TSRMLS_CC);
+		if (results_p) {
+			aerospike_future_collect(future_p, &result TSRMLS_CC);
+			if (str_key) {
+				add_assoc_zval_ex(results_p, ZSTR_VAL(str_key), ZSTR_LEN(str_key), &result);
+			} else {
+				add_index_zval(results_p, num_key, &result);
+			}
+		} else {
+			aerospike_future_collect(future_p, NULL TSRMLS_CC);
+		}
+#endif
+		if ((AEROSPIKE_OK == status) && (AEROSPIKE_OK != future_p->op_p->error.code)) {
+			status = future_p->op_p->error.code;
+			as_error_copy(error_p, &future_p->op_p->error);
+		}
+#if PHP_VERSION_ID < 70000
+	}
+#else
+	} ZEND_HASH_FOREACH_END();
+#endif
+
+	return status;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to get the fd which becomes readable when a watched future of the
+ * current PHP thread completes, creating it on first use. It is an eventfd
+ * on Linux and a pipe elsewhere, non blocking either way. A child process
+ * does not share the fd of its parent, it creates its own.
+ *
+ * @return the fd to be read, -1 if it cannot be created.
+ *******************************************************************************************************
+ */
+static int
+aerospike_async_notify_fd(TSRMLS_D)
+{
+	int     fds[2] = {-1, -1};
+
+	if ((AEROSPIKE_G(async_notify_fd) >= 0) && (AEROSPIKE_G(async_notify_pid) == (long) getpid())) {
+		return AEROSPIKE_G(async_notify_fd);
+	}
+
+	if (AEROSPIKE_G(async_notify_fd) >= 0) {
+		close(AEROSPIKE_G(async_notify_fd));
+		if (AEROSPIKE_G(async_notify_write_fd) != AEROSPIKE_G(async_notify_fd)) {
+			close(AEROSPIKE_G(async_notify_write_fd));
+		}
+		AEROSPIKE_G(async_notify_fd) = -1;
+		AEROSPIKE_G(async_notify_write_fd) = -1;
+	}
+
+#ifdef __linux__
+	if ((fds[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+		return -1;
+	}
+	fds[1] = fds[0];
+#else
+	if (0 != pipe(fds)) {
+		return -1;
+	}
+	fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+	fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+	fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+
+	AEROSPIKE_G(async_notify_fd) = fds[0];
+	AEROSPIKE_G(async_notify_write_fd) = fds[1];
+	AEROSPIKE_G(async_notify_pid) = (long) getpid();
+
+	return fds[0];
+}
+
+/*
+ *******************************************************************************************************
+ * Function to consume the pending wake ups of the notify fd.
+ *******************************************************************************************************
+ */
+static void
+aerospike_async_notify_drain(TSRMLS_D)
+{
+	char    buffer[64];
+
+	if ((AEROSPIKE_G(async_notify_fd) < 0) || (AEROSPIKE_G(async_notify_pid) != (long) getpid())) {
+		return;
+	}
+
+	while (read(AEROSPIKE_G(async_notify_fd), buffer, sizeof(buffer)) > 0) {
+		;
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to invoke the callback of a completed future, set by then(), with
+ * its status, its result and the future.
+ *******************************************************************************************************
+ */
+static void
+aerospike_future_invoke(zval *future_zval_p TSRMLS_DC)
+{
+	aerospike_future_object *future_p = aerospike_future_fetch(future_zval_p TSRMLS_CC);
+	as_status               status = AEROSPIKE_OK;
+#if PHP_VERSION_ID < 70000
+	zval                    *callback_p = future_p->callback;
+	zval                    *status_p = NULL;
+	zval                    *result_p = NULL;
+	zval                    *retval_p = NULL;
+	zval                    **args[3];
+
+	future_p->callback = NULL;
+	MAKE_STD_ZVAL(result_p);
+	status = aerospike_future_collect(future_p, result_p TSRMLS_CC);
+	aerospike_future_set_error(future_zval_p, &future_p->op_p->error TSRMLS_CC);
+	MAKE_STD_ZVAL(status_p);
+	ZVAL_LONG(status_p, status);
+
+	args[0] = &status_p;
+	args[1] = &result_p;
+	args[2] = &future_zval_p;
+	if (FAILURE == call_user_function_ex(EG(function_table), NULL, callback_p, &retval_p,
+				3, args, 0, NULL TSRMLS_CC)) {
+		php_error_docref(NULL TSRMLS_CC, E_WARNING, "Unable to invoke the callback of the future");
+	}
+
+	if (retval_p) {
+		zval_ptr_dtor(&retval_p);
+	}
+	zval_ptr_dtor(&status_p);
+	zval_ptr_dtor(&result_p);
+	zval_ptr_dtor(&callback_p);
+#else
+	zval                    callback;
+	zval                    retval;
+	zval                    args[3];
+
+	ZVAL_COPY_VALUE(&callback, &future_p->callback);
+	ZVAL_UNDEF(&future_p->callback);
+	status = aerospike_future_collect(future_p, &args[1] TSRMLS_CC);
+	aerospike_future_set_error(future_zval_p, &future_p->op_p->error TSRMLS_CC);
+	ZVAL_LONG(&args[0], status);
+	ZVAL_COPY_VALUE(&args[2], future_zval_p);
+
+	ZVAL_UNDEF(&retval);
+	if (FAILURE == call_user_function_ex(EG(function_table), NULL, &callback, &retval,
+				3, args, 0, NULL TSRMLS_CC)) {
+		php_error_docref(NULL TSRMLS_CC, E_WARNING, "Unable to invoke the callback of the future");
+	}
+
+	zval_ptr_dtor(&retval);
+	zval_ptr_dtor(&args[1]);
+	zval_ptr_dtor(&callback);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Invokes the callbacks of the watched futures of the current PHP thread
+ * which completed, for Aerospike::pollAsync(). A callback may set the
+ * callback of other futures. If a callback throws, the futures not invoked
+ * yet are kept for the next poll.
+ *
+ * @return the number of callbacks invoked.
+ *******************************************************************************************************
+ */
+extern long
+aerospike_async_poll(TSRMLS_D)
+{
+	HashTable               *watched_p = AEROSPIKE_G(async_watched_g);
+	aerospike_future_object *future_p = NULL;
+	long                    invoked = 0;
+	bool                    rewake = false;
+#if PHP_VERSION_ID < 70000
+	HashPosition            pointer;
+	zval                    *ready_p = NULL;
+	zval                    **future_pp = NULL;
+#else
+	zval                    ready;
+	zval                    *ready_p = &ready;
+	zval                    *future_pp = NULL;
+#endif
+
+	aerospike_async_notify_drain(TSRMLS_C);
+
+	if ((!watched_p) || (!zend_hash_num_elements(watched_p))) {
+		return 0;
+	}
+
+#if PHP_VERSION_ID < 70000
+	MAKE_STD_ZVAL(ready_p);
+#endif
+	array_init(ready_p);
+
+#if PHP_VERSION_ID < 70000
+	AEROSPIKE_FOREACH_HASHTABLE(watched_p, pointer, future_pp) {
+		future_p = aerospike_future_fetch(*future_pp TSRMLS_CC);
+		if (aerospike_async_is_done(future_p->op_p)) {
+			zval_add_ref(future_pp);
+			add_next_index_zval(ready_p, *future_pp);
+		}
+	}
+	AEROSPIKE_FOREACH_HASHTABLE(Z_ARRVAL_P(ready_p), pointer, future_pp) {
+		zend_hash_index_del(watched_p, Z_OBJ_HANDLE_PP(future_pp));
+	}
+#else
+	ZEND_HASH_FOREACH_VAL(watched_p, future_pp) {
+		future_p = aerospike_future_fetch(future_pp TSRMLS_CC);
+		if (aerospike_async_is_done(future_p->op_p)) {
+			Z_ADDREF_P(future_pp);
+			add_next_index_zval(ready_p, future_pp);
+		}
+	} ZEND_HASH_FOREACH_END();
+	ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(ready_p), future_pp) {
+		zend_hash_index_del(watched_p, Z_OBJ_HANDLE_P(future_pp));
+	} ZEND_HASH_FOREACH_END();
+#endif
+
+#if PHP_VERSION_ID < 70000
+	AEROSPIKE_FOREACH_HASHTABLE(Z_ARRVAL_P(ready_p), pointer, future_pp) {
+		if (EG(exception)) {
+			zval_add_ref(future_pp);
+			zend_hash_index_update(AEROSPIKE_G(async_watched_g), Z_OBJ_HANDLE_PP(future_pp),
+					future_pp, sizeof(zval *), NULL);
+			rewake = true;
+			continue;
+		}
+		aerospike_future_invoke(*future_pp TSRMLS_CC);
+		invoked++;
+	}
+	zval_ptr_dtor(&ready_p);
+#else
+	ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(ready_p), future_pp) {
+		if (EG(exception)) {
+			Z_ADDREF_P(future_pp);
+			zend_hash_index_update(AEROSPIKE_G(async_watched_g), Z_OBJ_HANDLE_P(future_pp),
+					future_pp);
+			rewake = true;
+			continue;
+		}
+		aerospike_future_invoke(future_pp TSRMLS_CC);
+		invoked++;
+	} ZEND_HASH_FOREACH_END();
+	zval_ptr_dtor(ready_p);
+#endif
+
+	if (rewake && (AEROSPIKE_G(async_notify_write_fd) >= 0)) {
+		aerospike_async_signal(AEROSPIKE_G(async_notify_write_fd));
+	}
+
+	return invoked;
+}
+
+/*
+ *******************************************************************************************************
+ * Opens a stream on the notify fd of the current PHP thread, for
+ * Aerospike::asyncEventStream(). The stream has its own fd, so closing it
+ * does not stop the notifications.
+ *
+ * @param stream_zval_p             The zval to be set to the stream.
+ * @param error_p                   The as_error to be set to the encountered error.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_async_event_stream(zval *stream_zval_p, as_error *error_p TSRMLS_DC)
+{
+	php_stream  *stream_p = NULL;
+	int         notify_fd = -1;
+	int         stream_fd = -1;
+
+	if (((notify_fd = aerospike_async_notify_fd(TSRMLS_C)) < 0) ||
+			((stream_fd = dup(notify_fd)) < 0)) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to create the async event fd");
+		return AEROSPIKE_ERR_CLIENT;
+	}
+
+	if (!(stream_p = php_stream_fopen_from_fd(stream_fd, "r", NULL))) {
+		close(stream_fd);
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to open the async event stream");
+		return AEROSPIKE_ERR_CLIENT;
+	}
+	php_stream_to_zval(stream_p, stream_zval_p);
+
+	return AEROSPIKE_OK;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to stop the following getAsync() of a record from joining its
+ * reads in flight, once the record is written. The record read by a getAsync()
+ * submitted after a write is read after it.
+ *
+ * @param aerospike_obj_p       The Aerospike_object writing the record.
+ * @param as_key_p              The key of the record written, NULL for all
+ *                              the records.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_async_flight_forget(Aerospike_object *aerospike_obj_p, as_key *as_key_p)
+{
+	char        flight_key[AEROSPIKE_ASYNC_FLIGHT_KEY_SIZE];
+	size_t      flight_key_len = 0;
+	TSRMLS_FETCH();
+
+	if ((!AEROSPIKE_G(async_flights_g)) ||
+			(0 == zend_hash_num_elements(AEROSPIKE_G(async_flights_g)))) {
+		return;
+	}
+
+	if ((!as_key_p) || (!aerospike_obj_p->as_ref_p) ||
+			(0 == (flight_key_len = aerospike_async_flight_key(aerospike_obj_p->as_ref_p->as_p,
+					as_key_p, flight_key)))) {
+		zend_hash_clean(AEROSPIKE_G(async_flights_g));
+		return;
+	}
+
+#if PHP_VERSION_ID < 70000
+	zend_hash_del(AEROSPIKE_G(async_flights_g), flight_key, flight_key_len);
+#else
+	zend_hash_str_del(AEROSPIKE_G(async_flights_g), flight_key, flight_key_len);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Function to cancel the commands of a client before its C client handle is
+ * closed or destroyed. Its commands still queued fail without being executed,
+ * and its commands already running are waited for. Their futures complete
+ * with the error.
+ *
+ * @param aerospike_obj_p       The Aerospike_object being closed.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_async_cancel(Aerospike_object *aerospike_obj_p)
+{
+	aerospike_async_op  *op_p = NULL;
+	aerospike_async_op  *prev_p = NULL;
+	aerospike_async_op  *next_p = NULL;
+	bool                running = false;
+	uint32_t            iter = 0;
+
+	pthread_mutex_lock(&async_lock);
+	for (op_p = async_head_p; op_p; op_p = next_p) {
+		next_p = op_p->next_p;
+		if (op_p->client_obj_p != aerospike_obj_p) {
+			prev_p = op_p;
+			continue;
+		}
+		if (prev_p) {
+			prev_p->next_p = next_p;
+		} else {
+			async_head_p = next_p;
+		}
+		if (async_tail_p == op_p) {
+			async_tail_p = prev_p;
+		}
+		op_p->next_p = NULL;
+		as_error_update(&op_p->error, AEROSPIKE_ERR_CLIENT, "Async command cancelled by close()");
+		op_p->done = true;
+		if (op_p->notify_fd >= 0) {
+			aerospike_async_signal(op_p->notify_fd);
+		}
+	}
+	pthread_cond_broadcast(&async_completed);
+
+	do {
+		running = false;
+		for (iter = 0; iter < async_n_threads; iter++) {
+			if (async_running_p[iter] &&
+					(async_running_p[iter]->client_obj_p == aerospike_obj_p)) {
+				running = true;
+				pthread_cond_wait(&async_completed, &async_lock);
+				break;
+			}
+		}
+	} while (running);
+	pthread_mutex_unlock(&async_lock);
+
+	aerospike_async_flight_forget(aerospike_obj_p, NULL);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to release the watched futures at RSHUTDOWN. Their callbacks are
+ * not invoked, and the futures still running are waited for. The futures
+ * freed afterwards find no read in flight to unregister.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_async_request_shutdown(TSRMLS_D)
+{
+	if (AEROSPIKE_G(async_watched_g)) {
+		zend_hash_destroy(AEROSPIKE_G(async_watched_g));
+		efree(AEROSPIKE_G(async_watched_g));
+		AEROSPIKE_G(async_watched_g) = NULL;
+	}
+	if (AEROSPIKE_G(async_flights_g)) {
+		zend_hash_destroy(AEROSPIKE_G(async_flights_g));
+		FREE_HASHTABLE(AEROSPIKE_G(async_flights_g));
+		AEROSPIKE_G(async_flights_g) = NULL;
+	}
+}
+
+/* {{{ proto bool Aerospike\Future::isDone( void )
+   Checks whether the command of the future has completed, without waiting */
+PHP_METHOD(Future, isDone)
+{
+	aerospike_future_object *future_p = aerospike_future_fetch(getThis() TSRMLS_CC);
+
+	if ((!future_p->op_p) || aerospike_async_is_done(future_p->op_p)) {
+		RETURN_TRUE;
+	}
+	RETURN_FALSE;
+}
+/* }}} */
+
+/* {{{ proto int Aerospike\Future::wait( [mixed &result] )
+   Waits for the command of the future to complete and gets its result */
+PHP_METHOD(Future, wait)
+{
+	aerospike_future_object *future_p = aerospike_future_fetch(getThis() TSRMLS_CC);
+	zval                    *result_p = NULL;
+	as_error                error;
+
+	as_error_init(&error);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "|z/", &result_p) == FAILURE) {
+		PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "Unable to parse parameters for wait");
+		DEBUG_PHP_EXT_ERROR("Unable to parse parameters for wait");
+		aerospike_future_set_error(getThis(), &error TSRMLS_CC);
+		RETURN_LONG(AEROSPIKE_ERR_PARAM);
+	}
+
+	if (!future_p->op_p) {
+		PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLIENT, "Invalid future");
+		aerospike_future_set_error(getThis(), &error TSRMLS_CC);
+		RETURN_LONG(AEROSPIKE_ERR_CLIENT);
+	}
+
+	aerospike_async_wait(future_p->op_p);
+	if (result_p) {
+		zval_dtor(result_p);
+	}
+	aerospike_future_collect(future_p, result_p TSRMLS_CC);
+	aerospike_future_set_error(getThis(), &future_p->op_p->error TSRMLS_CC);
+	RETURN_LONG(future_p->op_p->error.code);
+}
+/* }}} */
+
+/* {{{ proto int Aerospike\Future::then( callback callback )
+   Sets the callback invoked by Aerospike::pollAsync() once the command completed */
+PHP_METHOD(Future, then)
+{
+	aerospike_future_object *future_p = aerospike_future_fetch(getThis() TSRMLS_CC);
+	zval                    *callback_p = NULL;
+	as_error                error;
+	int                     notify_fd = -1;
+	bool                    done = false;
+
+	as_error_init(&error);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "z", &callback_p) == FAILURE ||
+			!zend_is_callable(callback_p, 0, NULL TSRMLS_CC)) {
+		PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_PARAM, "then() expects a callback");
+		DEBUG_PHP_EXT_ERROR("then() expects a callback");
+		goto exit;
+	}
+
+	if (!future_p->op_p) {
+		PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLIENT, "Invalid future");
+		goto exit;
+	}
+
+	if ((notify_fd = aerospike_async_notify_fd(TSRMLS_C)) < 0) {
+		PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLIENT, "Unable to create the async event fd");
+		goto exit;
+	}
+
+	AEROSPIKE_FUTURE_RELEASE(future_p, callback);
+	AEROSPIKE_FUTURE_HOLD(future_p, callback, callback_p);
+
+	if (!AEROSPIKE_G(async_watched_g)) {
+		ALLOC_HASHTABLE(AEROSPIKE_G(async_watched_g));
+		zend_hash_init(AEROSPIKE_G(async_watched_g), 16, NULL, ZVAL_PTR_DTOR, 0);
+	}
+	if (!zend_hash_index_exists(AEROSPIKE_G(async_watched_g), Z_OBJ_HANDLE_P(getThis()))) {
+		Z_ADDREF_P(getThis());
+#if PHP_VERSION_ID < 70000
+		zend_hash_index_update(AEROSPIKE_G(async_watched_g), Z_OBJ_HANDLE_P(getThis()),
+				&getThis(), sizeof(zval *), NULL);
+#else
+		zend_hash_index_update(AEROSPIKE_G(async_watched_g), Z_OBJ_HANDLE_P(getThis()),
+				getThis());
+#endif
+	}
+
+	pthread_mutex_lock(&async_lock);
+	if (!(done = future_p->op_p->done)) {
+		future_p->op_p->notify_fd = AEROSPIKE_G(async_notify_write_fd);
+	}
+	pthread_mutex_unlock(&async_lock);
+
+	if (done) {
+		aerospike_async_signal(AEROSPIKE_G(async_notify_write_fd));
+	}
+
+exit:
+	aerospike_future_set_error(getThis(), &error TSRMLS_CC);
+	RETURN_LONG(error.code);
+}
+/* }}} */
+
+/* {{{ proto string Aerospike\Future::error( void )
+   Displays the error message of the completed command */
+PHP_METHOD(Future, error)
+{
+#if PHP_VERSION_ID < 70000
+	char *error_msg = Z_STRVAL_P(zend_read_property(Future_ce, getThis(), "error", strlen("error"), 1 TSRMLS_CC));
+	RETURN_STRINGL(error_msg, strlen(error_msg), 1);
+#else
+	zval rv;
+	char *error_msg = Z_STRVAL_P(zend_read_property(Future_ce, getThis(), "error", strlen("error"), 1, &rv TSRMLS_CC));
+	RETURN_STRINGL(error_msg, strlen(error_msg));
+#endif
+}
+/* }}} */
+
+/* {{{ proto int Aerospike\Future::errorno( void )
+   Displays the status code of the completed command */
+PHP_METHOD(Future, errorno)
+{
+#if PHP_VERSION_ID < 70000
+	int error_code = Z_LVAL_P(zend_read_property(Future_ce, getThis(), "errorno", strlen("errorno"), 1 TSRMLS_CC));
+#else
+	zval rv;
+	int error_code = Z_LVAL_P(zend_read_property(Future_ce, getThis(), "errorno", strlen("errorno"), 1, &rv TSRMLS_CC));
+#endif
+	RETURN_LONG(error_code);
+}
+/* }}} */
+
+ZEND_BEGIN_ARG_INFO(arginfo_future_wait, 0)
+ZEND_ARG_PASS_INFO(1)
+ZEND_END_ARG_INFO()
+
+static zend_function_entry Future_class_functions[] =
+{
+	PHP_ME(Future, isDone, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Future, wait, arginfo_future_wait, ZEND_ACC_PUBLIC)
+	PHP_ME(Future, then, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Future, error, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Future, errorno, NULL, ZEND_ACC_PUBLIC)
+	{ NULL, NULL, NULL }
+};
+
+/*
+ *******************************************************************************************************
+ * Function to register the Aerospike\Future class and the fork handlers of
+ * the pool, once per process from MINIT.
+ *
+ * @return SUCCESS or FAILURE.
+ *******************************************************************************************************
+ */
+extern int
+aerospike_async_init(TSRMLS_D)
+{
+	zend_class_entry ce = {0};
+
+	INIT_NS_CLASS_ENTRY(ce, "Aerospike", "Future", Future_class_functions);
+	if (!(Future_ce = zend_register_internal_class(&ce TSRMLS_CC))) {
+		return FAILURE;
+	}
+	Future_ce->create_object = Future_object_new;
+#if PHP_VERSION_ID < 70000
+	Future_ce->ce_flags |= ZEND_ACC_FINAL_CLASS;
+#else
+	Future_ce->ce_flags |= ZEND_ACC_FINAL;
+#endif
+
+	memcpy(&Future_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+	Future_handlers.clone_obj = NULL;
+#if PHP_VERSION_ID >= 70000
+	Future_handlers.offset = XtOffsetOf(aerospike_future_object, std);
+	Future_handlers.free_obj = Future_object_free_storage;
+#endif
+
+	zend_declare_property_long(Future_ce, "errorno", strlen("errorno"), DEFAULT_ERRORNO, ZEND_ACC_PRIVATE TSRMLS_CC);
+	zend_declare_property_string(Future_ce, "error", strlen("error"), DEFAULT_ERROR, ZEND_ACC_PRIVATE TSRMLS_CC);
+
+	pthread_atfork(aerospike_async_atfork_prepare, aerospike_async_atfork_parent,
+			aerospike_async_atfork_child);
+
+	return SUCCESS;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to stop the worker threads at MSHUTDOWN, once the commands still
+ * queued have been executed.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_async_shutdown(void)
+{
+	uint32_t    iter = 0;
+
+	pthread_mutex_lock(&async_lock);
+	async_stopping = true;
+	pthread_cond_broadcast(&async_queued);
+	pthread_mutex_unlock(&async_lock);
+
+	for (iter = 0; iter < async_n_threads; iter++) {
+		pthread_join(async_threads_p[iter], NULL);
+	}
+
+	free(async_threads_p);
+	free(async_running_p);
+	async_threads_p = NULL;
+	async_running_p = NULL;
+	async_n_threads = 0;
+}
@@ -261,7 +261,7 @@ exit:
 #endif
 	metadata_callback.udata_p = metadata_p;
 	metadata_callback.error_p = error_p;
-	if (aerospike_batch_read(as_object_p, error_p, &batch_policy, &records) != AEROSPIKE_OK) {
+	if (aerospike_latency_batch_read(as_object_p, error_p, &batch_policy, &records) != AEROSPIKE_OK) {
 		DEBUG_PHP_EXT_DEBUG("Unable to get metadata of batch records");
 		goto exit;
 	}
@@ -435,7 +435,7 @@ aerospike_batch_operations_exists_many(aerospike *as_object_p, as_error *error_p
 	metadata_callback.udata_p = metadata_p;
 	metadata_callback.error_p = error_p;
 
-	if (AEROSPIKE_OK != (status = aerospike_batch_exists(as_object_p, error_p,
+	if (AEROSPIKE_OK != (status = aerospike_latency_batch_exists(as_object_p, error_p,
 			&batch_policy, &batch, batch_exists_cb, &metadata_callback))) {
 		DEBUG_PHP_EXT_DEBUG("Unable to get metadata of batch records");
 		goto exit;
@@ -559,6 +559,7 @@ batch_get_cb(const as_batch_read *results, uint32_t n, void *udata)
 				goto cleanup;
 			}
 		}
+		aerospike_memory_sample(TSRMLS_C);
 		if (udata_ptr->error_p->code == AEROSPIKE_OK) {
 			continue;
 		}
@@ -578,11 +579,68 @@ exit:
 	return true;
 }
 
+/*
+ ******************************************************************************************************
+ * Function to find the record of a batch read already reading a key, so that
+ * a key given more than once to getMany() is read once. The records reserved
+ * so far are indexed by namespace and digest in digests_p.
+ *
+ * @param digests_p                 The index of the records reserved so far.
+ * @param key_p                     The key of the record being reserved.
+ * @param index                     The index of that record in the batch.
+ * @param index_p                   Set to the index of the record reading the key.
+ *
+ * @return true if the key is already read by another record of the batch.
+ ******************************************************************************************************
+ */
+static bool
+batch_read_find_duplicate(HashTable *digests_p, as_key *key_p, uint32_t index,
+	uint32_t *index_p)
+{
+	char                     digest_key[AS_NAMESPACE_MAX_SIZE + AS_DIGEST_VALUE_SIZE];
+	size_t                   ns_len = strlen(key_p->ns);
+	size_t                   digest_key_len = ns_len + 1 + AS_DIGEST_VALUE_SIZE;
+	as_digest                *digest_p = NULL;
+#if PHP_VERSION_ID < 70000
+	uint32_t                 *found_p = NULL;
+#else
+	zval                     *found_p = NULL;
+	zval                     index_zval;
+#endif
+
+	*index_p = index;
+	if (!(digest_p = as_key_digest(key_p))) {
+		return false;
+	}
+
+	memcpy(digest_key, key_p->ns, ns_len);
+	digest_key[ns_len] = '\0';
+	memcpy(digest_key + ns_len + 1, digest_p->value, AS_DIGEST_VALUE_SIZE);
+
+#if PHP_VERSION_ID < 70000
+	if (SUCCESS == zend_hash_find(digests_p, digest_key, digest_key_len, (void **) &found_p)) {
+		*index_p = *found_p;
+		return true;
+	}
+	zend_hash_add(digests_p, digest_key, digest_key_len, &index, sizeof(uint32_t), NULL);
+#else
+	if ((found_p = zend_hash_str_find(digests_p, digest_key, digest_key_len))) {
+		*index_p = (uint32_t) Z_LVAL_P(found_p);
+		return true;
+	}
+	ZVAL_LONG(&index_zval, index);
+	zend_hash_str_add(digests_p, digest_key, digest_key_len, &index_zval);
+#endif
+	return false;
+}
+
 /*
  ******************************************************************************************************
  * Get all records indentified by the array of keys. This functions same as the
  * aerospike_batch_operations_get_many api, only difference being it uses new
  * batch apis released with server version 3.5.15.
+ * A key given more than once is read once, its record being returned at each
+ * of its positions in keys_p.
  *
  * @param as_object_p               The C Client's aerospike object.
  * @param error_p                   The C client's as_error to be set to the encountered error.
@@ -615,8 +673,15 @@ aerospike_batch_operations_get_many_new(aerospike *as_object_p, as_error *error_
 	bool                     null_flag = false;
 	as_batch_read_record     *record_batch = NULL;
 	char                     **select_p;
+	HashTable                digests;
+	bool                     is_digests_init = false;
+	uint32_t                 *positions_p = NULL;
+	uint32_t                 n_keys = 0;
+	bool                     is_unique_init = false;
+	bool                     memory_profiled = false;
 	DECLARE_ZVAL(record_p_local);
 	DECLARE_ZVAL(get_record_p);
+	DECLARE_ZVAL(unique_records);
 	DECLARE_ZVAL_P(key_entry);
 
 	if (!(as_object_p) || !(keys_p) || !(records_p)) {
@@ -651,12 +716,21 @@ aerospike_batch_operations_get_many_new(aerospike *as_object_p, as_error *error_
 
 	as_batch_read_record *record = NULL;
 
+	positions_p = (uint32_t *) emalloc(sizeof(uint32_t) * zend_hash_num_elements(keys_ht_p));
+	zend_hash_init(&digests, zend_hash_num_elements(keys_ht_p), NULL, NULL, 0);
+	is_digests_init = true;
+
 #if PHP_VERSION_ID < 70000
 	AEROSPIKE_FOREACH_HASHTABLE (keys_ht_p, key_pointer, key_entry) {
 #else
 	ZEND_HASH_FOREACH_VAL(keys_ht_p, key_entry) {
 #endif
-		record = as_batch_read_reserve(&records);
+		/*
+		 * The record reserved for a duplicate key is reused by the next key.
+		 */
+		if (!record) {
+			record = as_batch_read_reserve(&records);
+		}
 		if (AEROSPIKE_OK != aerospike_transform_iterate_for_rec_key_params(
 			AEROSPIKE_Z_ARRVAL_P(key_entry), &record->key, &initializeKey)) {
 				DEBUG_PHP_EXT_DEBUG("Invalid params.");
@@ -666,6 +740,12 @@ aerospike_batch_operations_get_many_new(aerospike *as_object_p, as_error *error_
 
 		i++;
 
+		if (batch_read_find_duplicate(&digests, &record->key, records.list.size - 1,
+				&positions_p[n_keys++])) {
+			as_key_destroy(&record->key);
+			continue;
+		}
+
 		if (filter_bins_p) {
 			filter_bins_count = zend_hash_num_elements(Z_ARRVAL_P(filter_bins_p));
 			if(filter_bins_count == 0) {
@@ -679,14 +759,42 @@ aerospike_batch_operations_get_many_new(aerospike *as_object_p, as_error *error_
 		} else {
 			record->read_all_bins = true;
 		}
+		record = NULL;
 	}
 #if PHP_VERSION_ID >= 70000
 	ZEND_HASH_FOREACH_END();
 #endif
-	batch_get_callback_udata.udata_p = records_p;
+	if (record) {
+		/*
+		 * The last key was a duplicate, its unused record is the last one.
+		 */
+		records.list.size--;
+	}
+
+	if (records.list.size < n_keys) {
+		/*
+		 * The records read are fanned out to the positions of their keys
+		 * once all read.
+		 */
+#if PHP_VERSION_ID < 70000
+		ALLOC_INIT_ZVAL(unique_records);
+		array_init(unique_records);
+#else
+		array_init(&unique_records);
+#endif
+		is_unique_init = true;
+		batch_get_callback_udata.udata_p = AEROSPIKE_ZVAL_ARG(unique_records);
+	} else {
+		batch_get_callback_udata.udata_p = records_p;
+	}
 	batch_get_callback_udata.error_p = error_p;
 
-	if (aerospike_batch_read(as_object_p, error_p, &batch_policy, &records) != AEROSPIKE_OK) {
+	/*
+	 * The records are converted after the batch read returns, so the profiled
+	 * span covers both, rather than only the read as in the wrapper.
+	 */
+	memory_profiled = aerospike_memory_begin(AEROSPIKE_COMMAND_BATCH);
+	if (aerospike_latency_batch_read(as_object_p, error_p, &batch_policy, &records) != AEROSPIKE_OK) {
 		DEBUG_PHP_EXT_DEBUG("Aerospike batch read failed");
 		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM, "Aerospike batch read failed with error");
 		goto exit;
@@ -760,6 +868,7 @@ aerospike_batch_operations_get_many_new(aerospike *as_object_p, as_error *error_
 		if (record_batch->bin_names) {
 			efree(record_batch->bin_names);
 		}
+		aerospike_memory_sample(TSRMLS_C);
 		if (batch_get_callback_udata.error_p->code == AEROSPIKE_OK) {
 			continue;
 		}
@@ -773,8 +882,39 @@ cleanup:
 		}
 	}
 
+	if (is_unique_init && (AEROSPIKE_OK == error_p->code)) {
+		for (i = 0; (uint32_t) i < n_keys; i++) {
+#if PHP_VERSION_ID < 70000
+			zval     **unique_record_pp = NULL;
+
+			if (SUCCESS == zend_hash_index_find(Z_ARRVAL_P(unique_records), positions_p[i],
+					(void **) &unique_record_pp)) {
+				zval_add_ref(unique_record_pp);
+				add_next_index_zval(records_p, *unique_record_pp);
+			}
+#else
+			zval     *unique_record_p = NULL;
+
+			if ((unique_record_p = zend_hash_index_find(Z_ARRVAL(unique_records), positions_p[i]))) {
+				Z_TRY_ADDREF_P(unique_record_p);
+				add_next_index_zval(records_p, unique_record_p);
+			}
+#endif
+		}
+	}
+
 exit:
+	if (is_unique_init) {
+		zval_ptr_dtor(&unique_records);
+	}
+	if (is_digests_init) {
+		zend_hash_destroy(&digests);
+	}
+	if (positions_p) {
+		efree(positions_p);
+	}
 	as_batch_read_destroy(&records);
+	aerospike_memory_end(memory_profiled);
 	return error_p->code;
 }
 
@@ -864,13 +1004,13 @@ aerospike_batch_operations_get_many(aerospike *as_object_p, as_error *error_p,
 		filter_bins_count = zend_hash_num_elements(Z_ARRVAL_P(filter_bins_p));
 		const char *select_p[filter_bins_count];
 		process_filer_bins(Z_ARRVAL_P(filter_bins_p), select_p TSRMLS_CC);
-		if (AEROSPIKE_OK != aerospike_batch_get_bins(as_object_p, error_p, &batch_policy,
+		if (AEROSPIKE_OK != aerospike_latency_batch_get_bins(as_object_p, error_p, &batch_policy,
 			&batch, select_p, filter_bins_count, (aerospike_batch_read_callback) batch_get_cb,
 			&batch_get_callback_udata)) {
 				DEBUG_PHP_EXT_DEBUG("Unable to get batch records");
 				goto exit;
 		}
-	} else if (AEROSPIKE_OK != aerospike_batch_get(as_object_p, error_p, &batch_policy,
+	} else if (AEROSPIKE_OK != aerospike_latency_batch_get(as_object_p, error_p, &batch_policy,
 			&batch, (aerospike_batch_read_callback) batch_get_cb,
 			&batch_get_callback_udata)) {
 				DEBUG_PHP_EXT_DEBUG("Unable to get batch records");
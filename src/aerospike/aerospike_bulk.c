@@ -0,0 +1,1514 @@
+/*
+ *
+ * Copyright (C) 2014-2016 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#include "php.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_key.h"
+#include "aerospike/aerospike_scan.h"
+#include "aerospike/as_arraylist.h"
+#include "aerospike/as_boolean.h"
+#include "aerospike/as_bytes.h"
+#include "aerospike/as_double.h"
+#include "aerospike/as_geojson.h"
+#include "aerospike/as_hashmap.h"
+#include "aerospike/as_integer.h"
+#include "aerospike/as_list.h"
+#include "aerospike/as_map.h"
+#include "aerospike/as_msgpack.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_record_iterator.h"
+#include "aerospike/as_scan.h"
+#include "aerospike/as_string.h"
+#include "aerospike/as_stringmap.h"
+#include "citrusleaf/cf_clock.h"
+#include "aerospike_common.h"
+#include "aerospike_policy.h"
+
+#define BULK_FILE_BUFFER_SIZE       (1024 * 1024)
+#define BULK_JSON_MAX_DEPTH         64
+#define BULK_LOAD_CONCURRENCY       16
+#define BULK_LOAD_MAX_CONCURRENCY   256
+#define BULK_LOAD_MAX_FAILURES      1000
+
+/*
+ *******************************************************************************************************
+ * Growable byte buffer a record is encoded into. It is allocated with malloc
+ * as records are encoded on the C client's scan threads.
+ *******************************************************************************************************
+ */
+typedef struct bulk_buffer_s {
+	char        *data_p;
+	size_t      size;
+	size_t      capacity;
+	bool        failed;
+} bulk_buffer;
+
+typedef struct bulk_json_iterate_s {
+	bulk_buffer *buffer_p;
+	bool        first;
+} bulk_json_iterate;
+
+/*
+ *******************************************************************************************************
+ * State of a scanToFile(), shared by the scan threads. Records are encoded
+ * without holding the lock, which is only held to write an encoded record.
+ *******************************************************************************************************
+ */
+typedef struct bulk_export_s {
+	pthread_mutex_t     lock;
+	FILE                *file_p;
+	int                 format;
+	uint64_t            records;
+	bool                failed;
+} bulk_export;
+
+/*
+ *******************************************************************************************************
+ * Function to append bytes to a buffer, growing it as needed. A buffer which
+ * could not be grown is marked as failed and ignores further appends.
+ *******************************************************************************************************
+ */
+static void
+bulk_buffer_append(bulk_buffer *buffer_p, const char *data_p, size_t size)
+{
+	char        *grown_p = NULL;
+	size_t      capacity = buffer_p->capacity ? buffer_p->capacity : 256;
+
+	if (buffer_p->failed) {
+		return;
+	}
+	if (buffer_p->size + size > buffer_p->capacity) {
+		while (capacity < buffer_p->size + size) {
+			capacity *= 2;
+		}
+		if (NULL == (grown_p = (char *) realloc(buffer_p->data_p, capacity))) {
+			buffer_p->failed = true;
+			return;
+		}
+		buffer_p->data_p = grown_p;
+		buffer_p->capacity = capacity;
+	}
+	memcpy(buffer_p->data_p + buffer_p->size, data_p, size);
+	buffer_p->size += size;
+}
+
+#define bulk_buffer_append_literal(buffer_p, literal) \
+	bulk_buffer_append(buffer_p, literal, sizeof(literal) - 1)
+
+/*
+ *******************************************************************************************************
+ * Function to append a string as a JSON string, escaping the quotes, the
+ * backslashes and the control characters. Other bytes are written as they
+ * are, strings being UTF-8.
+ *******************************************************************************************************
+ */
+static void
+bulk_json_string(bulk_buffer *buffer_p, const char *str_p, size_t len)
+{
+	char        escaped[8];
+	size_t      iter = 0;
+	size_t      start = 0;
+
+	bulk_buffer_append_literal(buffer_p, "\"");
+	for (iter = 0; iter < len; iter++) {
+		unsigned char   c = (unsigned char) str_p[iter];
+
+		if (c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+		bulk_buffer_append(buffer_p, str_p + start, iter - start);
+		start = iter + 1;
+		switch (c) {
+			case '"':
+				bulk_buffer_append_literal(buffer_p, "\\\"");
+				break;
+			case '\\':
+				bulk_buffer_append_literal(buffer_p, "\\\\");
+				break;
+			case '\n':
+				bulk_buffer_append_literal(buffer_p, "\\n");
+				break;
+			case '\r':
+				bulk_buffer_append_literal(buffer_p, "\\r");
+				break;
+			case '\t':
+				bulk_buffer_append_literal(buffer_p, "\\t");
+				break;
+			default:
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				bulk_buffer_append(buffer_p, escaped, 6);
+				break;
+		}
+	}
+	bulk_buffer_append(buffer_p, str_p + start, len - start);
+	bulk_buffer_append_literal(buffer_p, "\"");
+}
+
+/*
+ *******************************************************************************************************
+ * Function to append bytes as a base64 JSON string.
+ *******************************************************************************************************
+ */
+static void
+bulk_json_base64(bulk_buffer *buffer_p, const uint8_t *bytes_p, uint32_t size)
+{
+	static const char   alphabet[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	char                quad[4];
+	uint32_t            iter = 0;
+
+	bulk_buffer_append_literal(buffer_p, "\"");
+	for (iter = 0; iter < size; iter += 3) {
+		uint32_t    triple = bytes_p[iter] << 16;
+
+		if (iter + 1 < size) {
+			triple |= bytes_p[iter + 1] << 8;
+		}
+		if (iter + 2 < size) {
+			triple |= bytes_p[iter + 2];
+		}
+		quad[0] = alphabet[(triple >> 18) & 0x3f];
+		quad[1] = alphabet[(triple >> 12) & 0x3f];
+		quad[2] = (iter + 1 < size) ? alphabet[(triple >> 6) & 0x3f] : '=';
+		quad[3] = (iter + 2 < size) ? alphabet[triple & 0x3f] : '=';
+		bulk_buffer_append(buffer_p, quad, 4);
+	}
+	bulk_buffer_append_literal(buffer_p, "\"");
+}
+
+static void
+bulk_json_value(bulk_buffer *buffer_p, const as_val *val_p);
+
+/*
+ *******************************************************************************************************
+ * Callback appending an element of a list as JSON, after a comma unless it
+ * is the first one.
+ *
+ * @return true to continue iterating.
+ *******************************************************************************************************
+ */
+static bool
+bulk_json_list_element(as_val *val_p, void *udata_p)
+{
+	bulk_json_iterate   *iterate_p = (bulk_json_iterate *) udata_p;
+
+	if (!iterate_p->first) {
+		bulk_buffer_append_literal(iterate_p->buffer_p, ",");
+	}
+	iterate_p->first = false;
+	bulk_json_value(iterate_p->buffer_p, val_p);
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Callback appending an entry of a map as a JSON member, after a comma unless
+ * it is the first one.
+ *
+ * @return true to continue iterating.
+ *******************************************************************************************************
+ */
+static bool
+bulk_json_map_entry(const as_val *key_p, const as_val *val_p, void *udata_p)
+{
+	bulk_json_iterate   *iterate_p = (bulk_json_iterate *) udata_p;
+	bulk_buffer         key = {0};
+
+	if (!iterate_p->first) {
+		bulk_buffer_append_literal(iterate_p->buffer_p, ",");
+	}
+	iterate_p->first = false;
+
+	/* JSON keys are strings, other keys are written as their JSON text. */
+	if (as_val_type(key_p) == AS_STRING) {
+		bulk_json_value(iterate_p->buffer_p, key_p);
+	} else {
+		bulk_json_value(&key, key_p);
+		bulk_json_string(iterate_p->buffer_p, key.data_p ? key.data_p : "", key.size);
+		iterate_p->buffer_p->failed |= key.failed;
+		free(key.data_p);
+	}
+	bulk_buffer_append_literal(iterate_p->buffer_p, ":");
+	bulk_json_value(iterate_p->buffer_p, val_p);
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to append an as_val as JSON. Bytes are written as base64 strings,
+ * GeoJSON values as their JSON object, and doubles which are not finite as null.
+ * Doubles always have a fraction or an exponent.
+ *******************************************************************************************************
+ */
+static void
+bulk_json_value(bulk_buffer *buffer_p, const as_val *val_p)
+{
+	char                number[32];
+	int                 len = 0;
+	bulk_json_iterate   iterate = {buffer_p, true};
+	as_string           *string_p = NULL;
+	double              double_value = 0;
+
+	switch (val_p ? as_val_type(val_p) : AS_NIL) {
+		case AS_BOOLEAN:
+			if (as_boolean_get((as_boolean *) val_p)) {
+				bulk_buffer_append_literal(buffer_p, "true");
+			} else {
+				bulk_buffer_append_literal(buffer_p, "false");
+			}
+			break;
+		case AS_INTEGER:
+			len = snprintf(number, sizeof(number), "%lld",
+					(long long) as_integer_get((as_integer *) val_p));
+			bulk_buffer_append(buffer_p, number, len);
+			break;
+		case AS_DOUBLE:
+			double_value = as_double_get((as_double *) val_p);
+			if (isfinite(double_value)) {
+				len = snprintf(number, sizeof(number), "%.17g", double_value);
+				bulk_buffer_append(buffer_p, number, len);
+				/*
+				 * Integral doubles keep a fraction, as numbers without one
+				 * are loaded back as integers.
+				 */
+				if (!strpbrk(number, ".eE")) {
+					bulk_buffer_append_literal(buffer_p, ".0");
+				}
+			} else {
+				bulk_buffer_append_literal(buffer_p, "null");
+			}
+			break;
+		case AS_STRING:
+			string_p = (as_string *) val_p;
+			bulk_json_string(buffer_p, as_string_get(string_p), as_string_len(string_p));
+			break;
+		case AS_GEOJSON:
+			bulk_buffer_append(buffer_p, as_geojson_get((as_geojson *) val_p),
+					as_geojson_len((as_geojson *) val_p));
+			break;
+		case AS_BYTES:
+			bulk_json_base64(buffer_p, as_bytes_get((as_bytes *) val_p),
+					as_bytes_size((as_bytes *) val_p));
+			break;
+		case AS_LIST:
+			bulk_buffer_append_literal(buffer_p, "[");
+			as_list_foreach((as_list *) val_p, bulk_json_list_element, &iterate);
+			bulk_buffer_append_literal(buffer_p, "]");
+			break;
+		case AS_MAP:
+			bulk_buffer_append_literal(buffer_p, "{");
+			as_map_foreach((as_map *) val_p, bulk_json_map_entry, &iterate);
+			bulk_buffer_append_literal(buffer_p, "}");
+			break;
+		default:
+			bulk_buffer_append_literal(buffer_p, "null");
+			break;
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to encode a scanned record as one NDJSON line, in the shape of the
+ * records passed to the callback of scan(), with the digest hex encoded.
+ *******************************************************************************************************
+ */
+static void
+bulk_encode_json(bulk_buffer *buffer_p, as_record *record_p)
+{
+	as_record_iterator  iterator;
+	char                digest[AS_DIGEST_VALUE_SIZE * 2 + 1];
+	char                number[64];
+	int                 len = 0;
+	uint32_t            iter = 0;
+	bool                first = true;
+
+	for (iter = 0; iter < AS_DIGEST_VALUE_SIZE; iter++) {
+		snprintf(&digest[iter * 2], 3, "%02x", record_p->key.digest.value[iter]);
+	}
+
+	bulk_buffer_append_literal(buffer_p, "{\"key\":{\"ns\":");
+	bulk_json_string(buffer_p, record_p->key.ns, strlen(record_p->key.ns));
+	bulk_buffer_append_literal(buffer_p, ",\"set\":");
+	bulk_json_string(buffer_p, record_p->key.set, strlen(record_p->key.set));
+	bulk_buffer_append_literal(buffer_p, ",\"key\":");
+	bulk_json_value(buffer_p, (as_val *) record_p->key.valuep);
+	bulk_buffer_append_literal(buffer_p, ",\"digest\":\"");
+	bulk_buffer_append(buffer_p, digest, AS_DIGEST_VALUE_SIZE * 2);
+	len = snprintf(number, sizeof(number), "\"},\"metadata\":{\"ttl\":%u,\"generation\":%u},\"bins\":{",
+			record_p->ttl, record_p->gen);
+	bulk_buffer_append(buffer_p, number, len);
+
+	as_record_iterator_init(&iterator, record_p);
+	while (as_record_iterator_has_next(&iterator)) {
+		as_bin  *bin_p = as_record_iterator_next(&iterator);
+
+		if (!first) {
+			bulk_buffer_append_literal(buffer_p, ",");
+		}
+		first = false;
+		bulk_json_string(buffer_p, as_bin_get_name(bin_p), strlen(as_bin_get_name(bin_p)));
+		bulk_buffer_append_literal(buffer_p, ":");
+		bulk_json_value(buffer_p, (as_val *) as_bin_get_value(bin_p));
+	}
+	as_record_iterator_destroy(&iterator);
+
+	bulk_buffer_append_literal(buffer_p, "}}\n");
+}
+
+/*
+ *******************************************************************************************************
+ * Function to encode a scanned record as one msgpack map of its namespace,
+ * set, user key, digest, ttl, generation and bins, with the C client's serializer so
+ * values keep the encoding the server uses.
+ *******************************************************************************************************
+ */
+static void
+bulk_encode_msgpack(bulk_buffer *buffer_p, as_record *record_p)
+{
+	as_hashmap          map;
+	as_hashmap          *bins_p = as_hashmap_new(as_record_numbins(record_p) + 1);
+	as_record_iterator  iterator;
+	as_serializer       serializer;
+	as_buffer           encoded;
+
+	as_hashmap_init(&map, 8);
+	as_stringmap_set_str((as_map *) &map, "ns", record_p->key.ns);
+	as_stringmap_set_str((as_map *) &map, "set", record_p->key.set);
+	if (record_p->key.valuep) {
+		as_val_reserve((as_val *) record_p->key.valuep);
+		as_stringmap_set((as_map *) &map, "key", (as_val *) record_p->key.valuep);
+	}
+	as_stringmap_set_bytes((as_map *) &map, "digest",
+			as_bytes_new_wrap(record_p->key.digest.value, AS_DIGEST_VALUE_SIZE, false));
+	as_stringmap_set_int64((as_map *) &map, "ttl", record_p->ttl);
+	as_stringmap_set_int64((as_map *) &map, "generation", record_p->gen);
+
+	as_record_iterator_init(&iterator, record_p);
+	while (as_record_iterator_has_next(&iterator)) {
+		as_bin  *bin_p = as_record_iterator_next(&iterator);
+		as_val  *value_p = (as_val *) as_bin_get_value(bin_p);
+
+		as_val_reserve(value_p);
+		as_stringmap_set((as_map *) bins_p, as_bin_get_name(bin_p), value_p);
+	}
+	as_record_iterator_destroy(&iterator);
+	as_stringmap_set_map((as_map *) &map, "bins", (as_map *) bins_p);
+
+	as_msgpack_init(&serializer);
+	as_buffer_init(&encoded);
+	if (0 == as_serializer_serialize(&serializer, (as_val *) &map, &encoded)) {
+		bulk_buffer_append(buffer_p, (const char *) encoded.data, encoded.size);
+	} else {
+		buffer_p->failed = true;
+	}
+	as_buffer_destroy(&encoded);
+	as_serializer_destroy(&serializer);
+	as_hashmap_destroy(&map);
+}
+
+/*
+ *******************************************************************************************************
+ * Callback for the scan of scanToFile(), on the C client's scan threads.
+ * The record is encoded into a buffer of the thread, then written to the
+ * file under the lock.
+ *
+ * @return false once a record failed to be encoded or written; else true.
+ *******************************************************************************************************
+ */
+static bool
+bulk_export_callback(const as_val *val_p, void *udata_p)
+{
+	bulk_export     *export_p = (bulk_export *) udata_p;
+	as_record       *record_p = NULL;
+	bulk_buffer     buffer = {0};
+	bool            proceed = true;
+
+	if ((!val_p) || (NULL == (record_p = as_record_fromval(val_p)))) {
+		return true;
+	}
+
+	if (export_p->format == FILE_FORMAT_MSGPACK) {
+		bulk_encode_msgpack(&buffer, record_p);
+	} else {
+		bulk_encode_json(&buffer, record_p);
+	}
+
+	pthread_mutex_lock(&export_p->lock);
+	if (buffer.failed || export_p->failed ||
+			(buffer.size != fwrite(buffer.data_p, 1, buffer.size, export_p->file_p))) {
+		export_p->failed = true;
+		proceed = false;
+	} else {
+		export_p->records++;
+	}
+	pthread_mutex_unlock(&export_p->lock);
+
+	free(buffer.data_p);
+	return proceed;
+}
+
+/*
+ *******************************************************************************************************
+ * Exports a set in the Aerospike DB to a file, encoding the records in C on
+ * the scan threads as they are streamed, without a PHP callback per record.
+ * The nodes are scanned concurrently unless OPT_SCAN_CONCURRENTLY is false.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param namespace_p               The namespace to scan.
+ * @param set_p                     The set to scan.
+ * @param path_p                    The path of the file to be written.
+ * @param format                    One of FILE_FORMAT_NDJSON and FILE_FORMAT_MSGPACK.
+ * @param records_p                 Set to the number of records exported.
+ * @param options_p                 The optional policy.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_bulk_scan_to_file(aerospike *as_object_p, as_error *error_p,
+		char *namespace_p, char *set_p, const char *path_p, long format,
+		uint64_t *records_p, zval *options_p TSRMLS_DC)
+{
+	as_scan             scan;
+	bool                is_init_scan = false;
+	as_policy_scan      scan_policy;
+	bulk_export         export;
+	char                *file_buffer_p = NULL;
+
+	memset(&export, 0, sizeof(export));
+	pthread_mutex_init(&export.lock, NULL);
+	export.format = (int) format;
+
+	if ((format != FILE_FORMAT_NDJSON) && (format != FILE_FORMAT_MSGPACK)) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+				"Expects the format to be Aerospike::FILE_FORMAT_NDJSON or Aerospike::FILE_FORMAT_MSGPACK");
+		goto exit;
+	}
+
+	as_scan_init(&scan, namespace_p, set_p);
+	is_init_scan = true;
+	as_scan_set_concurrent(&scan, true);
+	set_policy_scan(&as_object_p->config, &scan_policy, NULL, &scan,
+			options_p, error_p TSRMLS_CC);
+	if (AEROSPIKE_OK != (error_p->code)) {
+		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+		goto exit;
+	}
+
+	if (php_check_open_basedir(path_p TSRMLS_CC) ||
+			(NULL == (export.file_p = VCWD_FOPEN(path_p, "wb")))) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+				"Unable to open the export file for writing");
+		goto exit;
+	}
+	if (NULL != (file_buffer_p = (char *) malloc(BULK_FILE_BUFFER_SIZE))) {
+		setvbuf(export.file_p, file_buffer_p, _IOFBF, BULK_FILE_BUFFER_SIZE);
+	}
+
+	if (AEROSPIKE_OK != aerospike_latency_scan_foreach(as_object_p, error_p,
+				&scan_policy, &scan, bulk_export_callback, &export)) {
+		DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+		goto exit;
+	}
+
+	if (export.failed) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+				"Unable to write a record to the export file");
+		goto exit;
+	}
+
+exit:
+	if (export.file_p) {
+		if ((0 != fclose(export.file_p)) && (AEROSPIKE_OK == error_p->code)) {
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+					"Unable to write the export file");
+		}
+	}
+	if (file_buffer_p) {
+		free(file_buffer_p);
+	}
+	if (is_init_scan) {
+		as_scan_destroy(&scan);
+	}
+	pthread_mutex_destroy(&export.lock);
+	if (records_p) {
+		*records_p = export.records;
+	}
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Parser of one JSON text between p and end, decoding it straight to as_vals:
+ * objects to as_hashmaps, arrays to as_arraylists, integral numbers to
+ * as_integers and other numbers to as_doubles.
+ *******************************************************************************************************
+ */
+typedef struct bulk_json_parser_s {
+	const char  *p;
+	const char  *end;
+	uint32_t    depth;
+} bulk_json_parser;
+
+/*
+ *******************************************************************************************************
+ * A record decoded by loadFile(), waiting for a writer thread.
+ *******************************************************************************************************
+ */
+typedef struct bulk_load_item_s {
+	as_key      *key_p;
+	as_record   *record_p;
+	uint64_t    position;
+} bulk_load_item;
+
+typedef struct bulk_load_failure_s {
+	uint64_t    position;
+	as_status   code;
+	char        message[AS_ERROR_MESSAGE_MAX_SIZE];
+} bulk_load_failure;
+
+/*
+ *******************************************************************************************************
+ * State of a loadFile(), shared by the PHP thread decoding the records and
+ * the writer threads. The queue of decoded records is bounded, so the
+ * decoding waits for the writers rather than holding the whole file as
+ * records in memory.
+ *******************************************************************************************************
+ */
+typedef struct bulk_load_s {
+	pthread_mutex_t     lock;
+	pthread_cond_t      not_empty;
+	pthread_cond_t      not_full;
+	bulk_load_item      *items_p;
+	uint32_t            capacity;
+	uint32_t            head;
+	uint32_t            count;
+	bool                done;
+	aerospike           *as_object_p;
+	as_policy_write     write_policy;
+	uint64_t            records;
+	uint64_t            written;
+	uint64_t            failed;
+	bulk_load_failure   *failures_p;
+	uint32_t            n_failures;
+} bulk_load;
+
+/*
+ *******************************************************************************************************
+ * Function to skip the JSON whitespace at the parser's position.
+ *******************************************************************************************************
+ */
+static void
+bulk_json_skip_space(bulk_json_parser *parser_p)
+{
+	while ((parser_p->p < parser_p->end) && ((*parser_p->p == ' ') ||
+				(*parser_p->p == '\t') || (*parser_p->p == '\r') || (*parser_p->p == '\n'))) {
+		parser_p->p++;
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to consume a literal, such as true, at the parser's position.
+ *
+ * @return true if the literal was there; else false and the parser is left
+ * where it was.
+ *******************************************************************************************************
+ */
+static bool
+bulk_json_literal(bulk_json_parser *parser_p, const char *literal_p, size_t len)
+{
+	if (((size_t) (parser_p->end - parser_p->p) < len) ||
+			(0 != memcmp(parser_p->p, literal_p, len))) {
+		return false;
+	}
+	parser_p->p += len;
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to decode the 4 hex digits of a \u escape.
+ *
+ * @param code_p                The code unit to be populated.
+ *
+ * @return true if the 4 characters are hex digits; else false.
+ *******************************************************************************************************
+ */
+static bool
+bulk_json_hex4(bulk_json_parser *parser_p, uint32_t *code_p)
+{
+	uint32_t    iter = 0;
+
+	*code_p = 0;
+	if (parser_p->end - parser_p->p < 4) {
+		return false;
+	}
+	for (iter = 0; iter < 4; iter++) {
+		char    c = *parser_p->p++;
+
+		*code_p <<= 4;
+		if (c >= '0' && c <= '9') {
+			*code_p |= c - '0';
+		} else if (c >= 'a' && c <= 'f') {
+			*code_p |= c - 'a' + 10;
+		} else if (c >= 'A' && c <= 'F') {
+			*code_p |= c - 'A' + 10;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to decode a JSON string, the parser being on its opening quote.
+ * Escapes are decoded to UTF-8, including the surrogate pairs of \u escapes.
+ *
+ * @return a malloc'd NUL terminated string, NULL if the string is malformed.
+ *******************************************************************************************************
+ */
+static char*
+bulk_json_parse_string(bulk_json_parser *parser_p)
+{
+	bulk_buffer     buffer = {0};
+	const char      *start_p = ++parser_p->p;
+	uint32_t        code = 0;
+	uint32_t        low = 0;
+	char            utf8[4];
+
+	while (parser_p->p < parser_p->end) {
+		char    c = *parser_p->p;
+
+		if (c == '"') {
+			bulk_buffer_append(&buffer, start_p, parser_p->p - start_p);
+			bulk_buffer_append(&buffer, "", 1);
+			parser_p->p++;
+			if (buffer.failed) {
+				break;
+			}
+			return buffer.data_p;
+		}
+		if ((unsigned char) c < 0x20) {
+			break;
+		}
+		if (c != '\\') {
+			parser_p->p++;
+			continue;
+		}
+
+		bulk_buffer_append(&buffer, start_p, parser_p->p - start_p);
+		if (++parser_p->p >= parser_p->end) {
+			break;
+		}
+		switch (*parser_p->p++) {
+			case '"':
+				bulk_buffer_append_literal(&buffer, "\"");
+				break;
+			case '\\':
+				bulk_buffer_append_literal(&buffer, "\\");
+				break;
+			case '/':
+				bulk_buffer_append_literal(&buffer, "/");
+				break;
+			case 'b':
+				bulk_buffer_append_literal(&buffer, "\b");
+				break;
+			case 'f':
+				bulk_buffer_append_literal(&buffer, "\f");
+				break;
+			case 'n':
+				bulk_buffer_append_literal(&buffer, "\n");
+				break;
+			case 'r':
+				bulk_buffer_append_literal(&buffer, "\r");
+				break;
+			case 't':
+				bulk_buffer_append_literal(&buffer, "\t");
+				break;
+			case 'u':
+				if (!bulk_json_hex4(parser_p, &code)) {
+					goto malformed;
+				}
+				if ((code >= 0xd800) && (code < 0xdc00)) {
+					if ((!bulk_json_literal(parser_p, "\\u", 2)) ||
+							(!bulk_json_hex4(parser_p, &low)) ||
+							(low < 0xdc00) || (low > 0xdfff)) {
+						goto malformed;
+					}
+					code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+				}
+				if (code < 0x80) {
+					utf8[0] = (char) code;
+					bulk_buffer_append(&buffer, utf8, 1);
+				} else if (code < 0x800) {
+					utf8[0] = (char) (0xc0 | (code >> 6));
+					utf8[1] = (char) (0x80 | (code & 0x3f));
+					bulk_buffer_append(&buffer, utf8, 2);
+				} else if (code < 0x10000) {
+					utf8[0] = (char) (0xe0 | (code >> 12));
+					utf8[1] = (char) (0x80 | ((code >> 6) & 0x3f));
+					utf8[2] = (char) (0x80 | (code & 0x3f));
+					bulk_buffer_append(&buffer, utf8, 3);
+				} else {
+					utf8[0] = (char) (0xf0 | (code >> 18));
+					utf8[1] = (char) (0x80 | ((code >> 12) & 0x3f));
+					utf8[2] = (char) (0x80 | ((code >> 6) & 0x3f));
+					utf8[3] = (char) (0x80 | (code & 0x3f));
+					bulk_buffer_append(&buffer, utf8, 4);
+				}
+				break;
+			default:
+				goto malformed;
+		}
+		start_p = parser_p->p;
+	}
+
+malformed:
+	free(buffer.data_p);
+	return NULL;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to decode a JSON number. The number is copied out of the file
+ * before being converted, as the mapped file is not NUL terminated.
+ *******************************************************************************************************
+ */
+static as_val*
+bulk_json_parse_number(bulk_json_parser *parser_p)
+{
+	char        number[64];
+	size_t      len = 0;
+	bool        integral = true;
+	char        *end_p = NULL;
+	long long   integer_value = 0;
+	double      double_value = 0;
+
+	while ((parser_p->p < parser_p->end) && (len < sizeof(number) - 1)) {
+		char    c = *parser_p->p;
+
+		if (c == '.' || c == 'e' || c == 'E') {
+			integral = false;
+		} else if (!((c >= '0' && c <= '9') || c == '-' || c == '+')) {
+			break;
+		}
+		number[len++] = c;
+		parser_p->p++;
+	}
+	number[len] = '\0';
+	if (len == 0) {
+		return NULL;
+	}
+
+	if (integral) {
+		errno = 0;
+		integer_value = strtoll(number, &end_p, 10);
+		if ((*end_p == '\0') && (errno == 0)) {
+			return (as_val *) as_integer_new(integer_value);
+		}
+	}
+	/* Integers out of the int64 range are kept as doubles. */
+	double_value = strtod(number, &end_p);
+	if (*end_p != '\0') {
+		return NULL;
+	}
+	return (as_val *) as_double_new(double_value);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to decode a JSON value into an as_val. null decodes to as_nil.
+ *
+ * @return the as_val, NULL if the JSON is malformed or nested too deep.
+ *******************************************************************************************************
+ */
+static as_val*
+bulk_json_parse_value(bulk_json_parser *parser_p)
+{
+	as_val      *val_p = NULL;
+	as_val      *element_p = NULL;
+	char        *str_p = NULL;
+
+	bulk_json_skip_space(parser_p);
+	if (parser_p->p >= parser_p->end) {
+		return NULL;
+	}
+
+	switch (*parser_p->p) {
+		case '"':
+			if (NULL == (str_p = bulk_json_parse_string(parser_p))) {
+				return NULL;
+			}
+			return (as_val *) as_string_new(str_p, true);
+		case 't':
+			return bulk_json_literal(parser_p, "true", 4) ?
+				(as_val *) as_boolean_new(true) : NULL;
+		case 'f':
+			return bulk_json_literal(parser_p, "false", 5) ?
+				(as_val *) as_boolean_new(false) : NULL;
+		case 'n':
+			return bulk_json_literal(parser_p, "null", 4) ? (as_val *) &as_nil : NULL;
+		case '[':
+			if (++parser_p->depth > BULK_JSON_MAX_DEPTH) {
+				return NULL;
+			}
+			parser_p->p++;
+			val_p = (as_val *) as_arraylist_new(8, 8);
+			bulk_json_skip_space(parser_p);
+			if ((parser_p->p < parser_p->end) && (*parser_p->p == ']')) {
+				parser_p->p++;
+				break;
+			}
+			for (;;) {
+				if (NULL == (element_p = bulk_json_parse_value(parser_p))) {
+					goto malformed;
+				}
+				as_arraylist_append((as_arraylist *) val_p, element_p);
+				bulk_json_skip_space(parser_p);
+				if (parser_p->p >= parser_p->end) {
+					goto malformed;
+				}
+				if (*parser_p->p == ']') {
+					parser_p->p++;
+					break;
+				}
+				if (*parser_p->p++ != ',') {
+					goto malformed;
+				}
+			}
+			break;
+		case '{':
+			if (++parser_p->depth > BULK_JSON_MAX_DEPTH) {
+				return NULL;
+			}
+			parser_p->p++;
+			val_p = (as_val *) as_hashmap_new(8);
+			bulk_json_skip_space(parser_p);
+			if ((parser_p->p < parser_p->end) && (*parser_p->p == '}')) {
+				parser_p->p++;
+				break;
+			}
+			for (;;) {
+				bulk_json_skip_space(parser_p);
+				if ((parser_p->p >= parser_p->end) || (*parser_p->p != '"') ||
+						(NULL == (str_p = bulk_json_parse_string(parser_p)))) {
+					goto malformed;
+				}
+				bulk_json_skip_space(parser_p);
+				if ((parser_p->p >= parser_p->end) || (*parser_p->p++ != ':') ||
+						(NULL == (element_p = bulk_json_parse_value(parser_p)))) {
+					free(str_p);
+					goto malformed;
+				}
+				as_map_set((as_map *) val_p, (as_val *) as_string_new(str_p, true), element_p);
+				bulk_json_skip_space(parser_p);
+				if (parser_p->p >= parser_p->end) {
+					goto malformed;
+				}
+				if (*parser_p->p == '}') {
+					parser_p->p++;
+					break;
+				}
+				if (*parser_p->p++ != ',') {
+					goto malformed;
+				}
+			}
+			break;
+		default:
+			return bulk_json_parse_number(parser_p);
+	}
+
+	parser_p->depth--;
+	return val_p;
+
+malformed:
+	as_val_destroy(val_p);
+	return NULL;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to record a record which could not be decoded or written. Only
+ * the first BULK_LOAD_MAX_FAILURES failures are kept, they are all counted.
+ * Called with the lock of the load held.
+ *******************************************************************************************************
+ */
+static void
+bulk_load_add_failure(bulk_load *load_p, uint64_t position, as_status code,
+		const char *message_p)
+{
+	bulk_load_failure   *failure_p = NULL;
+
+	load_p->failed++;
+	if (load_p->n_failures >= BULK_LOAD_MAX_FAILURES) {
+		return;
+	}
+	failure_p = &load_p->failures_p[load_p->n_failures++];
+	failure_p->position = position;
+	failure_p->code = code;
+	strncpy(failure_p->message, message_p, sizeof(failure_p->message) - 1);
+	failure_p->message[sizeof(failure_p->message) - 1] = '\0';
+}
+
+/*
+ *******************************************************************************************************
+ * Function to count a record which could not be decoded, as a failure with
+ * AEROSPIKE_ERR_PARAM. Called without the lock of the load held.
+ *******************************************************************************************************
+ */
+static void
+bulk_load_fail(bulk_load *load_p, uint64_t position, const char *message_p)
+{
+	pthread_mutex_lock(&load_p->lock);
+	load_p->records++;
+	bulk_load_add_failure(load_p, position, AEROSPIKE_ERR_PARAM, message_p);
+	pthread_mutex_unlock(&load_p->lock);
+}
+
+/*
+ *******************************************************************************************************
+ * Writer thread of loadFile(). Each writer has one put in flight, so the
+ * number of writers bounds the number of commands in flight.
+ *******************************************************************************************************
+ */
+static void*
+bulk_load_writer(void *udata_p)
+{
+	bulk_load       *load_p = (bulk_load *) udata_p;
+	bulk_load_item  item;
+	as_error        error;
+	as_status       status = AEROSPIKE_OK;
+	uint64_t        start_us = 0;
+	char            node_name[AS_NODE_NAME_SIZE];
+
+	for (;;) {
+		pthread_mutex_lock(&load_p->lock);
+		while ((load_p->count == 0) && (!load_p->done)) {
+			pthread_cond_wait(&load_p->not_empty, &load_p->lock);
+		}
+		if (load_p->count == 0) {
+			pthread_mutex_unlock(&load_p->lock);
+			break;
+		}
+		item = load_p->items_p[load_p->head];
+		load_p->head = (load_p->head + 1) % load_p->capacity;
+		load_p->count--;
+		pthread_cond_signal(&load_p->not_full);
+		pthread_mutex_unlock(&load_p->lock);
+
+		as_error_init(&error);
+		start_us = cf_getus();
+		status = aerospike_key_put(load_p->as_object_p, &error,
+				&load_p->write_policy, item.key_p, item.record_p);
+		aerospike_latency_key_node(load_p->as_object_p, item.key_p, node_name);
+		aerospike_latency_record(aerospike_latency_node(node_name),
+				AEROSPIKE_COMMAND_PUT, start_us, status);
+
+		pthread_mutex_lock(&load_p->lock);
+		load_p->records++;
+		if (status == AEROSPIKE_OK) {
+			load_p->written++;
+		} else {
+			bulk_load_add_failure(load_p, item.position, status, error.message);
+		}
+		pthread_mutex_unlock(&load_p->lock);
+
+		as_key_destroy(item.key_p);
+		as_record_destroy(item.record_p);
+	}
+
+	return NULL;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to queue a decoded record for the writers, waiting while the
+ * queue is full. Takes ownership of the key and the record.
+ *******************************************************************************************************
+ */
+static void
+bulk_load_push(bulk_load *load_p, as_key *key_p, as_record *record_p, uint64_t position)
+{
+	bulk_load_item  *item_p = NULL;
+
+	pthread_mutex_lock(&load_p->lock);
+	while (load_p->count == load_p->capacity) {
+		pthread_cond_wait(&load_p->not_full, &load_p->lock);
+	}
+	item_p = &load_p->items_p[(load_p->head + load_p->count) % load_p->capacity];
+	item_p->key_p = key_p;
+	item_p->record_p = record_p;
+	item_p->position = position;
+	load_p->count++;
+	pthread_cond_signal(&load_p->not_empty);
+	pthread_mutex_unlock(&load_p->lock);
+}
+
+/*
+ *******************************************************************************************************
+ * Callback setting a decoded bin into the record to be written. Null bins are
+ * skipped and booleans are written as integers.
+ *
+ * @return false if the bin cannot be set; else true.
+ *******************************************************************************************************
+ */
+static bool
+bulk_load_bin(const as_val *name_p, const as_val *value_p, void *udata_p)
+{
+	as_record   *record_p = (as_record *) udata_p;
+	const char  *bin_name_p = NULL;
+
+	if (as_val_type(name_p) != AS_STRING) {
+		return false;
+	}
+	bin_name_p = as_string_get((as_string *) name_p);
+
+	switch (as_val_type(value_p)) {
+		case AS_NIL:
+			return true;
+		case AS_BOOLEAN:
+			return as_record_set_int64(record_p, bin_name_p,
+					as_boolean_get((as_boolean *) value_p) ? 1 : 0);
+		default:
+			as_val_reserve((as_val *) value_p);
+			if (!as_record_set(record_p, bin_name_p, (as_bin_value *) value_p)) {
+				as_val_destroy((as_val *) value_p);
+				return false;
+			}
+			return true;
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to decode a digest written by scanToFile() as a hex string.
+ *
+ * @param digest                The digest to be populated.
+ *
+ * @return true if the string is AS_DIGEST_VALUE_SIZE hex encoded bytes;
+ * else false.
+ *******************************************************************************************************
+ */
+static bool
+bulk_load_hex_digest(const as_string *hex_p, as_digest_value digest)
+{
+	const char  *str_p = as_string_get((as_string *) hex_p);
+	uint32_t    iter = 0;
+	unsigned    byte = 0;
+
+	if (as_string_len((as_string *) hex_p) != AS_DIGEST_VALUE_SIZE * 2) {
+		return false;
+	}
+	for (iter = 0; iter < AS_DIGEST_VALUE_SIZE; iter++) {
+		if ((!isxdigit((unsigned char) str_p[iter * 2])) ||
+				(!isxdigit((unsigned char) str_p[iter * 2 + 1])) ||
+				(1 != sscanf(&str_p[iter * 2], "%2x", &byte))) {
+			return false;
+		}
+		digest[iter] = (uint8_t) byte;
+	}
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to convert a decoded record to an as_key and an as_record, and to
+ * queue them for the writers.
+ *
+ * A record is either an object of the bins, or a record in the shape written
+ * by scanToFile() with its key, metadata and bins. The key is the value of
+ * the key_field bin if given, else the key or the digest of an exported
+ * record.
+ *
+ * Takes ownership of decoded_p.
+ *******************************************************************************************************
+ */
+static void
+bulk_load_decoded(bulk_load *load_p, as_val *decoded_p, uint64_t position,
+		const char *namespace_p, const char *set_p, const char *key_field_p,
+		bool has_ttl, uint32_t ttl)
+{
+	as_map              *bins_p = NULL;
+	as_map              *exported_key_p = NULL;
+	as_map              *metadata_p = NULL;
+	as_val              *key_val_p = NULL;
+	as_val              *digest_p = NULL;
+	as_val              *ttl_p = NULL;
+	as_key              *key_p = NULL;
+	as_record           *record_p = NULL;
+	as_digest_value     digest;
+	const char          *message_p = NULL;
+
+	if ((!decoded_p) || (as_val_type(decoded_p) != AS_MAP)) {
+		message_p = "Expects a record to be a map";
+		goto exit;
+	}
+
+	if ((bins_p = as_map_fromval(as_stringmap_get((as_map *) decoded_p, "bins")))) {
+		exported_key_p = as_map_fromval(as_stringmap_get((as_map *) decoded_p, "key"));
+		if ((metadata_p = as_map_fromval(as_stringmap_get((as_map *) decoded_p, "metadata")))) {
+			ttl_p = as_stringmap_get(metadata_p, "ttl");
+		} else {
+			ttl_p = as_stringmap_get((as_map *) decoded_p, "ttl");
+		}
+		if (exported_key_p) {
+			key_val_p = as_stringmap_get(exported_key_p, "key");
+			digest_p = as_stringmap_get(exported_key_p, "digest");
+		} else {
+			key_val_p = as_stringmap_get((as_map *) decoded_p, "key");
+			digest_p = as_stringmap_get((as_map *) decoded_p, "digest");
+		}
+	} else {
+		bins_p = (as_map *) decoded_p;
+	}
+
+	if (key_field_p) {
+		key_val_p = as_stringmap_get(bins_p, key_field_p);
+		digest_p = NULL;
+	}
+
+	if (key_val_p && ((as_val_type(key_val_p) == AS_INTEGER) ||
+				(as_val_type(key_val_p) == AS_STRING) ||
+				(as_val_type(key_val_p) == AS_BYTES))) {
+		as_val_reserve(key_val_p);
+		key_p = as_key_new_value(namespace_p, set_p, (as_key_value *) key_val_p);
+	} else if (digest_p && (as_val_type(digest_p) == AS_BYTES) &&
+			(as_bytes_size((as_bytes *) digest_p) == AS_DIGEST_VALUE_SIZE)) {
+		key_p = as_key_new_digest(namespace_p, set_p,
+				as_bytes_get((as_bytes *) digest_p));
+	} else if (digest_p && (as_val_type(digest_p) == AS_STRING) &&
+			bulk_load_hex_digest((as_string *) digest_p, digest)) {
+		key_p = as_key_new_digest(namespace_p, set_p, digest);
+	} else {
+		message_p = key_field_p ?
+			"Expects the key field to be an integer, a string or bytes" :
+			"Expects a record to have a key or a digest";
+		goto exit;
+	}
+
+	record_p = as_record_new(as_map_size(bins_p));
+	if (has_ttl) {
+		record_p->ttl = ttl;
+	} else if (ttl_p && (as_val_type(ttl_p) == AS_INTEGER)) {
+		record_p->ttl = (uint32_t) as_integer_get((as_integer *) ttl_p);
+	}
+
+	if (!as_map_foreach(bins_p, bulk_load_bin, record_p)) {
+		message_p = "Unable to set a bin, its name may not be a string or be too long";
+	} else if (as_record_numbins(record_p) == 0) {
+		message_p = "Expects a record to have at least one bin";
+	}
+
+exit:
+	if (message_p) {
+		bulk_load_fail(load_p, position, message_p);
+		if (key_p) {
+			as_key_destroy(key_p);
+		}
+		if (record_p) {
+			as_record_destroy(record_p);
+		}
+	} else {
+		bulk_load_push(load_p, key_p, record_p, position);
+	}
+	if (decoded_p) {
+		as_val_destroy(decoded_p);
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to get the number of writers of a loadFile() from the
+ * OPT_BULK_CONCURRENCY option.
+ *******************************************************************************************************
+ */
+static as_status
+bulk_load_concurrency(zval *options_p, uint32_t *concurrency_p, as_error *error_p TSRMLS_DC)
+{
+	DECLARE_ZVAL_P(concurrency_pp);
+
+	*concurrency_p = BULK_LOAD_CONCURRENCY;
+
+	if (options_p) {
+#if PHP_VERSION_ID < 70000
+		if (zend_hash_index_find(Z_ARRVAL_P(options_p), OPT_BULK_CONCURRENCY, (void **) &concurrency_pp) == FAILURE) {
+#else
+		if ((concurrency_pp = zend_hash_index_find(Z_ARRVAL_P(options_p), OPT_BULK_CONCURRENCY)) == NULL) {
+#endif
+			goto exit;
+		}
+		if ((AEROSPIKE_Z_TYPE_P(concurrency_pp) != IS_LONG) ||
+				(AEROSPIKE_Z_LVAL_P(concurrency_pp) < 1) ||
+				(AEROSPIKE_Z_LVAL_P(concurrency_pp) > BULK_LOAD_MAX_CONCURRENCY)) {
+			DEBUG_PHP_EXT_DEBUG("OPT_BULK_CONCURRENCY should be an integer between 1 and 256");
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+				"OPT_BULK_CONCURRENCY should be an integer between 1 and 256");
+			goto exit;
+		}
+		*concurrency_p = (uint32_t) AEROSPIKE_Z_LVAL_P(concurrency_pp);
+	}
+
+exit:
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to populate the summary of a loadFile().
+ *******************************************************************************************************
+ */
+static void
+bulk_load_summary(bulk_load *load_p, zval *summary_p TSRMLS_DC)
+{
+	uint32_t    iter = 0;
+	DECLARE_ZVAL(failures);
+
+#if PHP_VERSION_ID < 70000
+	MAKE_STD_ZVAL(failures);
+	array_init(failures);
+#else
+	array_init(&failures);
+#endif
+
+	for (iter = 0; iter < load_p->n_failures; iter++) {
+		bulk_load_failure   *failure_p = &load_p->failures_p[iter];
+#if PHP_VERSION_ID < 70000
+		zval    *failure_zval_p = NULL;
+
+		MAKE_STD_ZVAL(failure_zval_p);
+#else
+		zval    failure_zval;
+		zval    *failure_zval_p = &failure_zval;
+#endif
+		array_init(failure_zval_p);
+		add_assoc_long(failure_zval_p, "record", failure_p->position);
+		add_assoc_long(failure_zval_p, "code", failure_p->code);
+		AEROSPIKE_ADD_ASSOC_STRINGL(failure_zval_p, "message", failure_p->message,
+				strlen(failure_p->message), 1);
+#if PHP_VERSION_ID < 70000
+		add_next_index_zval(failures, failure_zval_p);
+#else
+		add_next_index_zval(&failures, failure_zval_p);
+#endif
+	}
+
+	add_assoc_long(summary_p, "records", load_p->records);
+	add_assoc_long(summary_p, "written", load_p->written);
+	add_assoc_long(summary_p, "failed", load_p->failed);
+#if PHP_VERSION_ID < 70000
+	add_assoc_zval(summary_p, "failures", failures);
+#else
+	add_assoc_zval(summary_p, "failures", &failures);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Loads the records of an NDJSON or msgpack file into a set of the Aerospike
+ * DB. The file is mapped and decoded straight into as_records on the PHP
+ * thread, while writer threads put them with a bounded number of commands in
+ * flight. Records which cannot be decoded or written are counted and logged
+ * in the summary, they do not stop the load.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param path_p                    The path of the file to be loaded.
+ * @param format                    One of FILE_FORMAT_NDJSON and FILE_FORMAT_MSGPACK.
+ * @param namespace_p               The namespace the records are written to.
+ * @param set_p                     The set the records are written to.
+ * @param key_field_p               The bin holding the key of each record.
+ *                                  NULL to use the key or digest of exported records.
+ * @param summary_p                 The initialized PHP array to be populated
+ *                                  with the summary of the load.
+ * @param options_p                 The optional policy.
+ *
+ * @return AEROSPIKE_OK if the whole file was read. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_bulk_load_file(aerospike *as_object_p, as_error *error_p,
+		const char *path_p, long format, char *namespace_p, char *set_p,
+		char *key_field_p, zval *summary_p, zval *options_p TSRMLS_DC)
+{
+	bulk_load           load;
+	pthread_t           writers[BULK_LOAD_MAX_CONCURRENCY];
+	uint32_t            n_writers = 0;
+	uint32_t            concurrency = 0;
+	uint32_t            ttl = 0;
+	bool                has_ttl = false;
+	int                 fd = -1;
+	struct stat         file_stat;
+	const char          *data_p = MAP_FAILED;
+	size_t              size = 0;
+	size_t              offset = 0;
+	uint64_t            position = 0;
+
+	memset(&load, 0, sizeof(load));
+	pthread_mutex_init(&load.lock, NULL);
+	pthread_cond_init(&load.not_empty, NULL);
+	pthread_cond_init(&load.not_full, NULL);
+	load.as_object_p = as_object_p;
+
+	if ((format != FILE_FORMAT_NDJSON) && (format != FILE_FORMAT_MSGPACK)) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+				"Expects the format to be Aerospike::FILE_FORMAT_NDJSON or Aerospike::FILE_FORMAT_MSGPACK");
+		goto exit;
+	}
+
+	set_policy(&as_object_p->config, NULL, &load.write_policy, NULL, NULL, NULL,
+			NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
+	if (AEROSPIKE_OK != error_p->code) {
+		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+		goto exit;
+	}
+	if ((AEROSPIKE_OK != get_options_ttl_value(options_p, &ttl, error_p TSRMLS_CC)) ||
+			(AEROSPIKE_OK != bulk_load_concurrency(options_p, &concurrency, error_p TSRMLS_CC))) {
+		goto exit;
+	}
+	has_ttl = options_p && zend_hash_index_exists(Z_ARRVAL_P(options_p), OPT_TTL);
+
+	if (php_check_open_basedir(path_p TSRMLS_CC) ||
+			((fd = VCWD_OPEN(path_p, O_RDONLY)) < 0) ||
+			(0 != fstat(fd, &file_stat))) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+				"Unable to open the file to be loaded");
+		goto exit;
+	}
+	size = (size_t) file_stat.st_size;
+	if (size > 0) {
+		if (MAP_FAILED == (data_p = (const char *) mmap(NULL, size, PROT_READ,
+						MAP_PRIVATE, fd, 0))) {
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+					"Unable to map the file to be loaded");
+			goto exit;
+		}
+		madvise((void *) data_p, size, MADV_SEQUENTIAL);
+	}
+
+	load.capacity = concurrency * 4;
+	load.items_p = (bulk_load_item *) malloc(load.capacity * sizeof(bulk_load_item));
+	load.failures_p = (bulk_load_failure *) malloc(BULK_LOAD_MAX_FAILURES * sizeof(bulk_load_failure));
+	if ((!load.items_p) || (!load.failures_p)) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+				"Unable to allocate the queue of records to be written");
+		goto exit;
+	}
+
+	for (n_writers = 0; n_writers < concurrency; n_writers++) {
+		if (0 != pthread_create(&writers[n_writers], NULL, bulk_load_writer, &load)) {
+			break;
+		}
+	}
+	if (n_writers == 0) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+				"Unable to start the threads writing the records");
+		goto exit;
+	}
+
+	while (offset < size) {
+		if (format == FILE_FORMAT_NDJSON) {
+			const char          *line_p = data_p + offset;
+			const char          *newline_p = memchr(line_p, '\n', size - offset);
+			bulk_json_parser    parser = {line_p, newline_p ? newline_p : data_p + size, 0};
+			as_val              *decoded_p = NULL;
+
+			offset = (parser.end - data_p) + 1;
+			position++;
+
+			bulk_json_skip_space(&parser);
+			if (parser.p == parser.end) {
+				continue;
+			}
+			decoded_p = bulk_json_parse_value(&parser);
+			bulk_json_skip_space(&parser);
+			if ((!decoded_p) || (parser.p != parser.end)) {
+				if (decoded_p) {
+					as_val_destroy(decoded_p);
+				}
+				bulk_load_fail(&load, position, "Unable to decode the line as JSON");
+				continue;
+			}
+			bulk_load_decoded(&load, decoded_p, position, namespace_p, set_p,
+					key_field_p, has_ttl, ttl);
+		} else {
+			as_unpacker     unpacker;
+			as_val          *decoded_p = NULL;
+
+			unpacker.buffer = (const unsigned char *) data_p + offset;
+			unpacker.offset = 0;
+			unpacker.length = (int) MIN(size - offset, (size_t) INT_MAX);
+			position++;
+
+			/* A msgpack value which cannot be decoded leaves no way to find the next one. */
+			if ((0 != as_unpack_val(&unpacker, &decoded_p)) || (!decoded_p) ||
+					(unpacker.offset <= 0)) {
+				if (decoded_p) {
+					as_val_destroy(decoded_p);
+				}
+				bulk_load_fail(&load, position, "Unable to decode the record as msgpack");
+				PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+						"Unable to decode the msgpack file, it is truncated or corrupt");
+				break;
+			}
+			offset += unpacker.offset;
+			bulk_load_decoded(&load, decoded_p, position, namespace_p, set_p,
+					key_field_p, has_ttl, ttl);
+		}
+	}
+
+exit:
+	pthread_mutex_lock(&load.lock);
+	load.done = true;
+	pthread_cond_broadcast(&load.not_empty);
+	pthread_mutex_unlock(&load.lock);
+	while (n_writers > 0) {
+		pthread_join(writers[--n_writers], NULL);
+	}
+
+	if (summary_p && load.failures_p) {
+		bulk_load_summary(&load, summary_p TSRMLS_CC);
+	}
+
+	if (data_p != MAP_FAILED) {
+		munmap((void *) data_p, size);
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+	free(load.items_p);
+	free(load.failures_p);
+	pthread_cond_destroy(&load.not_full);
+	pthread_cond_destroy(&load.not_empty);
+	pthread_mutex_destroy(&load.lock);
+	return error_p->code;
+}
@@ -26,6 +26,9 @@
 #include "aerospike/as_operations.h"
 #include "aerospike/as_record.h"
 #include "aerospike/as_scan.h"
+#include "aerospike/aerospike_batch.h"
+#include "aerospike/aerospike_query.h"
+#include "aerospike/aerospike_scan.h"
 
 /*
  *******************************************************************************************************
@@ -89,12 +92,11 @@
 
 /*
  *******************************************************************************************************
- * MACROS FOR UDF KEYS AND FILE READING BUFFER SIZE.
+ * MACROS FOR UDF KEYS.
  *******************************************************************************************************
  */
 #define UDF_MODULE_NAME "name"
 #define UDF_MODULE_TYPE "type"
-#define LUA_FILE_BUFFER_FRAME 512
 
 /*
  *******************************************************************************************************
@@ -136,6 +138,9 @@
 #define SAVE_PATH_PHP_INI INI_STR("session.save_path") ? INI_STR("session.save_path") : NULL
 #define CACHE_EXPIRE_PHP_INI INI_INT("session.cache_expire") ? INI_INT("session.cache_expire") * 60 : 0
 #define SESSION_EXPIRE_PHP_INI INI_INT("session.gc_maxlifetime") ? INI_INT("session.gc_maxlifetime") * 60 : 0
+#define SESSION_COMPRESSION_THRESHOLD_PHP_INI INI_INT("aerospike.session_compression_threshold")
+#define SESSION_GENERATION_CHECK_PHP_INI INI_BOOL("aerospike.session_generation_check")
+#define SESSION_SERIALIZE_HANDLER_PHP_INI INI_STR("session.serialize_handler")
 
 #define AEROSPIKE_SESSION "aerospike"
 #define AEROSPIKE_SESSION_LEN 9
@@ -270,6 +275,10 @@ typedef struct csdk_aerospike_obj {
 	  u_int16_t is_conn_16;
 	  int8_t serializer_opt;
 	  bool hasGeoJSON;         /* Boolean value to store if GeoJSON is supported or not */
+	  HashTable *policy_profiles_p; /* Per namespace/set default policies, keyed by "ns" or "ns.set" */
+	  HashTable *memo_p;           /* Reads memoized by get(), keyed by namespace and digest */
+	  HashTable *counters_p;       /* Increments buffered by increment(), keyed by namespace and digest */
+	  uint64_t counters_since_ms;  /* When the oldest buffered increment was made, 0 if none */
     #ifdef ZTS
 	    void ***ts;
     #endif
@@ -281,6 +290,10 @@ typedef struct Aerospike_object {
 	u_int16_t is_conn_16;
 	int8_t serializer_opt;
 	bool hasGeoJSON;         /* Boolean value to store if GeoJSON is supported or not */
+	HashTable *policy_profiles_p; /* Per namespace/set default policies, keyed by "ns" or "ns.set" */
+	HashTable *memo_p;           /* Reads memoized by get(), keyed by namespace and digest */
+	HashTable *counters_p;       /* Increments buffered by increment(), keyed by namespace and digest */
+	uint64_t counters_since_ms;  /* When the oldest buffered increment was made, 0 if none */
 	#ifdef ZTS
 		void ***ts;
 	#endif
@@ -294,12 +307,35 @@ typedef struct Aerospike_object {
  * Structure containing session info of Aerospike_object.
  *******************************************************************************************************
  */
+#define AEROSPIKE_SESSION_DIGEST_SIZE 20
+
 typedef struct aerospike_session_t {
 	Aerospike_object    *aerospike_obj_p;
 	char                ns_p[AS_NAMESPACE_MAX_SIZE];
 	char                set_p[AS_SET_MAX_SIZE];
+	/* SHA1 of the session id and the data last read or written */
+	unsigned char       data_digest[AEROSPIKE_SESSION_DIGEST_SIZE];
+	bool                has_data_digest;
+	/* Data and generation of the record last read or written, for
+	 * aerospike.session_generation_check */
+	char                *base_data_p;
+	uint32_t            base_data_len;
+	uint16_t            generation;
+	bool                has_generation;
 } aerospike_session;
 
+/*
+ *******************************************************************************************************
+ * Structure of the per process cache of session save paths, holding the
+ * parsed ns and set and the aerospike_ref connected to the hosts.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_session_cache_entry_t {
+	aerospike_ref       *as_ref_p;
+	char                ns_p[AS_NAMESPACE_MAX_SIZE];
+	char                set_p[AS_SET_MAX_SIZE];
+} aerospike_session_cache_entry;
+
 /*
  *******************************************************************************************************
  * Struct for user data to be passed to aerospike foreach callbacks.
@@ -398,6 +434,71 @@ typedef struct _userland_callback {
 #endif
 } userland_callback;
 
+/*
+ *******************************************************************************************************
+ * MACROS AND STRUCTS FOR THE PER NODE LATENCY TRACKING.
+ * Histograms have AEROSPIKE_LATENCY_SUB_BUCKETS linear buckets per power of
+ * two microseconds, which keeps percentiles within 25% of the actual value.
+ *******************************************************************************************************
+ */
+#define AEROSPIKE_LATENCY_SUB_BUCKETS 4
+#define AEROSPIKE_LATENCY_BUCKETS 128
+#define AEROSPIKE_LATENCY_MAX_NODES 128
+#define AEROSPIKE_LATENCY_MIN_SAMPLES 100
+
+typedef enum aerospike_command_e {
+	AEROSPIKE_COMMAND_GET = 0,
+	AEROSPIKE_COMMAND_PUT,
+	AEROSPIKE_COMMAND_OPERATE,
+	AEROSPIKE_COMMAND_BATCH,
+	AEROSPIKE_COMMAND_SCAN,
+	AEROSPIKE_COMMAND_QUERY,
+	AEROSPIKE_COMMAND_UDF,
+	AEROSPIKE_COMMAND_MAX
+} aerospike_command;
+
+typedef struct aerospike_latency_histogram_t {
+	uint64_t    count;
+	uint64_t    sum_us;
+	uint64_t    max_us;
+	uint64_t    buckets[AEROSPIKE_LATENCY_BUCKETS];
+} aerospike_latency_histogram;
+
+typedef struct aerospike_command_stats_t {
+	uint64_t                    errors;
+	uint64_t                    timeouts;
+	aerospike_latency_histogram latency;
+} aerospike_command_stats;
+
+typedef struct aerospike_node_latency_t {
+	uint32_t                    state;
+	char                        name[AS_NODE_NAME_SIZE];
+	aerospike_command_stats     commands[AEROSPIKE_COMMAND_MAX];
+	uint64_t                    hedged;
+} aerospike_node_latency;
+
+/*
+ *******************************************************************************************************
+ * MACROS AND STRUCTS FOR THE SLOW COMMAND LOG.
+ *******************************************************************************************************
+ */
+#define AEROSPIKE_SLOWLOG_SIZE 128
+
+typedef struct aerospike_slowlog_entry_t {
+	uint64_t            seq;
+	uint64_t            time_ms;
+	aerospike_command   command;
+	as_status           status;
+	uint64_t            elapsed_us;
+	char                ns[AS_NAMESPACE_MAX_SIZE];
+	char                set[AS_SET_MAX_SIZE];
+	char                node[AS_NODE_NAME_SIZE];
+	uint8_t             digest[AS_DIGEST_VALUE_SIZE];
+	bool                has_digest;
+	uint32_t            n_bins;
+	uint32_t            payload_size;
+} aerospike_slowlog_entry;
+
 /*
  *******************************************************************************************************
  * Decision Structure for as_config/zval to be populated by
@@ -445,11 +546,43 @@ typedef struct _shared_memory_key
 
 extern bool
 aerospike_helper_log_callback(as_log_level level, const char * func TSRMLS_DC, const char * file, uint32_t line, const char * fmt, ...);
+
+/*
+ *******************************************************************************************************
+ * Log record queued for the userland log handler, see aerospike_log_queue.c.
+ * AEROSPIKE_LOG_QUEUE_SIZE must be a power of two.
+ *******************************************************************************************************
+ */
+#define AEROSPIKE_LOG_QUEUE_SIZE 1024
+
+typedef struct aerospike_log_record_t {
+	uint64_t        seq;
+	as_log_level    level;
+	uint32_t        line;
+	const char      *func;
+	const char      *file;
+} aerospike_log_record;
+
+extern void
+aerospike_log_queue_init(void);
+extern void
+aerospike_log_queue_push(as_log_level level, const char *func, const char *file,
+		uint32_t line);
+extern bool
+aerospike_log_queue_callback(as_log_level level, const char *func,
+		const char *file, uint32_t line, const char *fmt, ...);
+extern void
+aerospike_log_queue_drain(TSRMLS_D);
+extern uint64_t
+aerospike_log_queue_dropped(void);
 extern int parseLogParameters(as_log *as_log_p);
 extern bool
 aerospike_helper_record_stream_callback(const as_val* p_val, void* udata);
 extern bool
 aerospike_helper_aggregate_callback(const as_val* val_p, void* udata_p);
+
+extern bool
+aerospike_helper_aggregate_stream_callback(const as_val* val_p, void* udata_p);
 extern bool
 aerospike_info_callback(const as_error* err, const as_node* node, char* request,
 		char* response, void* udata);
@@ -594,6 +727,8 @@ do {
  *******************************************************************************************************
  */
 extern bool AS_DEFAULT_GET(const char *key, const as_val *value, void *array);
+extern bool AS_LIST_GET_CALLBACK(as_val *value, void *array);
+extern bool AS_MAP_GET_CALLBACK(as_val *key, as_val *value, void *array);
 extern bool AS_AGGREGATE_GET(Aerospike_object* as, const char *key, const as_val *value, void *array);
 
 extern as_status
@@ -622,6 +757,22 @@ aerospike_transform_key_data_put(Aerospike_object* as_object_p,
 								zval* options_p,
 								int8_t* serializer_policy_p TSRMLS_DC);
 
+extern as_status
+aerospike_transform_key_data_prepare_put(Aerospike_object* as_object_p,
+	              #if PHP_VERSION_ID < 70000
+		              zval **record_pp
+	              #else
+		              zval *record_pp
+	              #endif
+								, as_key* as_key_p,
+								as_record* record_p,
+								as_static_pool* static_pool_p,
+								as_policy_write* write_policy_p,
+								as_error *error_p,
+								u_int32_t ttl_u32,
+								zval* options_p,
+								int8_t* serializer_policy_p TSRMLS_DC);
+
 extern as_status
 aerospike_transform_get_record(Aerospike_object* aerospike_object_p,
 								as_key* get_rec_key_p,
@@ -647,7 +798,7 @@ extern void AS_LIST_PUT(Aerospike_object* as, void *key, void *value, void *stor
  *******************************************************************************************************
  */
 extern as_status
-aerospike_record_operations_exists(aerospike* as_object_p,
+aerospike_record_operations_exists(Aerospike_object* aerospike_obj_p,
 									as_key* as_key_p,
 									as_error *error_p,
 									zval* metadata_p,
@@ -676,6 +827,15 @@ extern as_status aerospike_record_operations_operate(Aerospike_object* aerospike
 								zval* returned_p,
 								HashTable* operations_array_p);
 
+extern as_status aerospike_record_operations_operate_prepare(Aerospike_object* aerospike_obj_p,
+								as_key* as_key_p,
+								zval* options_p,
+								as_error* error_p,
+								HashTable* operations_array_p,
+								as_operations* ops_p,
+								as_policy_operate* operate_policy_p,
+								bool copy_values);
+
 extern as_status aerospike_record_operations_operate_ordered(Aerospike_object* aerospike_obj_p,
                                 as_key* as_key_p,
                                 zval* options_p,
@@ -717,6 +877,10 @@ extern as_status
 get_options_ttl_value(zval* options_p, uint32_t* ttl_value_p,
 		as_error *error_p TSRMLS_DC);
 
+extern as_status
+get_options_hedge_delay_value(zval* options_p, int32_t* hedge_delay_p,
+		as_error *error_p TSRMLS_DC);
+
 /*
  *******************************************************************************************************
  * Extern declarations of helper functions.
@@ -793,6 +957,12 @@ aerospike_scan_run(aerospike* as_object_p, as_error* error_p,
 		char* namespace_p, char* set_p, userland_callback* user_func_p,
 		HashTable* bins_ht_p, zval* options_p, int8_t* serializer_policy_p TSRMLS_DC);
 
+extern as_status
+aerospike_scan_run_cursor(aerospike* as_object_p, as_error* error_p,
+		char* namespace_p, char* set_p, userland_callback* user_func_p,
+		HashTable* bins_ht_p, zval* cursor_p, zval* options_p,
+		int8_t* serializer_policy_p TSRMLS_DC);
+
 extern as_status
 aerospike_scan_run_background(Aerospike_object* as_object_p, as_error* error_p,
 		char *module_p, char *function_p,
@@ -811,6 +981,152 @@ aerospike_scan_get_info(aerospike* as_object_p, as_error* error_p,
 extern as_status
 aerospike_job_get_info(aerospike* as_object_p, as_error* error_p,
 		uint64_t job_id, zval* job_info_p, char* module_p, zval* options_p TSRMLS_DC);
+/*
+ ******************************************************************************************************
+ * Extern declarations of bulk export and import functions.
+ ******************************************************************************************************
+ */
+extern as_status
+aerospike_bulk_scan_to_file(aerospike *as_object_p, as_error *error_p,
+		char *namespace_p, char *set_p, const char *path_p, long format,
+		uint64_t *records_p, zval *options_p TSRMLS_DC);
+
+extern as_status
+aerospike_bulk_load_file(aerospike *as_object_p, as_error *error_p,
+		const char *path_p, long format, char *namespace_p, char *set_p,
+		char *key_field_p, zval *summary_p, zval *options_p TSRMLS_DC);
+
+/*
+ ******************************************************************************************************
+ * Extern declarations of async command functions.
+ ******************************************************************************************************
+ */
+extern int
+aerospike_async_init(TSRMLS_D);
+
+extern void
+aerospike_async_shutdown(void);
+
+extern as_status
+aerospike_async_get(Aerospike_object *aerospike_obj_p, zval *client_p,
+		zval *key_p, zval *select_p, zval *options_p, as_error *error_p,
+		zval *future_zval_p TSRMLS_DC);
+
+extern as_status
+aerospike_async_put(Aerospike_object *aerospike_obj_p, zval *client_p,
+		zval *key_p, zval *bins_p, u_int32_t ttl_u32, zval *options_p,
+		as_error *error_p, zval *future_zval_p TSRMLS_DC);
+
+extern as_status
+aerospike_async_operate(Aerospike_object *aerospike_obj_p, zval *client_p,
+		zval *key_p, zval *operations_p, zval *options_p, as_error *error_p,
+		zval *future_zval_p TSRMLS_DC);
+
+extern as_status
+aerospike_async_apply(Aerospike_object *aerospike_obj_p, zval *client_p,
+		zval *key_p, char *module_p, char *function_p, zval *args_p,
+		zval *options_p, as_error *error_p, zval *future_zval_p TSRMLS_DC);
+
+extern as_status
+aerospike_async_await_all(zval *futures_p, zval *results_p, as_error *error_p TSRMLS_DC);
+
+extern long
+aerospike_async_poll(TSRMLS_D);
+
+extern as_status
+aerospike_async_event_stream(zval *stream_zval_p, as_error *error_p TSRMLS_DC);
+
+extern void
+aerospike_async_request_shutdown(TSRMLS_D);
+
+extern void
+aerospike_async_flight_forget(Aerospike_object *aerospike_obj_p, as_key *as_key_p);
+
+extern void
+aerospike_async_cancel(Aerospike_object *aerospike_obj_p);
+
+/*
+ ******************************************************************************************************
+ * Extern declarations of read memoization functions.
+ ******************************************************************************************************
+ */
+extern void
+aerospike_memo_enable(Aerospike_object *aerospike_obj_p, bool enable);
+
+extern bool
+aerospike_memo_get(Aerospike_object *aerospike_obj_p, as_key *as_key_p, zval *bins_p,
+		as_record **record_pp, as_error *error_p TSRMLS_DC);
+
+extern void
+aerospike_memo_put(Aerospike_object *aerospike_obj_p, as_key *as_key_p, zval *bins_p,
+		as_record *record_p, as_error *error_p TSRMLS_DC);
+
+extern void
+aerospike_memo_invalidate(Aerospike_object *aerospike_obj_p, as_key *as_key_p);
+
+extern void
+aerospike_memo_clear(Aerospike_object *aerospike_obj_p);
+
+extern void
+aerospike_write_invalidate(Aerospike_object *aerospike_obj_p, as_key *as_key_p);
+
+extern void
+aerospike_write_invalidate_all(Aerospike_object *aerospike_obj_p);
+
+extern void
+aerospike_memo_destroy(Aerospike_object *aerospike_obj_p);
+
+/*
+ ******************************************************************************************************
+ * Extern declarations of increment buffering functions.
+ ******************************************************************************************************
+ */
+extern as_status
+aerospike_counters_enable(Aerospike_object *aerospike_obj_p, bool enable,
+		as_error *error_p TSRMLS_DC);
+
+extern bool
+aerospike_counters_add(Aerospike_object *aerospike_obj_p, as_key *as_key_p,
+		const char *bin_name_p, int64_t offset, double double_offset,
+		bool is_double, as_error *error_p TSRMLS_DC);
+
+extern as_status
+aerospike_counters_flush(Aerospike_object *aerospike_obj_p, as_error *error_p TSRMLS_DC);
+
+extern void
+aerospike_counters_destroy(Aerospike_object *aerospike_obj_p, as_error *error_p TSRMLS_DC);
+
+extern void
+aerospike_counters_request_shutdown(TSRMLS_D);
+
+/*
+ ******************************************************************************************************
+ * Extern declarations of near cache functions.
+ ******************************************************************************************************
+ */
+extern int
+aerospike_near_cache_init(TSRMLS_D);
+
+extern void
+aerospike_near_cache_shutdown(void);
+
+extern bool
+aerospike_near_cache_get(Aerospike_object *aerospike_obj_p, as_key *as_key_p,
+		as_policy_read *read_policy_p, int32_t hedge_delay, as_record **record_pp,
+		as_error *error_p TSRMLS_DC);
+
+extern void
+aerospike_near_cache_put(as_key *as_key_p, as_record *record_p TSRMLS_DC);
+
+extern void
+aerospike_near_cache_invalidate(as_key *as_key_p);
+
+extern void
+aerospike_near_cache_clear(void);
+
+extern void
+aerospike_near_cache_stats(zval *stats_p TSRMLS_DC);
+
 /*
  ******************************************************************************************************
  * Extern declarations of query functions.
@@ -843,7 +1159,13 @@ aerospike_query_aggregate(Aerospike_object* as_object_p, as_error* error_p,
 		#endif
 		,
 		char* namespace_p, char* set_p, HashTable* bins_ht_p,
-		HashTable* predicate_ht_p, zval* return_value_p, zval* options_p, int8_t* serializer_policy_p TSRMLS_DC);
+		HashTable* predicate_ht_p, zval* return_value_p, userland_callback* user_func_p,
+		zval* options_p, int8_t* serializer_policy_p TSRMLS_DC);
+
+extern as_status
+aerospike_query_aggregate_native(aerospike* as_object_p, as_error* error_p,
+		char* namespace_p, char* set_p, HashTable* predicate_ht_p,
+		HashTable* aggregates_ht_p, zval* return_value_p, zval* options_p TSRMLS_DC);
 
 /*
  ******************************************************************************************************
@@ -996,6 +1318,149 @@ extern as_status
 aerospike_security_operations_query_roles(aerospike* as_object_p, as_error *error_p,
 		zval* roles_p, zval* options_p TSRMLS_DC);
 
+/*
+ ******************************************************************************************************
+ * Extern declarations of latency tracking functions.
+ ******************************************************************************************************
+ */
+extern uint64_t
+aerospike_latency_bucket_upper_us(uint32_t index);
+
+extern void
+aerospike_latency_histogram_add(aerospike_latency_histogram *histogram_p,
+		uint64_t elapsed_us);
+
+extern uint64_t
+aerospike_latency_histogram_percentile(aerospike_latency_histogram *histogram_p,
+		double percentile);
+
+extern aerospike_node_latency*
+aerospike_latency_node(const char *node_name_p);
+
+extern void
+aerospike_latency_key_node(aerospike *as_object_p, const as_key *as_key_p,
+		char *node_name_p);
+
+extern const char*
+aerospike_latency_command_name(aerospike_command command);
+
+extern aerospike_command_stats*
+aerospike_latency_command_totals(aerospike_command command);
+
+extern uint64_t
+aerospike_latency_record(aerospike_node_latency *node_p,
+		aerospike_command command, uint64_t start_us, as_status status);
+
+extern void
+aerospike_latency_record_key(aerospike *as_object_p, const as_key *as_key_p,
+		const as_record *record_p, aerospike_command command,
+		uint64_t start_us, as_status status);
+
+extern void
+aerospike_latency_stats(zval *stats_p TSRMLS_DC);
+
+extern as_status
+aerospike_latency_key_get(aerospike *as_object_p, as_error *error_p,
+		const as_policy_read *policy_p, const as_key *as_key_p,
+		as_record **record_pp);
+
+extern as_status
+aerospike_latency_key_put(aerospike *as_object_p, as_error *error_p,
+		const as_policy_write *policy_p, const as_key *as_key_p,
+		as_record *record_p);
+
+extern as_status
+aerospike_latency_key_remove(aerospike *as_object_p, as_error *error_p,
+		const as_policy_remove *policy_p, const as_key *as_key_p);
+
+extern as_status
+aerospike_latency_key_operate(aerospike *as_object_p, as_error *error_p,
+		const as_policy_operate *policy_p, const as_key *as_key_p,
+		const as_operations *operations_p, as_record **record_pp);
+
+extern as_status
+aerospike_latency_key_apply(aerospike *as_object_p, as_error *error_p,
+		const as_policy_apply *policy_p, const as_key *as_key_p,
+		const char *module_p, const char *function_p, as_list *arglist_p,
+		as_val **result_pp);
+
+extern as_status
+aerospike_latency_batch_read(aerospike *as_object_p, as_error *error_p,
+		const as_policy_batch *policy_p, as_batch_read_records *records_p);
+
+extern as_status
+aerospike_latency_batch_exists(aerospike *as_object_p, as_error *error_p,
+		const as_policy_batch *policy_p, const as_batch *batch_p,
+		aerospike_batch_read_callback callback, void *udata_p);
+
+extern as_status
+aerospike_latency_batch_get(aerospike *as_object_p, as_error *error_p,
+		const as_policy_batch *policy_p, const as_batch *batch_p,
+		aerospike_batch_read_callback callback, void *udata_p);
+
+extern as_status
+aerospike_latency_batch_get_bins(aerospike *as_object_p, as_error *error_p,
+		const as_policy_batch *policy_p, const as_batch *batch_p,
+		const char **bins_p, uint32_t n_bins,
+		aerospike_batch_read_callback callback, void *udata_p);
+
+extern as_status
+aerospike_latency_scan_foreach(aerospike *as_object_p, as_error *error_p,
+		const as_policy_scan *policy_p, const as_scan *scan_p,
+		aerospike_scan_foreach_callback callback, void *udata_p);
+
+extern as_status
+aerospike_latency_scan_node(aerospike *as_object_p, as_error *error_p,
+		const as_policy_scan *policy_p, const as_scan *scan_p, const char *node_name_p,
+		aerospike_scan_foreach_callback callback, void *udata_p);
+
+extern as_status
+aerospike_latency_query_foreach(aerospike *as_object_p, as_error *error_p,
+		const as_policy_query *policy_p, const as_query *query_p,
+		aerospike_query_foreach_callback callback, void *udata_p);
+
+extern as_status
+aerospike_latency_hedged_read(aerospike *as_object_p, as_error *error_p,
+		as_policy_read *read_policy_p, const as_key *as_key_p,
+		const char **bins_p, bool exists_only, as_record **record_pp,
+		int32_t hedge_delay TSRMLS_DC);
+
+/*
+ ******************************************************************************************************
+ * Extern declarations of slow log functions.
+ ******************************************************************************************************
+ */
+extern void
+aerospike_slowlog_record(aerospike_command command, const char *ns_p,
+		const char *set_p, const as_key *as_key_p, const char *node_name_p,
+		const as_record *record_p, uint64_t elapsed_us, as_status status);
+
+extern void
+aerospike_slowlog_get(zval *slowlog_p TSRMLS_DC);
+
+extern void
+aerospike_slowlog_request_shutdown(TSRMLS_D);
+
+extern void
+aerospike_slowlog_shutdown(void);
+
+/*
+ ******************************************************************************************************
+ * Extern declarations of memory profiling functions.
+ ******************************************************************************************************
+ */
+extern bool
+aerospike_memory_begin(aerospike_command command);
+
+extern void
+aerospike_memory_sample(TSRMLS_D);
+
+extern void
+aerospike_memory_end(bool started);
+
+extern void
+aerospike_memory_stats(zval *stats_p TSRMLS_DC);
+
 extern int
 check_val_type_list(
 	#if PHP_VERSION_ID < 70000
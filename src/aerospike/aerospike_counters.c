@@ -0,0 +1,437 @@
+/*
+ *
+ * Copyright (C) 2014-2016 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#include "php.h"
+#include "php_aerospike.h"
+
+#include "aerospike/aerospike.h"
+#include "aerospike/as_error.h"
+#include "aerospike/as_key.h"
+#include "aerospike/as_operations.h"
+#include "citrusleaf/alloc.h"
+#include "citrusleaf/cf_clock.h"
+#include "aerospike_common.h"
+#include "aerospike_policy.h"
+
+#define COUNTERS_KEY_SIZE       (AS_NAMESPACE_MAX_SIZE + AS_DIGEST_VALUE_SIZE)
+
+/*
+ *******************************************************************************************************
+ * Sum of the buffered increments of one bin. The integer and the float
+ * increments are summed apart, as they are different operations.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_counter_bin_s {
+	char        name[AS_BIN_NAME_MAX_SIZE];
+	bool        has_integer;
+	int64_t     integer;
+	bool        has_double;
+	double      dbl;
+} aerospike_counter_bin;
+
+/*
+ *******************************************************************************************************
+ * Buffered increments of one record, kept in the buffer of an
+ * Aerospike_object under the namespace and digest of the record. The key is
+ * a copy of the key of the first increment, as its value may point into the
+ * zvals of that call.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_counter_s {
+	as_key                  key;
+	aerospike_counter_bin   *bins_p;
+	uint32_t                n_bins;
+	uint32_t                capacity;
+} aerospike_counter;
+
+/*
+ *******************************************************************************************************
+ * Function to free the buffered increments of a record, when it is removed
+ * from the buffer.
+ *******************************************************************************************************
+ */
+static void
+aerospike_counter_dtor(
+#if PHP_VERSION_ID < 70000
+		void
+#else
+		zval
+#endif
+		*hashtable_element)
+{
+	aerospike_counter *counter_p =
+#if PHP_VERSION_ID < 70000
+		*(aerospike_counter **) hashtable_element;
+#else
+		Z_PTR_P(hashtable_element);
+#endif
+
+	as_key_destroy(&counter_p->key);
+	if (counter_p->bins_p) {
+		efree(counter_p->bins_p);
+	}
+	efree(counter_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to copy the key of the first increment of a record into its
+ * buffered increments. A key given by its digest only is copied as such.
+ *******************************************************************************************************
+ */
+static void
+aerospike_counter_key_copy(as_key *to_p, as_key *from_p)
+{
+	as_key_value    *value_p = from_p->valuep;
+	uint8_t         *bytes_p = NULL;
+
+	if (value_p) {
+		switch (((as_val *) value_p)->type) {
+			case AS_INTEGER:
+				as_key_init_int64(to_p, from_p->ns, from_p->set, value_p->integer.value);
+				return;
+			case AS_STRING:
+				as_key_init_strp(to_p, from_p->ns, from_p->set,
+						cf_strdup(value_p->string.value), true);
+				return;
+			case AS_BYTES:
+				bytes_p = (uint8_t *) cf_malloc(value_p->bytes.size);
+				memcpy(bytes_p, value_p->bytes.value, value_p->bytes.size);
+				as_key_init_rawp(to_p, from_p->ns, from_p->set, bytes_p,
+						value_p->bytes.size, true);
+				return;
+			default:
+				break;
+		}
+	}
+
+	as_key_init_digest(to_p, from_p->ns, from_p->set, from_p->digest.value);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to register an Aerospike_object buffering increments, for its
+ * increments to be flushed at RSHUTDOWN.
+ *******************************************************************************************************
+ */
+static void
+aerospike_counters_register(Aerospike_object *aerospike_obj_p TSRMLS_DC)
+{
+	if (!AEROSPIKE_G(counters_objects_g)) {
+		ALLOC_HASHTABLE(AEROSPIKE_G(counters_objects_g));
+		zend_hash_init(AEROSPIKE_G(counters_objects_g), 4, NULL, NULL, 0);
+	}
+
+#if PHP_VERSION_ID < 70000
+	zend_hash_index_update(AEROSPIKE_G(counters_objects_g), (ulong) (uintptr_t) aerospike_obj_p,
+			&aerospike_obj_p, sizeof(Aerospike_object *), NULL);
+#else
+	zend_hash_index_update_ptr(AEROSPIKE_G(counters_objects_g),
+			(zend_ulong) (uintptr_t) aerospike_obj_p, aerospike_obj_p);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Function to write the buffered increments of an Aerospike_object, one
+ * operate() per record, and empty its buffer. The increments which failed
+ * are dropped, as they may have been applied.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ * @param error_p               Set to the error of the first record which
+ *                              failed.
+ *
+ * @return AEROSPIKE_OK if all the records were written. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_counters_flush(Aerospike_object *aerospike_obj_p, as_error *error_p TSRMLS_DC)
+{
+	aerospike_counter   *counter_p = NULL;
+	as_policy_operate   operate_policy;
+	as_operations       ops;
+	as_error            record_error;
+	uint32_t            iter = 0;
+#if PHP_VERSION_ID < 70000
+	HashPosition        pointer;
+	aerospike_counter   **counter_pp = NULL;
+#endif
+
+	as_error_init(error_p);
+	aerospike_obj_p->counters_since_ms = 0;
+
+	if ((!aerospike_obj_p->counters_p) ||
+			(0 == zend_hash_num_elements(aerospike_obj_p->counters_p))) {
+		return AEROSPIKE_OK;
+	}
+
+	if ((!aerospike_obj_p->as_ref_p) || (!aerospike_obj_p->as_ref_p->as_p)) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLUSTER, "Unable to flush the increments, not connected");
+		DEBUG_PHP_EXT_ERROR("Unable to flush the increments, not connected");
+		zend_hash_clean(aerospike_obj_p->counters_p);
+		return error_p->code;
+	}
+
+#if PHP_VERSION_ID < 70000
+	AEROSPIKE_FOREACH_HASHTABLE(aerospike_obj_p->counters_p, pointer, counter_pp) {
+		counter_p = *counter_pp;
+#else
+	ZEND_HASH_FOREACH_PTR(aerospike_obj_p->counters_p, counter_p) {
+#endif
+		as_error_init(&record_error);
+		as_operations_init(&ops, counter_p->n_bins * 2);
+		for (iter = 0; iter < counter_p->n_bins; iter++) {
+			if (counter_p->bins_p[iter].has_integer) {
+				as_operations_add_incr(&ops, counter_p->bins_p[iter].name,
+						counter_p->bins_p[iter].integer);
+			}
+			if (counter_p->bins_p[iter].has_double) {
+				as_operations_add_incr_double(&ops, counter_p->bins_p[iter].name,
+						counter_p->bins_p[iter].dbl);
+			}
+		}
+
+		as_policy_operate_init(&operate_policy);
+		set_policy_for_key(aerospike_obj_p, &counter_p->key, NULL, NULL, &operate_policy,
+				NULL, NULL, NULL, NULL, &record_error TSRMLS_CC);
+		if (AEROSPIKE_OK == record_error.code) {
+			aerospike_latency_key_operate(aerospike_obj_p->as_ref_p->as_p, &record_error,
+					&operate_policy, &counter_p->key, &ops, NULL);
+		}
+		aerospike_write_invalidate(aerospike_obj_p, &counter_p->key);
+		as_operations_destroy(&ops);
+
+		if ((AEROSPIKE_OK != record_error.code) && (AEROSPIKE_OK == error_p->code)) {
+			DEBUG_PHP_EXT_ERROR("Unable to flush the increments of a record");
+			as_error_copy(error_p, &record_error);
+		}
+#if PHP_VERSION_ID < 70000
+	}
+#else
+	} ZEND_HASH_FOREACH_END();
+#endif
+
+	zend_hash_clean(aerospike_obj_p->counters_p);
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to enable or disable the buffering of increment() by an
+ * Aerospike_object, for Aerospike::setIncrementBuffering(). Disabling it
+ * flushes the buffered increments.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ * @param enable                Whether increment() is to be buffered.
+ * @param error_p               Set to the error of the flush.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_counters_enable(Aerospike_object *aerospike_obj_p, bool enable,
+		as_error *error_p TSRMLS_DC)
+{
+	as_error_init(error_p);
+
+	if (!enable) {
+		aerospike_counters_destroy(aerospike_obj_p, error_p TSRMLS_CC);
+	} else if (!aerospike_obj_p->counters_p) {
+		ALLOC_HASHTABLE(aerospike_obj_p->counters_p);
+		zend_hash_init(aerospike_obj_p->counters_p, 32, NULL, aerospike_counter_dtor, 0);
+		aerospike_obj_p->counters_since_ms = 0;
+		aerospike_counters_register(aerospike_obj_p TSRMLS_CC);
+	}
+
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to buffer an increment of a bin of a record. The buffer is
+ * flushed once it holds aerospike.increment_buffer_max_keys records, or once
+ * its oldest increment is older than aerospike.increment_buffer_max_age_ms.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ * @param as_key_p              The key of the record.
+ * @param bin_name_p            The bin to be incremented.
+ * @param offset                The integer increment.
+ * @param double_offset         The float increment.
+ * @param is_double             true if the increment is a float one.
+ * @param error_p               Set to the error of the flush, if any.
+ *
+ * @return true if the increment was buffered, false if it is to be written
+ * right away.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_counters_add(Aerospike_object *aerospike_obj_p, as_key *as_key_p,
+		const char *bin_name_p, int64_t offset, double double_offset,
+		bool is_double, as_error *error_p TSRMLS_DC)
+{
+	char                    counters_key[COUNTERS_KEY_SIZE];
+	size_t                  ns_len = 0;
+	as_digest               *digest_p = NULL;
+	aerospike_counter       *counter_p = NULL;
+	aerospike_counter_bin   *bin_p = NULL;
+	uint32_t                iter = 0;
+	uint64_t                now_ms = 0;
+#if PHP_VERSION_ID < 70000
+	aerospike_counter       **counter_pp = NULL;
+#endif
+
+	if ((!aerospike_obj_p->counters_p) || (!as_key_p) ||
+			(strlen(bin_name_p) >= AS_BIN_NAME_MAX_SIZE) ||
+			(!(digest_p = as_key_digest(as_key_p)))) {
+		return false;
+	}
+
+	ns_len = strlen(as_key_p->ns);
+	memcpy(counters_key, as_key_p->ns, ns_len);
+	counters_key[ns_len] = '\0';
+	memcpy(counters_key + ns_len + 1, digest_p->value, AS_DIGEST_VALUE_SIZE);
+
+#if PHP_VERSION_ID < 70000
+	if (SUCCESS == zend_hash_find(aerospike_obj_p->counters_p, counters_key,
+				ns_len + 1 + AS_DIGEST_VALUE_SIZE, (void **) &counter_pp)) {
+		counter_p = *counter_pp;
+	}
+#else
+	counter_p = zend_hash_str_find_ptr(aerospike_obj_p->counters_p, counters_key,
+			ns_len + 1 + AS_DIGEST_VALUE_SIZE);
+#endif
+
+	if (!counter_p) {
+		counter_p = (aerospike_counter *) ecalloc(1, sizeof(aerospike_counter));
+		aerospike_counter_key_copy(&counter_p->key, as_key_p);
+#if PHP_VERSION_ID < 70000
+		zend_hash_update(aerospike_obj_p->counters_p, counters_key,
+				ns_len + 1 + AS_DIGEST_VALUE_SIZE, &counter_p, sizeof(aerospike_counter *), NULL);
+#else
+		zend_hash_str_update_ptr(aerospike_obj_p->counters_p, counters_key,
+				ns_len + 1 + AS_DIGEST_VALUE_SIZE, counter_p);
+#endif
+	}
+
+	for (iter = 0; iter < counter_p->n_bins; iter++) {
+		if (0 == strcmp(counter_p->bins_p[iter].name, bin_name_p)) {
+			bin_p = &counter_p->bins_p[iter];
+			break;
+		}
+	}
+	if (!bin_p) {
+		if (counter_p->n_bins == counter_p->capacity) {
+			counter_p->capacity = counter_p->capacity ? counter_p->capacity * 2 : 4;
+			counter_p->bins_p = (aerospike_counter_bin *) erealloc(counter_p->bins_p,
+					counter_p->capacity * sizeof(aerospike_counter_bin));
+		}
+		bin_p = &counter_p->bins_p[counter_p->n_bins++];
+		memset(bin_p, 0, sizeof(aerospike_counter_bin));
+		strcpy(bin_p->name, bin_name_p);
+	}
+
+	if (is_double) {
+		bin_p->has_double = true;
+		bin_p->dbl += double_offset;
+	} else {
+		bin_p->has_integer = true;
+		bin_p->integer += offset;
+	}
+
+	now_ms = cf_getms();
+	if (!aerospike_obj_p->counters_since_ms) {
+		aerospike_obj_p->counters_since_ms = now_ms;
+	}
+
+	if ((zend_hash_num_elements(aerospike_obj_p->counters_p) >=
+				(uint32_t) AEROSPIKE_G(increment_buffer_max_keys)) ||
+			(now_ms - aerospike_obj_p->counters_since_ms >=
+				(uint64_t) AEROSPIKE_G(increment_buffer_max_age_ms))) {
+		aerospike_counters_flush(aerospike_obj_p, error_p TSRMLS_CC);
+	}
+
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to flush and free the buffer of increments of an Aerospike_object,
+ * when the buffering is disabled or the object is freed.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ * @param error_p               Set to the error of the flush.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_counters_destroy(Aerospike_object *aerospike_obj_p, as_error *error_p TSRMLS_DC)
+{
+	if (!aerospike_obj_p->counters_p) {
+		return;
+	}
+
+	aerospike_counters_flush(aerospike_obj_p, error_p TSRMLS_CC);
+	zend_hash_destroy(aerospike_obj_p->counters_p);
+	FREE_HASHTABLE(aerospike_obj_p->counters_p);
+	aerospike_obj_p->counters_p = NULL;
+
+	if (AEROSPIKE_G(counters_objects_g)) {
+		zend_hash_index_del(AEROSPIKE_G(counters_objects_g),
+				(uintptr_t) aerospike_obj_p);
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to flush the buffered increments of all the Aerospike_objects at
+ * RSHUTDOWN. The objects still buffering are freed afterwards, with nothing
+ * left to flush.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_counters_request_shutdown(TSRMLS_D)
+{
+	Aerospike_object    *aerospike_obj_p = NULL;
+	as_error            error;
+#if PHP_VERSION_ID < 70000
+	HashPosition        pointer;
+	Aerospike_object    **aerospike_obj_pp = NULL;
+#endif
+
+	if (!AEROSPIKE_G(counters_objects_g)) {
+		return;
+	}
+
+#if PHP_VERSION_ID < 70000
+	AEROSPIKE_FOREACH_HASHTABLE(AEROSPIKE_G(counters_objects_g), pointer, aerospike_obj_pp) {
+		aerospike_obj_p = *aerospike_obj_pp;
+#else
+	ZEND_HASH_FOREACH_PTR(AEROSPIKE_G(counters_objects_g), aerospike_obj_p) {
+#endif
+		if (AEROSPIKE_OK != aerospike_counters_flush(aerospike_obj_p, &error TSRMLS_CC)) {
+			DEBUG_PHP_EXT_ERROR("Unable to flush the increments at request shutdown");
+		}
+#if PHP_VERSION_ID < 70000
+	}
+#else
+	} ZEND_HASH_FOREACH_END();
+#endif
+
+	zend_hash_destroy(AEROSPIKE_G(counters_objects_g));
+	FREE_HASHTABLE(AEROSPIKE_G(counters_objects_g));
+	AEROSPIKE_G(counters_objects_g) = NULL;
+}
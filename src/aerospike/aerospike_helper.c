@@ -60,10 +60,10 @@ uint32_t              is_callback_registered;
 
 /*
  *******************************************************************************************************
- * Callback for C client's logger.
- * This function shall be invoked by:
- * 1. C client's logger statements.
- * 2. PHP client's logger statements.
+ * Callback for PHP client's logger statements.
+ * The userland log handler is not invoked from here, the record is queued
+ * along with the C client's ones and the handler invoked when the queue is
+ * drained by aerospike_helper_set_error().
  *
  * @param level             The as_log_level to be used by the callback.
  * @param func              The function name generating the log.
@@ -90,7 +90,7 @@ aerospike_helper_log_callback(as_log_level level, const char * func TSRMLS_DC, c
 	}
 
 	if (is_callback_registered) {
-		INVOKE_CALLBACK_FUNCTION(level, func, file, line);
+		aerospike_log_queue_push(level, func, file, line);
 	}
 
 	return true;
@@ -113,7 +113,9 @@ aerospike_helper_set_error(zend_class_entry *ce_p, zval *object_p TSRMLS_DC)
 	aerospike_global_error error_t = AEROSPIKE_G(error_g);
 	DECLARE_ZVAL(err_code_p);
 	DECLARE_ZVAL(err_msg_p);
-	
+
+	aerospike_log_queue_drain(TSRMLS_C);
+
 #if defined(PHP_VERSION_ID) && (PHP_VERSION_ID < 70000)
 	MAKE_STD_ZVAL(err_code_p);
 	MAKE_STD_ZVAL(err_msg_p);
@@ -690,6 +692,7 @@ aerospike_helper_record_stream_callback(const as_val* p_val, void* udata)
 		pthread_rwlock_unlock(&AEROSPIKE_G(query_cb_mutex));
 		return true;
 	}
+	aerospike_memory_sample(TSRMLS_C);
 
 	/*
 	 * Call the userland function with the array representing the record.
@@ -762,6 +765,110 @@ exit:
 	return true;
 }
 
+/*
+ *******************************************************************************************************
+ * Callback for as_query_foreach function in case of Aerospike::aggregateStream().
+ * It translates each as_val of the stream into an equivalent zval as it
+ * arrives, and calls the user registered callback passing it as an argument.
+ * No value is kept once the user callback returns, and the stream threads
+ * wait on query_cb_mutex while it runs, so at most one value is held in PHP.
+ *
+ * @param val_p             The current as_val to be passed on to the user
+ *                          callback as an argument.
+ * @param udata_p           The userland_callback instance filled with fci and
+ *                          fcc.
+ * @return false if the user callback returned false; else true.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_helper_aggregate_stream_callback(const as_val* val_p, void* udata_p)
+{
+	as_error                error;
+	DECLARE_ZVAL(values);
+	DECLARE_ZVAL(retval);
+	DECLARE_ZVAL_P(value_pp);
+#if defined(PHP_VERSION_ID) && (PHP_VERSION_ID < 70000)
+	zval                    **args[1];
+#else
+	zval                    args[1];
+#endif
+	bool                    do_continue = true;
+	foreach_callback_udata  aggregate_callback_udata;
+	userland_callback       *user_func_p = (userland_callback *) udata_p;
+
+	TSRMLS_FETCH_FROM_CTX(user_func_p->ts);
+
+	if (!val_p) {
+		DEBUG_PHP_EXT_INFO("callback is null; stream complete.");
+		return true;
+	}
+
+	as_error_init(&error);
+	pthread_rwlock_wrlock(&AEROSPIKE_G(query_cb_mutex));
+#if defined(PHP_VERSION_ID) && (PHP_VERSION_ID < 70000)
+	MAKE_STD_ZVAL(values);
+	array_init(values);
+	aggregate_callback_udata.udata_p = values;
+#else
+	array_init(&values);
+	aggregate_callback_udata.udata_p = &values;
+#endif
+	aggregate_callback_udata.error_p = &error;
+	aggregate_callback_udata.obj = user_func_p->obj;
+
+	if ((!AS_AGGREGATE_GET(user_func_p->obj, NULL, val_p, &aggregate_callback_udata)) ||
+#if defined(PHP_VERSION_ID) && (PHP_VERSION_ID < 70000)
+			(SUCCESS != AEROSPIKE_ZEND_HASH_INDEX_FIND(Z_ARRVAL_P(values), 0, &value_pp))
+#else
+			(NULL == (value_pp = AEROSPIKE_ZEND_HASH_INDEX_FIND(Z_ARRVAL(values), 0, &value_pp)))
+#endif
+			) {
+		DEBUG_PHP_EXT_WARNING("stream callback failed to transform the as_val to a zval.");
+		zval_ptr_dtor(&values);
+		pthread_rwlock_unlock(&AEROSPIKE_G(query_cb_mutex));
+		return true;
+	}
+
+	/*
+	 * Call the userland function with the value of the stream.
+	 */
+#if defined(PHP_VERSION_ID) && (PHP_VERSION_ID < 70000)
+	args[0] = value_pp;
+	user_func_p->fci.retval_ptr_ptr = &retval;
+#else
+	ZVAL_COPY_VALUE(&args[0], value_pp);
+	user_func_p->fci.retval = &retval;
+#endif
+	user_func_p->fci.param_count = 1;
+	user_func_p->fci.params = args;
+
+	if (zend_call_function(&user_func_p->fci, &user_func_p->fcc TSRMLS_CC) == FAILURE) {
+		DEBUG_PHP_EXT_WARNING("stream callback could not invoke the userland function.");
+		php_error_docref(NULL TSRMLS_CC, E_WARNING, "stream callback could not invoke userland function.");
+		zval_ptr_dtor(&values);
+		pthread_rwlock_unlock(&AEROSPIKE_G(query_cb_mutex));
+		return true;
+	}
+	zval_ptr_dtor(&values);
+
+#if defined(PHP_VERSION_ID) && (PHP_VERSION_ID < 70000)
+	if (retval) {
+		if ((Z_TYPE_P(retval) == IS_BOOL) && !Z_BVAL_P(retval)) {
+			do_continue = false;
+		}
+		zval_ptr_dtor(&retval);
+	}
+#else
+	if (Z_TYPE_P(&retval) == IS_FALSE) {
+		do_continue = false;
+	}
+	zval_ptr_dtor(&retval);
+#endif
+
+	pthread_rwlock_unlock(&AEROSPIKE_G(query_cb_mutex));
+	return do_continue;
+}
+
 extern void
 aerospike_helper_check_and_configure_shm(as_config *config_p TSRMLS_DC) {
 	if (SHM_USE_PHP_INI) {
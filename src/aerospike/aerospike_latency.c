@@ -0,0 +1,816 @@
+/*
+ *
+ * Copyright (C) 2014-2016 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#include "php.h"
+
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_batch.h"
+#include "aerospike/aerospike_key.h"
+#include "aerospike/aerospike_query.h"
+#include "aerospike/aerospike_scan.h"
+#include "aerospike/as_cluster.h"
+#include "aerospike/as_error.h"
+#include "aerospike/as_policy.h"
+#include "citrusleaf/cf_clock.h"
+#include "aerospike_common.h"
+#include "aerospike_policy.h"
+
+/*
+ *******************************************************************************************************
+ * Per process table of the latencies observed against each node.
+ * Slots are claimed once per node name and never released, readers and
+ * writers only use atomic operations on it.
+ *******************************************************************************************************
+ */
+#define AEROSPIKE_LATENCY_SLOT_FREE 0
+#define AEROSPIKE_LATENCY_SLOT_CLAIMED 1
+#define AEROSPIKE_LATENCY_SLOT_READY 2
+
+static aerospike_node_latency node_latency_table[AEROSPIKE_LATENCY_MAX_NODES];
+
+/*
+ *******************************************************************************************************
+ * Per process totals of each command type, across all nodes. Commands which
+ * span several nodes (batch, scan and query) are only tracked here.
+ *******************************************************************************************************
+ */
+static aerospike_command_stats command_totals[AEROSPIKE_COMMAND_MAX];
+
+static const char *command_names[AEROSPIKE_COMMAND_MAX] = {
+	"get", "put", "operate", "batch", "scan", "query", "udf"
+};
+
+/*
+ *******************************************************************************************************
+ * Function to map a latency in microseconds to its histogram bucket.
+ * Buckets are log2 ranges, each split into AEROSPIKE_LATENCY_SUB_BUCKETS
+ * linear sub-buckets.
+ *
+ * @param elapsed_us            The latency in microseconds.
+ *
+ * @return the bucket index.
+ *******************************************************************************************************
+ */
+static uint32_t
+latency_bucket_index(uint64_t elapsed_us)
+{
+	uint32_t    power = 0;
+	uint32_t    index = 0;
+
+	if (elapsed_us < AEROSPIKE_LATENCY_SUB_BUCKETS) {
+		return (uint32_t) elapsed_us;
+	}
+
+	power = 63 - __builtin_clzll(elapsed_us);
+	index = (power - 1) * AEROSPIKE_LATENCY_SUB_BUCKETS +
+		(uint32_t) ((elapsed_us >> (power - 2)) & (AEROSPIKE_LATENCY_SUB_BUCKETS - 1));
+
+	return (index < AEROSPIKE_LATENCY_BUCKETS) ? index : AEROSPIKE_LATENCY_BUCKETS - 1;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to get the upper bound in microseconds of a histogram bucket.
+ *
+ * @param index                 The bucket index.
+ *
+ * @return the exclusive upper bound of the bucket.
+ *******************************************************************************************************
+ */
+extern uint64_t
+aerospike_latency_bucket_upper_us(uint32_t index)
+{
+	uint32_t    next = index + 1;
+
+	if (next < AEROSPIKE_LATENCY_SUB_BUCKETS) {
+		return next;
+	}
+
+	return ((uint64_t) (AEROSPIKE_LATENCY_SUB_BUCKETS + (next % AEROSPIKE_LATENCY_SUB_BUCKETS)))
+		<< (next / AEROSPIKE_LATENCY_SUB_BUCKETS - 1);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to add a sample to a latency histogram.
+ *
+ * @param histogram_p           The histogram to be updated.
+ * @param elapsed_us            The latency in microseconds.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_latency_histogram_add(aerospike_latency_histogram *histogram_p, uint64_t elapsed_us)
+{
+	uint64_t    max_us = histogram_p->max_us;
+
+	__sync_fetch_and_add(&histogram_p->buckets[latency_bucket_index(elapsed_us)], 1);
+	__sync_fetch_and_add(&histogram_p->count, 1);
+	__sync_fetch_and_add(&histogram_p->sum_us, elapsed_us);
+
+	while (elapsed_us > max_us) {
+		if (__sync_bool_compare_and_swap(&histogram_p->max_us, max_us, elapsed_us)) {
+			break;
+		}
+		max_us = histogram_p->max_us;
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to compute a percentile from a latency histogram.
+ *
+ * @param histogram_p           The histogram to be read.
+ * @param percentile            The percentile, between 0 and 100.
+ *
+ * @return the upper bound in microseconds of the bucket holding the
+ * percentile. 0 if the histogram is empty.
+ *******************************************************************************************************
+ */
+extern uint64_t
+aerospike_latency_histogram_percentile(aerospike_latency_histogram *histogram_p, double percentile)
+{
+	uint64_t    count = histogram_p->count;
+	uint64_t    threshold = 0;
+	uint64_t    seen = 0;
+	uint32_t    index = 0;
+
+	if (count == 0) {
+		return 0;
+	}
+
+	threshold = (uint64_t) ((count * percentile) / 100.0);
+	if (threshold == 0) {
+		threshold = 1;
+	}
+
+	for (index = 0; index < AEROSPIKE_LATENCY_BUCKETS; index++) {
+		seen += histogram_p->buckets[index];
+		if (seen >= threshold) {
+			return aerospike_latency_bucket_upper_us(index);
+		}
+	}
+
+	return histogram_p->max_us;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to find the latency slot of a node, claiming a free one the first
+ * time the node is seen.
+ *
+ * @param node_name_p           The name of the node.
+ *
+ * @return the slot of the node. NULL if the node name is empty or the table
+ * is full.
+ *******************************************************************************************************
+ */
+extern aerospike_node_latency*
+aerospike_latency_node(const char *node_name_p)
+{
+	uint32_t    iter = 0;
+
+	if ((!node_name_p) || (!*node_name_p)) {
+		return NULL;
+	}
+
+	for (iter = 0; iter < AEROSPIKE_LATENCY_MAX_NODES; iter++) {
+		aerospike_node_latency *slot_p = &node_latency_table[iter];
+
+		if (slot_p->state == AEROSPIKE_LATENCY_SLOT_READY) {
+			if (!strncmp(slot_p->name, node_name_p, AS_NODE_NAME_SIZE)) {
+				return slot_p;
+			}
+			continue;
+		}
+
+		if (__sync_bool_compare_and_swap(&slot_p->state, AEROSPIKE_LATENCY_SLOT_FREE,
+					AEROSPIKE_LATENCY_SLOT_CLAIMED)) {
+			strncpy(slot_p->name, node_name_p, AS_NODE_NAME_SIZE - 1);
+			slot_p->name[AS_NODE_NAME_SIZE - 1] = '\0';
+			__sync_synchronize();
+			slot_p->state = AEROSPIKE_LATENCY_SLOT_READY;
+			return slot_p;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to get the name of the master node of a key from the client's
+ * partition map.
+ *
+ * @param as_object_p           The C client's aerospike object.
+ * @param as_key_p              The key to be resolved.
+ * @param node_name_p           The buffer of AS_NODE_NAME_SIZE bytes to be
+ *                              populated with the node name.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_latency_key_node(aerospike *as_object_p, const as_key *as_key_p, char *node_name_p)
+{
+	as_digest   *digest_p = NULL;
+	as_node     *node_p = NULL;
+
+	node_name_p[0] = '\0';
+
+	if ((!as_object_p) || (!as_object_p->cluster) || (!as_key_p)) {
+		return;
+	}
+
+	if (!(digest_p = as_key_digest((as_key *) as_key_p))) {
+		return;
+	}
+
+	if ((node_p = as_node_get(as_object_p->cluster, as_key_p->ns, digest_p->value,
+					false, AS_POLICY_REPLICA_MASTER))) {
+		strncpy(node_name_p, node_p->name, AS_NODE_NAME_SIZE - 1);
+		node_name_p[AS_NODE_NAME_SIZE - 1] = '\0';
+		as_node_release(node_p);
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to get the name of a command type, as used by Aerospike::getStats().
+ *
+ * @param command               The command type.
+ *
+ * @return the name of the command type.
+ *******************************************************************************************************
+ */
+extern const char*
+aerospike_latency_command_name(aerospike_command command)
+{
+	return command_names[command];
+}
+
+/*
+ *******************************************************************************************************
+ * Function to get the process wide stats of a command type.
+ *
+ * @param command               The command type.
+ *
+ * @return the stats of the command type across all nodes.
+ *******************************************************************************************************
+ */
+extern aerospike_command_stats*
+aerospike_latency_command_totals(aerospike_command command)
+{
+	return &command_totals[command];
+}
+
+/*
+ *******************************************************************************************************
+ * Function to add the outcome of a command to its stats.
+ *******************************************************************************************************
+ */
+static void
+latency_command_add(aerospike_command_stats *stats_p, uint64_t elapsed_us,
+		as_status status)
+{
+	aerospike_latency_histogram_add(&stats_p->latency, elapsed_us);
+
+	if (status == AEROSPIKE_ERR_TIMEOUT) {
+		__sync_fetch_and_add(&stats_p->timeouts, 1);
+	} else if ((status != AEROSPIKE_OK) && (status != AEROSPIKE_ERR_RECORD_NOT_FOUND)) {
+		__sync_fetch_and_add(&stats_p->errors, 1);
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to record a command that was started at start_us.
+ *
+ * @param node_p                The latency slot of the node that served the
+ *                              command. NULL if unknown or several nodes.
+ * @param command               The command type.
+ * @param start_us              The cf_getus() at which the command started.
+ * @param status                The status returned by the C client.
+ *
+ * @return the latency of the command in microseconds.
+ *******************************************************************************************************
+ */
+extern uint64_t
+aerospike_latency_record(aerospike_node_latency *node_p,
+		aerospike_command command, uint64_t start_us, as_status status)
+{
+	uint64_t    elapsed_us = cf_getus() - start_us;
+
+	latency_command_add(&command_totals[command], elapsed_us, status);
+	if (node_p) {
+		latency_command_add(&node_p->commands[command], elapsed_us, status);
+	}
+
+	return elapsed_us;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to record a single record command that was started at start_us,
+ * against the master node of its key, and in the slow log if it was slow.
+ *
+ * @param as_object_p           The C client's aerospike object.
+ * @param as_key_p              The key of the command.
+ * @param record_p              The record sent or received, else NULL.
+ * @param command               The command type.
+ * @param start_us              The cf_getus() at which the command started.
+ * @param status                The status returned by the C client.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_latency_record_key(aerospike *as_object_p, const as_key *as_key_p,
+		const as_record *record_p, aerospike_command command,
+		uint64_t start_us, as_status status)
+{
+	uint64_t    elapsed_us = cf_getus() - start_us;
+	char        node_name[AS_NODE_NAME_SIZE];
+	aerospike_node_latency  *node_p = NULL;
+
+	latency_command_add(&command_totals[command], elapsed_us, status);
+
+	aerospike_latency_key_node(as_object_p, as_key_p, node_name);
+	if ((node_p = aerospike_latency_node(node_name))) {
+		latency_command_add(&node_p->commands[command], elapsed_us, status);
+	}
+
+	aerospike_slowlog_record(command, as_key_p->ns, as_key_p->set, as_key_p,
+			node_name, record_p, elapsed_us, status);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to populate a PHP array with the stats of a command type.
+ *******************************************************************************************************
+ */
+static void
+latency_command_stats_to_zval(aerospike_command_stats *stats_p, zval *stats_zval_p)
+{
+	aerospike_latency_histogram *histogram_p = &stats_p->latency;
+
+	add_assoc_long(stats_zval_p, "count", histogram_p->count);
+	add_assoc_long(stats_zval_p, "errors", stats_p->errors);
+	add_assoc_long(stats_zval_p, "timeouts", stats_p->timeouts);
+	add_assoc_long(stats_zval_p, "avg_us",
+			histogram_p->count ? histogram_p->sum_us / histogram_p->count : 0);
+	add_assoc_long(stats_zval_p, "max_us", histogram_p->max_us);
+	add_assoc_long(stats_zval_p, "p50_us", aerospike_latency_histogram_percentile(histogram_p, 50));
+	add_assoc_long(stats_zval_p, "p90_us", aerospike_latency_histogram_percentile(histogram_p, 90));
+	add_assoc_long(stats_zval_p, "p99_us", aerospike_latency_histogram_percentile(histogram_p, 99));
+	add_assoc_long(stats_zval_p, "p999_us", aerospike_latency_histogram_percentile(histogram_p, 99.9));
+}
+
+/*
+ *******************************************************************************************************
+ * Function to populate a PHP array keyed by command type, skipping the
+ * command types which were never issued.
+ *******************************************************************************************************
+ */
+static void
+latency_commands_to_zval(aerospike_command_stats *commands_p, zval *commands_zval_p)
+{
+	uint32_t    command = 0;
+
+	for (command = 0; command < AEROSPIKE_COMMAND_MAX; command++) {
+#if PHP_VERSION_ID < 70000
+		zval    *stats_zval_p = NULL;
+#else
+		zval    stats_zval;
+		zval    *stats_zval_p = &stats_zval;
+#endif
+
+		if (commands_p[command].latency.count == 0) {
+			continue;
+		}
+
+#if PHP_VERSION_ID < 70000
+		MAKE_STD_ZVAL(stats_zval_p);
+#endif
+		array_init(stats_zval_p);
+		latency_command_stats_to_zval(&commands_p[command], stats_zval_p);
+		add_assoc_zval(commands_zval_p, command_names[command], stats_zval_p);
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to populate a PHP array with the command stats of this process,
+ * for Aerospike::getStats().
+ *
+ * @param stats_p               The initialized PHP array to be populated with
+ *                              the "commands" totals and the per node "nodes".
+ *******************************************************************************************************
+ */
+extern void
+aerospike_latency_stats(zval *stats_p TSRMLS_DC)
+{
+	uint32_t    iter = 0;
+#if PHP_VERSION_ID < 70000
+	zval        *commands_p = NULL;
+	zval        *nodes_p = NULL;
+
+	MAKE_STD_ZVAL(commands_p);
+	MAKE_STD_ZVAL(nodes_p);
+	array_init(commands_p);
+	array_init(nodes_p);
+#else
+	zval        commands;
+	zval        nodes;
+	zval        *commands_p = &commands;
+	zval        *nodes_p = &nodes;
+
+	array_init(commands_p);
+	array_init(nodes_p);
+#endif
+
+	latency_commands_to_zval(command_totals, commands_p);
+
+	for (iter = 0; iter < AEROSPIKE_LATENCY_MAX_NODES; iter++) {
+		aerospike_node_latency *slot_p = &node_latency_table[iter];
+#if PHP_VERSION_ID < 70000
+		zval    *node_zval_p = NULL;
+		zval    *node_commands_p = NULL;
+#else
+		zval    node_zval;
+		zval    node_commands;
+		zval    *node_zval_p = &node_zval;
+		zval    *node_commands_p = &node_commands;
+#endif
+
+		if (slot_p->state != AEROSPIKE_LATENCY_SLOT_READY) {
+			continue;
+		}
+
+#if PHP_VERSION_ID < 70000
+		MAKE_STD_ZVAL(node_zval_p);
+		MAKE_STD_ZVAL(node_commands_p);
+#endif
+		array_init(node_zval_p);
+		array_init(node_commands_p);
+		latency_commands_to_zval(slot_p->commands, node_commands_p);
+		add_assoc_long(node_zval_p, "hedged", slot_p->hedged);
+		add_assoc_zval(node_zval_p, "commands", node_commands_p);
+		add_assoc_zval(nodes_p, slot_p->name, node_zval_p);
+	}
+
+	add_assoc_zval(stats_p, "commands", commands_p);
+	add_assoc_zval(stats_p, "nodes", nodes_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to issue a single read within the C client.
+ *******************************************************************************************************
+ */
+static as_status
+latency_issue_read(aerospike *as_object_p, as_error *error_p,
+		as_policy_read *read_policy_p, const as_key *as_key_p,
+		const char **bins_p, bool exists_only, as_record **record_pp)
+{
+	if (exists_only) {
+		return aerospike_key_exists(as_object_p, error_p, read_policy_p,
+				as_key_p, record_pp);
+	} else if (bins_p) {
+		return aerospike_key_select(as_object_p, error_p, read_policy_p,
+				as_key_p, bins_p, record_pp);
+	}
+	return aerospike_key_get(as_object_p, error_p, read_policy_p,
+			as_key_p, record_pp);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to perform a hedged read of a record.
+ * The read is first sent to the master with the hedge delay as timeout. If
+ * the master did not answer in time, the read is sent again with
+ * AS_POLICY_REPLICA_ANY for what is left of the read timeout, so that a slow
+ * master costs the hedge delay instead of the whole read timeout. The C client
+ * alternates AS_POLICY_REPLICA_ANY reads between the master and a replica, so
+ * the second attempt is not guaranteed to avoid the master.
+ * The latency observed against the master is tracked per node, and is used
+ * to derive the hedge delay when READ_HEDGE_DELAY_ADAPTIVE is requested.
+ * A hedged read is recorded as a single get command with its end to end
+ * latency, only in the process wide totals, so that the attempt cut off at
+ * the hedge delay is not part of the latencies of the master.
+ *
+ * @param as_object_p           The C client's aerospike object.
+ * @param error_p               The as_error to be populated by the function
+ *                              with the encountered error if any.
+ * @param read_policy_p         The as_policy_read of the read.
+ * @param as_key_p              The key of the record.
+ * @param bins_p                The NULL terminated bins to select. NULL for
+ *                              all bins.
+ * @param exists_only           true to read the metadata only.
+ * @param record_pp             The record to be populated.
+ * @param hedge_delay           The hedge delay in milliseconds. 0 disables
+ *                              hedging, READ_HEDGE_DELAY_ADAPTIVE uses the
+ *                              p95 of the master node.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_latency_hedged_read(aerospike *as_object_p, as_error *error_p,
+		as_policy_read *read_policy_p, const as_key *as_key_p,
+		const char **bins_p, bool exists_only, as_record **record_pp,
+		int32_t hedge_delay TSRMLS_DC)
+{
+	as_status               status = AEROSPIKE_OK;
+	as_policy_read          hedge_policy;
+	char                    node_name[AS_NODE_NAME_SIZE];
+	aerospike_node_latency  *node_p = NULL;
+	aerospike_latency_histogram *master_p = NULL;
+	uint32_t                delay_ms = 0;
+	uint64_t                start_us = 0;
+	uint64_t                elapsed_us = 0;
+
+	aerospike_latency_key_node(as_object_p, as_key_p, node_name);
+	if ((node_p = aerospike_latency_node(node_name))) {
+		master_p = &node_p->commands[AEROSPIKE_COMMAND_GET].latency;
+	}
+
+	if (hedge_delay > 0) {
+		delay_ms = (uint32_t) hedge_delay;
+	} else if ((hedge_delay == READ_HEDGE_DELAY_ADAPTIVE) && master_p &&
+			(master_p->count >= AEROSPIKE_LATENCY_MIN_SAMPLES)) {
+		delay_ms = (uint32_t) ((aerospike_latency_histogram_percentile(master_p, 95) + 999) / 1000);
+	}
+
+	if ((delay_ms == 0) || (read_policy_p->replica != AS_POLICY_REPLICA_MASTER) ||
+			((read_policy_p->timeout) && (delay_ms >= read_policy_p->timeout))) {
+		start_us = cf_getus();
+		status = latency_issue_read(as_object_p, error_p, read_policy_p,
+				as_key_p, bins_p, exists_only, record_pp);
+		if (read_policy_p->replica != AS_POLICY_REPLICA_MASTER) {
+			node_p = NULL;
+		}
+		elapsed_us = aerospike_latency_record(node_p, AEROSPIKE_COMMAND_GET,
+				start_us, status);
+		aerospike_slowlog_record(AEROSPIKE_COMMAND_GET, as_key_p->ns, as_key_p->set,
+				as_key_p, node_p ? node_p->name : NULL,
+				(status == AEROSPIKE_OK) ? *record_pp : NULL, elapsed_us, status);
+		return status;
+	}
+
+	as_policy_read_copy(read_policy_p, &hedge_policy);
+	hedge_policy.timeout = delay_ms;
+
+	start_us = cf_getus();
+	status = latency_issue_read(as_object_p, error_p, &hedge_policy,
+			as_key_p, bins_p, exists_only, record_pp);
+	if (status != AEROSPIKE_ERR_TIMEOUT) {
+		elapsed_us = aerospike_latency_record(node_p, AEROSPIKE_COMMAND_GET,
+				start_us, status);
+		aerospike_slowlog_record(AEROSPIKE_COMMAND_GET, as_key_p->ns, as_key_p->set,
+				as_key_p, node_name, (status == AEROSPIKE_OK) ? *record_pp : NULL,
+				elapsed_us, status);
+		return status;
+	}
+
+	DEBUG_PHP_EXT_DEBUG("Read not answered within %u ms, hedging to another replica", delay_ms);
+	if (node_p) {
+		__sync_fetch_and_add(&node_p->hedged, 1);
+	}
+
+	as_error_reset(error_p);
+	hedge_policy.timeout = (read_policy_p->timeout) ? read_policy_p->timeout - delay_ms : 0;
+	hedge_policy.replica = AS_POLICY_REPLICA_ANY;
+	status = latency_issue_read(as_object_p, error_p, &hedge_policy,
+			as_key_p, bins_p, exists_only, record_pp);
+	elapsed_us = aerospike_latency_record(NULL, AEROSPIKE_COMMAND_GET,
+			start_us, status);
+	aerospike_slowlog_record(AEROSPIKE_COMMAND_GET, as_key_p->ns, as_key_p->set,
+			as_key_p, NULL, (status == AEROSPIKE_OK) ? *record_pp : NULL,
+			elapsed_us, status);
+
+	return status;
+}
+
+/*
+ *******************************************************************************************************
+ * Wrappers of the C client commands recording the latency of each command.
+ * They take the same arguments as the C client function they wrap.
+ * The batch, scan and query wrappers also profile the memory used by their
+ * callbacks, when aerospike.memory_profiling is on.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_latency_key_get(aerospike *as_object_p, as_error *error_p,
+		const as_policy_read *policy_p, const as_key *as_key_p,
+		as_record **record_pp)
+{
+	uint64_t    start_us = cf_getus();
+	as_status   status = aerospike_key_get(as_object_p, error_p, policy_p,
+			as_key_p, record_pp);
+
+	aerospike_latency_record_key(as_object_p, as_key_p,
+			(status == AEROSPIKE_OK) ? *record_pp : NULL, AEROSPIKE_COMMAND_GET,
+			start_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_key_put(aerospike *as_object_p, as_error *error_p,
+		const as_policy_write *policy_p, const as_key *as_key_p,
+		as_record *record_p)
+{
+	uint64_t    start_us = cf_getus();
+	as_status   status = aerospike_key_put(as_object_p, error_p, policy_p,
+			as_key_p, record_p);
+
+	aerospike_latency_record_key(as_object_p, as_key_p, record_p,
+			AEROSPIKE_COMMAND_PUT, start_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_key_remove(aerospike *as_object_p, as_error *error_p,
+		const as_policy_remove *policy_p, const as_key *as_key_p)
+{
+	uint64_t    start_us = cf_getus();
+	as_status   status = aerospike_key_remove(as_object_p, error_p, policy_p,
+			as_key_p);
+
+	aerospike_latency_record_key(as_object_p, as_key_p, NULL,
+			AEROSPIKE_COMMAND_PUT, start_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_key_operate(aerospike *as_object_p, as_error *error_p,
+		const as_policy_operate *policy_p, const as_key *as_key_p,
+		const as_operations *operations_p, as_record **record_pp)
+{
+	uint64_t    start_us = cf_getus();
+	as_status   status = aerospike_key_operate(as_object_p, error_p, policy_p,
+			as_key_p, operations_p, record_pp);
+
+	aerospike_latency_record_key(as_object_p, as_key_p,
+			((status == AEROSPIKE_OK) && record_pp) ? *record_pp : NULL,
+			AEROSPIKE_COMMAND_OPERATE, start_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_key_apply(aerospike *as_object_p, as_error *error_p,
+		const as_policy_apply *policy_p, const as_key *as_key_p,
+		const char *module_p, const char *function_p, as_list *arglist_p,
+		as_val **result_pp)
+{
+	uint64_t    start_us = cf_getus();
+	as_status   status = aerospike_key_apply(as_object_p, error_p, policy_p,
+			as_key_p, module_p, function_p, arglist_p, result_pp);
+
+	aerospike_latency_record_key(as_object_p, as_key_p, NULL,
+			AEROSPIKE_COMMAND_UDF, start_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_batch_read(aerospike *as_object_p, as_error *error_p,
+		const as_policy_batch *policy_p, as_batch_read_records *records_p)
+{
+	bool        profiled = aerospike_memory_begin(AEROSPIKE_COMMAND_BATCH);
+	uint64_t    start_us = cf_getus();
+	uint64_t    elapsed_us = 0;
+	as_status   status = aerospike_batch_read(as_object_p, error_p, policy_p,
+			records_p);
+
+	aerospike_memory_end(profiled);
+	elapsed_us = aerospike_latency_record(NULL, AEROSPIKE_COMMAND_BATCH,
+			start_us, status);
+	aerospike_slowlog_record(AEROSPIKE_COMMAND_BATCH, NULL, NULL, NULL, NULL, NULL,
+			elapsed_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_batch_exists(aerospike *as_object_p, as_error *error_p,
+		const as_policy_batch *policy_p, const as_batch *batch_p,
+		aerospike_batch_read_callback callback, void *udata_p)
+{
+	bool        profiled = aerospike_memory_begin(AEROSPIKE_COMMAND_BATCH);
+	uint64_t    start_us = cf_getus();
+	uint64_t    elapsed_us = 0;
+	as_status   status = aerospike_batch_exists(as_object_p, error_p, policy_p,
+			batch_p, callback, udata_p);
+
+	aerospike_memory_end(profiled);
+	elapsed_us = aerospike_latency_record(NULL, AEROSPIKE_COMMAND_BATCH,
+			start_us, status);
+	aerospike_slowlog_record(AEROSPIKE_COMMAND_BATCH, NULL, NULL, NULL, NULL, NULL,
+			elapsed_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_batch_get(aerospike *as_object_p, as_error *error_p,
+		const as_policy_batch *policy_p, const as_batch *batch_p,
+		aerospike_batch_read_callback callback, void *udata_p)
+{
+	bool        profiled = aerospike_memory_begin(AEROSPIKE_COMMAND_BATCH);
+	uint64_t    start_us = cf_getus();
+	uint64_t    elapsed_us = 0;
+	as_status   status = aerospike_batch_get(as_object_p, error_p, policy_p,
+			batch_p, callback, udata_p);
+
+	aerospike_memory_end(profiled);
+	elapsed_us = aerospike_latency_record(NULL, AEROSPIKE_COMMAND_BATCH,
+			start_us, status);
+	aerospike_slowlog_record(AEROSPIKE_COMMAND_BATCH, NULL, NULL, NULL, NULL, NULL,
+			elapsed_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_batch_get_bins(aerospike *as_object_p, as_error *error_p,
+		const as_policy_batch *policy_p, const as_batch *batch_p,
+		const char **bins_p, uint32_t n_bins,
+		aerospike_batch_read_callback callback, void *udata_p)
+{
+	bool        profiled = aerospike_memory_begin(AEROSPIKE_COMMAND_BATCH);
+	uint64_t    start_us = cf_getus();
+	uint64_t    elapsed_us = 0;
+	as_status   status = aerospike_batch_get_bins(as_object_p, error_p, policy_p,
+			batch_p, bins_p, n_bins, callback, udata_p);
+
+	aerospike_memory_end(profiled);
+	elapsed_us = aerospike_latency_record(NULL, AEROSPIKE_COMMAND_BATCH,
+			start_us, status);
+	aerospike_slowlog_record(AEROSPIKE_COMMAND_BATCH, NULL, NULL, NULL, NULL, NULL,
+			elapsed_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_scan_foreach(aerospike *as_object_p, as_error *error_p,
+		const as_policy_scan *policy_p, const as_scan *scan_p,
+		aerospike_scan_foreach_callback callback, void *udata_p)
+{
+	bool        profiled = aerospike_memory_begin(AEROSPIKE_COMMAND_SCAN);
+	uint64_t    start_us = cf_getus();
+	uint64_t    elapsed_us = 0;
+	as_status   status = aerospike_scan_foreach(as_object_p, error_p, policy_p,
+			scan_p, callback, udata_p);
+
+	aerospike_memory_end(profiled);
+	elapsed_us = aerospike_latency_record(NULL, AEROSPIKE_COMMAND_SCAN,
+			start_us, status);
+	aerospike_slowlog_record(AEROSPIKE_COMMAND_SCAN, scan_p->ns, scan_p->set,
+			NULL, NULL, NULL, elapsed_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_scan_node(aerospike *as_object_p, as_error *error_p,
+		const as_policy_scan *policy_p, const as_scan *scan_p, const char *node_name_p,
+		aerospike_scan_foreach_callback callback, void *udata_p)
+{
+	bool        profiled = aerospike_memory_begin(AEROSPIKE_COMMAND_SCAN);
+	uint64_t    start_us = cf_getus();
+	uint64_t    elapsed_us = 0;
+	as_status   status = aerospike_scan_node(as_object_p, error_p, policy_p,
+			scan_p, node_name_p, callback, udata_p);
+
+	aerospike_memory_end(profiled);
+	elapsed_us = aerospike_latency_record(NULL, AEROSPIKE_COMMAND_SCAN,
+			start_us, status);
+	aerospike_slowlog_record(AEROSPIKE_COMMAND_SCAN, scan_p->ns, scan_p->set,
+			NULL, node_name_p, NULL, elapsed_us, status);
+	return status;
+}
+
+extern as_status
+aerospike_latency_query_foreach(aerospike *as_object_p, as_error *error_p,
+		const as_policy_query *policy_p, const as_query *query_p,
+		aerospike_query_foreach_callback callback, void *udata_p)
+{
+	bool        profiled = aerospike_memory_begin(AEROSPIKE_COMMAND_QUERY);
+	uint64_t    start_us = cf_getus();
+	uint64_t    elapsed_us = 0;
+	as_status   status = aerospike_query_foreach(as_object_p, error_p, policy_p,
+			query_p, callback, udata_p);
+
+	aerospike_memory_end(profiled);
+	elapsed_us = aerospike_latency_record(NULL, AEROSPIKE_COMMAND_QUERY,
+			start_us, status);
+	aerospike_slowlog_record(AEROSPIKE_COMMAND_QUERY, query_p->ns, query_p->set,
+			NULL, NULL, NULL, elapsed_us, status);
+	return status;
+}
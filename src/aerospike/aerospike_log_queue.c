@@ -0,0 +1,168 @@
+/*
+ *
+ * Copyright (C) 2014-2016 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#include "php.h"
+
+#include "aerospike/as_log.h"
+#include "aerospike_common.h"
+
+/*
+ *******************************************************************************************************
+ * Bounded multi-producer single-consumer queue of log records, between the
+ * threads logging (C client tend, scan and batch threads as well as the PHP
+ * thread) and the PHP thread invoking the userland log handler.
+ *
+ * Each slot carries a sequence number: a slot at position pos is free when
+ * its seq is pos, and holds a record when its seq is pos + 1. Producers
+ * claim positions with a CAS on log_queue_tail and drop the record when the
+ * queue is full, so a logging thread never waits on the PHP thread.
+ *******************************************************************************************************
+ */
+static aerospike_log_record log_queue[AEROSPIKE_LOG_QUEUE_SIZE];
+static uint64_t log_queue_tail = 0;
+static uint64_t log_queue_head = 0;
+static uint64_t log_queue_dropped = 0;
+static uint32_t log_queue_draining = 0;
+
+/*
+ *******************************************************************************************************
+ * Function to initialize the sequence numbers of the log queue, once per
+ * process from MINIT.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_log_queue_init(void)
+{
+	uint64_t    iter = 0;
+
+	for (iter = 0; iter < AEROSPIKE_LOG_QUEUE_SIZE; iter++) {
+		log_queue[iter].seq = iter;
+	}
+	__sync_synchronize();
+}
+
+/*
+ *******************************************************************************************************
+ * Function to add a log record to the queue, from any thread.
+ * The func and file names are kept by pointer, they are the __func__ and
+ * __FILE__ literals of the logging statement.
+ *
+ * @param level             The as_log_level of the record.
+ * @param func              The function name generating the log.
+ * @param file              The file name containing the func generating the log.
+ * @param line              The line number in file where the log was generated.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_log_queue_push(as_log_level level, const char *func, const char *file,
+		uint32_t line)
+{
+	aerospike_log_record    *slot_p = NULL;
+	uint64_t                position = log_queue_tail;
+	int64_t                 diff = 0;
+
+	for (;;) {
+		slot_p = &log_queue[position & (AEROSPIKE_LOG_QUEUE_SIZE - 1)];
+		diff = (int64_t) (*(volatile uint64_t *) &slot_p->seq - position);
+
+		if (diff == 0) {
+			if (__sync_bool_compare_and_swap(&log_queue_tail, position, position + 1)) {
+				break;
+			}
+		} else if (diff < 0) {
+			__sync_fetch_and_add(&log_queue_dropped, 1);
+			return;
+		}
+		position = *(volatile uint64_t *) &log_queue_tail;
+	}
+
+	slot_p->level = level;
+	slot_p->func = func;
+	slot_p->file = file;
+	slot_p->line = line;
+	__sync_synchronize();
+	slot_p->seq = position + 1;
+}
+
+/*
+ *******************************************************************************************************
+ * Callback registered with the C client's logger while a userland log handler
+ * is set. It only queues the record, the handler is invoked on the PHP thread
+ * by aerospike_log_queue_drain().
+ *
+ * @return true.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_log_queue_callback(as_log_level level, const char *func,
+		const char *file, uint32_t line, const char *fmt, ...)
+{
+	aerospike_log_queue_push(level, func, file, line);
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to invoke the userland log handler for the queued records, on the
+ * PHP thread. Only one thread drains at a time, and a log handler calling back
+ * into the extension does not drain recursively.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_log_queue_drain(TSRMLS_D)
+{
+	aerospike_log_record    record;
+	aerospike_log_record    *slot_p = NULL;
+	uint64_t                position = 0;
+
+	if ((*(volatile uint64_t *) &log_queue_head == *(volatile uint64_t *) &log_queue_tail) ||
+			!__sync_bool_compare_and_swap(&log_queue_draining, 0, 1)) {
+		return;
+	}
+
+	for (;;) {
+		position = log_queue_head;
+		slot_p = &log_queue[position & (AEROSPIKE_LOG_QUEUE_SIZE - 1)];
+		if (*(volatile uint64_t *) &slot_p->seq != position + 1) {
+			break;
+		}
+
+		memcpy(&record, slot_p, sizeof(record));
+		__sync_synchronize();
+		slot_p->seq = position + AEROSPIKE_LOG_QUEUE_SIZE;
+		log_queue_head = position + 1;
+
+		if (is_callback_registered) {
+			INVOKE_CALLBACK_FUNCTION(record.level, record.func, record.file, record.line);
+		}
+	}
+
+	__sync_synchronize();
+	log_queue_draining = 0;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to get the number of log records dropped because the queue was full.
+ *******************************************************************************************************
+ */
+extern uint64_t
+aerospike_log_queue_dropped(void)
+{
+	return log_queue_dropped;
+}
@@ -0,0 +1,413 @@
+/*
+ *
+ * Copyright (C) 2014-2016 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#include "php.h"
+
+#include "aerospike/aerospike.h"
+#include "aerospike/as_error.h"
+#include "aerospike/as_key.h"
+#include "aerospike/as_record.h"
+#include "aerospike_common.h"
+
+#define MEMO_KEY_SIZE           (AS_NAMESPACE_MAX_SIZE + AS_DIGEST_VALUE_SIZE)
+
+/*
+ *******************************************************************************************************
+ * Read of one record memoized by an Aerospike_object, for one bin selection.
+ * The reads of a record for its different selections are chained, and kept
+ * in the memo under the namespace and digest of the record, so that a write
+ * drops all of them at once. A read which did not find the record is
+ * memoized with a NULL record_p and its error.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_memo_entry_s {
+	struct aerospike_memo_entry_s   *next_p;
+	char                            *select_p;
+	size_t                          select_len;
+	as_record                       *record_p;
+	as_error                        error;
+} aerospike_memo_entry;
+
+/*
+ *******************************************************************************************************
+ * Function to free the chain of memoized reads of a record, when it is
+ * removed from the memo.
+ *******************************************************************************************************
+ */
+static void
+aerospike_memo_dtor(
+#if PHP_VERSION_ID < 70000
+		void
+#else
+		zval
+#endif
+		*hashtable_element)
+{
+	aerospike_memo_entry *entry_p =
+#if PHP_VERSION_ID < 70000
+		*(aerospike_memo_entry **) hashtable_element;
+#else
+		Z_PTR_P(hashtable_element);
+#endif
+	aerospike_memo_entry *next_p = NULL;
+
+	while (entry_p) {
+		next_p = entry_p->next_p;
+		if (entry_p->record_p) {
+			as_record_destroy(entry_p->record_p);
+		}
+		efree(entry_p->select_p);
+		efree(entry_p);
+		entry_p = next_p;
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to build the memo key of a record, its namespace followed by its
+ * digest.
+ *
+ * @return the length of the key, 0 if the digest cannot be computed.
+ *******************************************************************************************************
+ */
+static size_t
+aerospike_memo_key(as_key *as_key_p, char *memo_key)
+{
+	as_digest   *digest_p = NULL;
+	size_t      ns_len = strlen(as_key_p->ns);
+
+	if (!(digest_p = as_key_digest(as_key_p))) {
+		return 0;
+	}
+
+	memcpy(memo_key, as_key_p->ns, ns_len);
+	memo_key[ns_len] = '\0';
+	memcpy(memo_key + ns_len + 1, digest_p->value, AS_DIGEST_VALUE_SIZE);
+	return ns_len + 1 + AS_DIGEST_VALUE_SIZE;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to build the selection of a read, "*" for all the bins, or the
+ * bin names each terminated by a NUL, in the order given.
+ *
+ * @return the selection to be freed with efree(), NULL if a bin name is not
+ * a string, in which case the read is not memoized.
+ *******************************************************************************************************
+ */
+static char*
+aerospike_memo_select(zval *bins_p, size_t *select_len_p TSRMLS_DC)
+{
+	char            *select_p = NULL;
+	size_t          select_len = 0;
+#if PHP_VERSION_ID < 70000
+	HashPosition    pointer;
+	zval            **bin_pp = NULL;
+#else
+	zval            *bin_pp = NULL;
+#endif
+
+	if (!bins_p) {
+		*select_len_p = 1;
+		return estrndup("*", 1);
+	}
+
+#if PHP_VERSION_ID < 70000
+	AEROSPIKE_FOREACH_HASHTABLE(Z_ARRVAL_P(bins_p), pointer, bin_pp) {
+		if (Z_TYPE_PP(bin_pp) != IS_STRING) {
+			return NULL;
+		}
+		select_len += Z_STRLEN_PP(bin_pp) + 1;
+	}
+#else
+	ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(bins_p), bin_pp) {
+		if (Z_TYPE_P(bin_pp) != IS_STRING) {
+			return NULL;
+		}
+		select_len += Z_STRLEN_P(bin_pp) + 1;
+	} ZEND_HASH_FOREACH_END();
+#endif
+
+	select_p = emalloc(select_len + 1);
+	*select_len_p = 0;
+#if PHP_VERSION_ID < 70000
+	AEROSPIKE_FOREACH_HASHTABLE(Z_ARRVAL_P(bins_p), pointer, bin_pp) {
+		memcpy(select_p + *select_len_p, Z_STRVAL_PP(bin_pp), Z_STRLEN_PP(bin_pp) + 1);
+		*select_len_p += Z_STRLEN_PP(bin_pp) + 1;
+	}
+#else
+	ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(bins_p), bin_pp) {
+		memcpy(select_p + *select_len_p, Z_STRVAL_P(bin_pp), Z_STRLEN_P(bin_pp) + 1);
+		*select_len_p += Z_STRLEN_P(bin_pp) + 1;
+	} ZEND_HASH_FOREACH_END();
+#endif
+
+	return select_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to find the chain of memoized reads of a record.
+ *******************************************************************************************************
+ */
+static aerospike_memo_entry*
+aerospike_memo_find(Aerospike_object *aerospike_obj_p, char *memo_key, size_t memo_key_len)
+{
+#if PHP_VERSION_ID < 70000
+	aerospike_memo_entry    **entry_pp = NULL;
+
+	if (SUCCESS == zend_hash_find(aerospike_obj_p->memo_p, memo_key, memo_key_len,
+				(void **) &entry_pp)) {
+		return *entry_pp;
+	}
+	return NULL;
+#else
+	return zend_hash_str_find_ptr(aerospike_obj_p->memo_p, memo_key, memo_key_len);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Function to enable or disable the memoization of the reads of an
+ * Aerospike_object, for Aerospike::setReadMemoization(). Disabling it drops
+ * the memoized reads.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ * @param enable                Whether get() is to be memoized.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_memo_enable(Aerospike_object *aerospike_obj_p, bool enable)
+{
+	if (!enable) {
+		aerospike_memo_destroy(aerospike_obj_p);
+	} else if (!aerospike_obj_p->memo_p) {
+		ALLOC_HASHTABLE(aerospike_obj_p->memo_p);
+		zend_hash_init(aerospike_obj_p->memo_p, 32, NULL, aerospike_memo_dtor, 0);
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to look up the memoized read of a record for a bin selection.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ * @param as_key_p              The key of the record.
+ * @param bins_p                The optional PHP array of the bins to be read.
+ * @param record_pp             Set to the memoized record, reserved, to be
+ *                              destroyed by the caller. Set to NULL if the
+ *                              memoized read did not find the record.
+ * @param error_p               Set to the error of the memoized read.
+ *
+ * @return true if the read was memoized. Otherwise false.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_memo_get(Aerospike_object *aerospike_obj_p, as_key *as_key_p, zval *bins_p,
+		as_record **record_pp, as_error *error_p TSRMLS_DC)
+{
+	char                    memo_key[MEMO_KEY_SIZE];
+	size_t                  memo_key_len = 0;
+	char                    *select_p = NULL;
+	size_t                  select_len = 0;
+	aerospike_memo_entry    *entry_p = NULL;
+
+	if ((!aerospike_obj_p->memo_p) ||
+			(0 == zend_hash_num_elements(aerospike_obj_p->memo_p)) ||
+			(0 == (memo_key_len = aerospike_memo_key(as_key_p, memo_key))) ||
+			(!(select_p = aerospike_memo_select(bins_p, &select_len TSRMLS_CC)))) {
+		return false;
+	}
+
+	for (entry_p = aerospike_memo_find(aerospike_obj_p, memo_key, memo_key_len);
+			entry_p; entry_p = entry_p->next_p) {
+		if ((entry_p->select_len == select_len) &&
+				(0 == memcmp(entry_p->select_p, select_p, select_len))) {
+			break;
+		}
+	}
+	efree(select_p);
+
+	if (!entry_p) {
+		return false;
+	}
+
+	*record_pp = entry_p->record_p ?
+		(as_record *) as_val_reserve((as_val *) entry_p->record_p) : NULL;
+	as_error_copy(error_p, &entry_p->error);
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to memoize the read of a record for a bin selection. Only the
+ * reads which got the record, or found that it does not exist, are
+ * memoized.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ * @param as_key_p              The key of the record.
+ * @param bins_p                The optional PHP array of the bins read.
+ * @param record_p              The record read, reserved by the memo, or NULL.
+ * @param error_p               The error of the read.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_memo_put(Aerospike_object *aerospike_obj_p, as_key *as_key_p, zval *bins_p,
+		as_record *record_p, as_error *error_p TSRMLS_DC)
+{
+	char                    memo_key[MEMO_KEY_SIZE];
+	size_t                  memo_key_len = 0;
+	char                    *select_p = NULL;
+	size_t                  select_len = 0;
+	aerospike_memo_entry    *entry_p = NULL;
+	aerospike_memo_entry    *head_p = NULL;
+
+	if ((!aerospike_obj_p->memo_p) ||
+			((AEROSPIKE_OK != error_p->code) &&
+			 (AEROSPIKE_ERR_RECORD_NOT_FOUND != error_p->code)) ||
+			((AEROSPIKE_OK == error_p->code) && (!record_p)) ||
+			(0 == (memo_key_len = aerospike_memo_key(as_key_p, memo_key))) ||
+			(!(select_p = aerospike_memo_select(bins_p, &select_len TSRMLS_CC)))) {
+		return;
+	}
+
+	entry_p = emalloc(sizeof(aerospike_memo_entry));
+	entry_p->select_p = select_p;
+	entry_p->select_len = select_len;
+	entry_p->record_p = record_p ? (as_record *) as_val_reserve((as_val *) record_p) : NULL;
+	as_error_init(&entry_p->error);
+	as_error_copy(&entry_p->error, error_p);
+
+	/*
+	 * A memoized read is only looked up before reading, so the selection is
+	 * not in the chain yet.
+	 */
+	if ((head_p = aerospike_memo_find(aerospike_obj_p, memo_key, memo_key_len))) {
+		entry_p->next_p = head_p->next_p;
+		head_p->next_p = entry_p;
+		return;
+	}
+
+	entry_p->next_p = NULL;
+#if PHP_VERSION_ID < 70000
+	zend_hash_update(aerospike_obj_p->memo_p, memo_key, memo_key_len,
+			(void *) &entry_p, sizeof(entry_p), NULL);
+#else
+	zend_hash_str_update_ptr(aerospike_obj_p->memo_p, memo_key, memo_key_len, entry_p);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Function to drop the memoized reads of a record written, removed or
+ * touched through the Aerospike_object.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ * @param as_key_p              The key of the record written.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_memo_invalidate(Aerospike_object *aerospike_obj_p, as_key *as_key_p)
+{
+	char        memo_key[MEMO_KEY_SIZE];
+	size_t      memo_key_len = 0;
+
+	if ((!aerospike_obj_p->memo_p) || (!as_key_p) ||
+			(0 == zend_hash_num_elements(aerospike_obj_p->memo_p))) {
+		return;
+	}
+
+	if (0 == (memo_key_len = aerospike_memo_key(as_key_p, memo_key))) {
+		zend_hash_clean(aerospike_obj_p->memo_p);
+		return;
+	}
+
+#if PHP_VERSION_ID < 70000
+	zend_hash_del(aerospike_obj_p->memo_p, memo_key, memo_key_len);
+#else
+	zend_hash_str_del(aerospike_obj_p->memo_p, memo_key, memo_key_len);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Function to drop all the memoized reads of an Aerospike_object, such as
+ * when it is closed.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_memo_clear(Aerospike_object *aerospike_obj_p)
+{
+	if (aerospike_obj_p->memo_p) {
+		zend_hash_clean(aerospike_obj_p->memo_p);
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to drop every read of a record written, removed or touched
+ * through the Aerospike_object which could be served without reading it
+ * again: its memoized reads, its copy in the near cache and its getAsync()
+ * reads in flight. It is called by the write paths whatever the outcome of
+ * the write, as a failed or timed out write may still have been applied.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ * @param as_key_p              The key of the record written.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_write_invalidate(Aerospike_object *aerospike_obj_p, as_key *as_key_p)
+{
+	aerospike_memo_invalidate(aerospike_obj_p, as_key_p);
+	aerospike_near_cache_invalidate(as_key_p);
+	aerospike_async_flight_forget(aerospike_obj_p, as_key_p);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to drop the memoized reads and the getAsync() reads in flight of
+ * an Aerospike_object, when it writes records it does not know the keys of.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_write_invalidate_all(Aerospike_object *aerospike_obj_p)
+{
+	aerospike_memo_clear(aerospike_obj_p);
+	aerospike_async_flight_forget(aerospike_obj_p, NULL);
+}
+
+/*
+ *******************************************************************************************************
+ * Function for freeing the memo of an Aerospike_object.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_memo_destroy(Aerospike_object *aerospike_obj_p)
+{
+	if (aerospike_obj_p->memo_p) {
+		zend_hash_destroy(aerospike_obj_p->memo_p);
+		FREE_HASHTABLE(aerospike_obj_p->memo_p);
+		aerospike_obj_p->memo_p = NULL;
+	}
+}
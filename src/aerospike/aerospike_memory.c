@@ -0,0 +1,265 @@
+/*
+ *
+ * Copyright (C) 2014-2016 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#include "php.h"
+#include "php_aerospike.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "aerospike/aerospike.h"
+#include "aerospike/as_error.h"
+#include "aerospike_common.h"
+
+/*
+ *******************************************************************************************************
+ * The C heap is sampled once every this many samples of a command, as it is
+ * costlier to measure than the Zend heap.
+ *******************************************************************************************************
+ */
+#define MEMORY_HEAP_SAMPLE_EVERY 64
+
+/*
+ *******************************************************************************************************
+ * Per process memory used by each command type, while aerospike.memory_profiling
+ * is on. The bytes are those left allocated by a command in the Zend heap,
+ * mostly its result; the peaks are the highest growth of the Zend heap and of
+ * the C heap during a command, above their size when it started.
+ *******************************************************************************************************
+ */
+typedef struct aerospike_memory_stats_t {
+	uint64_t    count;
+	uint64_t    bytes_total;
+	uint64_t    bytes_max;
+	uint64_t    peak_total;
+	uint64_t    peak_max;
+	uint64_t    heap_peak_total;
+	uint64_t    heap_peak_max;
+} aerospike_memory_stats;
+
+static aerospike_memory_stats memory_totals[AEROSPIKE_COMMAND_MAX];
+
+/*
+ *******************************************************************************************************
+ * Function to measure the C heap in use, allocated by the C client and the
+ * libraries but not by emalloc(), which has its own pages.
+ *
+ * @return the bytes in use, or -1 where it cannot be measured.
+ *******************************************************************************************************
+ */
+static int64_t
+memory_heap_in_use()
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+	struct mallinfo2 info = mallinfo2();
+
+	return (int64_t) (info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+	struct mallinfo info = mallinfo();
+
+	return (int64_t) ((unsigned int) info.uordblks + (unsigned int) info.hblkhd);
+#else
+	return -1;
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Function to start profiling a command, unless profiling is off or a command
+ * is already being profiled, in which case this one is part of it.
+ *
+ * @param command               The command type.
+ *
+ * @return true if the profiling was started, to be ended by the caller.
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_memory_begin(aerospike_command command)
+{
+	aerospike_memory_span   *span_p = NULL;
+	TSRMLS_FETCH();
+
+	span_p = &AEROSPIKE_G(memory_span_g);
+	if (!AEROSPIKE_G(memory_profiling) || span_p->command >= 0) {
+		return false;
+	}
+
+	span_p->command = command;
+	span_p->emalloc_start = zend_memory_usage(0 TSRMLS_CC);
+	span_p->emalloc_peak = span_p->emalloc_start;
+	span_p->heap_start = memory_heap_in_use();
+	span_p->heap_peak = span_p->heap_start;
+	span_p->samples = 0;
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to sample the memory in use during the profiled command, if any.
+ * Called while its result is built, e.g. after each record.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_memory_sample(TSRMLS_D)
+{
+	aerospike_memory_span   *span_p = &AEROSPIKE_G(memory_span_g);
+	size_t                  emalloc_in_use = 0;
+	int64_t                 heap_in_use = 0;
+
+	if (span_p->command < 0) {
+		return;
+	}
+
+	emalloc_in_use = zend_memory_usage(0 TSRMLS_CC);
+	if (emalloc_in_use > span_p->emalloc_peak) {
+		span_p->emalloc_peak = emalloc_in_use;
+	}
+	if (span_p->heap_start >= 0 && (++span_p->samples % MEMORY_HEAP_SAMPLE_EVERY) == 0) {
+		heap_in_use = memory_heap_in_use();
+		if (heap_in_use > span_p->heap_peak) {
+			span_p->heap_peak = heap_in_use;
+		}
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to end the profiling of a command and add it to the totals.
+ *
+ * @param started               What aerospike_memory_begin() returned.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_memory_end(bool started)
+{
+	aerospike_memory_span   *span_p = NULL;
+	aerospike_memory_stats  *stats_p = NULL;
+	size_t                  emalloc_in_use = 0;
+	uint64_t                bytes = 0;
+	uint64_t                peak = 0;
+	uint64_t                heap_peak = 0;
+	TSRMLS_FETCH();
+
+	if (!started) {
+		return;
+	}
+
+	span_p = &AEROSPIKE_G(memory_span_g);
+	span_p->samples = MEMORY_HEAP_SAMPLE_EVERY - 1;
+	aerospike_memory_sample(TSRMLS_C);
+
+	emalloc_in_use = zend_memory_usage(0 TSRMLS_CC);
+	if (emalloc_in_use > span_p->emalloc_start) {
+		bytes = emalloc_in_use - span_p->emalloc_start;
+	}
+	peak = span_p->emalloc_peak - span_p->emalloc_start;
+	if (span_p->heap_start >= 0) {
+		heap_peak = span_p->heap_peak - span_p->heap_start;
+	}
+
+	stats_p = &memory_totals[span_p->command];
+	stats_p->count++;
+	stats_p->bytes_total += bytes;
+	stats_p->peak_total += peak;
+	stats_p->heap_peak_total += heap_peak;
+	if (bytes > stats_p->bytes_max) {
+		stats_p->bytes_max = bytes;
+	}
+	if (peak > stats_p->peak_max) {
+		stats_p->peak_max = peak;
+	}
+	if (heap_peak > stats_p->heap_peak_max) {
+		stats_p->heap_peak_max = heap_peak;
+	}
+	span_p->command = -1;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to populate a PHP array with the memory used by the commands of
+ * this process, for Aerospike::getStats(). Nothing is added unless profiling
+ * is on or was on for some command.
+ *
+ * @param stats_p               The initialized PHP array to be populated with
+ *                              "memory".
+ *******************************************************************************************************
+ */
+extern void
+aerospike_memory_stats(zval *stats_p TSRMLS_DC)
+{
+	uint32_t    command = 0;
+	bool        profiled = AEROSPIKE_G(memory_profiling);
+#if PHP_VERSION_ID < 70000
+	zval        *memory_p = NULL;
+	zval        *commands_p = NULL;
+#else
+	zval        memory;
+	zval        commands;
+	zval        *memory_p = &memory;
+	zval        *commands_p = &commands;
+#endif
+
+	for (command = 0; command < AEROSPIKE_COMMAND_MAX; command++) {
+		profiled = profiled || memory_totals[command].count;
+	}
+	if (!profiled) {
+		return;
+	}
+
+#if PHP_VERSION_ID < 70000
+	MAKE_STD_ZVAL(memory_p);
+	MAKE_STD_ZVAL(commands_p);
+#endif
+	array_init(memory_p);
+	array_init(commands_p);
+
+	for (command = 0; command < AEROSPIKE_COMMAND_MAX; command++) {
+		aerospike_memory_stats *totals_p = &memory_totals[command];
+#if PHP_VERSION_ID < 70000
+		zval    *command_p = NULL;
+#else
+		zval    command_zval;
+		zval    *command_p = &command_zval;
+#endif
+
+		if (totals_p->count == 0) {
+			continue;
+		}
+
+#if PHP_VERSION_ID < 70000
+		MAKE_STD_ZVAL(command_p);
+#endif
+		array_init(command_p);
+		add_assoc_long(command_p, "count", totals_p->count);
+		add_assoc_long(command_p, "bytes_avg", totals_p->bytes_total / totals_p->count);
+		add_assoc_long(command_p, "bytes_max", totals_p->bytes_max);
+		add_assoc_long(command_p, "peak_avg", totals_p->peak_total / totals_p->count);
+		add_assoc_long(command_p, "peak_max", totals_p->peak_max);
+		if (memory_heap_in_use() >= 0) {
+			add_assoc_long(command_p, "heap_peak_avg", totals_p->heap_peak_total / totals_p->count);
+			add_assoc_long(command_p, "heap_peak_max", totals_p->heap_peak_max);
+		}
+		add_assoc_zval(commands_p, aerospike_latency_command_name(command), command_p);
+	}
+
+	add_assoc_long(memory_p, "emalloc_peak", zend_memory_peak_usage(0 TSRMLS_CC));
+	add_assoc_long(memory_p, "static_pool_bytes", sizeof(as_static_pool));
+	add_assoc_zval(memory_p, "commands", commands_p);
+	add_assoc_zval(stats_p, "memory", memory_p);
+}
@@ -0,0 +1,546 @@
+/*
+ *
+ * Copyright (C) 2014-2016 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#include "php.h"
+#include "php_aerospike.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "aerospike/aerospike.h"
+#include "aerospike/as_buffer.h"
+#include "aerospike/as_error.h"
+#include "aerospike/as_hashmap.h"
+#include "aerospike/as_key.h"
+#include "aerospike/as_map.h"
+#include "aerospike/as_msgpack.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_serializer.h"
+#include "aerospike/as_string.h"
+#include "aerospike/as_stringmap.h"
+#include "citrusleaf/cf_clock.h"
+#include "aerospike_common.h"
+
+#define NEAR_CACHE_WAYS             4
+#define NEAR_CACHE_MIN_SLOT_SIZE    512
+
+/*
+ *******************************************************************************************************
+ * The near cache is a segment of shared memory mapped at MINIT, so that all
+ * the processes forked from the one loading the extension, such as the
+ * workers of PHP-FPM, share it. It is made of fixed size slots, each holding
+ * the bins of one record packed with msgpack. A record is kept in one of the
+ * NEAR_CACHE_WAYS slots of the bucket of its digest, the least recently used
+ * one being replaced.
+ *******************************************************************************************************
+ */
+typedef struct near_cache_header_s {
+	pthread_mutex_t     lock;
+	uint32_t            n_buckets;
+	uint32_t            slot_size;
+	uint64_t            hits;
+	uint64_t            validations;
+	uint64_t            misses;
+	uint64_t            stores;
+	uint64_t            invalidations;
+} near_cache_header;
+
+typedef struct near_cache_slot_s {
+	bool                used;
+	char                ns[AS_NAMESPACE_MAX_SIZE];
+	as_digest_value     digest;
+	uint16_t            gen;
+	uint32_t            data_len;
+	/* cf_getms() times: when the record was read or last validated, when
+	 * it expires on the server (0 for never) and when it was last used. */
+	uint64_t            validated_ms;
+	uint64_t            expires_ms;
+	uint64_t            used_ms;
+	uint8_t             data[];
+} near_cache_slot;
+
+static near_cache_header *near_cache_p = NULL;
+static size_t near_cache_size = 0;
+
+/*
+ *******************************************************************************************************
+ * Function to lock the near cache. A process which died holding the lock
+ * may have left a slot half written, so the cache is then emptied.
+ *******************************************************************************************************
+ */
+static void
+near_cache_lock(void)
+{
+#ifdef __linux__
+	if (EOWNERDEAD == pthread_mutex_lock(&near_cache_p->lock)) {
+		memset((char *) near_cache_p + sizeof(near_cache_header), 0,
+				near_cache_size - sizeof(near_cache_header));
+		pthread_mutex_consistent(&near_cache_p->lock);
+	}
+#else
+	pthread_mutex_lock(&near_cache_p->lock);
+#endif
+}
+
+static near_cache_slot*
+near_cache_slot_at(uint32_t index)
+{
+	return (near_cache_slot *) ((char *) near_cache_p + sizeof(near_cache_header) +
+			(size_t) index * near_cache_p->slot_size);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to find the slot of a record, with the lock held.
+ *
+ * @param as_key_p              The key of the record, its digest computed.
+ * @param lru_pp                If not NULL, set to the slot of the bucket to
+ *                              be replaced when the record is not found.
+ *
+ * @return the slot of the record, NULL if not found.
+ *******************************************************************************************************
+ */
+static near_cache_slot*
+near_cache_find(as_key *as_key_p, near_cache_slot **lru_pp)
+{
+	uint64_t            hash = 0;
+	uint32_t            first = 0;
+	uint32_t            iter = 0;
+	near_cache_slot     *slot_p = NULL;
+
+	memcpy(&hash, as_key_p->digest.value, sizeof(hash));
+	first = (uint32_t) (hash % near_cache_p->n_buckets) * NEAR_CACHE_WAYS;
+
+	for (iter = 0; iter < NEAR_CACHE_WAYS; iter++) {
+		slot_p = near_cache_slot_at(first + iter);
+		if (slot_p->used &&
+				(0 == memcmp(slot_p->digest, as_key_p->digest.value, AS_DIGEST_VALUE_SIZE)) &&
+				(0 == strncmp(slot_p->ns, as_key_p->ns, AS_NAMESPACE_MAX_SIZE))) {
+			return slot_p;
+		}
+		if (lru_pp && ((!*lru_pp) || (!slot_p->used) ||
+					((*lru_pp)->used && (slot_p->used_ms < (*lru_pp)->used_ms)))) {
+			*lru_pp = slot_p;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to check whether the records of the namespace and set of a key
+ * are to be cached, per aerospike.near_cache_sets: a comma separated list of
+ * "ns" or "ns.set".
+ *******************************************************************************************************
+ */
+static bool
+near_cache_is_cached(as_key *as_key_p TSRMLS_DC)
+{
+	const char  *entry_p = AEROSPIKE_G(near_cache_sets);
+	size_t      ns_len = strlen(as_key_p->ns);
+	size_t      set_len = strlen(as_key_p->set);
+	size_t      entry_len = 0;
+
+	if ((!near_cache_p) || (!entry_p)) {
+		return false;
+	}
+
+	while (*entry_p) {
+		while (*entry_p == ' ' || *entry_p == ',') {
+			entry_p++;
+		}
+		for (entry_len = 0; entry_p[entry_len] && entry_p[entry_len] != ','
+				&& entry_p[entry_len] != ' '; entry_len++) {
+			;
+		}
+		if ((entry_len >= ns_len) && (0 == strncmp(entry_p, as_key_p->ns, ns_len)) &&
+				((entry_len == ns_len) ||
+				 ((entry_len == ns_len + 1 + set_len) && (entry_p[ns_len] == '.') &&
+				  (0 == strncmp(entry_p + ns_len + 1, as_key_p->set, set_len))))) {
+			return true;
+		}
+		entry_p += entry_len;
+	}
+
+	return false;
+}
+
+static bool
+near_cache_set_bin(const as_val *key_p, const as_val *value_p, void *udata_p)
+{
+	if (as_val_type(key_p) == AS_STRING) {
+		as_record_set((as_record *) udata_p, as_string_get((as_string *) key_p),
+				(as_bin_value *) as_val_reserve((as_val *) value_p));
+	}
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to rebuild a record from the bins packed in a slot.
+ *******************************************************************************************************
+ */
+static as_record*
+near_cache_unpack(uint8_t *data_p, uint32_t data_len, uint16_t gen, uint64_t expires_ms)
+{
+	as_serializer   serializer;
+	as_buffer       buffer;
+	as_val          *bins_p = NULL;
+	as_map          *map_p = NULL;
+	as_record       *record_p = NULL;
+	uint64_t        now_ms = cf_getms();
+
+	buffer.data = data_p;
+	buffer.size = data_len;
+	buffer.capacity = data_len;
+
+	as_msgpack_init(&serializer);
+	as_serializer_deserialize(&serializer, &buffer, &bins_p);
+	as_serializer_destroy(&serializer);
+
+	if (!(map_p = as_map_fromval(bins_p))) {
+		goto exit;
+	}
+
+	record_p = as_record_new((uint16_t) as_map_size(map_p));
+	as_map_foreach(map_p, near_cache_set_bin, record_p);
+	record_p->gen = gen;
+	record_p->ttl = (0 == expires_ms) ? AS_RECORD_NO_EXPIRE_TTL :
+		(uint32_t) ((expires_ms > now_ms) ? (expires_ms - now_ms) / 1000 : 0);
+
+exit:
+	if (bins_p) {
+		as_val_destroy(bins_p);
+	}
+	return record_p;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to map the near cache, at MINIT, if aerospike.near_cache_size is
+ * set.
+ *
+ * @return SUCCESS, or FAILURE if the segment cannot be mapped.
+ *******************************************************************************************************
+ */
+extern int
+aerospike_near_cache_init(TSRMLS_D)
+{
+	pthread_mutexattr_t     attr;
+	long                    slot_size = AEROSPIKE_G(near_cache_slot_size);
+	size_t                  n_buckets = 0;
+	void                    *segment_p = NULL;
+
+	if (AEROSPIKE_G(near_cache_size) <= 0) {
+		return SUCCESS;
+	}
+
+	if (slot_size < NEAR_CACHE_MIN_SLOT_SIZE) {
+		slot_size = NEAR_CACHE_MIN_SLOT_SIZE;
+	}
+	slot_size = (slot_size + 7) & ~7L;
+	n_buckets = (size_t) AEROSPIKE_G(near_cache_size) / ((size_t) slot_size * NEAR_CACHE_WAYS);
+	if (n_buckets == 0) {
+		n_buckets = 1;
+	}
+	if (n_buckets > UINT32_MAX / NEAR_CACHE_WAYS) {
+		n_buckets = UINT32_MAX / NEAR_CACHE_WAYS;
+	}
+
+	near_cache_size = sizeof(near_cache_header) + n_buckets * NEAR_CACHE_WAYS * (size_t) slot_size;
+	segment_p = mmap(NULL, near_cache_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (segment_p == MAP_FAILED) {
+		php_error_docref(NULL TSRMLS_CC, E_WARNING,
+				"Unable to map the near cache of %zu bytes", near_cache_size);
+		near_cache_size = 0;
+		return FAILURE;
+	}
+
+	near_cache_p = (near_cache_header *) segment_p;
+	near_cache_p->n_buckets = (uint32_t) n_buckets;
+	near_cache_p->slot_size = (uint32_t) slot_size;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+#ifdef __linux__
+	pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+#endif
+	pthread_mutex_init(&near_cache_p->lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	return SUCCESS;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to unmap the near cache at MSHUTDOWN.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_near_cache_shutdown(void)
+{
+	if (near_cache_p) {
+		munmap(near_cache_p, near_cache_size);
+		near_cache_p = NULL;
+		near_cache_size = 0;
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to serve a full record read from the near cache. A record read or
+ * validated less than aerospike.near_cache_fresh_ms ago is served as is.
+ * Past that, its generation is checked with a read of its metadata only, and
+ * it is served if unchanged.
+ *
+ * @param aerospike_obj_p       The Aerospike_object.
+ * @param as_key_p              The key of the record.
+ * @param read_policy_p         The read policy of the metadata read.
+ * @param hedge_delay           The hedge delay of the metadata read.
+ * @param record_pp             Set to the record, to be destroyed by the
+ *                              caller, if served.
+ * @param error_p               The as_error, left as is if not served.
+ *
+ * @return true if the record was served. Otherwise false, the record is to
+ * be read and stored with aerospike_near_cache_put().
+ *******************************************************************************************************
+ */
+extern bool
+aerospike_near_cache_get(Aerospike_object *aerospike_obj_p, as_key *as_key_p,
+		as_policy_read *read_policy_p, int32_t hedge_delay, as_record **record_pp,
+		as_error *error_p TSRMLS_DC)
+{
+	near_cache_slot     *slot_p = NULL;
+	uint8_t             *data_p = NULL;
+	uint32_t            data_len = 0;
+	uint16_t            gen = 0;
+	uint64_t            expires_ms = 0;
+	uint64_t            now_ms = 0;
+	bool                fresh = false;
+	as_record           *meta_p = NULL;
+	as_error            meta_error;
+
+	*record_pp = NULL;
+	if ((!near_cache_is_cached(as_key_p TSRMLS_CC)) || (!as_key_digest(as_key_p))) {
+		return false;
+	}
+
+	now_ms = cf_getms();
+	near_cache_lock();
+	if ((slot_p = near_cache_find(as_key_p, NULL))) {
+		if (slot_p->expires_ms && (slot_p->expires_ms <= now_ms)) {
+			slot_p->used = false;
+		} else {
+			slot_p->used_ms = now_ms;
+			fresh = (now_ms - slot_p->validated_ms) < (uint64_t) AEROSPIKE_G(near_cache_fresh_ms);
+			gen = slot_p->gen;
+			expires_ms = slot_p->expires_ms;
+			data_len = slot_p->data_len;
+			data_p = emalloc(data_len);
+			memcpy(data_p, slot_p->data, data_len);
+		}
+	}
+	if (!data_p) {
+		near_cache_p->misses++;
+	}
+	pthread_mutex_unlock(&near_cache_p->lock);
+
+	if (!data_p) {
+		return false;
+	}
+
+	if (!fresh) {
+		as_error_init(&meta_error);
+		if ((AEROSPIKE_OK != aerospike_latency_hedged_read(aerospike_obj_p->as_ref_p->as_p,
+						&meta_error, read_policy_p, as_key_p, NULL, true, &meta_p,
+						hedge_delay TSRMLS_CC)) || (meta_p->gen != gen)) {
+			aerospike_near_cache_invalidate(as_key_p);
+			goto exit;
+		}
+
+		near_cache_lock();
+		near_cache_p->validations++;
+		if ((slot_p = near_cache_find(as_key_p, NULL)) && (slot_p->gen == gen)) {
+			slot_p->validated_ms = cf_getms();
+		}
+		pthread_mutex_unlock(&near_cache_p->lock);
+	}
+
+	if ((*record_pp = near_cache_unpack(data_p, data_len, gen, expires_ms))) {
+		as_error_reset(error_p);
+		near_cache_lock();
+		near_cache_p->hits++;
+		pthread_mutex_unlock(&near_cache_p->lock);
+	}
+
+exit:
+	if (meta_p) {
+		as_record_destroy(meta_p);
+	}
+	efree(data_p);
+	return (*record_pp != NULL);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to store a record read in full in the near cache. Records whose
+ * bins do not fit in a slot are not cached.
+ *
+ * @param as_key_p              The key of the record.
+ * @param record_p              The record read, or NULL if the read failed.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_near_cache_put(as_key *as_key_p, as_record *record_p TSRMLS_DC)
+{
+	as_serializer       serializer;
+	as_buffer           buffer;
+	as_hashmap          *bins_p = NULL;
+	near_cache_slot     *slot_p = NULL;
+	near_cache_slot     *lru_p = NULL;
+	uint16_t            iter = 0;
+	uint64_t            now_ms = 0;
+
+	if ((!record_p) || (!near_cache_is_cached(as_key_p TSRMLS_CC)) ||
+			(!as_key_digest(as_key_p))) {
+		return;
+	}
+
+	bins_p = as_hashmap_new(record_p->bins.size ? record_p->bins.size : 1);
+	for (iter = 0; iter < record_p->bins.size; iter++) {
+		as_bin *bin_p = &record_p->bins.entries[iter];
+		if (bin_p->valuep && (as_val_type(bin_p->valuep) != AS_NIL)) {
+			as_stringmap_set((as_map *) bins_p, bin_p->name,
+					as_val_reserve((as_val *) bin_p->valuep));
+		}
+	}
+
+	as_buffer_init(&buffer);
+	as_msgpack_init(&serializer);
+	as_serializer_serialize(&serializer, (as_val *) bins_p, &buffer);
+	as_serializer_destroy(&serializer);
+	as_hashmap_destroy(bins_p);
+
+	if ((buffer.size == 0) ||
+			(buffer.size > near_cache_p->slot_size - sizeof(near_cache_slot))) {
+		goto exit;
+	}
+
+	now_ms = cf_getms();
+	near_cache_lock();
+	if (!(slot_p = near_cache_find(as_key_p, &lru_p))) {
+		slot_p = lru_p;
+	}
+	slot_p->used = true;
+	strncpy(slot_p->ns, as_key_p->ns, AS_NAMESPACE_MAX_SIZE);
+	memcpy(slot_p->digest, as_key_p->digest.value, AS_DIGEST_VALUE_SIZE);
+	slot_p->gen = record_p->gen;
+	slot_p->validated_ms = now_ms;
+	slot_p->used_ms = now_ms;
+	slot_p->expires_ms = ((record_p->ttl == AS_RECORD_NO_EXPIRE_TTL) || (record_p->ttl == 0)) ?
+		0 : now_ms + (uint64_t) record_p->ttl * 1000;
+	slot_p->data_len = buffer.size;
+	memcpy(slot_p->data, buffer.data, buffer.size);
+	near_cache_p->stores++;
+	pthread_mutex_unlock(&near_cache_p->lock);
+
+exit:
+	as_buffer_destroy(&buffer);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to drop a record written by this process from the near cache.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_near_cache_invalidate(as_key *as_key_p)
+{
+	near_cache_slot     *slot_p = NULL;
+
+	if ((!near_cache_p) || (!as_key_p) || (!as_key_digest(as_key_p))) {
+		return;
+	}
+
+	near_cache_lock();
+	if ((slot_p = near_cache_find(as_key_p, NULL))) {
+		slot_p->used = false;
+		near_cache_p->invalidations++;
+	}
+	pthread_mutex_unlock(&near_cache_p->lock);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to empty the near cache, when records whose keys are not known
+ * are written, such as by scanApply().
+ *******************************************************************************************************
+ */
+extern void
+aerospike_near_cache_clear(void)
+{
+	uint32_t    iter = 0;
+
+	if (!near_cache_p) {
+		return;
+	}
+
+	near_cache_lock();
+	for (iter = 0; iter < near_cache_p->n_buckets * NEAR_CACHE_WAYS; iter++) {
+		near_cache_slot_at(iter)->used = false;
+	}
+	near_cache_p->invalidations++;
+	pthread_mutex_unlock(&near_cache_p->lock);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to add the counters of the near cache to the getStats() array.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_near_cache_stats(zval *stats_p TSRMLS_DC)
+{
+#if PHP_VERSION_ID < 70000
+	zval        *near_cache_zval_p = NULL;
+#else
+	zval        near_cache;
+	zval        *near_cache_zval_p = &near_cache;
+#endif
+
+	if (!near_cache_p) {
+		return;
+	}
+
+#if PHP_VERSION_ID < 70000
+	MAKE_STD_ZVAL(near_cache_zval_p);
+#endif
+	array_init(near_cache_zval_p);
+	near_cache_lock();
+	add_assoc_long(near_cache_zval_p, "slots", near_cache_p->n_buckets * NEAR_CACHE_WAYS);
+	add_assoc_long(near_cache_zval_p, "hits", near_cache_p->hits);
+	add_assoc_long(near_cache_zval_p, "validations", near_cache_p->validations);
+	add_assoc_long(near_cache_zval_p, "misses", near_cache_p->misses);
+	add_assoc_long(near_cache_zval_p, "stores", near_cache_p->stores);
+	add_assoc_long(near_cache_zval_p, "invalidations", near_cache_p->invalidations);
+	pthread_mutex_unlock(&near_cache_p->lock);
+	add_assoc_zval(stats_p, "near_cache", near_cache_zval_p);
+}
@@ -51,6 +51,7 @@
 #define GEN_POLICY_PHP_INI INI_STR("aerospike.key_gen") ? (uint32_t) atoi(INI_STR("aerospike.key_gen")) : 0
 #define USE_BATCH_DIRECT_PHP_INI INI_STR("aerospike.use_batch_direct") ? (bool) atoi(INI_STR("aerospike.use_batch_direct")) : 0
 #define COMPRESSION_THRESHOLD_PHP_INI INI_STR("aerospike.compression_threshold") ? (uint32_t) atoi(INI_STR("aerospike.compression_threshold")) : 0
+#define READ_HEDGE_DELAY_PHP_INI INI_STR("aerospike.read_hedge_delay") ? (int32_t) atoi(INI_STR("aerospike.read_hedge_delay")) : 0
 
 /*
  *******************************************************************************************************
@@ -209,12 +210,55 @@ exit:
 	return error_p->code;
 }
 
+/*
+ *******************************************************************************************************
+ * Function for getting the hedge delay of a read from the user's optional
+ * policy options (if set), else from the aerospike.read_hedge_delay INI entry.
+ *
+ * @param options_p             The optional parameters.
+ * @param hedge_delay_p         The hedge delay in milliseconds to be set.
+ * @param error_p               The as_error to be populated by the function
+ *                              with the encountered error if any.
+ *******************************************************************************************************
+ */
+extern as_status
+get_options_hedge_delay_value(zval* options_p, int32_t* hedge_delay_p, as_error *error_p TSRMLS_DC)
+{
+	DECLARE_ZVAL_P(hedge_delay_pp);
+
+	*hedge_delay_p = READ_HEDGE_DELAY_PHP_INI;
+
+	if (options_p) {
+#if PHP_VERSION_ID < 70000
+		if (zend_hash_index_find(Z_ARRVAL_P(options_p), OPT_READ_HEDGE_DELAY, (void **) &hedge_delay_pp) == FAILURE) {
+#else
+		if ((hedge_delay_pp = zend_hash_index_find(Z_ARRVAL_P(options_p), OPT_READ_HEDGE_DELAY)) == NULL) {
+#endif
+			goto exit;
+		}
+		if ((AEROSPIKE_Z_TYPE_P(hedge_delay_pp) != IS_LONG) ||
+				(AEROSPIKE_Z_LVAL_P(hedge_delay_pp) < READ_HEDGE_DELAY_ADAPTIVE)) {
+			DEBUG_PHP_EXT_DEBUG("OPT_READ_HEDGE_DELAY should be a positive integer or READ_HEDGE_DELAY_ADAPTIVE");
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+				"OPT_READ_HEDGE_DELAY should be a positive integer or READ_HEDGE_DELAY_ADAPTIVE");
+			goto exit;
+		}
+		*hedge_delay_p = (int32_t) AEROSPIKE_Z_LVAL_P(hedge_delay_pp);
+	}
+
+exit:
+	return error_p->code;
+}
+
 /*
  *******************************************************************************************************
  * Function for setting the relevant aerospike policies by using the user's
  * optional policy options (if set) else the defaults.
  *
  * @param as_config_p           The as_config object to be passed in case of connect.
+ * @param profile_p             The as_policies of a matching namespace/set policy
+ *                              profile to copy defaults from. NULL to use the
+ *                              defaults within as_config_p.
  * @param read_policy_p         The as_policy_read to be passed in case of connect/get.
  * @param write_policy_p        The as_policy_write to be passed in case of connect/put.
  * @param operate_policy_p      The as_policy_operate to be passed in case of operations:
@@ -240,6 +284,7 @@ exit:
  */
 static  void
 set_policy_ex(as_config *as_config_p,
+	as_policies *profile_p,
 	as_policy_read *read_policy_p,
 	as_policy_write *write_policy_p,
 	as_policy_operate *operate_policy_p,
@@ -256,6 +301,7 @@ set_policy_ex(as_config *as_config_p,
 	as_error *error_p TSRMLS_DC)
 {
 	//int16_t             serializer_flag = 0;
+	as_policies         *defaults_p = (profile_p) ? profile_p : &as_config_p->policies;
 
 	if ((!read_policy_p) && (!write_policy_p) &&
 		(!operate_policy_p) && (!remove_policy_p) && (!info_policy_p) &&
@@ -275,63 +321,63 @@ set_policy_ex(as_config *as_config_p,
 		 * case: get
 		 */
 		as_policy_read_init(read_policy_p);
-		as_policy_read_copy(&as_config_p->policies.read,
+		as_policy_read_copy(&defaults_p->read,
 				read_policy_p);
 	} else if (write_policy_p && (!read_policy_p)) {
 		/*
 		 * case: put
 		 */
 		as_policy_write_init(write_policy_p);
-		as_policy_write_copy(&as_config_p->policies.write,
+		as_policy_write_copy(&defaults_p->write,
 				write_policy_p);
 	} else if (operate_policy_p) {
 		/*
 		 * case: operate
 		 */
 		as_policy_operate_init(operate_policy_p);
-		as_policy_operate_copy(&as_config_p->policies.operate,
+		as_policy_operate_copy(&defaults_p->operate,
 				operate_policy_p);
 	} else if (remove_policy_p) {
 		/*
 		 * case: remove
 		 */
 		as_policy_remove_init(remove_policy_p);
-		as_policy_remove_copy(&as_config_p->policies.remove,
+		as_policy_remove_copy(&defaults_p->remove,
 				remove_policy_p);
 	} else if (info_policy_p) {
 		/*
 		 * case: info
 		 */
 		as_policy_info_init(info_policy_p);
-		as_policy_info_copy(&as_config_p->policies.info,
+		as_policy_info_copy(&defaults_p->info,
 				info_policy_p);
 	} else if (scan_policy_p) {
 		/*
 		 * case: scan, scanApply
 		 */
 		as_policy_scan_init(scan_policy_p);
-		as_policy_scan_copy(&as_config_p->policies.scan,
+		as_policy_scan_copy(&defaults_p->scan,
 				scan_policy_p);
 	} else if (query_policy_p) {
 		/*
 		 * case: query, aggregate
 		 */
 		as_policy_query_init(query_policy_p);
-		as_policy_query_copy(&as_config_p->policies.query,
+		as_policy_query_copy(&defaults_p->query,
 				query_policy_p);
 	} else if (batch_policy_p) {
 		/*
 		 * case: getMany, existsMany
 		 */
 		as_policy_batch_init(batch_policy_p);
-		as_policy_batch_copy(&as_config_p->policies.batch,
+		as_policy_batch_copy(&defaults_p->batch,
 				batch_policy_p);
 	} else if(apply_policy_p) {
 		/*
 		 * case : apply udf
 		 */
 		as_policy_apply_init(apply_policy_p);
-		as_policy_apply_copy(&as_config_p->policies.apply,
+		as_policy_apply_copy(&defaults_p->apply,
 				apply_policy_p);
 	} else if(admin_policy_p) {
 		/*
@@ -718,6 +764,16 @@ set_policy_ex(as_config *as_config_p,
 
 		  case OPT_TTL:
 			  break;
+		  case OPT_READ_HEDGE_DELAY:
+			  if (!read_policy_p) {
+				  DEBUG_PHP_EXT_DEBUG("Unable to set policy: Invalid Value for OPT_READ_HEDGE_DELAY");
+				  PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+						  "Unable to set policy: Invalid Value for OPT_READ_HEDGE_DELAY");
+				  goto exit;
+			  }
+			  break;
+		  case OPT_BULK_CONCURRENCY:
+			  break;
 		  default:
 			  DEBUG_PHP_EXT_DEBUG("Unable to set policy: Invalid Policy Constant Key");
 			  PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
@@ -763,7 +819,7 @@ exit:
 extern void
 set_policy_read(as_policy_read *read_policy_p, zval *options_p, as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(NULL, read_policy_p, NULL, NULL, NULL, NULL, NULL,
+	set_policy_ex(NULL, NULL, read_policy_p, NULL, NULL, NULL, NULL, NULL,
 		NULL, NULL, NULL, NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
 }
 
@@ -785,7 +841,7 @@ extern void
 set_policy_write(as_policy_write *write_policy_p,
 	int8_t *serializer_policy_p, zval *options_p, as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(NULL, NULL, write_policy_p, NULL, NULL, NULL, NULL,
+	set_policy_ex(NULL, NULL, NULL, write_policy_p, NULL, NULL, NULL, NULL,
 		NULL, serializer_policy_p, NULL, NULL, NULL, NULL, options_p,
 		error_p TSRMLS_CC);
 }
@@ -808,7 +864,7 @@ extern void
 set_policy_operate(as_policy_operate *operate_policy_p,
 	int8_t *serializer_policy_p, zval *options_p, as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(NULL, NULL, NULL, operate_policy_p, NULL, NULL, NULL,
+	set_policy_ex(NULL, NULL, NULL, NULL, operate_policy_p, NULL, NULL, NULL,
 			NULL, serializer_policy_p, NULL, NULL, NULL, NULL,
 			options_p, error_p TSRMLS_CC);
 }
@@ -828,7 +884,7 @@ set_policy_operate(as_policy_operate *operate_policy_p,
 extern void
 set_policy_remove(as_policy_remove *remove_policy_p, zval *options_p, as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(NULL, NULL, NULL, NULL, remove_policy_p, NULL, NULL,
+	set_policy_ex(NULL, NULL, NULL, NULL, NULL, remove_policy_p, NULL, NULL,
 		NULL, NULL, NULL, NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
 }
 
@@ -848,7 +904,7 @@ set_policy_remove(as_policy_remove *remove_policy_p, zval *options_p, as_error *
 extern void
 set_policy_info(as_policy_info *info_policy_p, zval *options_p, as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(NULL, NULL, NULL, NULL, NULL, info_policy_p, NULL,
+	set_policy_ex(NULL, NULL, NULL, NULL, NULL, NULL, info_policy_p, NULL,
 		NULL, NULL, NULL, NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
 }
 
@@ -878,11 +934,52 @@ set_policy(as_config *as_config_p,
 		zval *options_p,
 		as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(as_config_p, read_policy_p, write_policy_p, operate_policy_p,
+	set_policy_ex(as_config_p, NULL, read_policy_p, write_policy_p, operate_policy_p,
 		remove_policy_p, info_policy_p, scan_policy_p, query_policy_p,
 		serializer_policy_p, NULL, NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
 }
 
+/*
+ *******************************************************************************************************
+ * Wrapper function for setting the single record policies by using the user's
+ * optional policy options (if set), else the defaults of the policy profile
+ * registered for the key's namespace/set (if any), else the global defaults.
+ *
+ * @param aerospike_obj_p       The Aerospike_object holding the policy profiles.
+ * @param as_key_p              The as_key of the record for which the policy is
+ *                              to be resolved.
+ * @param read_policy_p         The as_policy_read to be passed in case of get.
+ * @param write_policy_p        The as_policy_write to be passed in case of put.
+ * @param operate_policy_p      The as_policy_operate to be passed in case of operate.
+ * @param remove_policy_p       The as_policy_remove to be passed in case of remove.
+ * @param apply_policy_p        The as_policy_apply to be passed in case of udf apply.
+ * @param serializer_policy_p   The integer serializer_policy to be passed to
+ *                              handle aerospike-unsupported data types.
+ * @param options_p             The user's optional policy options to be used if set, else defaults.
+ * @param error_p               The as_error to be populated by the function
+ *                              with the encountered error if any.
+ *
+ *******************************************************************************************************
+ */
+extern void
+set_policy_for_key(Aerospike_object *aerospike_obj_p,
+		as_key *as_key_p,
+		as_policy_read *read_policy_p,
+		as_policy_write *write_policy_p,
+		as_policy_operate *operate_policy_p,
+		as_policy_remove *remove_policy_p,
+		as_policy_apply *apply_policy_p,
+		int8_t *serializer_policy_p,
+		zval *options_p,
+		as_error *error_p TSRMLS_DC)
+{
+	set_policy_ex(&aerospike_obj_p->as_ref_p->as_p->config,
+		aerospike_policy_profile_find(aerospike_obj_p, as_key_p),
+		read_policy_p, write_policy_p, operate_policy_p, remove_policy_p,
+		NULL, NULL, NULL, serializer_policy_p, NULL, NULL, apply_policy_p,
+		NULL, options_p, error_p TSRMLS_CC);
+}
+
 /*
  *******************************************************************************************************
  * Wrapper function for setting the scan policy by using the user's
@@ -906,7 +1003,7 @@ set_policy_scan(as_config *as_config_p,
 	zval *options_p,
 	as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(as_config_p, NULL, NULL, NULL, NULL, NULL, scan_policy_p, NULL,
+	set_policy_ex(as_config_p, NULL, NULL, NULL, NULL, NULL, NULL, scan_policy_p, NULL,
 		serializer_policy_p, as_scan_p, NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
 }
 
@@ -931,7 +1028,7 @@ set_policy_query_apply(as_config *as_config_p,
 	zval *options_p,
 	as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(as_config_p, NULL, write_policy_p, NULL, NULL, NULL, NULL, NULL,
+	set_policy_ex(as_config_p, NULL, NULL, write_policy_p, NULL, NULL, NULL, NULL, NULL,
 		NULL, NULL, NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
 }
 
@@ -954,7 +1051,7 @@ set_policy_batch(as_config *as_config_p,
 	zval *options_p,
 	as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(as_config_p, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+	set_policy_ex(as_config_p, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
 		NULL, NULL, batch_policy_p, NULL, NULL, options_p, error_p TSRMLS_CC);
 }
 
@@ -977,7 +1074,7 @@ set_policy_udf_apply(as_config *as_config_p,
 	zval *options_p,
 	as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(as_config_p, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+	set_policy_ex(as_config_p, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
 		serializer_policy_p, NULL, NULL, apply_policy_p, NULL, options_p, error_p TSRMLS_CC);
 }
 
@@ -998,7 +1095,7 @@ set_policy_admin(as_policy_admin *admin_policy_p,
 	zval *options_p,
 	as_error *error_p TSRMLS_DC)
 {
-	set_policy_ex(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+	set_policy_ex(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
 		NULL, NULL, NULL, NULL, admin_policy_p, options_p, error_p TSRMLS_CC);
 }
 
@@ -1299,3 +1396,275 @@ set_general_policies(as_config *as_config_p, zval *options_p, as_error *error_p,
 exit:
 	return;
 }
+
+/*
+ *******************************************************************************************************
+ * Destructor for the entries of the policy profiles hashtable.
+ * PHP5 owns the copied as_policies itself, PHP7 stores a pointer to it.
+ *******************************************************************************************************
+ */
+#if PHP_VERSION_ID >= 70000
+static void
+policy_profile_dtor(zval *profile_p)
+{
+	efree(Z_PTR_P(profile_p));
+}
+#endif
+
+/*
+ *******************************************************************************************************
+ * Function for parsing the user's policy options into a policy profile.
+ * Only the options which make sense as namespace/set wide defaults of single
+ * record commands are accepted.
+ *
+ * @param profile_p             The as_policies to be populated.
+ * @param options_p             The user's policy options.
+ * @param error_p               The as_error to be populated by the function
+ *                              with the encountered error if any.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+set_policy_profile_options(as_policies *profile_p, zval *options_p,
+	as_error *error_p TSRMLS_DC)
+{
+	HashTable*          options_array = Z_ARRVAL_P(options_p);
+	HashPosition        options_pointer;
+	DECLARE_ZVAL_P(options_value);
+#if PHP_VERSION_ID < 70000
+	int8_t*             options_key;
+	uint                options_key_len;
+	ulong               options_index;
+#else
+	zend_string*        options_key;
+	zend_ulong          options_index;
+#endif
+
+#if PHP_VERSION_ID < 70000
+	AEROSPIKE_FOREACH_HASHTABLE(options_array, options_pointer, options_value) {
+		if (HASH_KEY_IS_LONG != AEROSPIKE_ZEND_HASH_GET_CURRENT_KEY_EX(options_array, &options_key,
+					&options_key_len, &options_index, 0, &options_pointer)) {
+			DEBUG_PHP_EXT_DEBUG("Unable to set policy profile: Invalid Policy Constant Key");
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+					"Unable to set policy profile: Invalid Policy Constant Key");
+			goto exit;
+		}
+#else
+	ZEND_HASH_FOREACH_KEY_VAL(options_array, options_index, options_key, options_value) {
+		if (options_key) {
+			DEBUG_PHP_EXT_DEBUG("Unable to set policy profile: Invalid Policy Constant Key");
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+					"Unable to set policy profile: Invalid Policy Constant Key");
+			goto exit;
+		}
+#endif
+		if (AEROSPIKE_Z_TYPE_P(options_value) != IS_LONG) {
+			DEBUG_PHP_EXT_DEBUG("Unable to set policy profile: Invalid Value for policy option");
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+					"Unable to set policy profile: Invalid Value for policy option");
+			goto exit;
+		}
+
+		switch((int) options_index) {
+			case OPT_READ_TIMEOUT:
+				profile_p->read.timeout = (uint32_t) AEROSPIKE_Z_LVAL_P(options_value);
+				break;
+			case OPT_WRITE_TIMEOUT:
+				profile_p->write.timeout = (uint32_t) AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->operate.timeout = (uint32_t) AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->remove.timeout = (uint32_t) AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->apply.timeout = (uint32_t) AEROSPIKE_Z_LVAL_P(options_value);
+				break;
+			case OPT_POLICY_RETRY:
+				profile_p->write.retry = AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->operate.retry = AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->remove.retry = AEROSPIKE_Z_LVAL_P(options_value);
+				break;
+			case OPT_POLICY_EXISTS:
+				profile_p->write.exists = AEROSPIKE_Z_LVAL_P(options_value);
+				break;
+			case OPT_POLICY_KEY:
+				profile_p->read.key = AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->write.key = AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->operate.key = AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->remove.key = AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->apply.key = AEROSPIKE_Z_LVAL_P(options_value);
+				break;
+			case OPT_POLICY_REPLICA:
+				profile_p->read.replica = AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->operate.replica = AEROSPIKE_Z_LVAL_P(options_value);
+				break;
+			case OPT_POLICY_CONSISTENCY:
+				profile_p->read.consistency_level = AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->operate.consistency_level = AEROSPIKE_Z_LVAL_P(options_value);
+				break;
+			case OPT_POLICY_COMMIT_LEVEL:
+				profile_p->write.commit_level = AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->operate.commit_level = AEROSPIKE_Z_LVAL_P(options_value);
+				profile_p->remove.commit_level = AEROSPIKE_Z_LVAL_P(options_value);
+				break;
+			default:
+				DEBUG_PHP_EXT_DEBUG("Unable to set policy profile: Invalid Policy Constant Key");
+				PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+						"Unable to set policy profile: Invalid Policy Constant Key");
+				goto exit;
+		}
+#if PHP_VERSION_ID < 70000
+	}
+#else
+	} ZEND_HASH_FOREACH_END();
+#endif
+
+	PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_OK, DEFAULT_ERROR);
+exit:
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function for registering, replacing or removing the policy profile of a
+ * namespace ("ns") or a set ("ns.set") within the Aerospike_object.
+ * The profile starts off as a copy of the connection's default policies and
+ * the user's options are applied on top of it.
+ *
+ * @param aerospike_obj_p       The Aerospike_object holding the policy profiles.
+ * @param scope_p               The "ns" or "ns.set" the profile applies to.
+ * @param scope_len             The length of scope_p.
+ * @param options_p             The user's policy options. NULL or an empty array
+ *                              removes the profile.
+ * @param error_p               The as_error to be populated by the function
+ *                              with the encountered error if any.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_policy_profile_set(Aerospike_object *aerospike_obj_p,
+	char *scope_p,
+	int scope_len,
+	zval *options_p,
+	as_error *error_p TSRMLS_DC)
+{
+	as_policies         profile;
+
+	if ((!scope_p) || (scope_len <= 0) ||
+			(scope_len >= AS_NAMESPACE_MAX_SIZE + AS_SET_MAX_SIZE)) {
+		DEBUG_PHP_EXT_DEBUG("Unable to set policy profile: Invalid namespace/set");
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+				"Unable to set policy profile: Invalid namespace/set");
+		goto exit;
+	}
+
+	if ((!options_p) || (0 == zend_hash_num_elements(Z_ARRVAL_P(options_p)))) {
+		if (aerospike_obj_p->policy_profiles_p) {
+#if PHP_VERSION_ID < 70000
+			zend_hash_del(aerospike_obj_p->policy_profiles_p, scope_p, scope_len + 1);
+#else
+			zend_hash_str_del(aerospike_obj_p->policy_profiles_p, scope_p, scope_len);
+#endif
+		}
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_OK, DEFAULT_ERROR);
+		goto exit;
+	}
+
+	memcpy(&profile, &aerospike_obj_p->as_ref_p->as_p->config.policies, sizeof(as_policies));
+	if (AEROSPIKE_OK != set_policy_profile_options(&profile, options_p, error_p TSRMLS_CC)) {
+		goto exit;
+	}
+
+	if (!aerospike_obj_p->policy_profiles_p) {
+		ALLOC_HASHTABLE(aerospike_obj_p->policy_profiles_p);
+#if PHP_VERSION_ID < 70000
+		zend_hash_init(aerospike_obj_p->policy_profiles_p, 8, NULL, NULL, 0);
+#else
+		zend_hash_init(aerospike_obj_p->policy_profiles_p, 8, NULL, policy_profile_dtor, 0);
+#endif
+	}
+
+#if PHP_VERSION_ID < 70000
+	zend_hash_update(aerospike_obj_p->policy_profiles_p, scope_p, scope_len + 1,
+			(void *) &profile, sizeof(as_policies), NULL);
+#else
+	zend_hash_str_update_mem(aerospike_obj_p->policy_profiles_p, scope_p, scope_len,
+			(void *) &profile, sizeof(as_policies));
+#endif
+
+exit:
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function for looking up the policy profile that applies to a key.
+ * A profile registered for the key's "ns.set" wins over the one registered
+ * for its "ns".
+ *
+ * @param aerospike_obj_p       The Aerospike_object holding the policy profiles.
+ * @param as_key_p              The as_key to be resolved.
+ *
+ * @return the matching as_policies if any. Otherwise NULL.
+ *******************************************************************************************************
+ */
+extern as_policies*
+aerospike_policy_profile_find(Aerospike_object *aerospike_obj_p, as_key *as_key_p)
+{
+	char                scope[AS_NAMESPACE_MAX_SIZE + AS_SET_MAX_SIZE];
+	size_t              ns_len = 0;
+	size_t              set_len = 0;
+	as_policies         *profile_p = NULL;
+
+	if ((!aerospike_obj_p->policy_profiles_p) || (!as_key_p) ||
+			(0 == zend_hash_num_elements(aerospike_obj_p->policy_profiles_p))) {
+		return NULL;
+	}
+
+	ns_len = strlen(as_key_p->ns);
+	set_len = strlen(as_key_p->set);
+	memcpy(scope, as_key_p->ns, ns_len);
+
+	if (set_len) {
+		scope[ns_len] = '.';
+		memcpy(scope + ns_len + 1, as_key_p->set, set_len);
+		scope[ns_len + 1 + set_len] = '\0';
+#if PHP_VERSION_ID < 70000
+		if (SUCCESS == zend_hash_find(aerospike_obj_p->policy_profiles_p, scope,
+					ns_len + set_len + 2, (void **) &profile_p)) {
+			return profile_p;
+		}
+#else
+		if (NULL != (profile_p = zend_hash_str_find_ptr(aerospike_obj_p->policy_profiles_p,
+						scope, ns_len + set_len + 1))) {
+			return profile_p;
+		}
+#endif
+	}
+
+	scope[ns_len] = '\0';
+#if PHP_VERSION_ID < 70000
+	if (SUCCESS == zend_hash_find(aerospike_obj_p->policy_profiles_p, scope,
+				ns_len + 1, (void **) &profile_p)) {
+		return profile_p;
+	}
+	return NULL;
+#else
+	return zend_hash_str_find_ptr(aerospike_obj_p->policy_profiles_p, scope, ns_len);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Function for freeing the policy profiles of an Aerospike_object.
+ *
+ * @param aerospike_obj_p       The Aerospike_object holding the policy profiles.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_policy_profiles_destroy(Aerospike_object *aerospike_obj_p)
+{
+	if (aerospike_obj_p->policy_profiles_p) {
+		zend_hash_destroy(aerospike_obj_p->policy_profiles_p);
+		FREE_HASHTABLE(aerospike_obj_p->policy_profiles_p);
+		aerospike_obj_p->policy_profiles_p = NULL;
+	}
+}
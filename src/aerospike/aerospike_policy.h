@@ -47,8 +47,18 @@ enum Aerospike_constants {
 	OPT_TTL,                 /* set to time-to-live of the record in seconds                                  */
 	USE_BATCH_DIRECT,        /* use new batch index protocol if server supports it                            */
 	COMPRESSION_THRESHOLD,   /* Minimum record size beyond which it is compressed and sent to the server      */
+	OPT_READ_HEDGE_DELAY,    /* value in milliseconds, 0 to disable or Aerospike::READ_HEDGE_DELAY_ADAPTIVE   */
+	OPT_BULK_CONCURRENCY,    /* integer value 1-256, the writes in flight of loadFile(), default: 16          */
 };
 
+/*
+ *******************************************************************************************************
+ * Value of OPT_READ_HEDGE_DELAY deriving the delay from the p95 latency
+ * observed against the master node of the key.
+ *******************************************************************************************************
+ */
+#define READ_HEDGE_DELAY_ADAPTIVE -1
+
 /*
  *******************************************************************************************************
  * Enum for PHP client's SERIALIZER_* constant values. Possible values for
@@ -63,6 +73,17 @@ enum Aerospike_serializer_values {
 
 #define SERIALIZER_DEFAULT "php"
 
+/*
+ *******************************************************************************************************
+ * Enum for PHP client's FILE_FORMAT_* constant values, the formats of the
+ * files of scanToFile().
+ *******************************************************************************************************
+ */
+enum Aerospike_file_formats {
+	FILE_FORMAT_NDJSON,  /* one JSON object per line */
+	FILE_FORMAT_MSGPACK, /* one msgpack map after the other */
+};
+
 #define MAX_CONSTANT_STR_SIZE 512
 /*
  *******************************************************************************************************
@@ -102,6 +123,9 @@ AerospikeConstants aerospike_constants[] = {
 	{ OPT_TTL                               ,   "OPT_TTL"                           },
 	{ USE_BATCH_DIRECT                      ,   "USE_BATCH_DIRECT"                  },
 	{ COMPRESSION_THRESHOLD                 ,   "COMPRESSION_THRESHOLD"             },
+	{ OPT_READ_HEDGE_DELAY                  ,   "OPT_READ_HEDGE_DELAY"              },
+	{ OPT_BULK_CONCURRENCY                  ,   "OPT_BULK_CONCURRENCY"              },
+	{ READ_HEDGE_DELAY_ADAPTIVE             ,   "READ_HEDGE_DELAY_ADAPTIVE"         },
 	{ AS_POLICY_RETRY_NONE                  ,   "POLICY_RETRY_NONE"                 },
 	{ AS_POLICY_RETRY_ONCE                  ,   "POLICY_RETRY_ONCE"                 },
 	{ AS_POLICY_EXISTS_IGNORE               ,   "POLICY_EXISTS_IGNORE"              },
@@ -112,6 +136,8 @@ AerospikeConstants aerospike_constants[] = {
 	{ SERIALIZER_NONE                       ,   "SERIALIZER_NONE"                   },
 	{ SERIALIZER_PHP                        ,   "SERIALIZER_PHP"                    },
 	{ SERIALIZER_USER                       ,   "SERIALIZER_USER"                   },
+	{ FILE_FORMAT_NDJSON                    ,   "FILE_FORMAT_NDJSON"                },
+	{ FILE_FORMAT_MSGPACK                   ,   "FILE_FORMAT_MSGPACK"               },
 	{ AS_UDF_TYPE_LUA                       ,   "UDF_TYPE_LUA"                      },
 	{ AS_SCAN_PRIORITY_AUTO 		        ,   "SCAN_PRIORITY_AUTO" 		        },
 	{ AS_SCAN_PRIORITY_LOW 		            ,   "SCAN_PRORITY_LOW" 			        },
@@ -193,6 +219,32 @@ set_policy_query_apply(as_config *as_config_p,
 	zval *options_p,
 	as_error *error_p TSRMLS_DC);
 
+extern void
+set_policy_for_key(Aerospike_object *aerospike_obj_p,
+	as_key *as_key_p,
+	as_policy_read *read_policy_p,
+	as_policy_write *write_policy_p,
+	as_policy_operate *operate_policy_p,
+	as_policy_remove *remove_policy_p,
+	as_policy_apply *apply_policy_p,
+	int8_t *serializer_policy_p,
+	zval *options_p,
+	as_error *error_p TSRMLS_DC);
+
+extern as_status
+aerospike_policy_profile_set(Aerospike_object *aerospike_obj_p,
+	char *scope_p,
+	int scope_len,
+	zval *options_p,
+	as_error *error_p TSRMLS_DC);
+
+extern as_policies*
+aerospike_policy_profile_find(Aerospike_object *aerospike_obj_p,
+	as_key *as_key_p);
+
+extern void
+aerospike_policy_profiles_destroy(Aerospike_object *aerospike_obj_p);
+
 extern as_status
 declare_policy_constants_php(zend_class_entry *Aerospike_ce TSRMLS_DC);
 #endif /* end of __AEROSPIKE_POLICY_H__ */
@@ -28,6 +28,17 @@
 #include "aerospike/as_query.h"
 #include "aerospike/aerospike_query.h"
 #include "aerospike_policy.h"
+#include "aerospike/as_double.h"
+#include "aerospike/as_hashmap.h"
+#include "aerospike/as_hashmap_iterator.h"
+#include "aerospike/as_integer.h"
+#include "aerospike/as_pair.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_scan.h"
+#include "aerospike/aerospike_scan.h"
+
+#include <math.h>
+#include <pthread.h>
 
 #define PROGRESS_PCT "progress_pct"
 #define RECORDS_READ "records_read"
@@ -628,14 +639,14 @@ aerospike_query_run(aerospike* as_object_p, as_error* error_p, char* namespace_p
 #if PHP_VERSION_ID >= 70000
 		ZEND_HASH_FOREACH_END();
 #endif
-		if (AEROSPIKE_OK != (aerospike_query_foreach(as_object_p, error_p,
+		if (AEROSPIKE_OK != (aerospike_latency_query_foreach(as_object_p, error_p,
 						&query_policy, &query,
 						aerospike_helper_record_stream_callback,
 						user_func_p))) {
 			DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
 			goto exit;
 		}
-	} else if (AEROSPIKE_OK != (aerospike_query_foreach(as_object_p, error_p,
+	} else if (AEROSPIKE_OK != (aerospike_latency_query_foreach(as_object_p, error_p,
 					NULL, &query, aerospike_helper_record_stream_callback,
 					user_func_p))) {
 		DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
@@ -664,7 +675,10 @@ exit:
  * @param bins_ht_p                 The HashTable for optional filter bins array.
  * @param predicate_p               The HashTable for Query Predicate array.
  * @param return_value_p            The return value of aggregation to be
- *                                  populated by this method.
+ *                                  populated by this method, NULL when the
+ *                                  values are streamed to user_func_p.
+ * @param user_func_p               The user's callback to be applied per value
+ *                                  of the stream as it arrives, else NULL.
  * @param options_p                 The optional policy.
  * @param serializer_policy_p       The serializer_policy value set in AerospikeObject structure.
  *                                  Either an INI read value or value from user provided options array.
@@ -677,7 +691,8 @@ aerospike_query_aggregate(Aerospike_object* as_object_p, as_error* error_p,
 		const char* module_p, const char* function_p, PARAM_ZVAL_P(args_pp),
 		char* namespace_p, char* set_p, HashTable* bins_ht_p,
 		HashTable* predicate_ht_p, zval* return_value_p,
-		zval* options_p, int8_t* serializer_policy_p  TSRMLS_DC)
+		userland_callback* user_func_p, zval* options_p,
+		int8_t* serializer_policy_p  TSRMLS_DC)
 {
 	as_arraylist                args_list;
 	as_arraylist*               args_list_p = NULL;
@@ -688,6 +703,8 @@ aerospike_query_aggregate(Aerospike_object* as_object_p, as_error* error_p,
 	bool                        is_init_query = false;
 	foreach_callback_udata      aggregate_result_callback_udata;
 	bool                        return_value_assoc = false;
+	aerospike_query_foreach_callback    callback = aerospike_helper_aggregate_callback;
+	void*                       udata_p = &aggregate_result_callback_udata;
 
 	if ((!as_object_p->as_ref_p->as_p) || (!error_p) || (!module_p) || (!function_p) ||
 			(!args_pp && (!(
@@ -697,7 +714,7 @@ aerospike_query_aggregate(Aerospike_object* as_object_p, as_error* error_p,
 					args_pp
 #endif
 			))) || (!namespace_p) || (!set_p) ||
-			(!predicate_ht_p) || (!return_value_p)) {
+			(!predicate_ht_p) || ((!return_value_p) && (!user_func_p))) {
 		DEBUG_PHP_EXT_DEBUG("Unable to initiate query aggregation");
 		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to initiate query aggregation");
 		goto exit;
@@ -750,6 +767,10 @@ aerospike_query_aggregate(Aerospike_object* as_object_p, as_error* error_p,
 	aggregate_result_callback_udata.udata_p = return_value_p;
 	aggregate_result_callback_udata.error_p = error_p;
 	aggregate_result_callback_udata.obj	 = as_object_p;
+	if (user_func_p) {
+		callback = aerospike_helper_aggregate_stream_callback;
+		udata_p = user_func_p;
+	}
 
 	if (bins_ht_p) {
 		as_query_select_inita(&query, zend_hash_num_elements(bins_ht_p));
@@ -778,16 +799,13 @@ aerospike_query_aggregate(Aerospike_object* as_object_p, as_error* error_p,
 			}
 		}
 
-		if (AEROSPIKE_OK != (aerospike_query_foreach(as_object_p->as_ref_p->as_p, error_p,
-						&query_policy, &query,
-						aerospike_helper_aggregate_callback,
-						&aggregate_result_callback_udata))) {
+		if (AEROSPIKE_OK != (aerospike_latency_query_foreach(as_object_p->as_ref_p->as_p, error_p,
+						&query_policy, &query, callback, udata_p))) {
 			DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
 			goto exit;
 		}
-	} else if (AEROSPIKE_OK != (aerospike_query_foreach(as_object_p->as_ref_p->as_p, error_p,
-					&query_policy, &query, aerospike_helper_aggregate_callback,
-					&aggregate_result_callback_udata))) {
+	} else if (AEROSPIKE_OK != (aerospike_latency_query_foreach(as_object_p->as_ref_p->as_p, error_p,
+					&query_policy, &query, callback, udata_p))) {
 		DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
 		goto exit;
 	}
@@ -810,3 +828,708 @@ exit:
 	aerospike_helper_free_static_pool(&udf_pool);
 	return error_p->code;
 }
+
+/*
+ ******************************************************************************************************
+ * The native aggregates of Aerospike::aggregateNative(), folded in C over the
+ * records streamed by a scan or a query. Scan and query callbacks run on the
+ * C client's threads, so each of them folds into its own partial, which never
+ * touches zvals, and the partials are merged once the scan or query returns.
+ * The lock is only taken by a thread to claim its partial, and by the threads
+ * beyond NATIVE_AGGREGATE_PARTIALS which share one.
+ ******************************************************************************************************
+ */
+#define NATIVE_AGGREGATE_SUM            0
+#define NATIVE_AGGREGATE_MIN            1
+#define NATIVE_AGGREGATE_MAX            2
+#define NATIVE_AGGREGATE_HISTOGRAM      3
+#define NATIVE_AGGREGATE_BINS           4
+#define NATIVE_AGGREGATE_MAX_BUCKETS    100000
+#define NATIVE_AGGREGATE_PARTIALS       64
+
+static const char *native_aggregate_names[NATIVE_AGGREGATE_BINS] = {
+	"sum", "min", "max", "histogram"
+};
+
+typedef struct native_aggregate_bin_s {
+	bool        enabled;
+	char        bin[AS_BIN_NAME_MAX_SIZE];
+	bool        has_int;
+	bool        has_double;
+	int64_t     int_value;
+	double      double_value;
+} native_aggregate_bin;
+
+typedef struct native_aggregate_partial_s {
+	pthread_t               thread;
+	uint64_t                records;
+	native_aggregate_bin    bins[NATIVE_AGGREGATE_BINS];
+	as_hashmap              buckets;
+} native_aggregate_partial;
+
+typedef struct native_aggregate_s {
+	pthread_mutex_t             lock;
+	bool                        count;
+	uint64_t                    records;
+	native_aggregate_bin        bins[NATIVE_AGGREGATE_BINS];
+	int64_t                     bucket_width;
+	as_hashmap                  buckets;
+	bool                        overflow;
+	bool                        sum_overflow;
+	uint32_t                    n_partials;
+	native_aggregate_partial    partials[NATIVE_AGGREGATE_PARTIALS];
+	native_aggregate_partial    shared;
+} native_aggregate;
+
+typedef struct native_aggregate_bucket_s {
+	int64_t     start;
+	int64_t     count;
+} native_aggregate_bucket;
+
+/*
+ ******************************************************************************************************
+ * Parses the aggregates array of aggregateNative() into the native_aggregate.
+ *
+ * @param aggregate_p               The native_aggregate to be populated.
+ * @param aggregates_ht_p           The HashTable for the aggregates array.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+static as_status
+native_aggregate_parse(native_aggregate* aggregate_p, HashTable* aggregates_ht_p,
+		as_error* error_p TSRMLS_DC)
+{
+	HashPosition            pos;
+	DECLARE_ZVAL_P(value_pp);
+	DECLARE_ZVAL_P(bin_pp);
+	DECLARE_ZVAL_P(width_pp);
+	const char*             name_p = NULL;
+	zval*                   bin_zval_p = NULL;
+	int                     kind = 0;
+	bool                    is_named = false;
+#if PHP_VERSION_ID < 70000
+	int8_t*                 key_p = NULL;
+	uint                    key_len = 0;
+	ulong                   index = 0;
+#else
+	zend_string*            key_p = NULL;
+	zend_ulong              index = 0;
+#endif
+
+	if (zend_hash_num_elements(aggregates_ht_p) == 0) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+				"Expects at least one aggregate");
+		goto exit;
+	}
+
+#if PHP_VERSION_ID < 70000
+	AEROSPIKE_FOREACH_HASHTABLE(aggregates_ht_p, pos, value_pp) {
+		is_named = false;
+		if (HASH_KEY_IS_STRING == AEROSPIKE_ZEND_HASH_GET_CURRENT_KEY_EX(aggregates_ht_p,
+					&key_p, &key_len, &index, 0, &pos)) {
+			name_p = (const char *) key_p;
+			is_named = true;
+		} else if (AEROSPIKE_Z_TYPE_P(value_pp) == IS_STRING) {
+			name_p = AEROSPIKE_Z_STRVAL_P(value_pp);
+		} else {
+			name_p = NULL;
+		}
+#else
+	ZEND_HASH_FOREACH_KEY_VAL(aggregates_ht_p, index, key_p, value_pp) {
+		is_named = false;
+		if (key_p) {
+			name_p = ZSTR_VAL(key_p);
+			is_named = true;
+		} else if (AEROSPIKE_Z_TYPE_P(value_pp) == IS_STRING) {
+			name_p = AEROSPIKE_Z_STRVAL_P(value_pp);
+		} else {
+			name_p = NULL;
+		}
+#endif
+		if (name_p && !strcmp(name_p, "count")) {
+			aggregate_p->count = true;
+			continue;
+		}
+		for (kind = 0; kind < NATIVE_AGGREGATE_BINS; kind++) {
+			if (name_p && !strcmp(name_p, native_aggregate_names[kind])) {
+				break;
+			}
+		}
+		if (kind == NATIVE_AGGREGATE_BINS || !is_named) {
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+					"Unknown aggregate, expects count, sum, min, max or histogram");
+			goto exit;
+		}
+
+		if (kind == NATIVE_AGGREGATE_HISTOGRAM) {
+			if ((AEROSPIKE_Z_TYPE_P(value_pp) != IS_ARRAY) ||
+#if PHP_VERSION_ID < 70000
+					(SUCCESS != AEROSPIKE_ZEND_HASH_INDEX_FIND(AEROSPIKE_Z_ARRVAL_P(value_pp), 0, &bin_pp)) ||
+					(SUCCESS != AEROSPIKE_ZEND_HASH_INDEX_FIND(AEROSPIKE_Z_ARRVAL_P(value_pp), 1, &width_pp)) ||
+#else
+					(NULL == (bin_pp = AEROSPIKE_ZEND_HASH_INDEX_FIND(AEROSPIKE_Z_ARRVAL_P(value_pp), 0, &bin_pp))) ||
+					(NULL == (width_pp = AEROSPIKE_ZEND_HASH_INDEX_FIND(AEROSPIKE_Z_ARRVAL_P(value_pp), 1, &width_pp))) ||
+#endif
+					(AEROSPIKE_Z_TYPE_P(width_pp) != IS_LONG) ||
+					(AEROSPIKE_Z_LVAL_P(width_pp) <= 0)) {
+				PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+						"Expects histogram to be an array of a bin name and a positive bucket width");
+				goto exit;
+			}
+			aggregate_p->bucket_width = (int64_t) AEROSPIKE_Z_LVAL_P(width_pp);
+		} else {
+			bin_pp = value_pp;
+		}
+
+#if PHP_VERSION_ID < 70000
+		bin_zval_p = *bin_pp;
+#else
+		bin_zval_p = bin_pp;
+#endif
+		if ((PHP_TYPE_ISNOTSTR(bin_zval_p)) || (Z_STRLEN_P(bin_zval_p) == 0) ||
+				(Z_STRLEN_P(bin_zval_p) >= AS_BIN_NAME_MAX_SIZE)) {
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+					"Expects the bin of an aggregate to be a valid bin name");
+			goto exit;
+		}
+		aggregate_p->bins[kind].enabled = true;
+		strcpy(aggregate_p->bins[kind].bin, Z_STRVAL_P(bin_zval_p));
+#if PHP_VERSION_ID < 70000
+	}
+#else
+	} ZEND_HASH_FOREACH_END();
+#endif
+
+	PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_OK, DEFAULT_ERROR);
+exit:
+	return error_p->code;
+}
+
+/*
+ ******************************************************************************************************
+ * Adds records to a histogram, in the bucket starting at start.
+ * Sets the overflow of the native_aggregate once there are too many buckets.
+ ******************************************************************************************************
+ */
+static void
+native_aggregate_bucket_add(native_aggregate* aggregate_p, as_hashmap* buckets_p,
+		int64_t start, int64_t count)
+{
+	as_integer      key;
+	as_integer*     count_p = NULL;
+
+	as_integer_init(&key, start);
+	if (NULL != (count_p = (as_integer *) as_hashmap_get(buckets_p, (as_val *) &key))) {
+		count_p->value += count;
+	} else if (as_hashmap_size(buckets_p) >= NATIVE_AGGREGATE_MAX_BUCKETS) {
+		aggregate_p->overflow = true;
+	} else {
+		as_hashmap_set(buckets_p, (as_val *) as_integer_new(start),
+				(as_val *) as_integer_new(count));
+	}
+}
+
+/*
+ ******************************************************************************************************
+ * Adds one value to the histogram of a partial, in the bucket starting at the
+ * value rounded down to a multiple of the bucket width.
+ ******************************************************************************************************
+ */
+static void
+native_aggregate_value_add(native_aggregate* aggregate_p, native_aggregate_partial* partial_p,
+		double value)
+{
+	native_aggregate_bucket_add(aggregate_p, &partial_p->buckets,
+			(int64_t) floor(value / (double) aggregate_p->bucket_width) *
+			aggregate_p->bucket_width, 1);
+}
+
+/*
+ ******************************************************************************************************
+ * Adds an integer to an integer sum, setting the sum_overflow of the
+ * native_aggregate if it does not fit.
+ ******************************************************************************************************
+ */
+static void
+native_aggregate_sum_add(native_aggregate* aggregate_p, int64_t* sum_p, int64_t value)
+{
+	if (__builtin_add_overflow(*sum_p, value, sum_p)) {
+		aggregate_p->sum_overflow = true;
+	}
+}
+
+/*
+ ******************************************************************************************************
+ * Gets the partial of the calling C client thread, claiming a free one on
+ * its first record. Threads beyond NATIVE_AGGREGATE_PARTIALS get the shared
+ * partial, with the lock held until they release it.
+ *
+ * @param aggregate_p               The native_aggregate.
+ * @param locked_p                  Set to true if the lock is to be released.
+ *
+ * @return the partial to fold the record into.
+ ******************************************************************************************************
+ */
+static native_aggregate_partial*
+native_aggregate_partial_get(native_aggregate* aggregate_p, bool* locked_p)
+{
+	native_aggregate_partial    *partial_p = NULL;
+	pthread_t                   self = pthread_self();
+	uint32_t                    n_partials = *(volatile uint32_t *) &aggregate_p->n_partials;
+	uint32_t                    iter = 0;
+
+	/* Only this thread claims a partial for itself, so a claimed one is seen here. */
+	for (iter = 0; iter < n_partials; iter++) {
+		if (pthread_equal(aggregate_p->partials[iter].thread, self)) {
+			return &aggregate_p->partials[iter];
+		}
+	}
+
+	pthread_mutex_lock(&aggregate_p->lock);
+	n_partials = aggregate_p->n_partials;
+	if (n_partials == NATIVE_AGGREGATE_PARTIALS) {
+		*locked_p = true;
+		return &aggregate_p->shared;
+	}
+	partial_p = &aggregate_p->partials[n_partials];
+	partial_p->thread = self;
+	as_hashmap_init(&partial_p->buckets, 32);
+	__sync_synchronize();
+	aggregate_p->n_partials = n_partials + 1;
+	pthread_mutex_unlock(&aggregate_p->lock);
+
+	return partial_p;
+}
+
+/*
+ ******************************************************************************************************
+ * Merges a partial into the native_aggregate, on the PHP thread once the scan
+ * or query returned.
+ ******************************************************************************************************
+ */
+static void
+native_aggregate_merge(native_aggregate* aggregate_p, native_aggregate_partial* partial_p)
+{
+	as_hashmap_iterator     iterator;
+	int                     kind = 0;
+
+	aggregate_p->records += partial_p->records;
+	for (kind = 0; kind < NATIVE_AGGREGATE_HISTOGRAM; kind++) {
+		native_aggregate_bin    *bin_p = &aggregate_p->bins[kind];
+		native_aggregate_bin    *part_p = &partial_p->bins[kind];
+
+		if (!bin_p->enabled) {
+			continue;
+		}
+		if (part_p->has_int) {
+			if (kind == NATIVE_AGGREGATE_SUM) {
+				native_aggregate_sum_add(aggregate_p, &bin_p->int_value, part_p->int_value);
+			} else if ((!bin_p->has_int) || ((kind == NATIVE_AGGREGATE_MIN) ?
+						(part_p->int_value < bin_p->int_value) :
+						(part_p->int_value > bin_p->int_value))) {
+				bin_p->int_value = part_p->int_value;
+			}
+			bin_p->has_int = true;
+		}
+		if (part_p->has_double) {
+			if (kind == NATIVE_AGGREGATE_SUM) {
+				bin_p->double_value += part_p->double_value;
+			} else if ((!bin_p->has_double) || ((kind == NATIVE_AGGREGATE_MIN) ?
+						(part_p->double_value < bin_p->double_value) :
+						(part_p->double_value > bin_p->double_value))) {
+				bin_p->double_value = part_p->double_value;
+			}
+			bin_p->has_double = true;
+		}
+	}
+
+	as_hashmap_iterator_init(&iterator, &partial_p->buckets);
+	while (as_hashmap_iterator_has_next(&iterator)) {
+		as_pair *pair_p = (as_pair *) as_hashmap_iterator_next(&iterator);
+
+		native_aggregate_bucket_add(aggregate_p, &aggregate_p->buckets,
+				as_integer_get((as_integer *) as_pair_1(pair_p)),
+				as_integer_get((as_integer *) as_pair_2(pair_p)));
+	}
+	as_hashmap_iterator_destroy(&iterator);
+}
+
+/*
+ ******************************************************************************************************
+ * Callback for the scan or query of aggregateNative(), folding one record
+ * into the native aggregates.
+ *
+ * @param val_p                     The record streamed, NULL at the end.
+ * @param udata_p                   The native_aggregate.
+ *
+ * @return true to continue the scan or query, false once the histogram has
+ *         too many buckets or an integer sum overflowed.
+ ******************************************************************************************************
+ */
+static bool
+native_aggregate_callback(const as_val* val_p, void* udata_p)
+{
+	native_aggregate*           aggregate_p = (native_aggregate *) udata_p;
+	native_aggregate_partial*   partial_p = NULL;
+	as_record*                  record_p = NULL;
+	as_val*                     bin_val_p = NULL;
+	int                         kind = 0;
+	bool                        locked = false;
+
+	if ((!val_p) || (NULL == (record_p = as_record_fromval(val_p)))) {
+		return true;
+	}
+
+	partial_p = native_aggregate_partial_get(aggregate_p, &locked);
+	partial_p->records++;
+	for (kind = 0; kind < NATIVE_AGGREGATE_BINS; kind++) {
+		native_aggregate_bin    *bin_p = &partial_p->bins[kind];
+		int64_t                 int_value = 0;
+		double                  double_value = 0;
+
+		if ((!aggregate_p->bins[kind].enabled) ||
+				(NULL == (bin_val_p = (as_val *) as_record_get(record_p,
+					aggregate_p->bins[kind].bin)))) {
+			continue;
+		}
+
+		if (as_val_type(bin_val_p) == AS_INTEGER) {
+			int_value = as_integer_get((as_integer *) bin_val_p);
+			switch (kind) {
+				case NATIVE_AGGREGATE_SUM:
+					native_aggregate_sum_add(aggregate_p, &bin_p->int_value, int_value);
+					break;
+				case NATIVE_AGGREGATE_MIN:
+					if (!bin_p->has_int || int_value < bin_p->int_value) {
+						bin_p->int_value = int_value;
+					}
+					break;
+				case NATIVE_AGGREGATE_MAX:
+					if (!bin_p->has_int || int_value > bin_p->int_value) {
+						bin_p->int_value = int_value;
+					}
+					break;
+				default:
+					native_aggregate_value_add(aggregate_p, partial_p, (double) int_value);
+					break;
+			}
+			bin_p->has_int = true;
+		} else if (as_val_type(bin_val_p) == AS_DOUBLE) {
+			double_value = as_double_get((as_double *) bin_val_p);
+			switch (kind) {
+				case NATIVE_AGGREGATE_SUM:
+					bin_p->double_value += double_value;
+					break;
+				case NATIVE_AGGREGATE_MIN:
+					if (!bin_p->has_double || double_value < bin_p->double_value) {
+						bin_p->double_value = double_value;
+					}
+					break;
+				case NATIVE_AGGREGATE_MAX:
+					if (!bin_p->has_double || double_value > bin_p->double_value) {
+						bin_p->double_value = double_value;
+					}
+					break;
+				default:
+					native_aggregate_value_add(aggregate_p, partial_p, double_value);
+					break;
+			}
+			bin_p->has_double = true;
+		}
+	}
+	if (locked) {
+		pthread_mutex_unlock(&aggregate_p->lock);
+	}
+
+	return !(*(volatile bool *) &aggregate_p->overflow) &&
+		!(*(volatile bool *) &aggregate_p->sum_overflow);
+}
+
+/*
+ ******************************************************************************************************
+ * Compares two histogram buckets by their start, for qsort().
+ ******************************************************************************************************
+ */
+static int
+native_aggregate_bucket_compare(const void* left_p, const void* right_p)
+{
+	int64_t     left = ((const native_aggregate_bucket *) left_p)->start;
+	int64_t     right = ((const native_aggregate_bucket *) right_p)->start;
+
+	return (left > right) - (left < right);
+}
+
+/*
+ ******************************************************************************************************
+ * Adds the folded value of a sum, min or max aggregate to the result array.
+ * Integer bins give an integer, a double anywhere in the values gives a
+ * double, and a min or max without any numeric value gives NULL.
+ ******************************************************************************************************
+ */
+static void
+native_aggregate_add_value(zval* result_p, int kind, native_aggregate_bin* bin_p)
+{
+	const char      *name_p = native_aggregate_names[kind];
+	double          double_value = bin_p->double_value;
+
+	if (kind == NATIVE_AGGREGATE_SUM) {
+		if (bin_p->has_double) {
+			add_assoc_double(result_p, name_p, (double) bin_p->int_value + double_value);
+		} else {
+			add_assoc_long(result_p, name_p, bin_p->int_value);
+		}
+	} else if (bin_p->has_int && bin_p->has_double) {
+		if ((kind == NATIVE_AGGREGATE_MIN) ?
+				((double) bin_p->int_value < double_value) :
+				((double) bin_p->int_value > double_value)) {
+			add_assoc_long(result_p, name_p, bin_p->int_value);
+		} else {
+			add_assoc_double(result_p, name_p, double_value);
+		}
+	} else if (bin_p->has_int) {
+		add_assoc_long(result_p, name_p, bin_p->int_value);
+	} else if (bin_p->has_double) {
+		add_assoc_double(result_p, name_p, double_value);
+	} else {
+		add_assoc_null(result_p, name_p);
+	}
+}
+
+/*
+ ******************************************************************************************************
+ * Adds the histogram to the result array, as bucket start => record count
+ * in ascending order of the buckets.
+ ******************************************************************************************************
+ */
+static void
+native_aggregate_add_histogram(zval* result_p, native_aggregate* aggregate_p TSRMLS_DC)
+{
+	as_hashmap_iterator         iterator;
+	native_aggregate_bucket*    buckets_p = NULL;
+	uint32_t                    n_buckets = 0;
+	uint32_t                    iter = 0;
+#if PHP_VERSION_ID < 70000
+	zval*                       histogram_p = NULL;
+
+	MAKE_STD_ZVAL(histogram_p);
+#else
+	zval                        histogram;
+	zval*                       histogram_p = &histogram;
+#endif
+
+	array_init(histogram_p);
+	n_buckets = as_hashmap_size(&aggregate_p->buckets);
+	if (n_buckets > 0) {
+		buckets_p = (native_aggregate_bucket *) emalloc(n_buckets * sizeof(native_aggregate_bucket));
+		as_hashmap_iterator_init(&iterator, &aggregate_p->buckets);
+		while (as_hashmap_iterator_has_next(&iterator) && iter < n_buckets) {
+			as_pair *pair_p = (as_pair *) as_hashmap_iterator_next(&iterator);
+
+			buckets_p[iter].start = as_integer_get((as_integer *) as_pair_1(pair_p));
+			buckets_p[iter].count = as_integer_get((as_integer *) as_pair_2(pair_p));
+			iter++;
+		}
+		as_hashmap_iterator_destroy(&iterator);
+
+		qsort(buckets_p, iter, sizeof(native_aggregate_bucket), native_aggregate_bucket_compare);
+		for (n_buckets = iter, iter = 0; iter < n_buckets; iter++) {
+			add_index_long(histogram_p, buckets_p[iter].start, buckets_p[iter].count);
+		}
+		efree(buckets_p);
+	}
+	add_assoc_zval(result_p, native_aggregate_names[NATIVE_AGGREGATE_HISTOGRAM], histogram_p);
+}
+
+/*
+ ******************************************************************************************************
+ * Computes count, sum, min, max and histogram aggregates over the records of
+ * a set, or over the records matching a query predicate, without a stream UDF.
+ * Only the bins the aggregates need are selected, and the records are folded
+ * in C as they are streamed, so no zval is built per record.
+ * With an empty predicate the set is scanned, and a count alone is computed
+ * from the record metadata without reading any bin.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param namespace_p               The namespace to aggregate.
+ * @param set_p                     The set to aggregate.
+ * @param predicate_ht_p            The HashTable for Query Predicate array.
+ * @param aggregates_ht_p           The HashTable for the aggregates array.
+ * @param return_value_p            The array to be populated with the aggregates.
+ * @param options_p                 The optional policy.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+extern as_status
+aerospike_query_aggregate_native(aerospike* as_object_p, as_error* error_p,
+		char* namespace_p, char* set_p, HashTable* predicate_ht_p,
+		HashTable* aggregates_ht_p, zval* return_value_p, zval* options_p TSRMLS_DC)
+{
+	native_aggregate        aggregate;
+	as_query                query;
+	as_scan                 scan;
+	as_policy_query         query_policy;
+	as_policy_scan          scan_policy;
+	bool                    is_init_query = false;
+	bool                    is_init_scan = false;
+	bool                    is_scan = (!predicate_ht_p) ||
+		(zend_hash_num_elements(predicate_ht_p) == 0);
+	uint16_t                n_bins = 0;
+	int                     kind = 0;
+	int                     other = 0;
+	uint32_t                iter = 0;
+	int                     selected[NATIVE_AGGREGATE_BINS];
+	DECLARE_ZVAL_P(predicate_bin_pp);
+
+	memset(&aggregate, 0, sizeof(aggregate));
+	pthread_mutex_init(&aggregate.lock, NULL);
+	as_hashmap_init(&aggregate.buckets, 32);
+	as_hashmap_init(&aggregate.shared.buckets, 32);
+
+	if ((!as_object_p) || (!error_p) || (!namespace_p) || (!aggregates_ht_p) ||
+			(!return_value_p)) {
+		DEBUG_PHP_EXT_DEBUG("Unable to initiate native aggregation");
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to initiate native aggregation");
+		goto exit;
+	}
+
+	if (AEROSPIKE_OK != native_aggregate_parse(&aggregate, aggregates_ht_p,
+				error_p TSRMLS_CC)) {
+		DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+		goto exit;
+	}
+
+	/* Each distinct bin is selected once, whichever aggregates read it. */
+	for (kind = 0; kind < NATIVE_AGGREGATE_BINS; kind++) {
+		selected[kind] = 0;
+		if (!aggregate.bins[kind].enabled) {
+			continue;
+		}
+		for (other = 0; other < kind; other++) {
+			if (selected[other] &&
+					!strcmp(aggregate.bins[other].bin, aggregate.bins[kind].bin)) {
+				break;
+			}
+		}
+		if (other == kind) {
+			selected[kind] = 1;
+			n_bins++;
+		}
+	}
+
+	if (is_scan) {
+		as_scan_init(&scan, namespace_p, set_p);
+		is_init_scan = true;
+		set_policy_scan(&as_object_p->config, &scan_policy, NULL, &scan,
+				options_p, error_p TSRMLS_CC);
+		if (AEROSPIKE_OK != (error_p->code)) {
+			DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+			goto exit;
+		}
+		if (n_bins == 0) {
+			as_scan_set_nobins(&scan, true);
+		} else {
+			as_scan_select_inita(&scan, n_bins);
+			for (kind = 0; kind < NATIVE_AGGREGATE_BINS; kind++) {
+				if (selected[kind]) {
+					as_scan_select(&scan, aggregate.bins[kind].bin);
+				}
+			}
+		}
+		if (AEROSPIKE_OK != (aerospike_latency_scan_foreach(as_object_p, error_p,
+						&scan_policy, &scan, native_aggregate_callback, &aggregate))) {
+			DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+			goto exit;
+		}
+	} else {
+		set_policy(&as_object_p->config, NULL, NULL, NULL, NULL, NULL, NULL,
+				&query_policy, NULL, options_p, error_p TSRMLS_CC);
+		if (AEROSPIKE_OK != (error_p->code)) {
+			DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+			goto exit;
+		}
+		as_query_init(&query, namespace_p, set_p);
+		is_init_query = true;
+		as_query_where_inita(&query, 1);
+		if (AEROSPIKE_OK != (aerospike_query_define(&query, error_p, namespace_p,
+						set_p, predicate_ht_p, NULL, NULL, NULL TSRMLS_CC))) {
+			DEBUG_PHP_EXT_DEBUG("Unable to define query");
+			goto exit;
+		}
+
+		/*
+		 * A query cannot skip the bins, a count alone selects the predicate's
+		 * bin rather than all of them.
+		 */
+		if (n_bins == 0) {
+#if PHP_VERSION_ID < 70000
+			if (SUCCESS == zend_hash_find(predicate_ht_p, BIN, sizeof(BIN),
+						(void **) &predicate_bin_pp)) {
+#else
+			if (NULL != (predicate_bin_pp = zend_hash_str_find(predicate_ht_p, BIN,
+							strlen(BIN)))) {
+#endif
+				as_query_select_inita(&query, 1);
+				as_query_select(&query, AEROSPIKE_Z_STRVAL_P(predicate_bin_pp));
+			}
+		} else {
+			as_query_select_inita(&query, n_bins);
+			for (kind = 0; kind < NATIVE_AGGREGATE_BINS; kind++) {
+				if (selected[kind]) {
+					as_query_select(&query, aggregate.bins[kind].bin);
+				}
+			}
+		}
+		if (AEROSPIKE_OK != (aerospike_latency_query_foreach(as_object_p, error_p,
+						&query_policy, &query, native_aggregate_callback, &aggregate))) {
+			DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+			goto exit;
+		}
+	}
+
+	for (iter = 0; iter < aggregate.n_partials; iter++) {
+		native_aggregate_merge(&aggregate, &aggregate.partials[iter]);
+	}
+	native_aggregate_merge(&aggregate, &aggregate.shared);
+
+	if (aggregate.overflow) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+				"Too many histogram buckets, use a larger bucket width");
+		goto exit;
+	}
+	if (aggregate.sum_overflow) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+				"Integer sum overflow, the sum does not fit in 64 bits");
+		goto exit;
+	}
+
+	if (aggregate.count) {
+		add_assoc_long(return_value_p, "count", (long) aggregate.records);
+	}
+	for (kind = 0; kind < NATIVE_AGGREGATE_HISTOGRAM; kind++) {
+		if (aggregate.bins[kind].enabled) {
+			native_aggregate_add_value(return_value_p, kind, &aggregate.bins[kind]);
+		}
+	}
+	if (aggregate.bins[NATIVE_AGGREGATE_HISTOGRAM].enabled) {
+		native_aggregate_add_histogram(return_value_p, &aggregate TSRMLS_CC);
+	}
+
+exit:
+	if (is_init_scan) {
+		as_scan_destroy(&scan);
+	}
+	if (is_init_query) {
+		as_query_destroy(&query);
+	}
+	for (iter = 0; iter < aggregate.n_partials; iter++) {
+		as_hashmap_destroy(&aggregate.partials[iter].buckets);
+	}
+	as_hashmap_destroy(&aggregate.shared.buckets);
+	as_hashmap_destroy(&aggregate.buckets);
+	pthread_mutex_destroy(&aggregate.lock);
+	return error_p->code;
+}
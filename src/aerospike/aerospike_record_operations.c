@@ -23,6 +23,7 @@
 #include "aerospike/as_error.h"
 #include "aerospike/as_record.h"
 #include "aerospike/as_boolean.h"
+#include "aerospike/as_msgpack.h"
 #include "string.h"
 #include "aerospike_common.h"
 #include "aerospike_policy.h"
@@ -142,6 +143,39 @@ extern bool operater_ordered_callback(const char *key, const as_val *value, void
 }
 
 
+/*
+ *******************************************************************************************************
+ * Function to copy a value of an operation out of the static pool it was
+ * built in, so the as_operations own a value which outlives the pool.
+ * Only operations prepared for operateAsync() need it, a synchronous
+ * operate() is executed while the pool is still there.
+ *
+ * @return the copy, NULL if val_p is NULL or cannot be copied.
+ *******************************************************************************************************
+ */
+static as_val*
+aerospike_record_operations_copy_val(as_val* val_p)
+{
+	as_serializer       serializer;
+	as_buffer           buffer;
+	as_val*             copy_p = NULL;
+
+	if (!val_p) {
+		return NULL;
+	}
+
+	as_msgpack_init(&serializer);
+	as_buffer_init(&buffer);
+	if (0 == as_serializer_serialize(&serializer, val_p, &buffer)) {
+		as_serializer_deserialize(&serializer, &buffer, &copy_p);
+	}
+	as_buffer_destroy(&buffer);
+	as_serializer_destroy(&serializer);
+
+	return copy_p;
+}
+
+
 /*
  *******************************************************************************************************
  * Wrapper function to perform an aerospike_key_oeprate within the C client.
@@ -182,6 +216,7 @@ aerospike_record_operations_ops(Aerospike_object *aerospike_obj_p,
 								#endif
 								, as_policy_operate* operate_policy,
 								int8_t serializer_policy,
+								bool copy_values,
 								as_record** get_rec TSRMLS_DC)
 {
 	as_val*                value_p = NULL;
@@ -293,6 +328,9 @@ aerospike_record_operations_ops(Aerospike_object *aerospike_obj_p,
 				goto exit;
 			}
 			val = (as_val*) as_record_get(&record, bin_name_p);
+			if (copy_values) {
+				val = aerospike_record_operations_copy_val(val);
+			}
 			if (val) {
 				if (!as_operations_add_list_append(ops, bin_name_p, val)) {
 					PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to append");
@@ -321,6 +359,9 @@ aerospike_record_operations_ops(Aerospike_object *aerospike_obj_p,
 				goto exit;
 			}
 			val = (as_val*) as_record_get(&record, bin_name_p);
+			if (copy_values) {
+				val = aerospike_record_operations_copy_val(val);
+			}
 			if (val) {
 				if (!as_operations_add_list_insert(ops, bin_name_p, index, val)) {
 					PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to insert");
@@ -342,7 +383,9 @@ aerospike_record_operations_ops(Aerospike_object *aerospike_obj_p,
 					error_p TSRMLS_CC);
 
 			if (error_p->code == AEROSPIKE_OK) {
-				if (!as_operations_add_list_append_items(ops, bin_name_p, (as_list*)args_list_p)) {
+				val = copy_values ?
+					aerospike_record_operations_copy_val((as_val*) args_list_p) : (as_val*) args_list_p;
+				if ((!val) || (!as_operations_add_list_append_items(ops, bin_name_p, (as_list*) val))) {
 					PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to insert items.");
 					DEBUG_PHP_EXT_DEBUG("Unable to insert items.");
 					goto exit;
@@ -409,6 +452,9 @@ aerospike_record_operations_ops(Aerospike_object *aerospike_obj_p,
 				goto exit;
 			}
 			val = (as_val*) as_record_get(&record, bin_name_p);
+			if (copy_values) {
+				val = aerospike_record_operations_copy_val(val);
+			}
 			if (val) {
 				if (!as_operations_add_list_set(ops, bin_name_p, index, val)){
 					PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to set.");
@@ -470,7 +516,7 @@ exit:
  *******************************************************************************************************
  * Wrapper function to perform an aerospike_key_exists within the C client.
  *
- * @param as_object_p           The C client's aerospike object.
+ * @param aerospike_obj_p       The Aerospike_object upon which exists is invoked.
  * @param as_key_p              The C client's as_key that identifies the record.
  * @param error_p               The as_error to be populated by the function
  *                              with the encountered error if any.
@@ -480,7 +526,7 @@ exit:
  *
  *******************************************************************************************************
  */
-extern as_status aerospike_record_operations_exists(aerospike* as_object_p,
+extern as_status aerospike_record_operations_exists(Aerospike_object* aerospike_obj_p,
 		as_key* as_key_p,
 		as_error *error_p,
 		zval* metadata_p,
@@ -488,6 +534,8 @@ extern as_status aerospike_record_operations_exists(aerospike* as_object_p,
 {
 	as_policy_read              read_policy;
 	as_record*                  record_p = NULL;
+	aerospike*                  as_object_p = aerospike_obj_p->as_ref_p->as_p;
+	int32_t                     hedge_delay = 0;
 
 	if ((!as_key_p) || (!error_p) || (!as_object_p) || (!metadata_p)) {
 		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Cannot perform exists");
@@ -495,15 +543,22 @@ extern as_status aerospike_record_operations_exists(aerospike* as_object_p,
 		goto exit;
 	}
 
-	set_policy(&as_object_p->config, &read_policy, NULL, NULL, NULL, NULL,
-			NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
+	set_policy_for_key(aerospike_obj_p, as_key_p, &read_policy, NULL, NULL, NULL,
+			NULL, NULL, options_p, error_p TSRMLS_CC);
 	if (AEROSPIKE_OK != error_p->code) {
 		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
 		goto exit;
 	}
 
-	if (AEROSPIKE_OK != aerospike_key_exists(as_object_p, error_p,
-				&read_policy, as_key_p, &record_p)) {
+	if (AEROSPIKE_OK != get_options_hedge_delay_value(options_p, &hedge_delay,
+				error_p TSRMLS_CC)) {
+		DEBUG_PHP_EXT_DEBUG("Unable to get hedge delay");
+		goto exit;
+	}
+
+	if (AEROSPIKE_OK != aerospike_latency_hedged_read(as_object_p, error_p,
+				&read_policy, as_key_p, NULL, true, &record_p,
+				hedge_delay TSRMLS_CC)) {
 		goto exit;
 	}
 
@@ -547,8 +602,8 @@ aerospike_record_operations_remove(Aerospike_object* aerospike_obj_p,
 		goto exit;
 	}
 
-	set_policy(&as_object_p->config, NULL, NULL, NULL, &remove_policy,
-			NULL, NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
+	set_policy_for_key(aerospike_obj_p, as_key_p, NULL, NULL, NULL, &remove_policy,
+			NULL, NULL, options_p, error_p TSRMLS_CC);
 	if (AEROSPIKE_OK != error_p->code) {
 		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
 		goto exit;
@@ -556,7 +611,7 @@ aerospike_record_operations_remove(Aerospike_object* aerospike_obj_p,
 
 	get_generation_value(options_p, &remove_policy.generation, error_p TSRMLS_CC);
 	if (error_p->code == AEROSPIKE_OK) {
-		aerospike_key_remove(as_object_p, error_p, &remove_policy, as_key_p);
+		aerospike_latency_key_remove(as_object_p, error_p, &remove_policy, as_key_p);
 	}
 
 exit:
@@ -564,13 +619,15 @@ exit:
 }
 
 static as_status
-aerospike_record_initialization(aerospike* as_object_p,
+aerospike_record_initialization(Aerospike_object* aerospike_obj_p,
 		as_key* as_key_p,
 		zval* options_p,
 		as_error* error_p,
 		as_policy_operate* operate_policy,
 		int8_t* serializer_policy TSRMLS_DC)
 {
+	aerospike*          as_object_p = aerospike_obj_p->as_ref_p->as_p;
+
 	as_policy_operate_init(operate_policy);
 
 	if ((!as_object_p) || (!error_p) || (!as_key_p)) {
@@ -579,8 +636,8 @@ aerospike_record_initialization(aerospike* as_object_p,
 		goto exit;
 	}
 
-	set_policy(&as_object_p->config, NULL, NULL, operate_policy, NULL, NULL,
-			NULL, NULL, serializer_policy, options_p, error_p TSRMLS_CC);
+	set_policy_for_key(aerospike_obj_p, as_key_p, NULL, NULL, operate_policy, NULL,
+			NULL, serializer_policy, options_p, error_p TSRMLS_CC);
 	if (AEROSPIKE_OK != error_p->code) {
 		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
 		goto exit;
@@ -618,7 +675,7 @@ aerospike_record_operations_general(Aerospike_object* aerospike_obj_p,
 	if (error_p->code != AEROSPIKE_OK) {
 		goto exit;
 	}
-	if (AEROSPIKE_OK != aerospike_record_initialization(as_object_p, as_key_p,
+	if (AEROSPIKE_OK != aerospike_record_initialization(aerospike_obj_p, as_key_p,
 				options_p, error_p,
 				&operate_policy,
 				&serializer_policy TSRMLS_CC)) {
@@ -630,7 +687,7 @@ aerospike_record_operations_general(Aerospike_object* aerospike_obj_p,
 				options_p, error_p,
 				bin_name_p, str, NULL,
 				offset, double_offset, time_to_live, 0, operation,
-				&ops, NULL, NULL, 0, &get_rec TSRMLS_CC)) {
+				&ops, NULL, NULL, 0, false, &get_rec TSRMLS_CC)) {
 
 		DEBUG_PHP_EXT_ERROR("Prepend function returned an error");
 		goto exit;
@@ -638,7 +695,7 @@ aerospike_record_operations_general(Aerospike_object* aerospike_obj_p,
 
 
 	if (AEROSPIKE_OK == get_options_ttl_value(options_p, &ops.ttl, error_p TSRMLS_CC)) {
-		aerospike_key_operate(as_object_p, error_p, &operate_policy,
+		aerospike_latency_key_operate(as_object_p, error_p, &operate_policy,
 				as_key_p, &ops, NULL);
 	}
 
@@ -651,18 +708,17 @@ exit:
 }
 
 extern as_status
-aerospike_record_operations_operate(Aerospike_object* aerospike_obj_p,
+aerospike_record_operations_operate_prepare(Aerospike_object* aerospike_obj_p,
 		as_key* as_key_p,
 		zval* options_p,
 		as_error* error_p,
-		zval* returned_p,
-		HashTable* operations_array_p)
+		HashTable* operations_array_p,
+		as_operations* ops_p,
+		as_policy_operate* operate_policy_p,
+		bool copy_values)
 {
-	as_operations               ops;
-	as_record*                  get_rec = NULL;
 	aerospike*                  as_object_p = aerospike_obj_p->as_ref_p->as_p;
 	as_status                   status = AEROSPIKE_OK;
-	as_policy_operate           operate_policy;
 	HashPosition                pointer;
 	HashPosition                each_pointer;
 	char*                       bin_name_p;
@@ -683,20 +739,17 @@ aerospike_record_operations_operate(Aerospike_object* aerospike_obj_p,
 	int8_t                      serializer_policy;
 	uint32_t                    ttl;
 	int64_t                     index;
-	foreach_callback_udata      foreach_record_callback_udata;
 
 	TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
-	as_operations_inita(&ops, zend_hash_num_elements(operations_array_p));
-
-	get_generation_value(options_p, &ops.gen, error_p TSRMLS_CC);
+	get_generation_value(options_p, &ops_p->gen, error_p TSRMLS_CC);
 	if (error_p->code != AEROSPIKE_OK) {
 		goto exit;
 	}
 
 	if (AEROSPIKE_OK !=
-			(status = aerospike_record_initialization(as_object_p, as_key_p,
+			(status = aerospike_record_initialization(aerospike_obj_p, as_key_p,
 													  options_p, error_p,
-													  &operate_policy,
+													  operate_policy_p,
 													  &serializer_policy TSRMLS_CC))) {
 		DEBUG_PHP_EXT_ERROR("Initialization returned error");
 		goto exit;
@@ -881,8 +934,8 @@ aerospike_record_operations_operate(Aerospike_object* aerospike_obj_p,
 
 			if (AEROSPIKE_OK != (status = aerospike_record_operations_ops(aerospike_obj_p, as_object_p,
 							as_key_p, options_p, error_p, bin_name_p, str, geoStr,
-							offset, double_offset, ttl, index, op, &ops, each_operation, &operate_policy,
-							serializer_policy, &temp_rec TSRMLS_CC))) {
+							offset, double_offset, ttl, index, op, ops_p, each_operation, operate_policy_p,
+							serializer_policy, copy_values, &temp_rec TSRMLS_CC))) {
 				DEBUG_PHP_EXT_ERROR("Operate function returned an error");
 				goto exit;
 			}
@@ -898,11 +951,36 @@ aerospike_record_operations_operate(Aerospike_object* aerospike_obj_p,
 	ZEND_HASH_FOREACH_END();
 #endif
 
-	if (AEROSPIKE_OK != get_options_ttl_value(options_p, &ops.ttl, error_p TSRMLS_CC)) {
+	get_options_ttl_value(options_p, &ops_p->ttl, error_p TSRMLS_CC);
+
+exit:
+	return status;
+}
+
+extern as_status
+aerospike_record_operations_operate(Aerospike_object* aerospike_obj_p,
+		as_key* as_key_p,
+		zval* options_p,
+		as_error* error_p,
+		zval* returned_p,
+		HashTable* operations_array_p)
+{
+	as_operations               ops;
+	as_record*                  get_rec = NULL;
+	aerospike*                  as_object_p = aerospike_obj_p->as_ref_p->as_p;
+	as_status                   status = AEROSPIKE_OK;
+	as_policy_operate           operate_policy;
+	foreach_callback_udata      foreach_record_callback_udata;
+
+	as_operations_inita(&ops, zend_hash_num_elements(operations_array_p));
+
+	if ((AEROSPIKE_OK != (status = aerospike_record_operations_operate_prepare(aerospike_obj_p,
+						as_key_p, options_p, error_p, operations_array_p, &ops,
+						&operate_policy, false))) || (AEROSPIKE_OK != error_p->code)) {
 		goto exit;
 	}
 
-	if (AEROSPIKE_OK != (status = aerospike_key_operate(as_object_p, error_p,
+	if (AEROSPIKE_OK != (status = aerospike_latency_key_operate(as_object_p, error_p,
 					&operate_policy, as_key_p, &ops, &get_rec))) {
 		DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
 		goto exit;
@@ -980,7 +1058,7 @@ aerospike_record_operations_operate_ordered(Aerospike_object* aerospike_obj_p,
 	TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
 
 	if (AEROSPIKE_OK !=
-			(status = aerospike_record_initialization(as_object_p, as_key_p,
+			(status = aerospike_record_initialization(aerospike_obj_p, as_key_p,
 													  options_p, error_p,
 													  &operate_policy,
 													  &serializer_policy TSRMLS_CC))) {
@@ -1165,7 +1243,7 @@ aerospike_record_operations_operate_ordered(Aerospike_object* aerospike_obj_p,
 			if (AEROSPIKE_OK != (status = aerospike_record_operations_ops(aerospike_obj_p, as_object_p,
 							as_key_p, options_p, error_p, bin_name_p, str, geoStr,
 							offset, double_offset, ttl, index, op, &ops, each_operation, &operate_policy,
-							serializer_policy, &temp_rec TSRMLS_CC))) {
+							serializer_policy, false, &temp_rec TSRMLS_CC))) {
 				DEBUG_PHP_EXT_ERROR("Operate function returned an error");
 				goto exit;
 			}
@@ -1184,7 +1262,7 @@ aerospike_record_operations_operate_ordered(Aerospike_object* aerospike_obj_p,
 		foreach_record_callback_udata.error_p = error_p;
 		foreach_record_callback_udata.obj = aerospike_obj_p;
 
-		if (AEROSPIKE_OK != (status = aerospike_key_operate(as_object_p, error_p,
+		if (AEROSPIKE_OK != (status = aerospike_latency_key_operate(as_object_p, error_p,
 						&operate_policy, as_key_p, &ops, &get_rec))) {
 			DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
 			operater_ordered_callback(bin_name_p, NULL, &foreach_record_callback_udata TSRMLS_CC);
@@ -1313,8 +1391,8 @@ aerospike_record_operations_remove_bin(Aerospike_object* aerospike_obj_p,
 		goto exit;
 	}
 
-	set_policy(&as_object_p->config, NULL, &write_policy, NULL, NULL, NULL,
-			NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
+	set_policy_for_key(aerospike_obj_p, as_key_p, NULL, &write_policy, NULL, NULL,
+			NULL, NULL, options_p, error_p TSRMLS_CC);
 	if (AEROSPIKE_OK != (status = (error_p->code))) {
 		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
 		goto exit;
@@ -1338,8 +1416,8 @@ aerospike_record_operations_remove_bin(Aerospike_object* aerospike_obj_p,
 	if (error_p->code == AEROSPIKE_OK) {
 		if (AEROSPIKE_OK == get_options_ttl_value(options_p, &rec.ttl,
 					error_p TSRMLS_CC)) {
-			if (AEROSPIKE_OK != (status = aerospike_key_put(as_object_p, error_p,
-							NULL, as_key_p, &rec))) {
+			if (AEROSPIKE_OK != (status = aerospike_latency_key_put(as_object_p, error_p,
+							&write_policy, as_key_p, &rec))) {
 				goto exit;
 			}
 		}
@@ -1416,7 +1494,7 @@ aerospike_php_exists_metadata(Aerospike_object* aerospike_obj_p,
 	}
 
 	if (AEROSPIKE_OK != (status =
-				aerospike_record_operations_exists(as_object_p, &as_key_for_put_record,
+				aerospike_record_operations_exists(aerospike_obj_p, &as_key_for_put_record,
 					error_p, metadata_p, options_p TSRMLS_CC))) {
 		DEBUG_PHP_EXT_ERROR("exists/getMetadata: unable to fetch the record");
 		goto exit;
@@ -27,6 +27,9 @@
 #include "aerospike/as_udf.h"
 #include "aerospike/as_scan.h"
 #include "aerospike/aerospike_scan.h"
+#include "aerospike/as_cluster.h"
+#include "aerospike/as_node.h"
+#include "aerospike/as_record.h"
 #include "aerospike_policy.h"
 
 #define PROGRESS_PCT "progress_pct"
@@ -104,12 +107,12 @@ aerospike_scan_run(aerospike* as_object_p, as_error* error_p, char* namespace_p,
 
 	scan_p->concurrent = false;
 
-		if (AEROSPIKE_OK != (aerospike_scan_foreach(as_object_p, error_p, &scan_policy,
+		if (AEROSPIKE_OK != (aerospike_latency_scan_foreach(as_object_p, error_p, &scan_policy,
 						&scan, aerospike_helper_record_stream_callback, user_func_p))) {
 			goto exit;
 		}
 	} else {
-		if (AEROSPIKE_OK != (aerospike_scan_foreach(as_object_p, error_p, NULL,
+		if (AEROSPIKE_OK != (aerospike_latency_scan_foreach(as_object_p, error_p, NULL,
 						&scan, aerospike_helper_record_stream_callback, user_func_p))) {
 			goto exit;
 		}
@@ -121,6 +124,355 @@ exit:
 	return error_p->code;
 }
 
+/*
+ ******************************************************************************************************
+ * Resumable scans of Aerospike::scanCursor().
+ * The scan is run one node at a time, and the cursor records the nodes whose
+ * scan completed as well as the partitions whose records were all delivered
+ * by them, so a resumed scan skips both. Records are filtered to the
+ * partition range of the cursor, which lets a set be split across workers.
+ ******************************************************************************************************
+ */
+#define SCAN_CURSOR_PARTITIONS          4096
+#define SCAN_CURSOR_MAX_NODES           128
+
+typedef struct scan_cursor_s {
+	userland_callback   *user_func_p;
+	uint32_t            partition_begin;
+	uint32_t            partition_count;
+	uint8_t             done[SCAN_CURSOR_PARTITIONS / 8];
+	uint8_t             seen[SCAN_CURSOR_PARTITIONS / 8];
+	char                nodes_done[SCAN_CURSOR_MAX_NODES][AS_NODE_NAME_SIZE];
+	uint32_t            n_nodes_done;
+	bool                stopped;
+} scan_cursor;
+
+/*
+ ******************************************************************************************************
+ * Finds the value of a key of the cursor array, NULL if it is missing.
+ ******************************************************************************************************
+ */
+static zval*
+scan_cursor_find(HashTable* cursor_ht_p, const char* key_p)
+{
+#if PHP_VERSION_ID < 70000
+	zval        **value_pp = NULL;
+
+	if (SUCCESS == zend_hash_find(cursor_ht_p, key_p, strlen(key_p) + 1,
+				(void **) &value_pp)) {
+		return *value_pp;
+	}
+	return NULL;
+#else
+	return zend_hash_str_find(cursor_ht_p, key_p, strlen(key_p));
+#endif
+}
+
+/*
+ ******************************************************************************************************
+ * Loads a cursor array returned by a previous scanCursor(), or the partition
+ * range of a new one, into the scan_cursor.
+ *
+ * @param cursor_p                  The scan_cursor to be populated.
+ * @param cursor_zval_p             The user's cursor array, or NULL.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+static as_status
+scan_cursor_load(scan_cursor* cursor_p, zval* cursor_zval_p, as_error* error_p TSRMLS_DC)
+{
+	HashTable*          cursor_ht_p = NULL;
+	zval*               value_p = NULL;
+	HashPosition        pos;
+	DECLARE_ZVAL_P(node_pp);
+	uint32_t            iter = 0;
+	unsigned int        byte = 0;
+
+	cursor_p->partition_begin = 0;
+	cursor_p->partition_count = SCAN_CURSOR_PARTITIONS;
+	if (!cursor_zval_p || Z_TYPE_P(cursor_zval_p) != IS_ARRAY) {
+		goto exit;
+	}
+	cursor_ht_p = Z_ARRVAL_P(cursor_zval_p);
+
+	if (NULL != (value_p = scan_cursor_find(cursor_ht_p, "partition_begin"))) {
+		if ((Z_TYPE_P(value_p) != IS_LONG) || (Z_LVAL_P(value_p) < 0) ||
+				(Z_LVAL_P(value_p) >= SCAN_CURSOR_PARTITIONS)) {
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+					"Expects partition_begin to be an integer between 0 and 4095");
+			goto exit;
+		}
+		cursor_p->partition_begin = (uint32_t) Z_LVAL_P(value_p);
+	}
+	cursor_p->partition_count = SCAN_CURSOR_PARTITIONS - cursor_p->partition_begin;
+	if (NULL != (value_p = scan_cursor_find(cursor_ht_p, "partition_count"))) {
+		if ((Z_TYPE_P(value_p) != IS_LONG) || (Z_LVAL_P(value_p) <= 0) ||
+				(Z_LVAL_P(value_p) > cursor_p->partition_count)) {
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+					"Expects partition_count to be a positive integer within the 4096 partitions");
+			goto exit;
+		}
+		cursor_p->partition_count = (uint32_t) Z_LVAL_P(value_p);
+	}
+
+	if (NULL != (value_p = scan_cursor_find(cursor_ht_p, "partitions_done"))) {
+		if ((Z_TYPE_P(value_p) != IS_STRING) ||
+				(Z_STRLEN_P(value_p) != sizeof(cursor_p->done) * 2)) {
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+					"Expects partitions_done to be returned by a previous scanCursor()");
+			goto exit;
+		}
+		for (iter = 0; iter < sizeof(cursor_p->done); iter++) {
+			if (1 != sscanf(Z_STRVAL_P(value_p) + iter * 2, "%2x", &byte)) {
+				PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM,
+						"Expects partitions_done to be returned by a previous scanCursor()");
+				goto exit;
+			}
+			cursor_p->done[iter] = (uint8_t) byte;
+		}
+	}
+
+	if ((NULL != (value_p = scan_cursor_find(cursor_ht_p, "nodes_done"))) &&
+			(Z_TYPE_P(value_p) == IS_ARRAY)) {
+#if PHP_VERSION_ID < 70000
+		AEROSPIKE_FOREACH_HASHTABLE(Z_ARRVAL_P(value_p), pos, node_pp) {
+#else
+		ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(value_p), node_pp) {
+#endif
+			if ((AEROSPIKE_Z_TYPE_P(node_pp) == IS_STRING) &&
+					(cursor_p->n_nodes_done < SCAN_CURSOR_MAX_NODES)) {
+				strncpy(cursor_p->nodes_done[cursor_p->n_nodes_done],
+						AEROSPIKE_Z_STRVAL_P(node_pp), AS_NODE_NAME_SIZE - 1);
+				cursor_p->n_nodes_done++;
+			}
+		}
+#if PHP_VERSION_ID >= 70000
+		ZEND_HASH_FOREACH_END();
+#endif
+	}
+
+exit:
+	return error_p->code;
+}
+
+/*
+ ******************************************************************************************************
+ * Stores the scan_cursor into the user's cursor array, with complete set to
+ * whether every node of the cluster was scanned.
+ ******************************************************************************************************
+ */
+static void
+scan_cursor_store(scan_cursor* cursor_p, zval* cursor_zval_p, bool complete TSRMLS_DC)
+{
+	char                done_hex[SCAN_CURSOR_PARTITIONS / 4 + 1];
+	uint32_t            iter = 0;
+#if PHP_VERSION_ID < 70000
+	zval*               nodes_p = NULL;
+
+	MAKE_STD_ZVAL(nodes_p);
+#else
+	zval                nodes;
+	zval*               nodes_p = &nodes;
+#endif
+
+	array_init(nodes_p);
+	for (iter = 0; iter < cursor_p->n_nodes_done; iter++) {
+		AEROSPIKE_ADD_NEXT_INDEX_STRINGL(nodes_p, cursor_p->nodes_done[iter],
+				strlen(cursor_p->nodes_done[iter]), 1);
+	}
+	for (iter = 0; iter < sizeof(cursor_p->done); iter++) {
+		snprintf(&done_hex[iter * 2], 3, "%02x", cursor_p->done[iter]);
+	}
+
+	zval_dtor(cursor_zval_p);
+	array_init(cursor_zval_p);
+	add_assoc_long(cursor_zval_p, "partition_begin", cursor_p->partition_begin);
+	add_assoc_long(cursor_zval_p, "partition_count", cursor_p->partition_count);
+	AEROSPIKE_ADD_ASSOC_STRINGL(cursor_zval_p, "partitions_done", done_hex,
+			sizeof(cursor_p->done) * 2, 1);
+	add_assoc_zval(cursor_zval_p, "nodes_done", nodes_p);
+	add_assoc_bool(cursor_zval_p, "complete", complete);
+}
+
+/*
+ ******************************************************************************************************
+ * Callback for aerospike_scan_node in case of Aerospike::scanCursor().
+ * It skips the records outside of the cursor's partition range or of the
+ * partitions already done, and passes the others on to the user's callback.
+ *
+ * @return false if the user callback returned false; else true.
+ ******************************************************************************************************
+ */
+static bool
+scan_cursor_callback(const as_val* val_p, void* udata_p)
+{
+	scan_cursor     *cursor_p = (scan_cursor *) udata_p;
+	as_record       *record_p = NULL;
+	const uint8_t   *digest_p = NULL;
+	uint32_t        partition_id = 0;
+
+	if ((!val_p) || (NULL == (record_p = as_record_fromval(val_p)))) {
+		return true;
+	}
+
+	digest_p = record_p->key.digest.value;
+	partition_id = (digest_p[0] | (digest_p[1] << 8)) & (SCAN_CURSOR_PARTITIONS - 1);
+	if ((partition_id < cursor_p->partition_begin) ||
+			(partition_id >= cursor_p->partition_begin + cursor_p->partition_count) ||
+			(cursor_p->done[partition_id / 8] & (1 << (partition_id % 8)))) {
+		return true;
+	}
+	cursor_p->seen[partition_id / 8] |= (1 << (partition_id % 8));
+
+	if (!aerospike_helper_record_stream_callback(val_p, cursor_p->user_func_p)) {
+		cursor_p->stopped = true;
+		return false;
+	}
+	return true;
+}
+
+/*
+ ******************************************************************************************************
+ * Scans a set in the Aerospike DB node by node, resuming from a cursor.
+ * The cursor is updated after each node, and stored into cursor_p whether
+ * the scan completes, is stopped by the user's callback or fails.
+ *
+ * @param as_object_p               The C client's aerospike object.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param namespace_p               The namespace to scan.
+ * @param set_p                     The set to scan.
+ * @param user_func_p               The user's callback to be applied per record
+ *                                  that is scanned.
+ * @param bins_ht_p                 The HashTable for optional filter bins array.
+ * @param cursor_p                  The user's cursor array, to be resumed from
+ *                                  and updated.
+ * @param options_p                 The optional policy.
+ * @param serializer_policy_p       The serializer_policy value set in AerospikeObject structure.
+ *                                  Value read from either INI or user provided options array.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+extern as_status
+aerospike_scan_run_cursor(aerospike* as_object_p, as_error* error_p, char* namespace_p,
+		char* set_p, userland_callback* user_func_p, HashTable* bins_ht_p,
+		zval* cursor_p, zval* options_p, int8_t* serializer_policy_p TSRMLS_DC)
+{
+	as_scan             scan;
+	as_scan*            scan_p = NULL;
+	as_policy_scan      scan_policy;
+	int8_t              serializer_policy = (serializer_policy_p) ? *serializer_policy_p : SERIALIZER_NONE;
+	scan_cursor*        scan_cursor_p = NULL;
+	as_nodes*           nodes_p = NULL;
+	char                (*node_names_p)[AS_NODE_NAME_SIZE] = NULL;
+	uint32_t            n_nodes = 0;
+	uint32_t            iter = 0;
+	uint32_t            done_iter = 0;
+	bool                complete = false;
+
+	if ((!as_object_p) || (!error_p) || (!namespace_p) || (!cursor_p)) {
+		DEBUG_PHP_EXT_DEBUG("Unable to initiate scan");
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to initiate scan");
+		goto exit;
+	}
+
+	scan_cursor_p = (scan_cursor *) ecalloc(1, sizeof(scan_cursor));
+	scan_cursor_p->user_func_p = user_func_p;
+	if (AEROSPIKE_OK != scan_cursor_load(scan_cursor_p, cursor_p, error_p TSRMLS_CC)) {
+		DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+		efree(scan_cursor_p);
+		scan_cursor_p = NULL;
+		goto exit;
+	}
+
+	scan_p = &scan;
+	as_scan_init(scan_p, namespace_p, set_p);
+
+	set_policy_scan(&as_object_p->config, &scan_policy, &serializer_policy,
+			scan_p, options_p, error_p TSRMLS_CC);
+	if (AEROSPIKE_OK != (error_p->code)) {
+		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
+		goto exit;
+	}
+
+	if (bins_ht_p) {
+		as_scan_select_inita(&scan, zend_hash_num_elements(bins_ht_p));
+		HashPosition pos;
+		DECLARE_ZVAL_P(bin_names_pp);
+#if PHP_VERSION_ID < 70000
+		AEROSPIKE_FOREACH_HASHTABLE(bins_ht_p, pos, bin_names_pp) {
+#else
+		ZEND_HASH_FOREACH_VAL(bins_ht_p, bin_names_pp) {
+#endif
+			if (AEROSPIKE_Z_TYPE_P(bin_names_pp) != IS_STRING) {
+				convert_to_string_ex(bin_names_pp);
+			}
+			as_scan_select(&scan, AEROSPIKE_Z_STRVAL_P(bin_names_pp));
+		}
+#if PHP_VERSION_ID >= 70000
+		ZEND_HASH_FOREACH_END();
+#endif
+	}
+
+	/*
+	 * The node names are copied so the nodes are not held reserved while
+	 * the user's callback runs.
+	 */
+	nodes_p = as_nodes_reserve(as_object_p->cluster);
+	n_nodes = nodes_p->size;
+	node_names_p = ecalloc(n_nodes ? n_nodes : 1, AS_NODE_NAME_SIZE);
+	for (iter = 0; iter < n_nodes; iter++) {
+		strncpy(node_names_p[iter], nodes_p->array[iter]->name, AS_NODE_NAME_SIZE - 1);
+	}
+	as_nodes_release(nodes_p);
+
+	for (iter = 0; iter < n_nodes; iter++) {
+		for (done_iter = 0; done_iter < scan_cursor_p->n_nodes_done; done_iter++) {
+			if (!strcmp(scan_cursor_p->nodes_done[done_iter], node_names_p[iter])) {
+				break;
+			}
+		}
+		if (done_iter < scan_cursor_p->n_nodes_done) {
+			continue;
+		}
+
+		memset(scan_cursor_p->seen, 0, sizeof(scan_cursor_p->seen));
+		if (AEROSPIKE_OK != aerospike_latency_scan_node(as_object_p, error_p,
+					&scan_policy, &scan, node_names_p[iter], scan_cursor_callback,
+					scan_cursor_p)) {
+			DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
+			goto exit;
+		}
+		if (scan_cursor_p->stopped) {
+			goto exit;
+		}
+
+		for (done_iter = 0; done_iter < sizeof(scan_cursor_p->done); done_iter++) {
+			scan_cursor_p->done[done_iter] |= scan_cursor_p->seen[done_iter];
+		}
+		if (scan_cursor_p->n_nodes_done < SCAN_CURSOR_MAX_NODES) {
+			strcpy(scan_cursor_p->nodes_done[scan_cursor_p->n_nodes_done++],
+					node_names_p[iter]);
+		}
+	}
+	complete = true;
+
+exit:
+	if (scan_cursor_p) {
+		scan_cursor_store(scan_cursor_p, cursor_p, complete TSRMLS_CC);
+		efree(scan_cursor_p);
+	}
+	if (node_names_p) {
+		efree(node_names_p);
+	}
+	if (scan_p) {
+		as_scan_destroy(scan_p);
+	}
+	return error_p->code;
+}
+
 /*
  ******************************************************************************************************
  * Scans a set in the Aerospike DB and applies UDF on it.
@@ -24,13 +24,38 @@
 #include "php_variables.h"
 #include "php_aerospike.h"
 #include "ext/session/php_session.h"
+#include "ext/standard/sha1.h"
 #include "aerospike/aerospike.h"
 #include "aerospike/aerospike_key.h"
+#include "aerospike/as_operations.h"
 #include "aerospike/as_config.h"
 #include "aerospike_common.h"
 
+#include <ctype.h>
+#include <zlib.h>
+
 #define AEROSPIKE_SESSION_BIN "PHP_SESSION"
 
+/*
+ * Compressed sessions are stored as AS_BYTES_BLOB, holding a 3 bytes magic
+ * and a version byte, then the size of the session data as a 4 bytes big endian
+ * integer, followed by its deflate stream. The magic starts with a NUL byte,
+ * which no serialized session starts with, so sessions without it are read
+ * back as they are, whatever their bytes type.
+ */
+#define AEROSPIKE_SESSION_COMPRESSED_TYPE AS_BYTES_BLOB
+#define AEROSPIKE_SESSION_COMPRESSED_MAGIC "\0AS"
+#define AEROSPIKE_SESSION_COMPRESSED_MAGIC_SIZE 3
+#define AEROSPIKE_SESSION_COMPRESSED_VERSION 1
+#define AEROSPIKE_SESSION_COMPRESSED_HEADER 8
+#define AEROSPIKE_SESSION_MAX_INFLATE_RATIO 1032
+
+/*
+ * Maximum number of times a generation checked write is merged into the
+ * session written by concurrent requests before giving up.
+ */
+#define AEROSPIKE_SESSION_MAX_MERGES 3
+
 extern int persist;
 
 /*
@@ -38,10 +63,17 @@ extern int persist;
  * Sesion handler structure instance for Aerospike.
  *******************************************************************************************************
  */
+#if PHP_VERSION_ID < 70000
 PS_FUNCS(aerospike);
 ps_module ps_mod_aerospike = {
     PS_MOD(aerospike)
 };
+#else
+PS_FUNCS_UPDATE_TIMESTAMP(aerospike);
+ps_module ps_mod_aerospike = {
+    PS_MOD_UPDATE_TIMESTAMP(aerospike)
+};
+#endif
 
 /*
  *******************************************************************************************************
@@ -106,6 +138,12 @@ init_session(aerospike_session **session_pp, as_error *error_p TSRMLS_DC)
 		goto exit;
 	}
 
+	(*session_pp)->has_data_digest = false;
+	(*session_pp)->base_data_p = NULL;
+	(*session_pp)->base_data_len = 0;
+	(*session_pp)->generation = 0;
+	(*session_pp)->has_generation = false;
+
 	if (NULL != ((*session_pp)->aerospike_obj_p = ecalloc(1, sizeof(Aerospike_object)))) {
 		(*session_pp)->aerospike_obj_p->as_ref_p = NULL;
 		(*session_pp)->aerospike_obj_p->is_conn_16 = AEROSPIKE_CONN_STATE_FALSE;
@@ -138,6 +176,9 @@ destroy_session(aerospike_session *session_p TSRMLS_DC)
 		session_p->aerospike_obj_p->as_ref_p = NULL;
 		efree(session_p->aerospike_obj_p);
 		session_p->aerospike_obj_p = NULL;
+		if (session_p->base_data_p) {
+			efree(session_p->base_data_p);
+		}
 		efree(session_p);
 		DEBUG_PHP_EXT_INFO("aerospike session object destroyed");
 	} else {
@@ -145,6 +186,974 @@ destroy_session(aerospike_session *session_p TSRMLS_DC)
 	}
 }
 
+/*
+ *******************************************************************************************************
+ * Function to compute the digest of the session data, used to detect a write
+ * of the data unchanged since it was read. The session id is part of the
+ * digest so that data written under a regenerated id is never skipped.
+ *
+ * @param key_p             The session id.
+ * @param data_p            The serialized session data.
+ * @param data_len          The length of data_p.
+ * @param digest_p          The AEROSPIKE_SESSION_DIGEST_SIZE bytes digest to
+ *                          be populated by this method.
+ *******************************************************************************************************
+ */
+static void
+session_data_digest(const char *key_p, const char *data_p, size_t data_len,
+		unsigned char *digest_p)
+{
+	PHP_SHA1_CTX    context;
+
+	PHP_SHA1Init(&context);
+	PHP_SHA1Update(&context, (const unsigned char *) key_p, strlen(key_p) + 1);
+	PHP_SHA1Update(&context, (const unsigned char *) data_p, data_len);
+	PHP_SHA1Final(digest_p, &context);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to refresh the ttl of a session record without rewriting its data.
+ *
+ * @param session_p         The aerospike_session object.
+ * @param as_key_p          The key of the session record.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_touch(aerospike_session *session_p, const as_key *as_key_p,
+		as_error *error_p TSRMLS_DC)
+{
+	as_operations       operations;
+
+	as_operations_inita(&operations, 1);
+	as_operations_add_touch(&operations);
+	operations.ttl = SESSION_EXPIRE_PHP_INI;
+
+	aerospike_latency_key_operate(session_p->aerospike_obj_p->as_ref_p->as_p,
+			error_p, NULL, as_key_p, &operations, NULL);
+
+	as_operations_destroy(&operations);
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to compress the session data if it is at least
+ * aerospike.session_compression_threshold bytes long, and compressing it
+ * saves space.
+ *
+ * @param data_p            The serialized session data.
+ * @param data_len          The length of data_p.
+ * @param compressed_pp     The emalloc'ed compressed session to be populated
+ *                          by this method, to be efree'd by the caller.
+ * @param compressed_len_p  The length of *compressed_pp.
+ *
+ * @return true if the session data was compressed. Otherwise false.
+ *******************************************************************************************************
+ */
+static bool
+session_compress(const char *data_p, size_t data_len, uint8_t **compressed_pp,
+		uint32_t *compressed_len_p TSRMLS_DC)
+{
+	long        threshold = SESSION_COMPRESSION_THRESHOLD_PHP_INI;
+	uLongf      deflated_len = 0;
+	uint8_t     *compressed_p = NULL;
+
+	if ((threshold <= 0) || (data_len < (size_t) threshold) || (data_len > UINT32_MAX)) {
+		return false;
+	}
+
+	deflated_len = compressBound((uLong) data_len);
+	compressed_p = (uint8_t *) emalloc(AEROSPIKE_SESSION_COMPRESSED_HEADER + deflated_len);
+
+	if ((Z_OK != compress2(compressed_p + AEROSPIKE_SESSION_COMPRESSED_HEADER,
+					&deflated_len, (const Bytef *) data_p, (uLong) data_len, Z_BEST_SPEED)) ||
+			(AEROSPIKE_SESSION_COMPRESSED_HEADER + deflated_len >= data_len)) {
+		efree(compressed_p);
+		return false;
+	}
+
+	memcpy(compressed_p, AEROSPIKE_SESSION_COMPRESSED_MAGIC,
+			AEROSPIKE_SESSION_COMPRESSED_MAGIC_SIZE);
+	compressed_p[3] = AEROSPIKE_SESSION_COMPRESSED_VERSION;
+	compressed_p[4] = (uint8_t) (data_len >> 24);
+	compressed_p[5] = (uint8_t) (data_len >> 16);
+	compressed_p[6] = (uint8_t) (data_len >> 8);
+	compressed_p[7] = (uint8_t) data_len;
+
+	*compressed_pp = compressed_p;
+	*compressed_len_p = (uint32_t) (AEROSPIKE_SESSION_COMPRESSED_HEADER + deflated_len);
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to check whether a bytes session bin holds a compressed session,
+ * by its magic and version.
+ *
+ * @param session_p         The bytes of the session bin.
+ * @param session_len       The length of session_p.
+ *
+ * @return true if the session is compressed. Otherwise false, the session
+ *         data is the bytes as they are.
+ *******************************************************************************************************
+ */
+static bool
+session_is_compressed(const uint8_t *session_p, uint32_t session_len)
+{
+	return (session_len > AEROSPIKE_SESSION_COMPRESSED_HEADER) &&
+		!memcmp(session_p, AEROSPIKE_SESSION_COMPRESSED_MAGIC,
+				AEROSPIKE_SESSION_COMPRESSED_MAGIC_SIZE) &&
+		(session_p[3] == AEROSPIKE_SESSION_COMPRESSED_VERSION);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to get the size of the session data held by a compressed session.
+ *
+ * @param compressed_p      The compressed session.
+ * @param compressed_len    The length of compressed_p.
+ * @param data_len_p        The size of the session data to be populated by
+ *                          this method.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_uncompressed_size(const uint8_t *compressed_p, uint32_t compressed_len,
+		uint32_t *data_len_p, as_error *error_p TSRMLS_DC)
+{
+	if (compressed_len <= AEROSPIKE_SESSION_COMPRESSED_HEADER) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Invalid compressed session");
+		DEBUG_PHP_EXT_ERROR("Invalid compressed session");
+		goto exit;
+	}
+
+	*data_len_p = ((uint32_t) compressed_p[4] << 24) | ((uint32_t) compressed_p[5] << 16) |
+		((uint32_t) compressed_p[6] << 8) | (uint32_t) compressed_p[7];
+
+	if ((uint64_t) *data_len_p > (uint64_t) compressed_len * AEROSPIKE_SESSION_MAX_INFLATE_RATIO) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Invalid compressed session");
+		DEBUG_PHP_EXT_ERROR("Invalid compressed session");
+		goto exit;
+	}
+exit:
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to uncompress a compressed session.
+ *
+ * @param compressed_p      The compressed session.
+ * @param compressed_len    The length of compressed_p.
+ * @param data_p            The buffer to be populated with the session data.
+ * @param data_len          The size of the session data, as returned by
+ *                          session_uncompressed_size().
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_uncompress(const uint8_t *compressed_p, uint32_t compressed_len,
+		char *data_p, uint32_t data_len, as_error *error_p TSRMLS_DC)
+{
+	uLongf      inflated_len = data_len;
+
+	if ((Z_OK != uncompress((Bytef *) data_p, &inflated_len,
+					compressed_p + AEROSPIKE_SESSION_COMPRESSED_HEADER,
+					compressed_len - AEROSPIKE_SESSION_COMPRESSED_HEADER)) ||
+			(inflated_len != data_len)) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to uncompress session data");
+		DEBUG_PHP_EXT_ERROR("Unable to uncompress session data");
+	}
+	data_p[data_len] = '\0';
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Structure of a top level session variable within the serialized session
+ * data, pointing into the data.
+ *******************************************************************************************************
+ */
+typedef struct session_entry_t {
+	const char  *name_p;
+	size_t      name_len;
+	const char  *value_p;
+	size_t      value_len;
+} session_entry;
+
+/*
+ *******************************************************************************************************
+ * Function to replace the base data and generation of the session, the ones
+ * a generation checked write is merged against on conflict.
+ *
+ * @param session_p         The aerospike_session object.
+ * @param data_p            The session data as stored at generation.
+ * @param data_len          The length of data_p.
+ * @param generation        The generation of the session record.
+ *******************************************************************************************************
+ */
+static void
+session_set_base(aerospike_session *session_p, const char *data_p,
+		uint32_t data_len, uint16_t generation)
+{
+	if (session_p->base_data_p) {
+		efree(session_p->base_data_p);
+	}
+	session_p->base_data_p = estrndup(data_p, data_len);
+	session_p->base_data_len = data_len;
+	session_p->generation = generation;
+	session_p->has_generation = true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to forget the base data and generation of the session.
+ *
+ * @param session_p         The aerospike_session object.
+ *******************************************************************************************************
+ */
+static void
+session_reset_base(aerospike_session *session_p)
+{
+	if (session_p->base_data_p) {
+		efree(session_p->base_data_p);
+		session_p->base_data_p = NULL;
+	}
+	session_p->base_data_len = 0;
+	session_p->generation = 0;
+	session_p->has_generation = false;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to parse the length of a serialized value, up to its terminator.
+ *
+ * @return The position following the terminator, NULL if malformed.
+ *******************************************************************************************************
+ */
+static const char *
+session_skip_length(const char *p, const char *end_p, char terminator,
+		size_t *length_p)
+{
+	size_t      length = 0;
+
+	if ((p >= end_p) || !isdigit((unsigned char) *p)) {
+		return NULL;
+	}
+	while ((p < end_p) && isdigit((unsigned char) *p)) {
+		length = (length * 10) + (*p - '0');
+		p++;
+	}
+	if ((p >= end_p) || (*p != terminator)) {
+		return NULL;
+	}
+
+	*length_p = length;
+	return p + 1;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to skip a value serialized by serialize(), without unserializing
+ * it, so that neither classes are loaded nor __wakeup() is called.
+ *
+ * @param p                 The start of the serialized value.
+ * @param end_p             The end of the serialized data.
+ * @param has_ref_p         Set to true if the value holds a reference, as
+ *                          references are numbered across the whole session.
+ *
+ * @return The position following the value, NULL if malformed.
+ *******************************************************************************************************
+ */
+static const char *
+session_skip_value(const char *p, const char *end_p, bool *has_ref_p)
+{
+	size_t      length = 0;
+	size_t      count = 0;
+	char        type = 0;
+
+	if ((end_p - p) < 2) {
+		return NULL;
+	}
+
+	type = *p;
+	if (type == 'N') {
+		return (p[1] == ';') ? p + 2 : NULL;
+	}
+	if (p[1] != ':') {
+		return NULL;
+	}
+	p += 2;
+
+	switch (type) {
+		case 'r':
+		case 'R':
+			*has_ref_p = true;
+			/* fall through */
+		case 'b':
+		case 'i':
+		case 'd':
+			p = memchr(p, ';', end_p - p);
+			return p ? p + 1 : NULL;
+		case 's':
+		case 'E':
+			if (!(p = session_skip_length(p, end_p, ':', &length)) ||
+					((size_t) (end_p - p) < length + 3) || (p[0] != '"') ||
+					(p[length + 1] != '"') || (p[length + 2] != ';')) {
+				return NULL;
+			}
+			return p + length + 3;
+		case 'a':
+			if (!(p = session_skip_length(p, end_p, ':', &count)) ||
+					(p >= end_p) || (*p != '{')) {
+				return NULL;
+			}
+			p++;
+			break;
+		case 'O':
+		case 'C':
+			if (!(p = session_skip_length(p, end_p, ':', &length)) ||
+					((size_t) (end_p - p) < length + 3) || (p[0] != '"') ||
+					(p[length + 1] != '"') || (p[length + 2] != ':')) {
+				return NULL;
+			}
+			p += length + 3;
+			if (!(p = session_skip_length(p, end_p, ':', &count)) ||
+					(p >= end_p) || (*p != '{')) {
+				return NULL;
+			}
+			p++;
+			if (type == 'C') {
+				if (((size_t) (end_p - p) < count + 1) || (p[count] != '}')) {
+					return NULL;
+				}
+				return p + count + 1;
+			}
+			break;
+		default:
+			return NULL;
+	}
+
+	/* Key value pairs of an array, or properties of an object. */
+	while (count--) {
+		if (!(p = session_skip_value(p, end_p, has_ref_p)) ||
+				!(p = session_skip_value(p, end_p, has_ref_p))) {
+			return NULL;
+		}
+	}
+	return ((p < end_p) && (*p == '}')) ? p + 1 : NULL;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to split serialized session data into its top level variables.
+ * Supports the php and php_serialize session.serialize_handler. For the
+ * latter, the name of an entry is the serialized array key.
+ *
+ * @param data_p            The serialized session data.
+ * @param data_len          The length of data_p.
+ * @param php_serialize     true for the php_serialize format, false for php.
+ * @param entries_pp        The emalloc'ed entries to be populated by this
+ *                          method, to be efree'd by the caller.
+ * @param n_entries_p       The number of entries.
+ *
+ * @return true if success. Otherwise false.
+ *******************************************************************************************************
+ */
+static bool
+session_split(const char *data_p, size_t data_len, bool php_serialize,
+		session_entry **entries_pp, uint32_t *n_entries_p)
+{
+	const char      *p = data_p;
+	const char      *end_p = data_p + data_len;
+	const char      *name_p = NULL;
+	const char      *value_p = NULL;
+	size_t          count = 0;
+	uint32_t        capacity = 8;
+	uint32_t        n_entries = 0;
+	bool            has_ref = false;
+	session_entry   *entries_p = NULL;
+
+	*entries_pp = NULL;
+	*n_entries_p = 0;
+
+	if (data_len == 0) {
+		return true;
+	}
+
+	if (php_serialize) {
+		if (((end_p - p) < 2) || (p[0] != 'a') || (p[1] != ':') ||
+				!(p = session_skip_length(p + 2, end_p, ':', &count)) ||
+				(p >= end_p) || (*p != '{')) {
+			return false;
+		}
+		p++;
+	}
+
+	entries_p = (session_entry *) emalloc(capacity * sizeof(session_entry));
+
+	while (php_serialize ? (count > 0) : (p < end_p)) {
+		if (php_serialize) {
+			name_p = p;
+			if (!(p = session_skip_value(p, end_p, &has_ref))) {
+				goto error;
+			}
+			value_p = p;
+			count--;
+		} else {
+			name_p = p;
+			if (!(p = memchr(p, '|', end_p - p))) {
+				goto error;
+			}
+			value_p = ++p;
+		}
+
+		/* PHP 5 marks unset variables with a leading '!' and no value. */
+		if (php_serialize || (*name_p != '!')) {
+			if (!(p = session_skip_value(p, end_p, &has_ref))) {
+				goto error;
+			}
+		}
+
+		if (n_entries == capacity) {
+			capacity *= 2;
+			entries_p = (session_entry *) erealloc(entries_p, capacity * sizeof(session_entry));
+		}
+		entries_p[n_entries].name_p = name_p;
+		entries_p[n_entries].name_len = php_serialize ? (value_p - name_p) : (value_p - 1 - name_p);
+		entries_p[n_entries].value_p = value_p;
+		entries_p[n_entries].value_len = p - value_p;
+		n_entries++;
+	}
+
+	if (php_serialize && ((p >= end_p) || (*p != '}') || (p + 1 != end_p))) {
+		goto error;
+	}
+	if (has_ref) {
+		goto error;
+	}
+
+	*entries_pp = entries_p;
+	*n_entries_p = n_entries;
+	return true;
+
+error:
+	efree(entries_p);
+	return false;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to find a top level session variable by name.
+ *
+ * @return The entry if found. Otherwise NULL.
+ *******************************************************************************************************
+ */
+static const session_entry *
+session_find_entry(const session_entry *entries_p, uint32_t n_entries,
+		const session_entry *entry_p)
+{
+	uint32_t    iter = 0;
+
+	for (iter = 0; iter < n_entries; iter++) {
+		if ((entries_p[iter].name_len == entry_p->name_len) &&
+				!memcmp(entries_p[iter].name_p, entry_p->name_p, entry_p->name_len)) {
+			return &entries_p[iter];
+		}
+	}
+	return NULL;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to check whether two versions of a session variable are the same,
+ * a NULL entry standing for an unset variable.
+ *******************************************************************************************************
+ */
+static bool
+session_entry_equals(const session_entry *entry_p, const session_entry *other_p)
+{
+	if (!entry_p || !other_p) {
+		return entry_p == other_p;
+	}
+	return (entry_p->value_len == other_p->value_len) &&
+		!memcmp(entry_p->value_p, other_p->value_p, entry_p->value_len);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to merge the session variables changed by this request into the
+ * session written by a concurrent request.
+ * The variables this request set, changed or unset since base are taken from
+ * mine, all others from theirs.
+ *
+ * @param base_p            The session data this request read.
+ * @param mine_p            The session data this request writes.
+ * @param theirs_p          The session data currently stored.
+ * @param merged_pp         The emalloc'ed merged session data to be populated
+ *                          by this method, to be efree'd by the caller.
+ * @param merged_len_p      The length of *merged_pp.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_merge(const char *base_p, uint32_t base_len, const char *mine_p,
+		uint32_t mine_len, const char *theirs_p, uint32_t theirs_len,
+		char **merged_pp, uint32_t *merged_len_p, as_error *error_p TSRMLS_DC)
+{
+	char            *serialize_handler = SESSION_SERIALIZE_HANDLER_PHP_INI;
+	bool            php_serialize = false;
+	session_entry   *base_entries_p = NULL;
+	session_entry   *mine_entries_p = NULL;
+	session_entry   *theirs_entries_p = NULL;
+	uint32_t        n_base = 0;
+	uint32_t        n_mine = 0;
+	uint32_t        n_theirs = 0;
+	uint32_t        n_merged = 0;
+	uint32_t        iter = 0;
+	bool            *keep_theirs_p = NULL;
+	bool            *keep_mine_p = NULL;
+	char            *merged_p = NULL;
+	char            *out_p = NULL;
+
+	if (serialize_handler && !strcmp(serialize_handler, "php_serialize")) {
+		php_serialize = true;
+	} else if (!serialize_handler || strcmp(serialize_handler, "php")) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+				"Unable to merge sessions of this session.serialize_handler");
+		DEBUG_PHP_EXT_ERROR("Unable to merge sessions of this session.serialize_handler");
+		goto exit;
+	}
+
+	if (!session_split(base_p, base_len, php_serialize, &base_entries_p, &n_base) ||
+			!session_split(mine_p, mine_len, php_serialize, &mine_entries_p, &n_mine) ||
+			!session_split(theirs_p, theirs_len, php_serialize, &theirs_entries_p, &n_theirs)) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to merge session data");
+		DEBUG_PHP_EXT_ERROR("Unable to merge session data");
+		goto exit;
+	}
+
+	keep_theirs_p = (bool *) ecalloc(n_theirs + 1, sizeof(bool));
+	keep_mine_p = (bool *) ecalloc(n_mine + 1, sizeof(bool));
+
+	for (iter = 0; iter < n_theirs; iter++) {
+		keep_theirs_p[iter] = session_entry_equals(
+				session_find_entry(mine_entries_p, n_mine, &theirs_entries_p[iter]),
+				session_find_entry(base_entries_p, n_base, &theirs_entries_p[iter]));
+		n_merged += keep_theirs_p[iter];
+	}
+	for (iter = 0; iter < n_mine; iter++) {
+		keep_mine_p[iter] = !session_entry_equals(&mine_entries_p[iter],
+				session_find_entry(base_entries_p, n_base, &mine_entries_p[iter]));
+		n_merged += keep_mine_p[iter];
+	}
+
+	/* The merged data is at most both sessions, plus the array header. */
+	merged_p = out_p = (char *) emalloc(mine_len + theirs_len + 32);
+	if (php_serialize) {
+		out_p += sprintf(out_p, "a:%u:{", n_merged);
+	}
+	for (iter = 0; iter < n_theirs; iter++) {
+		if (keep_theirs_p[iter]) {
+			memcpy(out_p, theirs_entries_p[iter].name_p, theirs_entries_p[iter].name_len);
+			out_p += theirs_entries_p[iter].name_len;
+			if (!php_serialize) {
+				*out_p++ = '|';
+			}
+			memcpy(out_p, theirs_entries_p[iter].value_p, theirs_entries_p[iter].value_len);
+			out_p += theirs_entries_p[iter].value_len;
+		}
+	}
+	for (iter = 0; iter < n_mine; iter++) {
+		if (keep_mine_p[iter]) {
+			memcpy(out_p, mine_entries_p[iter].name_p, mine_entries_p[iter].name_len);
+			out_p += mine_entries_p[iter].name_len;
+			if (!php_serialize) {
+				*out_p++ = '|';
+			}
+			memcpy(out_p, mine_entries_p[iter].value_p, mine_entries_p[iter].value_len);
+			out_p += mine_entries_p[iter].value_len;
+		}
+	}
+	if (php_serialize) {
+		*out_p++ = '}';
+	}
+	*out_p = '\0';
+
+	*merged_pp = merged_p;
+	*merged_len_p = (uint32_t) (out_p - merged_p);
+
+exit:
+	if (keep_theirs_p) {
+		efree(keep_theirs_p);
+	}
+	if (keep_mine_p) {
+		efree(keep_mine_p);
+	}
+	if (base_entries_p) {
+		efree(base_entries_p);
+	}
+	if (mine_entries_p) {
+		efree(mine_entries_p);
+	}
+	if (theirs_entries_p) {
+		efree(theirs_entries_p);
+	}
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to fetch the session data of a session record.
+ * Only the bin named "PHP_SESSION" is read, and uncompressed if it was stored
+ * compressed.
+ *
+ * @param session_p         The aerospike_session object.
+ * @param as_key_p          The key of the session record.
+ * @param data_pp           The emalloc'ed session data to be populated by this
+ *                          method, to be efree'd by the caller.
+ * @param data_len_p        The length of *data_pp.
+ * @param generation_p      The generation of the session record.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_fetch(aerospike_session *session_p, const as_key *as_key_p,
+		char **data_pp, uint32_t *data_len_p, uint16_t *generation_p,
+		as_error *error_p TSRMLS_DC)
+{
+	as_record*              record_p = NULL;
+	as_policy_read          read_policy;
+	const char*             select_bins[] = { AEROSPIKE_SESSION_BIN, NULL };
+	as_bin_value*           session_data_p = NULL;
+	as_bytes*               session_bytes = NULL;
+	uint8_t*                session_bytes_value = NULL;
+	const char*             session_bytes_str = NULL;
+	const as_string*        session_bytes_string = NULL;
+	uint32_t                size = 0;
+	uint32_t                data_len = 0;
+
+	*data_pp = NULL;
+
+	as_policy_read_copy(&session_p->aerospike_obj_p->as_ref_p->as_p->config.policies.read,
+			&read_policy);
+	if (AEROSPIKE_OK != aerospike_latency_hedged_read(session_p->aerospike_obj_p->as_ref_p->as_p,
+			error_p, &read_policy, as_key_p, select_bins, false, &record_p, 0 TSRMLS_CC)) {
+		DEBUG_PHP_EXT_ERROR("Unable to retrieve session data");
+		goto exit;
+	}
+
+	if (NULL == (session_data_p = as_record_get(record_p, AEROSPIKE_SESSION_BIN))) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+				"Unable to get session bin of the record");
+		DEBUG_PHP_EXT_DEBUG("Unable to get session bin of the record");
+		goto exit;
+	}
+
+	switch (as_val_type(session_data_p)) {
+		case AS_BYTES:
+			session_bytes = as_bytes_fromval((as_val *) session_data_p);
+			session_bytes_value = as_bytes_get(session_bytes);
+			session_bytes_str = (char *) session_bytes_value;
+			size = as_bytes_size(session_bytes);
+
+			if (session_is_compressed(session_bytes_value, size)) {
+				if (AEROSPIKE_OK != session_uncompressed_size(session_bytes_value, size,
+							&data_len, error_p TSRMLS_CC)) {
+					goto exit;
+				}
+				*data_pp = (char *) emalloc(data_len + 1);
+				*data_len_p = data_len;
+				if (AEROSPIKE_OK != session_uncompress(session_bytes_value, size,
+							*data_pp, data_len, error_p TSRMLS_CC)) {
+					efree(*data_pp);
+					*data_pp = NULL;
+					goto exit;
+				}
+				break;
+			}
+
+			*data_pp = estrndup(session_bytes_str, size);
+			*data_len_p = size;
+			break;
+		case AS_STRING:
+			session_bytes_string = as_string_fromval((as_val *) session_data_p);
+			session_bytes_str = as_string_get(session_bytes_string);
+			*data_pp = estrndup(session_bytes_str, strlen(session_bytes_str));
+			*data_len_p = strlen(session_bytes_str);
+			break;
+		default: 
+			PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
+					"Unable to read session bin of the record");
+			DEBUG_PHP_EXT_DEBUG("Unable to read session bin of the record");
+			goto exit;
+	}
+
+	*generation_p = record_p->gen;
+
+exit:
+	if (record_p) {
+		as_record_destroy(record_p);
+	}
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to write the session data of a session record, compressed if it
+ * is at least aerospike.session_compression_threshold bytes long.
+ *
+ * @param session_p         The aerospike_session object.
+ * @param as_key_p          The key of the session record.
+ * @param data_p            The session data.
+ * @param data_len          The length of data_p.
+ * @param write_policy_p    The as_policy_write of the write. NULL for the
+ *                          defaults.
+ * @param generation        The generation expected by write_policy_p.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_put(aerospike_session *session_p, const as_key *as_key_p,
+		const char *data_p, uint32_t data_len, const as_policy_write *write_policy_p,
+		uint16_t generation, as_error *error_p TSRMLS_DC)
+{
+	as_record           record;
+	uint8_t             *compressed_p = NULL;
+	uint32_t            compressed_len = 0;
+	bool                set_bin = false;
+
+	as_record_inita(&record, 1);
+	if (session_compress(data_p, data_len, &compressed_p, &compressed_len TSRMLS_CC)) {
+		set_bin = as_record_set_raw_typep(&record, AEROSPIKE_SESSION_BIN, compressed_p,
+				compressed_len, AEROSPIKE_SESSION_COMPRESSED_TYPE, false);
+	} else {
+		set_bin = as_record_set_raw_typep(&record, AEROSPIKE_SESSION_BIN,
+				(const uint8_t *) data_p, data_len, AS_BYTES_PHP, false);
+	}
+	if (!set_bin) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to set record");
+		DEBUG_PHP_EXT_ERROR("Unable to set record");
+		goto exit;
+	}
+
+	record.ttl = SESSION_EXPIRE_PHP_INI;
+	record.gen = generation;
+	if (AEROSPIKE_OK != aerospike_latency_key_put(session_p->aerospike_obj_p->as_ref_p->as_p,
+				error_p, write_policy_p, as_key_p, &record)) {
+		DEBUG_PHP_EXT_ERROR("Unable to save session data");
+	}
+
+exit:
+	as_record_destroy(&record);
+	if (compressed_p) {
+		efree(compressed_p);
+	}
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to write the session data only if the session record is still at
+ * the generation it was read at, for aerospike.session_generation_check.
+ * When a concurrent request wrote the session in between, it is read again
+ * and the variables changed by this request are merged into it, at most
+ * AEROSPIKE_SESSION_MAX_MERGES times.
+ *
+ * @param session_p         The aerospike_session object.
+ * @param as_key_p          The key of the session record.
+ * @param data_p            The session data.
+ * @param data_len          The length of data_p.
+ * @param error_p           The C SDK's as_error object to be populated by this
+ *                          method in case of any errors if encountered.
+ *
+ * @return AEROSPIKE::OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+static as_status
+session_put_checked(aerospike_session *session_p, const as_key *as_key_p,
+		const char *data_p, uint32_t data_len, as_error *error_p TSRMLS_DC)
+{
+	as_policy_write     write_policy;
+	const char          *write_p = data_p;
+	uint32_t            write_len = data_len;
+	char                *merged_p = NULL;
+	char                *next_p = NULL;
+	char                *theirs_p = NULL;
+	uint32_t            theirs_len = 0;
+	uint16_t            generation = 0;
+	uint32_t            merges = 0;
+
+	as_policy_write_copy(&session_p->aerospike_obj_p->as_ref_p->as_p->config.policies.write,
+			&write_policy);
+
+	for (;;) {
+		if (session_p->has_generation) {
+			write_policy.gen = AS_POLICY_GEN_EQ;
+			write_policy.exists = AS_POLICY_EXISTS_IGNORE;
+		} else {
+			write_policy.gen = AS_POLICY_GEN_IGNORE;
+			write_policy.exists = AS_POLICY_EXISTS_CREATE;
+		}
+
+		if (AEROSPIKE_OK == session_put(session_p, as_key_p, write_p, write_len,
+					&write_policy, session_p->generation, error_p TSRMLS_CC)) {
+			session_set_base(session_p, write_p, write_len,
+					session_p->has_generation ? session_p->generation + 1 : 1);
+			break;
+		}
+
+		if (((AEROSPIKE_ERR_RECORD_GENERATION != error_p->code) &&
+					(AEROSPIKE_ERR_RECORD_EXISTS != error_p->code)) ||
+				(merges++ >= AEROSPIKE_SESSION_MAX_MERGES)) {
+			break;
+		}
+
+		/* A concurrent request wrote the session since it was read. */
+		as_error_init(error_p);
+		if (AEROSPIKE_OK != session_fetch(session_p, as_key_p, &theirs_p, &theirs_len,
+					&generation, error_p TSRMLS_CC)) {
+			if (AEROSPIKE_ERR_RECORD_NOT_FOUND != error_p->code) {
+				break;
+			}
+			/* It was destroyed or expired since, create it again. */
+			as_error_init(error_p);
+			session_reset_base(session_p);
+			continue;
+		}
+
+		if (AEROSPIKE_OK != session_merge(session_p->base_data_p,
+					session_p->base_data_len, write_p, write_len, theirs_p, theirs_len,
+					&next_p, &write_len, error_p TSRMLS_CC)) {
+			break;
+		}
+		if (merged_p) {
+			efree(merged_p);
+		}
+		write_p = merged_p = next_p;
+
+		session_set_base(session_p, theirs_p, theirs_len, generation);
+		efree(theirs_p);
+		theirs_p = NULL;
+	}
+
+	if (theirs_p) {
+		efree(theirs_p);
+	}
+	if (merged_p) {
+		efree(merged_p);
+	}
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to set the session object from the per process cache of save
+ * paths, skipping the parsing of the save path and the lookup of the hosts in
+ * the persistent list.
+ *
+ * @param save_path         The session save path.
+ * @param session_p         The aerospike_session object whose ns_p, set_p and
+ *                          aerospike object are to be set.
+ *
+ * @return true if the save path was cached. Otherwise false.
+ *******************************************************************************************************
+ */
+static bool
+session_cache_find(const char *save_path, aerospike_session *session_p TSRMLS_DC)
+{
+	HashTable                       *session_cache = AEROSPIKE_G(session_cache_g);
+	aerospike_session_cache_entry   *entry_p = NULL;
+#if PHP_VERSION_ID < 70000
+	aerospike_session_cache_entry   **entry_pp = NULL;
+#endif
+
+	if (!session_cache || !save_path || !*save_path) {
+		return false;
+	}
+
+	pthread_rwlock_rdlock(&AEROSPIKE_G(aerospike_mutex));
+#if PHP_VERSION_ID < 70000
+	if (SUCCESS == zend_hash_find(session_cache, (char *) save_path,
+				strlen(save_path) + 1, (void **) &entry_pp)) {
+		entry_p = *entry_pp;
+	}
+#else
+	entry_p = zend_hash_str_find_ptr(session_cache, save_path, strlen(save_path));
+#endif
+	pthread_rwlock_unlock(&AEROSPIKE_G(aerospike_mutex));
+
+	if (!entry_p || !entry_p->as_ref_p || !entry_p->as_ref_p->as_p) {
+		return false;
+	}
+
+	memcpy(session_p->ns_p, entry_p->ns_p, sizeof(session_p->ns_p));
+	memcpy(session_p->set_p, entry_p->set_p, sizeof(session_p->set_p));
+	session_p->aerospike_obj_p->as_ref_p = entry_p->as_ref_p;
+	session_p->aerospike_obj_p->as_ref_p->ref_as_p++;
+	session_p->aerospike_obj_p->is_conn_16 = AEROSPIKE_CONN_STATE_TRUE;
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to add a connected session object to the per process cache of
+ * save paths. The cached aerospike_ref lives in the persistent list, which
+ * is destroyed together with the cache.
+ *
+ * @param save_path         The session save path.
+ * @param session_p         The connected aerospike_session object.
+ *******************************************************************************************************
+ */
+static void
+session_cache_add(const char *save_path, aerospike_session *session_p TSRMLS_DC)
+{
+	HashTable                       *session_cache = AEROSPIKE_G(session_cache_g);
+	aerospike_session_cache_entry   *entry_p = NULL;
+
+	if (!session_cache || !save_path || !*save_path) {
+		return;
+	}
+
+	entry_p = pemalloc(sizeof(aerospike_session_cache_entry), 1);
+	entry_p->as_ref_p = session_p->aerospike_obj_p->as_ref_p;
+	memcpy(entry_p->ns_p, session_p->ns_p, sizeof(entry_p->ns_p));
+	memcpy(entry_p->set_p, session_p->set_p, sizeof(entry_p->set_p));
+
+	pthread_rwlock_wrlock(&AEROSPIKE_G(aerospike_mutex));
+#if PHP_VERSION_ID < 70000
+	if (SUCCESS != zend_hash_add(session_cache, (char *) save_path,
+				strlen(save_path) + 1, (void *) &entry_p, sizeof(entry_p), NULL)) {
+		pefree(entry_p, 1);
+	}
+#else
+	if (NULL == zend_hash_str_add_ptr(session_cache, save_path, strlen(save_path), entry_p)) {
+		pefree(entry_p, 1);
+	}
+#endif
+	pthread_rwlock_unlock(&AEROSPIKE_G(aerospike_mutex));
+}
+
 /*
  *******************************************************************************************************
  * PHP Exposed-Function to open an Aerospike PHP Session.
@@ -152,6 +1161,8 @@ destroy_session(aerospike_session *session_p TSRMLS_DC)
  * specified in session.save_path only if session.save_handler is set to
  * "aerospike". The internal C SDK aerospike object is fetched/hashed into the
  * Aerospike extension's Persistent List.
+ * The parsed save path and the connected aerospike object are cached per
+ * process, so later requests with the same save path skip both steps.
  *
  * Invoked on calling session_start() from PHP userland.
  * @return SUCCESS or FAILURE.
@@ -180,6 +1191,11 @@ PS_OPEN_FUNC(aerospike)
 		goto exit;
 	}
 
+	if (session_cache_find(save_path, session_p TSRMLS_CC)) {
+		DEBUG_PHP_EXT_INFO("Reusing cached session save path");
+		goto exit;
+	}
+
 	if (AEROSPIKE_OK !=
 			aerospike_helper_check_and_set_config_for_session(&config,
 				(char *) save_path, session_p, &error TSRMLS_CC)) {
@@ -218,6 +1234,7 @@ PS_OPEN_FUNC(aerospike)
 
 	/* connection is established, set the connection flag now */
 	session_p->aerospike_obj_p->is_conn_16 = AEROSPIKE_CONN_STATE_TRUE;
+	session_cache_add(save_path, session_p TSRMLS_CC);
 
 	DEBUG_PHP_EXT_INFO("Success in creating php-aerospike object");
 exit:
@@ -266,8 +1283,9 @@ exit:
 /*
  *******************************************************************************************************
  * PHP Exposed-Function to read and populate contents of an Aerospike PHP Session.
- * Fetches record in the aerospike server with PK==session_id.
- * Populates the session object with contents of a bin named "PHP_SESSION".
+ * Fetches the bin named "PHP_SESSION" of the record in the aerospike server
+ * with PK==session_id, and populates the session object with its contents,
+ * uncompressing them if they were stored compressed.
  *
  * Invoked on calling session_start() from PHP userland.
  * @return SUCCESS or FAILURE.
@@ -277,20 +1295,19 @@ PS_READ_FUNC(aerospike)
 {
 	as_error                error;
 	aerospike_session*      session_p = PS_GET_MOD_DATA();
-	as_record*              record_p = NULL;
 	as_key                  key_get;
 	int16_t                 init_key = 0;
-	as_bin_value*           session_data_p = NULL;
-	as_bytes*               session_bytes = NULL;
-	uint8_t*                session_bytes_value = NULL;
-	const char*             session_bytes_str = NULL;
-	const as_string*        session_bytes_string = NULL;
+	char*                   data_p = NULL;
+	uint32_t                data_len = 0;
+	uint16_t                generation = 0;
 
 	DEBUG_PHP_EXT_INFO("In PS_READ_FUNC");
 
 	if (AEROSPIKE_OK != validate_session(session_p, &error TSRMLS_CC)) {
 		goto exit; 
 	}
+	session_p->has_data_digest = false;
+	session_reset_base(session_p);
 
 #if PHP_VERSION_ID < 70000
 	as_key_init_str(&key_get, session_p->ns_p, session_p->set_p, key);
@@ -299,60 +1316,34 @@ PS_READ_FUNC(aerospike)
 #endif
 	init_key = 1;
 
-	if (AEROSPIKE_OK != aerospike_key_get(session_p->aerospike_obj_p->as_ref_p->as_p,
-			&error, NULL, &key_get, &record_p)) {
-		DEBUG_PHP_EXT_ERROR("Unable to retrieve session data");
-		goto exit;
-	}
-
-	if (NULL == (session_data_p = as_record_get(record_p, AEROSPIKE_SESSION_BIN))) {
-		PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLIENT,
-				"Unable to get session bin of the record");
-		DEBUG_PHP_EXT_DEBUG("Unable to get session bin of the record");
+	if (AEROSPIKE_OK != session_fetch(session_p, &key_get, &data_p, &data_len,
+				&generation, &error TSRMLS_CC)) {
 		goto exit;
 	}
 
-	switch (as_val_type(session_data_p)) {
-		case AS_BYTES:
-			session_bytes = as_bytes_fromval((as_val *) session_data_p);
-			session_bytes_value = as_bytes_get(session_bytes);
-			session_bytes_str = (char *) session_bytes_value;
-
-			uint32_t size = as_bytes_size(session_bytes);
 #if PHP_VERSION_ID < 70000
-			*vallen = size;
-			*val = estrndup(session_bytes_str, size);
+	session_data_digest(key, data_p, data_len, session_p->data_digest);
 #else
-			*val = zend_string_init((const char *)session_bytes_str, size, 0);
+	session_data_digest(ZSTR_VAL(key), data_p, data_len, session_p->data_digest);
 #endif
-			as_val_destroy(session_data_p);
-			as_bytes_destroy(session_bytes);
-			break;
-		case AS_STRING:
-			session_bytes_string = as_string_fromval((as_val *) session_data_p);
-			session_bytes_str = as_string_get(session_bytes_string);
+	session_p->has_data_digest = true;
+
+	if (SESSION_GENERATION_CHECK_PHP_INI) {
+		session_set_base(session_p, data_p, data_len, generation);
+	}
+
 #if PHP_VERSION_ID < 70000
-			*val = estrndup(session_bytes_str, strlen(session_bytes_str));
-			*vallen = strlen(session_bytes_str);
+	*val = data_p;
+	*vallen = data_len;
 #else
-			*val = zend_string_init((const char *)session_bytes_str, strlen(session_bytes_str), 0);
+	*val = zend_string_init(data_p, data_len, 0);
+	efree(data_p);
 #endif
-			break;
-		default: 
-			PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLIENT,
-					"Unable to read session bin of the record");
-			DEBUG_PHP_EXT_DEBUG("Unable to read session bin of the record");
-			goto exit;
-	}
 
 exit:
 	if (init_key) {
 		as_key_destroy(&key_get);
 	}
-
-	if (record_p) {
-		as_record_destroy(record_p);
-	}
 	return (error.code == AEROSPIKE_OK) ? SUCCESS : FAILURE;
 }
 
@@ -362,6 +1353,10 @@ exit:
  * server.
  * Writes a record in the aerospike server with PK==session_id with a bin named "PHP_SESSION"
  * containing all the session object contents.
+ * If the contents are the ones last read or written for this session id, only
+ * the ttl of the record is refreshed.
+ * With aerospike.session_generation_check, the contents are merged into the
+ * session written by concurrent requests instead of overwriting it.
  *
  * Invoked on calling session_write_close() from PHP userland.
  * @return SUCCESS or FAILURE.
@@ -372,9 +1367,10 @@ PS_WRITE_FUNC(aerospike)
 	as_error            error;
 	aerospike_session*  session_p = PS_GET_MOD_DATA();
 	as_key              key_put;
-	as_record           record;
 	int16_t             init_key = 0;
-	int16_t             init_record = 0;
+	unsigned char       data_digest[AEROSPIKE_SESSION_DIGEST_SIZE];
+	const char          *data_p = NULL;
+	uint32_t            data_len = 0;
 
 	DEBUG_PHP_EXT_INFO("In PS_WRITE_FUNC");
 
@@ -396,35 +1392,46 @@ PS_WRITE_FUNC(aerospike)
 
 #if PHP_VERSION_ID < 70000
 	as_key_init_str(&key_put, session_p->ns_p, session_p->set_p, key);
+	data_p = val;
+	data_len = vallen;
+	session_data_digest(key, data_p, data_len, data_digest);
 #else
 	as_key_init_str(&key_put, session_p->ns_p, session_p->set_p, ZSTR_VAL(key));
+	data_p = ZSTR_VAL(val);
+	data_len = ZSTR_LEN(val);
+	session_data_digest(ZSTR_VAL(key), data_p, data_len, data_digest);
 #endif
 	init_key = 1;
 
-	as_record_inita(&record, 1);
-	init_record = 1;
-	if (
-#if PHP_VERSION_ID < 70000
-	 	!as_record_set_raw_typep(&record, AEROSPIKE_SESSION_BIN, val, vallen, AS_BYTES_PHP, false)
-#else
-	    !as_record_set_raw_typep(&record, AEROSPIKE_SESSION_BIN, ZSTR_VAL(val), ZSTR_LEN(val), AS_BYTES_PHP, false)
-#endif
-		) {
-		PHP_EXT_SET_AS_ERR(&error, AEROSPIKE_ERR_CLIENT, "Unable to set record");
-		DEBUG_PHP_EXT_ERROR("Unable to set record");
-		goto exit;
+	if (session_p->has_data_digest &&
+			!memcmp(data_digest, session_p->data_digest, sizeof(data_digest))) {
+		if (AEROSPIKE_OK == session_touch(session_p, &key_put, &error TSRMLS_CC)) {
+			/* A touch is a write, it bumps the generation too. */
+			session_p->generation++;
+			goto exit;
+		}
+		if (AEROSPIKE_ERR_RECORD_NOT_FOUND != error.code) {
+			goto exit;
+		}
+		/* The record expired since it was read, write it again. */
+		as_error_init(&error);
+		session_reset_base(session_p);
 	}
+	session_p->has_data_digest = false;
 
-	record.ttl = SESSION_EXPIRE_PHP_INI;
-	if (AEROSPIKE_OK != aerospike_key_put(session_p->aerospike_obj_p->as_ref_p->as_p,
-				&error, NULL, &key_put, &record)) {
-		DEBUG_PHP_EXT_ERROR("Unable to save session data");
+	if (SESSION_GENERATION_CHECK_PHP_INI) {
+		session_put_checked(session_p, &key_put, data_p, data_len, &error TSRMLS_CC);
+	} else {
+		session_put(session_p, &key_put, data_p, data_len, NULL, 0, &error TSRMLS_CC);
+	}
+	if (AEROSPIKE_OK != error.code) {
+		goto exit;
 	}
 
+	memcpy(session_p->data_digest, data_digest, sizeof(data_digest));
+	session_p->has_data_digest = true;
+
 exit:
-	if (init_record) {
-		as_record_destroy(&record);
-	}
 	if (init_key) {
 		as_key_destroy(&key_put);
 	}
@@ -461,9 +1468,11 @@ PS_DESTROY_FUNC(aerospike)
 	as_key_init_str(&key_remove, session_p->ns_p, session_p->set_p, ZSTR_VAL(key));
 #endif
 	init_key = 1;
+	session_p->has_data_digest = false;
+	session_reset_base(session_p);
 
 	if (AEROSPIKE_OK !=
-			aerospike_key_remove(session_p->aerospike_obj_p->as_ref_p->as_p,
+			aerospike_latency_key_remove(session_p->aerospike_obj_p->as_ref_p->as_p,
 				&error, NULL, &key_remove)) {
 		goto exit;
 	}
@@ -488,3 +1497,74 @@ PS_GC_FUNC(aerospike)
 	return SUCCESS;
 }
 
+#if PHP_VERSION_ID >= 70000
+/*
+ *******************************************************************************************************
+ * PHP Exposed-Function to create a new session id, using the default
+ * session id generator.
+ *
+ * @return The new session id.
+ *******************************************************************************************************
+ */
+PS_CREATE_SID_FUNC(aerospike)
+{
+	DEBUG_PHP_EXT_INFO("In PS_CREATE_SID_FUNC");
+	return php_session_create_id(mod_data);
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Exposed-Function to check that a session id names an existing session,
+ * for session.use_strict_mode.
+ *
+ * @return SUCCESS if the session record exists, FAILURE otherwise.
+ *******************************************************************************************************
+ */
+PS_VALIDATE_SID_FUNC(aerospike)
+{
+	as_error            error;
+	aerospike_session*  session_p = PS_GET_MOD_DATA();
+	as_policy_read      read_policy;
+	as_record*          record_p = NULL;
+	as_key              key_exists;
+	int16_t             init_key = 0;
+
+	DEBUG_PHP_EXT_INFO("In PS_VALIDATE_SID_FUNC");
+
+	if (AEROSPIKE_OK != validate_session(session_p, &error TSRMLS_CC)) {
+		goto exit;
+	}
+
+	as_key_init_str(&key_exists, session_p->ns_p, session_p->set_p, ZSTR_VAL(key));
+	init_key = 1;
+
+	as_policy_read_copy(&session_p->aerospike_obj_p->as_ref_p->as_p->config.policies.read,
+			&read_policy);
+	aerospike_latency_hedged_read(session_p->aerospike_obj_p->as_ref_p->as_p,
+			&error, &read_policy, &key_exists, NULL, true, &record_p, 0 TSRMLS_CC);
+
+exit:
+	if (init_key) {
+		as_key_destroy(&key_exists);
+	}
+	if (record_p) {
+		as_record_destroy(record_p);
+	}
+	return (error.code == AEROSPIKE_OK) ? SUCCESS : FAILURE;
+}
+
+/*
+ *******************************************************************************************************
+ * PHP Exposed-Function to refresh the ttl of an unchanged Aerospike PHP Session.
+ * Invoked by session.lazy_write instead of PS_WRITE_FUNC when the session
+ * data did not change, it only touches the record unless it expired.
+ *
+ * @return SUCCESS or FAILURE.
+ *******************************************************************************************************
+ */
+PS_UPDATE_TIMESTAMP_FUNC(aerospike)
+{
+	DEBUG_PHP_EXT_INFO("In PS_UPDATE_TIMESTAMP_FUNC");
+	return ps_write_aerospike(mod_data, key, val, maxlifetime);
+}
+#endif
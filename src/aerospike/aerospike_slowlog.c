@@ -0,0 +1,408 @@
+/*
+ *
+ * Copyright (C) 2014-2016 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#include "php.h"
+#include "php_aerospike.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "aerospike/aerospike.h"
+#include "aerospike/as_bytes.h"
+#include "aerospike/as_list.h"
+#include "aerospike/as_map.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_record_iterator.h"
+#include "aerospike/as_string.h"
+#include "citrusleaf/cf_clock.h"
+#include "aerospike_common.h"
+
+/*
+ *******************************************************************************************************
+ * Per process ring of the last AEROSPIKE_SLOWLOG_SIZE slow commands.
+ * Writers claim a slot with an atomic increment of slowlog_head, and publish
+ * it by setting its seq to the claimed position + 1 once it is written.
+ * Readers skip the slots whose seq changed while being copied, so neither
+ * side ever waits on the other.
+ *******************************************************************************************************
+ */
+static aerospike_slowlog_entry slowlog_ring[AEROSPIKE_SLOWLOG_SIZE];
+static uint64_t slowlog_head = 0;
+
+/*
+ *******************************************************************************************************
+ * Part of the ring already appended to the aerospike.slowlog_file, and the
+ * descriptor kept open on it, both guarded by slowlog_file_lock. The file is
+ * only written at the end of a request, never by the command being recorded.
+ *******************************************************************************************************
+ */
+static pthread_mutex_t slowlog_file_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t slowlog_flushed = 0;
+static int slowlog_fd = -1;
+static char slowlog_fd_path[MAXPATHLEN];
+
+#define SLOWLOG_LINE_SIZE 512
+
+static uint32_t
+slowlog_value_size(const as_val *value_p);
+
+/*
+ *******************************************************************************************************
+ * Callbacks of as_list_foreach() and as_map_foreach() adding the estimated
+ * size of each element to the uint32_t udata.
+ *******************************************************************************************************
+ */
+static bool
+slowlog_list_element_size(as_val *value_p, void *udata)
+{
+	*(uint32_t *) udata += slowlog_value_size(value_p);
+	return true;
+}
+
+static bool
+slowlog_map_entry_size(const as_val *key_p, const as_val *value_p, void *udata)
+{
+	*(uint32_t *) udata += slowlog_value_size(key_p) + slowlog_value_size(value_p);
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to estimate the size of a value as sent on the wire. Lists and maps
+ * are walked, counting a one byte msgpack header per element, rather than
+ * serialized.
+ *******************************************************************************************************
+ */
+static uint32_t
+slowlog_value_size(const as_val *value_p)
+{
+	uint32_t    size = 0;
+
+	switch (as_val_type((as_val *) value_p)) {
+		case AS_INTEGER:
+		case AS_DOUBLE:
+			return 8;
+		case AS_STRING:
+		case AS_GEOJSON:
+			return (uint32_t) as_string_len((as_string *) value_p);
+		case AS_BYTES:
+			return as_bytes_size((as_bytes *) value_p);
+		case AS_LIST:
+			size = 1 + as_list_size((as_list *) value_p);
+			as_list_foreach((as_list *) value_p, slowlog_list_element_size, &size);
+			return size;
+		case AS_MAP:
+			size = 1 + 2 * as_map_size((as_map *) value_p);
+			as_map_foreach((as_map *) value_p, slowlog_map_entry_size, &size);
+			return size;
+		default:
+			return 0;
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to estimate the size of the bins of a record as sent on the wire.
+ *******************************************************************************************************
+ */
+static uint32_t
+slowlog_record_size(const as_record *record_p)
+{
+	as_record_iterator  iterator;
+	uint32_t            size = 0;
+
+	as_record_iterator_init(&iterator, record_p);
+	while (as_record_iterator_has_next(&iterator)) {
+		as_bin  *bin_p = as_record_iterator_next(&iterator);
+
+		size += slowlog_value_size((as_val *) as_bin_get_value(bin_p));
+	}
+	as_record_iterator_destroy(&iterator);
+
+	return size;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to format a slow command as one line of the aerospike.slowlog_file,
+ * of space separated fields.
+ *
+ * @return the length of the line, 0 if it could not be formatted.
+ *******************************************************************************************************
+ */
+static int
+slowlog_format_line(const aerospike_slowlog_entry *entry_p, char *line_p, size_t size)
+{
+	char        digest[AS_DIGEST_VALUE_SIZE * 2 + 1] = "-";
+	int         length = 0;
+	uint32_t    iter = 0;
+
+	if (entry_p->has_digest) {
+		for (iter = 0; iter < AS_DIGEST_VALUE_SIZE; iter++) {
+			snprintf(&digest[iter * 2], 3, "%02x", entry_p->digest[iter]);
+		}
+	}
+
+	length = snprintf(line_p, size, "%llu %s %s %s %s %s %u %u %llu %d\n",
+			(unsigned long long) entry_p->time_ms,
+			aerospike_latency_command_name(entry_p->command),
+			entry_p->ns[0] ? entry_p->ns : "-",
+			entry_p->set[0] ? entry_p->set : "-",
+			digest,
+			entry_p->node[0] ? entry_p->node : "-",
+			entry_p->n_bins, entry_p->payload_size,
+			(unsigned long long) entry_p->elapsed_us, entry_p->status);
+	if (length <= 0) {
+		return 0;
+	}
+	if (length >= (int) size) {
+		line_p[size - 2] = '\n';
+		length = size - 1;
+	}
+	return length;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to open the aerospike.slowlog_file, unless it is already open.
+ * Called with slowlog_file_lock held.
+ *
+ * @return true if slowlog_fd can be written.
+ *******************************************************************************************************
+ */
+static bool
+slowlog_open_file(const char *path_p)
+{
+	if (slowlog_fd >= 0 && 0 == strcmp(slowlog_fd_path, path_p)) {
+		return true;
+	}
+	if (slowlog_fd >= 0) {
+		close(slowlog_fd);
+		slowlog_fd = -1;
+	}
+	if (strlen(path_p) >= sizeof(slowlog_fd_path)) {
+		return false;
+	}
+	if ((slowlog_fd = open(path_p, O_WRONLY | O_APPEND | O_CREAT, 0644)) < 0) {
+		return false;
+	}
+	strcpy(slowlog_fd_path, path_p);
+	return true;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to record a command in the slow log if it took at least
+ * aerospike.slowlog_threshold_ms. A threshold of 0 disables the slow log.
+ *
+ * @param command               The command type.
+ * @param ns_p                  The namespace of the command. NULL if unknown.
+ * @param set_p                 The set of the command. NULL if unknown.
+ * @param as_key_p              The key of a single record command, else NULL.
+ * @param node_name_p           The node which served the command. NULL if
+ *                              unknown or several nodes.
+ * @param record_p              The record sent or received, else NULL.
+ * @param elapsed_us            The latency of the command in microseconds.
+ * @param status                The status returned by the C client.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_slowlog_record(aerospike_command command, const char *ns_p,
+		const char *set_p, const as_key *as_key_p, const char *node_name_p,
+		const as_record *record_p, uint64_t elapsed_us, as_status status)
+{
+	aerospike_slowlog_entry *entry_p = NULL;
+	uint64_t                position = 0;
+	long                    threshold_ms = 0;
+	TSRMLS_FETCH();
+
+	threshold_ms = AEROSPIKE_G(slowlog_threshold_ms);
+	if ((threshold_ms <= 0) || (elapsed_us < (uint64_t) threshold_ms * 1000)) {
+		return;
+	}
+
+	position = __sync_fetch_and_add(&slowlog_head, 1);
+	entry_p = &slowlog_ring[position % AEROSPIKE_SLOWLOG_SIZE];
+
+	entry_p->seq = 0;
+	__sync_synchronize();
+
+	entry_p->time_ms = cf_clock_getabsolute();
+	entry_p->command = command;
+	entry_p->status = status;
+	entry_p->elapsed_us = elapsed_us;
+	strncpy(entry_p->ns, ns_p ? ns_p : "", sizeof(entry_p->ns) - 1);
+	entry_p->ns[sizeof(entry_p->ns) - 1] = '\0';
+	strncpy(entry_p->set, set_p ? set_p : "", sizeof(entry_p->set) - 1);
+	entry_p->set[sizeof(entry_p->set) - 1] = '\0';
+	strncpy(entry_p->node, node_name_p ? node_name_p : "", sizeof(entry_p->node) - 1);
+	entry_p->node[sizeof(entry_p->node) - 1] = '\0';
+
+	entry_p->has_digest = false;
+	if (as_key_p && as_key_p->digest.init) {
+		memcpy(entry_p->digest, as_key_p->digest.value, AS_DIGEST_VALUE_SIZE);
+		entry_p->has_digest = true;
+	}
+
+	entry_p->n_bins = record_p ? as_record_numbins((as_record *) record_p) : 0;
+	entry_p->payload_size = record_p ? slowlog_record_size(record_p) : 0;
+
+	__sync_synchronize();
+	entry_p->seq = position + 1;
+}
+
+/*
+ *******************************************************************************************************
+ * Function to populate a PHP array with the slow log, for Aerospike::getSlowLog().
+ *
+ * @param slowlog_p             The initialized PHP array to be populated with
+ *                              the slow commands, oldest first.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_slowlog_get(zval *slowlog_p TSRMLS_DC)
+{
+	uint64_t                head = slowlog_head;
+	uint64_t                position = (head > AEROSPIKE_SLOWLOG_SIZE) ?
+		head - AEROSPIKE_SLOWLOG_SIZE : 0;
+	aerospike_slowlog_entry entry;
+
+	for (; position < head; position++) {
+		aerospike_slowlog_entry *slot_p = &slowlog_ring[position % AEROSPIKE_SLOWLOG_SIZE];
+#if PHP_VERSION_ID < 70000
+		zval    *entry_zval_p = NULL;
+#else
+		zval    entry_zval;
+		zval    *entry_zval_p = &entry_zval;
+#endif
+
+		if (slot_p->seq != position + 1) {
+			continue;
+		}
+		memcpy(&entry, slot_p, sizeof(entry));
+		__sync_synchronize();
+		if (slot_p->seq != position + 1) {
+			continue;
+		}
+
+#if PHP_VERSION_ID < 70000
+		MAKE_STD_ZVAL(entry_zval_p);
+#endif
+		array_init(entry_zval_p);
+		add_assoc_long(entry_zval_p, "time_ms", entry.time_ms);
+		AEROSPIKE_ADD_ASSOC_STRINGL(entry_zval_p, "command",
+				(char *) aerospike_latency_command_name(entry.command),
+				strlen(aerospike_latency_command_name(entry.command)), 1);
+		AEROSPIKE_ADD_ASSOC_STRINGL(entry_zval_p, "ns", entry.ns, strlen(entry.ns), 1);
+		AEROSPIKE_ADD_ASSOC_STRINGL(entry_zval_p, "set", entry.set, strlen(entry.set), 1);
+		if (entry.has_digest) {
+			AEROSPIKE_ADD_ASSOC_STRINGL(entry_zval_p, "digest", (char *) entry.digest,
+					AS_DIGEST_VALUE_SIZE, 1);
+		} else {
+			add_assoc_null(entry_zval_p, "digest");
+		}
+		AEROSPIKE_ADD_ASSOC_STRINGL(entry_zval_p, "node", entry.node, strlen(entry.node), 1);
+		add_assoc_long(entry_zval_p, "bins", entry.n_bins);
+		add_assoc_long(entry_zval_p, "payload_size", entry.payload_size);
+		add_assoc_long(entry_zval_p, "elapsed_us", entry.elapsed_us);
+		add_assoc_long(entry_zval_p, "status", entry.status);
+		add_next_index_zval(slowlog_p, entry_zval_p);
+	}
+}
+
+/*
+ *******************************************************************************************************
+ * Function to append the slow commands recorded since the last call to the
+ * aerospike.slowlog_file, if set, in as few writes as possible. Called at the
+ * end of each request. The slow log is best effort: commands overwritten in
+ * the ring before being appended, and failed writes, are dropped.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_slowlog_request_shutdown(TSRMLS_D)
+{
+	const char              *path_p = AEROSPIKE_G(slowlog_file);
+	char                    buffer[16 * SLOWLOG_LINE_SIZE];
+	size_t                  used = 0;
+	uint64_t                head = 0;
+	uint64_t                position = 0;
+	aerospike_slowlog_entry entry;
+
+	if (slowlog_flushed == slowlog_head) {
+		return;
+	}
+
+	pthread_mutex_lock(&slowlog_file_lock);
+	head = slowlog_head;
+	position = (head > slowlog_flushed + AEROSPIKE_SLOWLOG_SIZE) ?
+		head - AEROSPIKE_SLOWLOG_SIZE : slowlog_flushed;
+
+	if (!path_p || !*path_p || !slowlog_open_file(path_p)) {
+		slowlog_flushed = head;
+		pthread_mutex_unlock(&slowlog_file_lock);
+		return;
+	}
+
+	for (; position < head; position++) {
+		aerospike_slowlog_entry *slot_p = &slowlog_ring[position % AEROSPIKE_SLOWLOG_SIZE];
+		uint64_t                seq = slot_p->seq;
+
+		/* Still being recorded, it is appended by a later request. */
+		if (seq < position + 1) {
+			break;
+		}
+		if (seq != position + 1) {
+			continue;
+		}
+		memcpy(&entry, slot_p, sizeof(entry));
+		__sync_synchronize();
+		if (slot_p->seq != position + 1) {
+			continue;
+		}
+
+		if (used + SLOWLOG_LINE_SIZE > sizeof(buffer)) {
+			if (write(slowlog_fd, buffer, used) < 0) {
+				DEBUG_PHP_EXT_DEBUG("Unable to append to the slow log file");
+			}
+			used = 0;
+		}
+		used += slowlog_format_line(&entry, &buffer[used], SLOWLOG_LINE_SIZE);
+	}
+	if (used > 0 && write(slowlog_fd, buffer, used) < 0) {
+		DEBUG_PHP_EXT_DEBUG("Unable to append to the slow log file");
+	}
+	slowlog_flushed = position;
+	pthread_mutex_unlock(&slowlog_file_lock);
+}
+
+/*
+ *******************************************************************************************************
+ * Function to close the aerospike.slowlog_file at module shutdown.
+ *******************************************************************************************************
+ */
+extern void
+aerospike_slowlog_shutdown(void)
+{
+	pthread_mutex_lock(&slowlog_file_lock);
+	if (slowlog_fd >= 0) {
+		close(slowlog_fd);
+		slowlog_fd = -1;
+	}
+	pthread_mutex_unlock(&slowlog_file_lock);
+}
@@ -3755,11 +3755,16 @@ exit:
 
 /*
  *******************************************************************************************************
- * Creates and puts the as_record into Aerospike db by using appropriate write policy.
+ * Creates the as_record to be put into Aerospike db and the write policy to
+ * put it with, without putting it.
  *
- * @param as_object_p               The C client's aerospike object for the db to be written to.
+ * @param aerospike_object_p        The Aerospike_object for the db to be written to.
  * @param record_pp                 The record to be written.
  * @param as_key_p                  The C client's as_key identifying the record to be written to.
+ * @param record_p                  The initialized as_record to be populated with the bins.
+ * @param static_pool_p             The static pool holding the values of the bins.
+ *                                  It must outlive record_p.
+ * @param write_policy_p            The as_policy_write to be set.
  * @param error_p                   The C client's as_error to be set to the encountered error.
  * @param ttl_u64                   The ttl to be set for C client's as_record.
  * @param options_p                 The optional parameters to Aerospike::put()
@@ -3770,44 +3775,35 @@ exit:
  *******************************************************************************************************
  */
 extern as_status
-aerospike_transform_key_data_put(Aerospike_object* aerospike_object_p,
+aerospike_transform_key_data_prepare_put(Aerospike_object* aerospike_object_p,
 		PARAM_ZVAL_P(record_pp),
 		as_key* as_key_p,
+		as_record* record_p,
+		as_static_pool* static_pool_p,
+		as_policy_write* write_policy_p,
 		as_error *error_p,
 		u_int32_t ttl_u32,
 		zval* options_p,
 		int8_t* serializer_policy_p TSRMLS_DC)
 {
-	as_policy_write             write_policy;
 	int8_t                      serializer_policy = (serializer_policy_p) ? *serializer_policy_p : SERIALIZER_NONE;
-	as_static_pool              static_pool = {0};
-	as_record                   record;
-	int16_t                     init_record = 0;
 	uint16_t                    gen_value = 0;
-	int                         num_of_bins = 0;
 	bool                        server_support_double = false;
 
-	if ((!record_pp) || (!as_key_p) || (!error_p) || (!aerospike_object_p->as_ref_p->as_p)) {
+	if ((!record_pp) || (!as_key_p) || (!record_p) || (!error_p) || (!aerospike_object_p->as_ref_p->as_p)) {
 		DEBUG_PHP_EXT_DEBUG("Unable to put record");
 		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to put record");
 		goto exit;
 	}
 
-	as_record_inita(&record, zend_hash_num_elements(AEROSPIKE_Z_ARRVAL_P(record_pp)));
-	num_of_bins = zend_hash_num_elements(AEROSPIKE_Z_ARRVAL_P(record_pp));
-
-	if (num_of_bins < 1) {
+	if (zend_hash_num_elements(AEROSPIKE_Z_ARRVAL_P(record_pp)) < 1) {
 		error_p->code = AEROSPIKE_ERR_PARAM;
 		DEBUG_PHP_EXT_DEBUG("Record must be given at least one bin => val pair");
 		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_PARAM, "Record must be given at least one bin => val pair");
 		goto exit;
 	}
 
-	as_record_inita(&record, num_of_bins);
-
-	init_record = 1;
-
-	set_policy(&aerospike_object_p->as_ref_p->as_p->config, NULL, &write_policy, NULL, NULL, NULL, NULL, NULL,
+	set_policy_for_key(aerospike_object_p, as_key_p, NULL, write_policy_p, NULL, NULL, NULL,
 			&serializer_policy, options_p, error_p TSRMLS_CC);
 
 	if (AEROSPIKE_OK != (error_p->code)) {
@@ -3823,17 +3819,67 @@ aerospike_transform_key_data_put(Aerospike_object* aerospike_object_p,
 
 	server_support_double = aerospike_has_double (aerospike_object_p->as_ref_p->as_p);
 
-	aerospike_transform_iterate_records(aerospike_object_p, record_pp, &record,
-			&static_pool, serializer_policy, server_support_double,
+	aerospike_transform_iterate_records(aerospike_object_p, record_pp, record_p,
+			static_pool_p, serializer_policy, server_support_double,
 			error_p TSRMLS_CC);
 	if (AEROSPIKE_OK != (error_p->code)) {
 		DEBUG_PHP_EXT_DEBUG("Unable to put record");
 		goto exit;
 	}
 
-	record.gen = gen_value;
-	record.ttl = ttl_u32;
-	aerospike_key_put(aerospike_object_p->as_ref_p->as_p, error_p, &write_policy, as_key_p, &record);
+	record_p->gen = gen_value;
+	record_p->ttl = ttl_u32;
+
+exit:
+	return error_p->code;
+}
+
+/*
+ *******************************************************************************************************
+ * Creates and puts the as_record into Aerospike db by using appropriate write policy.
+ *
+ * @param as_object_p               The C client's aerospike object for the db to be written to.
+ * @param record_pp                 The record to be written.
+ * @param as_key_p                  The C client's as_key identifying the record to be written to.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ * @param ttl_u64                   The ttl to be set for C client's as_record.
+ * @param options_p                 The optional parameters to Aerospike::put()
+ * @param serializer_policy_p       The serializer_policy value set in AerospikeObject. Either from
+ *                                  INI or user provided options array.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ *******************************************************************************************************
+ */
+extern as_status
+aerospike_transform_key_data_put(Aerospike_object* aerospike_object_p,
+		PARAM_ZVAL_P(record_pp),
+		as_key* as_key_p,
+		as_error *error_p,
+		u_int32_t ttl_u32,
+		zval* options_p,
+		int8_t* serializer_policy_p TSRMLS_DC)
+{
+	as_policy_write             write_policy;
+	as_static_pool              static_pool = {0};
+	as_record                   record;
+	int16_t                     init_record = 0;
+
+	if ((!record_pp) || (!as_key_p) || (!error_p) || (!aerospike_object_p->as_ref_p->as_p)) {
+		DEBUG_PHP_EXT_DEBUG("Unable to put record");
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT, "Unable to put record");
+		goto exit;
+	}
+
+	as_record_inita(&record, zend_hash_num_elements(AEROSPIKE_Z_ARRVAL_P(record_pp)));
+	init_record = 1;
+
+	if (AEROSPIKE_OK != aerospike_transform_key_data_prepare_put(aerospike_object_p,
+				record_pp, as_key_p, &record, &static_pool, &write_policy,
+				error_p, ttl_u32, options_p, serializer_policy_p TSRMLS_CC)) {
+		goto exit;
+	}
+
+	aerospike_latency_key_put(aerospike_object_p->as_ref_p->as_p, error_p, &write_policy, as_key_p, &record);
 
 exit:
 	/* clean up the as_* objects that were initialised */
@@ -3860,6 +3906,7 @@ exit:
  *                                  record to be read.
  * @param read_policy_p             The C client's as_policy_read to be used
  *                                  while reading the record.
+ * @param hedge_delay               The hedge delay in milliseconds of the read.
  *
  * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
  *******************************************************************************************************
@@ -3870,12 +3917,13 @@ aerospike_transform_filter_bins_exists(Aerospike_object *as_object_p,
 		as_record **get_record_p,
 		as_error *error_p,
 		as_key *get_rec_key_p,
-		as_policy_read *read_policy_p)
+		as_policy_read *read_policy_p,
+		int32_t hedge_delay TSRMLS_DC)
 {
 	int                 bins_count = zend_hash_num_elements(bins_array_p);
 	as_status           status = AEROSPIKE_OK;
 	uint                sel_cnt = 0;
-	const char          *select[bins_count];
+	const char          *select[bins_count + 1];
 	HashPosition        pointer;
 #if PHP_VERSION_ID < 70000
 	zval                **bin_names;
@@ -3899,8 +3947,9 @@ aerospike_transform_filter_bins_exists(Aerospike_object *as_object_p,
 	#endif
 	select[bins_count] = NULL;
 	if (AEROSPIKE_OK != (status =
-				aerospike_key_select(as_object_p->as_ref_p->as_p, error_p, read_policy_p,
-					get_rec_key_p, select, get_record_p))) {
+				aerospike_latency_hedged_read(as_object_p->as_ref_p->as_p, error_p,
+					read_policy_p, get_rec_key_p, select, false, get_record_p,
+					hedge_delay TSRMLS_CC))) {
 		goto exit;
 	}
 
@@ -4468,6 +4517,7 @@ aerospike_transform_get_record(Aerospike_object* aerospike_obj_p,
 	as_record               *get_record = NULL;
 	aerospike               *as_object_p = aerospike_obj_p->as_ref_p->as_p;
 	foreach_callback_udata  foreach_record_callback_udata;
+	int32_t                 hedge_delay = 0;
 
 	DECLARE_ZVAL(get_record_p);
 
@@ -4488,23 +4538,45 @@ aerospike_transform_get_record(Aerospike_object* aerospike_obj_p,
 		goto exit;
 	}
 
-	set_policy(&as_object_p->config, &read_policy, NULL, NULL, NULL, NULL,
-			NULL, NULL, NULL, options_p, error_p TSRMLS_CC);
+	set_policy_for_key(aerospike_obj_p, get_rec_key_p, &read_policy, NULL, NULL, NULL,
+			NULL, NULL, options_p, error_p TSRMLS_CC);
 	if (AEROSPIKE_OK != (status = (error_p->code))) {
 		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
 		goto exit;
 	}
 
-	if (bins_p != NULL) {
-		if (AEROSPIKE_OK != (status =
-					aerospike_transform_filter_bins_exists(aerospike_obj_p,
-						Z_ARRVAL_P(bins_p), &get_record, error_p,
-						get_rec_key_p, &read_policy))) {
+	if (AEROSPIKE_OK != (status = get_options_hedge_delay_value(options_p,
+					&hedge_delay, error_p TSRMLS_CC))) {
+		DEBUG_PHP_EXT_DEBUG("Unable to get hedge delay");
+		goto exit;
+	}
+
+	if (aerospike_memo_get(aerospike_obj_p, get_rec_key_p, bins_p, &get_record,
+				error_p TSRMLS_CC)) {
+		if (AEROSPIKE_OK != (status = error_p->code)) {
+			goto exit;
+		}
+	} else {
+		if (bins_p != NULL) {
+			status = aerospike_transform_filter_bins_exists(aerospike_obj_p,
+					Z_ARRVAL_P(bins_p), &get_record, error_p,
+					get_rec_key_p, &read_policy, hedge_delay TSRMLS_CC);
+		} else if (aerospike_near_cache_get(aerospike_obj_p, get_rec_key_p,
+					&read_policy, hedge_delay, &get_record, error_p TSRMLS_CC)) {
+			status = AEROSPIKE_OK;
+		} else {
+			status = aerospike_latency_hedged_read(as_object_p,
+					error_p, &read_policy, get_rec_key_p, NULL, false,
+					&get_record, hedge_delay TSRMLS_CC);
+			if (AEROSPIKE_OK == status) {
+				aerospike_near_cache_put(get_rec_key_p, get_record TSRMLS_CC);
+			}
+		}
+		aerospike_memo_put(aerospike_obj_p, get_rec_key_p, bins_p, get_record,
+				error_p TSRMLS_CC);
+		if (AEROSPIKE_OK != status) {
 			goto exit;
 		}
-	} else if (AEROSPIKE_OK != (status = aerospike_key_get(as_object_p, error_p,
-					&read_policy, get_rec_key_p, &get_record))) {
-		goto exit;
 	}
 
 	if (!as_record_foreach(get_record, (as_rec_foreach_callback) AS_DEFAULT_GET,
@@ -17,6 +17,7 @@
  */
 
 #include "php.h"
+#include "ext/standard/sha1.h"
 #include "aerospike/as_log.h"
 #include "aerospike/aerospike_key.h"
 #include "aerospike/as_config.h"
@@ -28,9 +29,191 @@
 #include "aerospike/aerospike_udf.h"
 #include "aerospike_policy.h"
 
+#include <sys/stat.h>
+
+/*
+ ******************************************************************************************************
+ * Function to read a whole UDF file in one go.
+ *
+ * @param path_p                    The path to the file.
+ * @param bytes_pp                  The emalloc'ed contents of the file to be
+ *                                  populated by this function, to be efree'd
+ *                                  by the caller.
+ * @param size_p                    The size of the contents.
+ *
+ * @return true if the file was read. Otherwise false.
+ ******************************************************************************************************
+ */
+static bool
+udf_read_file(const char *path_p, uint8_t **bytes_pp, uint32_t *size_p TSRMLS_DC)
+{
+	FILE*                   file_p = NULL;
+	struct stat             file_stat;
+	uint8_t*                bytes_p = NULL;
+	size_t                  size = 0;
+	size_t                  read = 0;
+
+	if (NULL == (file_p = fopen(path_p, "r"))) {
+		return false;
+	}
+
+	if ((0 != fstat(fileno(file_p), &file_stat)) || (file_stat.st_size > UINT32_MAX)) {
+		fclose(file_p);
+		return false;
+	}
+
+	bytes_p = (uint8_t *) emalloc(file_stat.st_size + 1);
+	while (size < (size_t) file_stat.st_size &&
+			0 < (read = fread(bytes_p + size, 1, file_stat.st_size - size, file_p))) {
+		size += read;
+	}
+	fclose(file_p);
+
+	*bytes_pp = bytes_p;
+	*size_p = (uint32_t) size;
+	return true;
+}
+
+/*
+ ******************************************************************************************************
+ * Function to compute the hash of a UDF module the way the server reports it
+ * in udf-list, the hex encoded SHA1 of its contents.
+ *
+ * @param bytes_p                   The contents of the module.
+ * @param size                      The size of the contents.
+ * @param hash_p                    The AS_UDF_FILE_HASH_SIZE + 1 bytes buffer
+ *                                  to be populated with the hash.
+ ******************************************************************************************************
+ */
+static void
+udf_content_hash(const uint8_t *bytes_p, uint32_t size, char *hash_p)
+{
+	PHP_SHA1_CTX            context;
+	unsigned char           digest[AS_UDF_FILE_HASH_SIZE / 2];
+
+	PHP_SHA1Init(&context);
+	PHP_SHA1Update(&context, bytes_p, size);
+	PHP_SHA1Final(digest, &context);
+	make_sha1_digest(hash_p, digest);
+}
+
+/*
+ ******************************************************************************************************
+ * Function to check whether a UDF module is registered with the given
+ * contents. Errors listing the modules are not reported, the module is then
+ * registered again.
+ *
+ * @param as_p                      The C client's aerospike object.
+ * @param info_policy_p             The as_policy_info of the listing.
+ * @param module_p                  The name of the module.
+ * @param language                  The Aerospike::UDF_TYPE_* of the module.
+ * @param hash_p                    The hash of the contents of the module.
+ *
+ * @return true if the module is registered with the same contents.
+ ******************************************************************************************************
+ */
+static bool
+udf_is_registered(aerospike *as_p, as_policy_info *info_policy_p,
+		const char *module_p, long language, const char *hash_p)
+{
+	as_error                error;
+	as_udf_files            udf_files;
+	uint32_t                i = 0;
+	bool                    registered = false;
+
+	as_error_init(&error);
+	as_udf_files_init(&udf_files, 0);
+	if (AEROSPIKE_OK == aerospike_udf_list(as_p, &error, info_policy_p, &udf_files)) {
+		for (i = 0; i < udf_files.size; i++) {
+			if (!strcmp(udf_files.entries[i].name, module_p) &&
+					(udf_files.entries[i].type == language) &&
+					!strncasecmp((const char *) udf_files.entries[i].hash, hash_p,
+						AS_UDF_FILE_HASH_SIZE)) {
+				registered = true;
+				break;
+			}
+		}
+	}
+	as_udf_files_destroy(&udf_files);
+
+	return registered;
+}
+
+/*
+ ******************************************************************************************************
+ * Function to copy a UDF module into aerospike.udf.lua_user_path, where it is
+ * loaded from when applied on the client side by query aggregations.
+ * The copy is only written if it differs from the module.
+ *
+ * @param path_p                    The path to the module on the client side.
+ * @param bytes_p                   The contents of the module.
+ * @param size                      The size of the contents.
+ * @param error_p                   The C client's as_error to be set to the encountered error.
+ *
+ * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_x.
+ ******************************************************************************************************
+ */
+static as_status
+udf_copy_to_user_path(const char *path_p, const uint8_t *bytes_p,
+		uint32_t size, as_error *error_p TSRMLS_DC)
+{
+	char                    *udf_path = LUA_USER_PATH_PHP_INI;
+	char                    copy_filepath[AS_CONFIG_PATH_MAX_LEN] = {0};
+	uint32_t                copy_len = strlen(udf_path);
+	const char              *filename = strrchr(path_p, '/');
+	uint8_t                 *copy_bytes_p = NULL;
+	uint32_t                copy_size = 0;
+	FILE                    *fileW_p = NULL;
+
+	filename = filename ? filename + 1 : path_p;
+	if (copy_len + strlen(filename) + 2 > sizeof(copy_filepath)) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_UDF_NOT_FOUND,
+				"Cannot create script file");
+		DEBUG_PHP_EXT_DEBUG("Cannot create script file");
+		goto exit;
+	}
+
+	memcpy(copy_filepath, udf_path, copy_len);
+	if (copy_len && udf_path[copy_len - 1] != '/') {
+		copy_filepath[copy_len++] = '/';
+	}
+	memcpy(copy_filepath + copy_len, filename, strlen(filename));
+
+	if (udf_read_file(copy_filepath, &copy_bytes_p, &copy_size TSRMLS_CC) &&
+			(copy_size == size) && !memcmp(copy_bytes_p, bytes_p, size)) {
+		DEBUG_PHP_EXT_DEBUG("Script file is up to date");
+		goto exit;
+	}
+
+	fileW_p = fopen(copy_filepath, "w");
+	if (!fileW_p) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_UDF_NOT_FOUND,
+					"Cannot create script file");
+		DEBUG_PHP_EXT_DEBUG("Cannot create script file");
+		goto exit;
+	}
+
+	if (0 >= (int) fwrite(bytes_p, size, 1, fileW_p)) {
+		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_UDF_NOT_FOUND, "unable to write to script file");
+			DEBUG_PHP_EXT_DEBUG("unable to write to script file");
+		goto exit;
+	}
+
+exit:
+	if (copy_bytes_p) {
+		efree(copy_bytes_p);
+	}
+	if (fileW_p) {
+		fclose(fileW_p);
+	}
+	return error_p->code;
+}
+
 /*
  ******************************************************************************************************
  Registers a UDF module.
+ * The module is uploaded and waited for only if the server does not already
+ * hold the same contents under that name, as reported by udf-list.
  *
  * @param aerospike_obj_p           The C client's aerospike object.
  * @param error_p                   The C client's as_error to be set to the encountered error.
@@ -45,13 +228,9 @@ extern as_status
 aerospike_udf_register(Aerospike_object* aerospike_obj_p, as_error* error_p,
         char* path_p, char* module_p, long language, zval* options_p)
 {
-	FILE*                   file_p = NULL;
-	FILE*                   fileW_p = NULL;
 	uint32_t                size = 0;
-	uint32_t                content_size;
 	uint8_t*                bytes_p = NULL;
-	uint8_t*                buff_p = NULL;
-	uint32_t                read;
+	char                    hash[AS_UDF_FILE_HASH_SIZE + 1];
 	as_bytes                udf_content;
 	as_bytes*               udf_content_p = NULL;
 	as_policy_info          info_policy;
@@ -65,18 +244,23 @@ aerospike_udf_register(Aerospike_object* aerospike_obj_p, as_error* error_p,
 		goto exit;
 	}
 
-	file_p = fopen(path_p, "r");
-
-	if (!file_p) {
+	if (!udf_read_file(path_p, &bytes_p, &size TSRMLS_CC)) {
 		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_UDF_NOT_FOUND,
 				"Cannot open script file");
 		DEBUG_PHP_EXT_DEBUG("Cannot open script file");
 		goto exit;
 	}
 
-	fseek(file_p, 0L, SEEK_END);
-	content_size = ftell(file_p);
-	fseek(file_p, 0L, SEEK_SET);
+	if (AEROSPIKE_OK != udf_copy_to_user_path(path_p, bytes_p, size, error_p TSRMLS_CC)) {
+		goto exit;
+	}
+
+	udf_content_hash(bytes_p, size, hash);
+	if (udf_is_registered(aerospike_obj_p->as_ref_p->as_p, &info_policy,
+				module_p, language, hash)) {
+		DEBUG_PHP_EXT_DEBUG("UDF module is already registered");
+		goto exit;
+	}
 
 	/*
 	 * Using emalloc here to maintain consistency of PHP extension.
@@ -84,54 +268,6 @@ aerospike_udf_register(Aerospike_object* aerospike_obj_p, as_error* error_p,
 	 * if emalloc is used, pass parameter 4 of function as_bytes_init_wrap as
 	 * "false" and handle the freeing up of the same here.
 	 */
-	if (NULL == (bytes_p = (uint8_t *) emalloc(content_size + 1))) {
-		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_CLIENT,
-				"Memory allocation failed for contents of UDF");
-		DEBUG_PHP_EXT_DEBUG("Memory allocation failed for contents of UDF");
-		goto exit;
-	}
-
-	buff_p = bytes_p;
-	read = (int) fread(buff_p, 1, LUA_FILE_BUFFER_FRAME, file_p);
-	while (read) {
-		size += read;
-		buff_p += read;
-		read = (int) fread(buff_p, 1, LUA_FILE_BUFFER_FRAME, file_p);
-	}
-
-	char *udf_path = LUA_USER_PATH_PHP_INI;
-	char copy_filepath[AS_CONFIG_PATH_MAX_LEN] = {0};
-	uint32_t user_path_len = strlen(udf_path);
-
-	memcpy(copy_filepath, udf_path, user_path_len);
-
-	if(udf_path[user_path_len - 1] != '/') {
-		memcpy(copy_filepath + user_path_len, "/", 1);
-	}
-
-	char *filename = strrchr(path_p, '/');
-	if(!filename) {
-		filename = path_p;
-	} else if(filename[0] == '/') {
-		filename = filename + 1;
-	}
-
-	memcpy(copy_filepath + user_path_len + 1, filename, strlen(filename));
-
-	fileW_p = fopen(copy_filepath, "w");
-	if (!fileW_p) {
-		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_UDF_NOT_FOUND,
-					"Cannot create script file");
-		DEBUG_PHP_EXT_DEBUG("Cannot create script file");
-		goto exit;
-	}
-
-	if (0 >= (int) fwrite(bytes_p, size, 1, fileW_p)) {
-		PHP_EXT_SET_AS_ERR(error_p, AEROSPIKE_ERR_UDF_NOT_FOUND, "unable to write to script file");
-			DEBUG_PHP_EXT_DEBUG("unable to write to script file");
-		goto exit;
-	}
-
 	as_bytes_init_wrap(&udf_content, bytes_p, size, false);
 	udf_content_p = &udf_content;
 	/*
@@ -150,18 +286,10 @@ aerospike_udf_register(Aerospike_object* aerospike_obj_p, as_error* error_p,
 	}
 
 exit:
-	if (file_p) {
-		fclose(file_p);
-	}
-
 	if (bytes_p) {
 		efree(bytes_p);
 	}
 
-	if (fileW_p) {
-		fclose(fileW_p);
-	}
-
 	if (udf_content_p) {
 		as_bytes_destroy(udf_content_p);
 	}
@@ -245,8 +373,8 @@ aerospike_udf_apply(Aerospike_object* aerospike_obj_p,
 	as_policy_apply             apply_policy;
 	TSRMLS_FETCH_FROM_CTX(aerospike_obj_p->ts);
 
-	set_policy_udf_apply(&aerospike_obj_p->as_ref_p->as_p->config, &apply_policy, &serializer_policy,
-			options_p, error_p TSRMLS_CC);
+	set_policy_for_key(aerospike_obj_p, as_key_p, NULL, NULL, NULL, NULL, &apply_policy,
+			&serializer_policy, options_p, error_p TSRMLS_CC);
 
 	if (AEROSPIKE_OK != (error_p->code)) {
 		DEBUG_PHP_EXT_DEBUG("Unable to set policy");
@@ -266,7 +394,7 @@ aerospike_udf_apply(Aerospike_object* aerospike_obj_p,
 		AS_LIST_PUT(aerospike_obj_p, NULL, args_pp, args_list_p, &udf_pool, serializer_policy, error_p TSRMLS_CC);
 	}
 
-	if (AEROSPIKE_OK != (aerospike_key_apply(aerospike_obj_p->as_ref_p->as_p,
+	if (AEROSPIKE_OK != (aerospike_latency_key_apply(aerospike_obj_p->as_ref_p->as_p,
 					error_p, &apply_policy, as_key_p, module_p, function_p,
 					(as_list *) args_list_p, &udf_result_p))) {
 		DEBUG_PHP_EXT_DEBUG("%s", error_p->message);
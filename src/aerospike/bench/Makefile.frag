@@ -0,0 +1,4 @@
+
+aerospike-transform-bench: $(srcdir)/bench/aerospike_transform_bench.c $(shared_objects_aerospike)
+	$(LIBTOOL) --mode=compile $(CC) $(COMMON_FLAGS) $(CFLAGS_CLEAN) $(EXTRA_CFLAGS) -I$(srcdir) -c $(srcdir)/bench/aerospike_transform_bench.c -o aerospike_transform_bench.lo
+	$(LIBTOOL) --mode=link $(CC) $(CFLAGS_CLEAN) $(EXTRA_CFLAGS) $(LDFLAGS) -o $@ aerospike_transform_bench.lo $(shared_objects_aerospike) $(EXTRA_LDFLAGS) $(AEROSPIKE_SHARED_LIBADD) $(AEROSPIKE_BENCH_LIBS)
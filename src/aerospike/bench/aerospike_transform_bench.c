@@ -0,0 +1,399 @@
+/*
+ *
+ * Copyright (C) 2014-2016 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+/*
+ *******************************************************************************************************
+ * Microbenchmark of the transform layer between the zvals and the as_vals,
+ * run inside the embed SAPI without a server. Each corpus is a PHP record,
+ * put into an as_record as by Aerospike::put() (AS_DEFAULT_PUT), then read
+ * back into a PHP array as by Aerospike::get() (AS_DEFAULT_GET) and, for the
+ * list and the map corpora, through AS_LIST_GET_CALLBACK and
+ * AS_MAP_GET_CALLBACK alone.
+ *
+ * Reports the time, the number of allocations and the bytes allocated per
+ * operation. The allocations are counted by interposing malloc() on glibc,
+ * where the Zend memory manager is disabled (USE_ZEND_ALLOC=0) unless
+ * --zend-mm is given, so that the emalloc() calls are counted as well.
+ *******************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "php.h"
+#include "sapi/embed/php_embed.h"
+#include "php_aerospike.h"
+
+#include "aerospike/as_error.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_list.h"
+#include "aerospike/as_map.h"
+#include "aerospike_common.h"
+#include "aerospike_transform.h"
+#include "aerospike_policy.h"
+
+#define BENCH_DEFAULT_ITERATIONS    10000
+#define BENCH_WARMUP_ITERATIONS     100
+
+/*
+ *******************************************************************************************************
+ * Allocation counters, updated while a benchmark is being measured.
+ *******************************************************************************************************
+ */
+static volatile bool bench_counting = false;
+static volatile uint64_t bench_allocs = 0;
+static volatile uint64_t bench_bytes = 0;
+
+#if defined(__GLIBC__)
+#define BENCH_COUNTS_ALLOCATIONS 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+	if (bench_counting) {
+		bench_allocs++;
+		bench_bytes += size;
+	}
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	if (bench_counting) {
+		bench_allocs++;
+		bench_bytes += nmemb * size;
+	}
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	if (bench_counting) {
+		bench_allocs++;
+		bench_bytes += size;
+	}
+	return __libc_realloc(ptr, size);
+}
+#endif
+
+/*
+ *******************************************************************************************************
+ * The corpora, PHP expressions evaluated once at startup. The bin holding the
+ * list or the map of a corpus, if any, is also benchmarked alone.
+ *******************************************************************************************************
+ */
+typedef struct bench_corpus_s {
+	const char *name;
+	const char *code;
+	const char *list_bin;
+	const char *map_bin;
+} bench_corpus;
+
+static bench_corpus bench_corpora[] = {
+	{ "flat",
+		"array('id' => 12345, 'name' => 'John Doe', 'email' => 'john.doe@example.com', 'age' => 42,"
+		" 'score' => 98.6, 'city' => 'Mountain View', 'active' => 1, 'visits' => 1024,"
+		" 'country' => 'US', 'updated' => 1476000000)",
+		NULL, NULL },
+	{ "wide",
+		"array_combine(array_map(function ($i) { return 'bin' . $i; }, range(1, 100)),"
+		" array_map(function ($i) { return ($i % 2) ? str_repeat('x', 16) : $i * 1000; }, range(1, 100)))",
+		NULL, NULL },
+	{ "deep_map",
+		"call_user_func(function () { $m = array('leaf' => 1, 'name' => 'leaf');"
+		" for ($i = 0; $i < 8; $i++) { $m = array('level' => $i, 'name' => 'node' . $i, 'child' => $m,"
+		" 'sibling' => array('a' => $i, 'b' => 'x', 'c' => 1.5)); } return array('map' => $m); })",
+		NULL, "map" },
+	{ "int_list",
+		"array('list' => range(1, 2000))",
+		"list", NULL },
+	{ "blob",
+		"array('blob' => (object) array('id' => 1, 'tags' => array('a', 'b', 'c'),"
+		" 'payload' => str_repeat('y', 256)))",
+		NULL, NULL },
+};
+
+/*
+ *******************************************************************************************************
+ * State of a corpus: its PHP record, and the as_record it was put into, kept
+ * with its static pool for the get benchmarks.
+ *******************************************************************************************************
+ */
+typedef struct bench_state_s {
+	Aerospike_object  as;
+#if PHP_VERSION_ID < 70000
+	zval              *record;
+#else
+	zval              record;
+#endif
+	as_record         as_record;
+	as_static_pool    *pool_p;
+	as_static_pool    *scratch_pool_p;
+	as_error          error;
+} bench_state;
+
+typedef void (*bench_fn)(bench_state *state_p, const bench_corpus *corpus_p TSRMLS_DC);
+
+static inline uint64_t bench_now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/*
+ *******************************************************************************************************
+ * One put of the corpus, as done by aerospike_transform_key_data_put(): the
+ * static pool is zeroed and the record allocated on the stack.
+ *******************************************************************************************************
+ */
+static void bench_put(bench_state *state_p, const bench_corpus *corpus_p TSRMLS_DC)
+{
+	as_record record;
+
+	memset(state_p->scratch_pool_p, 0, sizeof(as_static_pool));
+	as_record_inita(&record, zend_hash_num_elements(AEROSPIKE_Z_ARRVAL_P(&state_p->record)));
+	aerospike_transform_iterate_records(&state_p->as, &state_p->record, &record,
+			state_p->scratch_pool_p, SERIALIZER_PHP, true, &state_p->error TSRMLS_CC);
+	aerospike_helper_free_static_pool(state_p->scratch_pool_p);
+	as_record_destroy(&record);
+}
+
+static void bench_get(bench_state *state_p, const bench_corpus *corpus_p TSRMLS_DC)
+{
+	DECLARE_ZVAL(result);
+	foreach_callback_udata udata;
+
+#if PHP_VERSION_ID < 70000
+	MAKE_STD_ZVAL(result);
+#endif
+	array_init(AEROSPIKE_ZVAL_ARG(result));
+	udata.udata_p = AEROSPIKE_ZVAL_ARG(result);
+	udata.error_p = &state_p->error;
+	udata.obj = &state_p->as;
+	as_record_foreach(&state_p->as_record, (as_rec_foreach_callback) AS_DEFAULT_GET, &udata);
+#if PHP_VERSION_ID < 70000
+	zval_ptr_dtor(&result);
+#else
+	zval_dtor(&result);
+#endif
+}
+
+static void bench_list_get(bench_state *state_p, const bench_corpus *corpus_p TSRMLS_DC)
+{
+	DECLARE_ZVAL(result);
+	foreach_callback_udata udata;
+	as_list *list_p = as_list_fromval((as_val *) as_record_get(&state_p->as_record, corpus_p->list_bin));
+
+#if PHP_VERSION_ID < 70000
+	MAKE_STD_ZVAL(result);
+#endif
+	array_init(AEROSPIKE_ZVAL_ARG(result));
+	udata.udata_p = AEROSPIKE_ZVAL_ARG(result);
+	udata.error_p = &state_p->error;
+	udata.obj = &state_p->as;
+	as_list_foreach(list_p, (as_list_foreach_callback) AS_LIST_GET_CALLBACK, &udata);
+#if PHP_VERSION_ID < 70000
+	zval_ptr_dtor(&result);
+#else
+	zval_dtor(&result);
+#endif
+}
+
+static void bench_map_get(bench_state *state_p, const bench_corpus *corpus_p TSRMLS_DC)
+{
+	DECLARE_ZVAL(result);
+	foreach_callback_udata udata;
+	as_map *map_p = as_map_fromval((as_val *) as_record_get(&state_p->as_record, corpus_p->map_bin));
+
+#if PHP_VERSION_ID < 70000
+	MAKE_STD_ZVAL(result);
+#endif
+	array_init(AEROSPIKE_ZVAL_ARG(result));
+	udata.udata_p = AEROSPIKE_ZVAL_ARG(result);
+	udata.error_p = &state_p->error;
+	udata.obj = &state_p->as;
+	as_map_foreach(map_p, (as_map_foreach_callback) AS_MAP_GET_CALLBACK, &udata);
+#if PHP_VERSION_ID < 70000
+	zval_ptr_dtor(&result);
+#else
+	zval_dtor(&result);
+#endif
+}
+
+/*
+ *******************************************************************************************************
+ * Runs and reports one benchmark, unless filtered out.
+ *
+ * @return false if the transform failed.
+ *******************************************************************************************************
+ */
+static bool bench_run(const char *operation, bench_fn fn, bench_state *state_p,
+		const bench_corpus *corpus_p, uint32_t iterations, const char *filter TSRMLS_DC)
+{
+	char name[64];
+	uint64_t start_ns, elapsed_ns;
+	uint32_t i;
+
+	snprintf(name, sizeof(name), "%s/%s", operation, corpus_p->name);
+	if (filter && !strstr(name, filter)) {
+		return true;
+	}
+
+	for (i = 0; i < BENCH_WARMUP_ITERATIONS; i++) {
+		fn(state_p, corpus_p TSRMLS_CC);
+	}
+	if (state_p->error.code != AEROSPIKE_OK) {
+		fprintf(stderr, "%s failed: %s\n", name, state_p->error.message);
+		return false;
+	}
+
+	bench_allocs = 0;
+	bench_bytes = 0;
+	bench_counting = true;
+	start_ns = bench_now_ns();
+	for (i = 0; i < iterations; i++) {
+		fn(state_p, corpus_p TSRMLS_CC);
+	}
+	elapsed_ns = bench_now_ns() - start_ns;
+	bench_counting = false;
+
+#ifdef BENCH_COUNTS_ALLOCATIONS
+	printf("%-24s %10u %12.1f %12.1f %12.1f\n", name, iterations,
+			(double) elapsed_ns / iterations, (double) bench_allocs / iterations,
+			(double) bench_bytes / iterations);
+#else
+	printf("%-24s %10u %12.1f %12s %12s\n", name, iterations,
+			(double) elapsed_ns / iterations, "-", "-");
+#endif
+	return true;
+}
+
+static bool bench_corpus_run(const bench_corpus *corpus_p, uint32_t iterations,
+		const char *filter TSRMLS_DC)
+{
+	bench_state state;
+	bool ok = false;
+
+	memset(&state, 0, sizeof(state));
+	state.as.serializer_opt = SERIALIZER_PHP;
+	state.pool_p = (as_static_pool *) calloc(1, sizeof(as_static_pool));
+	state.scratch_pool_p = (as_static_pool *) calloc(1, sizeof(as_static_pool));
+	as_error_init(&state.error);
+
+#if PHP_VERSION_ID < 70000
+	MAKE_STD_ZVAL(state.record);
+	if (SUCCESS != zend_eval_string((char *) corpus_p->code, state.record,
+				(char *) corpus_p->name TSRMLS_CC) || Z_TYPE_P(state.record) != IS_ARRAY) {
+#else
+	if (SUCCESS != zend_eval_string((char *) corpus_p->code, &state.record,
+				(char *) corpus_p->name) || Z_TYPE(state.record) != IS_ARRAY) {
+#endif
+		fprintf(stderr, "Unable to build the %s corpus\n", corpus_p->name);
+		goto exit;
+	}
+
+	as_record_init(&state.as_record, zend_hash_num_elements(AEROSPIKE_Z_ARRVAL_P(&state.record)));
+	aerospike_transform_iterate_records(&state.as, &state.record, &state.as_record,
+			state.pool_p, SERIALIZER_PHP, true, &state.error TSRMLS_CC);
+	if (state.error.code != AEROSPIKE_OK) {
+		fprintf(stderr, "Unable to put the %s corpus: %s\n", corpus_p->name, state.error.message);
+		goto destroy;
+	}
+
+	ok = bench_run("put", bench_put, &state, corpus_p, iterations, filter TSRMLS_CC) &&
+		bench_run("get", bench_get, &state, corpus_p, iterations, filter TSRMLS_CC) &&
+		(!corpus_p->list_bin ||
+		 bench_run("list_get", bench_list_get, &state, corpus_p, iterations, filter TSRMLS_CC)) &&
+		(!corpus_p->map_bin ||
+		 bench_run("map_get", bench_map_get, &state, corpus_p, iterations, filter TSRMLS_CC));
+
+destroy:
+	as_record_destroy(&state.as_record);
+	aerospike_helper_free_static_pool(state.pool_p);
+exit:
+#if PHP_VERSION_ID < 70000
+	zval_ptr_dtor(&state.record);
+#else
+	zval_dtor(&state.record);
+#endif
+	free(state.pool_p);
+	free(state.scratch_pool_p);
+	return ok;
+}
+
+static void bench_usage(const char *program)
+{
+	fprintf(stderr, "%s [-n ITERATIONS] [-f FILTER] [--zend-mm]\n", program);
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t iterations = BENCH_DEFAULT_ITERATIONS;
+	const char *filter = NULL;
+	bool zend_mm = false;
+	int status = 0;
+	size_t i;
+
+	for (i = 1; i < (size_t) argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < (size_t) argc) {
+			iterations = (uint32_t) strtoul(argv[++i], NULL, 10);
+		} else if (!strcmp(argv[i], "-f") && i + 1 < (size_t) argc) {
+			filter = argv[++i];
+		} else if (!strcmp(argv[i], "--zend-mm")) {
+			zend_mm = true;
+		} else {
+			bench_usage(argv[0]);
+			return 1;
+		}
+	}
+	if (!iterations) {
+		bench_usage(argv[0]);
+		return 1;
+	}
+
+	/* Read by the Zend memory manager when it starts */
+	if (!zend_mm && !getenv("USE_ZEND_ALLOC")) {
+		setenv("USE_ZEND_ALLOC", "0", 1);
+	}
+
+	PHP_EMBED_START_BLOCK(argc, argv)
+
+	/* Loaded as by dl(), in the running request */
+	if (SUCCESS != zend_startup_module(&aerospike_module_entry)) {
+		fprintf(stderr, "Unable to start the aerospike module\n");
+		status = 1;
+	} else {
+		printf("%-24s %10s %12s %12s %12s\n", "benchmark", "iterations", "ns/op", "allocs/op",
+				"bytes/op");
+		for (i = 0; i < sizeof(bench_corpora) / sizeof(bench_corpora[0]); i++) {
+			if (!bench_corpus_run(&bench_corpora[i], iterations, filter TSRMLS_CC)) {
+				status = 1;
+			}
+		}
+	}
+
+	PHP_EMBED_END_BLOCK()
+
+	return status;
+}
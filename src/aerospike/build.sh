@@ -20,6 +20,7 @@ export AEROSPIKE_C_CLIENT=${AEROSPIKE_C_CLIENT:-4.0.7}
 export DOWNLOAD_C_CLIENT=${DOWNLOAD_C_CLIENT:-1}
 export LUA_SYSPATH=${LUA_SYSPATH:-/usr/local/aerospike/lua}
 export LUA_USRPATH=${LUA_USRPATH:-/usr/local/aerospike/usr-lua}
+export BUILD_BENCH=${BUILD_BENCH:-0}
 if [[ ! -d $CLIENTREPO_3X || ! `ls $CLIENTREPO_3X/package/aerospike-client-c-devel-${AEROSPIKE_C_CLIENT}* 2> /dev/null` ]]; then
     rm -rf $CLIENTREPO_3X/package
     echo "Downloading Aerospike C Client SDK $AEROSPIKE_C_CLIENT"
@@ -98,14 +99,18 @@ if [ -f Makefile ]; then
 fi
 parse_args $@
 phpize
-./configure --enable-aerospike --with-php-config=$PHP_CONFIG "CFLAGS=-g -O3"
+if [ $BUILD_BENCH -eq 1 ]; then
+    ./configure --enable-aerospike --enable-aerospike-bench --with-php-config=$PHP_CONFIG "CFLAGS=-g -O3"
+else
+    ./configure --enable-aerospike --with-php-config=$PHP_CONFIG "CFLAGS=-g -O3"
+fi
 
 OS=`uname`
 
 CFLAGS="-std=gnu99 -g -D__AEROSPIKE_PHP_CLIENT_LOG_LEVEL__=${LOGLEVEL}"
 
 if [ $OS = "Darwin" ] ; then
-    LDFLAGS="-L$CLIENTREPO_3X/lib -laerospike -lcrypto"
+    LDFLAGS="-L$CLIENTREPO_3X/lib -laerospike -lcrypto -lz"
 else
     LDFLAGS="-Wl,-Bstatic -L$CLIENTREPO_3X/lib -laerospike -Wl,-Bdynamic"
     # Find and link to libcrypto (provided by OpenSSL)
@@ -134,7 +139,7 @@ else
             fi
         fi
     fi
-    LDFLAGS="$LDFLAGS $LIBCRYPTO -lrt"
+    LDFLAGS="$LDFLAGS $LIBCRYPTO -lrt -lz"
 fi
 
 make clean all "CFLAGS=$CFLAGS" "EXTRA_INCLUDES+=-I$CLIENTREPO_3X/include -I$CLIENTREPO_3X/include/ck" "EXTRA_LDFLAGS=$LDFLAGS"
@@ -142,6 +147,13 @@ if [ $? -gt 0 ] ; then
     echo "The build has failed...exiting"
     exit 3
 fi
+if [ $BUILD_BENCH -eq 1 ]; then
+    make aerospike-transform-bench "CFLAGS=$CFLAGS" "EXTRA_INCLUDES+=-I$CLIENTREPO_3X/include -I$CLIENTREPO_3X/include/ck" "EXTRA_LDFLAGS=$LDFLAGS"
+    if [ $? -gt 0 ] ; then
+        echo "The build of the transform benchmark has failed...exiting"
+        exit 3
+    fi
+fi
 scripts/test-cleanup.sh
 
 if [ ! -d $LUA_SYSPATH ]; then
@@ -1,6 +1,20 @@
 PHP_ARG_ENABLE(aerospike, whether to enable Aerospike support, [ --enable-aerospike Enable Aerospike support])
+PHP_ARG_ENABLE(aerospike-bench, whether to build the transform benchmark, [ --enable-aerospike-bench Build the aerospike-transform-bench target (needs the embed SAPI)], no, no)
 
 if test "$PHP_AEROSPIKE" = "yes"; then
   AC_DEFINE(HAVE_AEROSPIKE, 1, [Whether you have Aerospike])
-  PHP_NEW_EXTENSION(aerospike, aerospike.c aerospike_policy.c aerospike_helper.c aerospike_transform.c aerospike_record_operations.c aerospike_udf.c aerospike_scan.c aerospike_query.c aerospike_index_operations.c aerospike_info_operations.c aerospike_batch_operations.c aerospike_session_handler.c aerospike_security_operations.c, $ext_shared)
+  PHP_NEW_EXTENSION(aerospike, aerospike.c aerospike_policy.c aerospike_helper.c aerospike_transform.c aerospike_record_operations.c aerospike_udf.c aerospike_scan.c aerospike_query.c aerospike_index_operations.c aerospike_info_operations.c aerospike_batch_operations.c aerospike_session_handler.c aerospike_security_operations.c aerospike_latency.c aerospike_slowlog.c aerospike_log_queue.c aerospike_bulk.c aerospike_async.c aerospike_memo.c aerospike_near_cache.c aerospike_counters.c aerospike_memory.c, $ext_shared)
+  PHP_ADD_LIBRARY(z, 1, AEROSPIKE_SHARED_LIBADD)
+  PHP_SUBST(AEROSPIKE_SHARED_LIBADD)
+
+  if test "$PHP_AEROSPIKE_BENCH" = "yes"; then
+    AEROSPIKE_PHP_PREFIX=`$PHP_CONFIG --prefix`
+    if test `$PHP_CONFIG --vernum` -ge 70000; then
+      AEROSPIKE_BENCH_LIBS="-L$AEROSPIKE_PHP_PREFIX/lib -Wl,-rpath,$AEROSPIKE_PHP_PREFIX/lib -lphp7"
+    else
+      AEROSPIKE_BENCH_LIBS="-L$AEROSPIKE_PHP_PREFIX/lib -Wl,-rpath,$AEROSPIKE_PHP_PREFIX/lib -lphp5"
+    fi
+    PHP_SUBST(AEROSPIKE_BENCH_LIBS)
+    PHP_ADD_MAKEFILE_FRAGMENT($ext_srcdir/bench/Makefile.frag)
+  fi
 fi
@@ -40,6 +40,18 @@ typedef struct global_error {
 	as_error error;
 } aerospike_global_error;
 
+/*
+ * Memory used by the command being profiled, see aerospike.memory_profiling.
+ */
+typedef struct memory_span {
+	int command;             /* aerospike_command being profiled, -1 if none */
+	size_t emalloc_start;
+	size_t emalloc_peak;
+	int64_t heap_start;      /* C heap in use, -1 where it cannot be measured */
+	int64_t heap_peak;
+	uint32_t samples;
+} aerospike_memory_span;
+
 ZEND_BEGIN_MODULE_GLOBALS(aerospike)
 	int nesting_depth;
 	int connect_timeout;
@@ -62,9 +74,30 @@ ZEND_BEGIN_MODULE_GLOBALS(aerospike)
 	int shm_key;
 	int shm_key_counter;
 	int compression_threshold;
+	int read_hedge_delay;
+	long slowlog_threshold_ms;
+	char *slowlog_file;
+	long async_threads;
+	long near_cache_size;
+	long near_cache_slot_size;
+	long near_cache_fresh_ms;
+	char *near_cache_sets;
+	long increment_buffer_max_keys;
+	long increment_buffer_max_age_ms;
+	int async_notify_fd;
+	int async_notify_write_fd;
+	long async_notify_pid;
+	long session_compression_threshold;
+	zend_bool session_generation_check;
+	zend_bool memory_profiling;
 	aerospike_global_error error_g;
+	aerospike_memory_span memory_span_g;
 	HashTable *persistent_list_g;
 	HashTable *shm_key_list_g;
+	HashTable *session_cache_g;
+	HashTable *async_watched_g;
+	HashTable *async_flights_g;
+	HashTable *counters_objects_g;
 	int persistent_ref_count;
 	int shm_key_ref_count;
 	pthread_rwlock_t aerospike_mutex;
@@ -102,6 +135,8 @@ PHP_METHOD(Aerospike, isConnected);
 PHP_METHOD(Aerospike, close);
 PHP_METHOD(Aerospike, reconnect);
 PHP_METHOD(Aerospike, getNodes);
+PHP_METHOD(Aerospike, getStats);
+PHP_METHOD(Aerospike, getSlowLog);
 PHP_METHOD(Aerospike, info);
 PHP_METHOD(Aerospike, infoMany);
 
@@ -134,8 +169,24 @@ PHP_METHOD(Aerospike, remove);
 PHP_METHOD(Aerospike, removeBin);
 PHP_METHOD(Aerospike, setDeserializer);
 PHP_METHOD(Aerospike, setSerializer);
+PHP_METHOD(Aerospike, setPolicyProfile);
+PHP_METHOD(Aerospike, setReadMemoization);
+PHP_METHOD(Aerospike, setIncrementBuffering);
+PHP_METHOD(Aerospike, flush);
 PHP_METHOD(Aerospike, touch);
 
+/*
+ * Async APIs:
+ */
+
+PHP_METHOD(Aerospike, getAsync);
+PHP_METHOD(Aerospike, putAsync);
+PHP_METHOD(Aerospike, operateAsync);
+PHP_METHOD(Aerospike, applyAsync);
+PHP_METHOD(Aerospike, awaitAll);
+PHP_METHOD(Aerospike, pollAsync);
+PHP_METHOD(Aerospike, asyncEventStream);
+
 /*
  * Logging APIs:
  */
@@ -160,7 +211,12 @@ PHP_METHOD(Aerospike, predicateContains);
 PHP_METHOD(Aerospike, predicateRange);
 PHP_METHOD(Aerospike, query);
 PHP_METHOD(Aerospike, aggregate);
+PHP_METHOD(Aerospike, aggregateStream);
+PHP_METHOD(Aerospike, aggregateNative);
 PHP_METHOD(Aerospike, scan);
+PHP_METHOD(Aerospike, scanCursor);
+PHP_METHOD(Aerospike, scanToFile);
+PHP_METHOD(Aerospike, loadFile);
 PHP_METHOD(Aerospike, scanApply);
 PHP_METHOD(Aerospike, queryApply);
 PHP_METHOD(Aerospike, scanInfo);
@@ -0,0 +1,15 @@
+--TEST--
+AerospikeSession - Check for session write of unchanged data.
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionCUnchangedWrite");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionCUnchangedWrite");
+--EXPECT--
+OK
+
@@ -0,0 +1,15 @@
+--TEST--
+AerospikeSession - Check for session write of compressed data.
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionDCompressedWrite");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionDCompressedWrite");
+--EXPECT--
+OK
+
@@ -0,0 +1,14 @@
+--TEST--
+AerospikeSession - Check for session read of uncompressed data stored as a blob.
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionDRawBlobRead");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionDRawBlobRead");
+--EXPECT--
+OK
@@ -0,0 +1,15 @@
+--TEST--
+AerospikeSession - Check for generation checked session write.
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionEGenerationCheckedWrite");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionEGenerationCheckedWrite");
+--EXPECT--
+OK
+
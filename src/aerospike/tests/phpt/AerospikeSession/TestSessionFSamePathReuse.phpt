@@ -0,0 +1,14 @@
+--TEST--
+AerospikeSession - Check that sessions with the same save path reuse its connection.
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionFSamePathReuse");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionFSamePathReuse");
+--EXPECT--
+OK
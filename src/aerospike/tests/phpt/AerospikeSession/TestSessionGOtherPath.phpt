@@ -0,0 +1,14 @@
+--TEST--
+AerospikeSession - Check that a session with another save path gets its own connection.
+
+--SKIPIF--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_skipif("AerospikeSession", "testSessionGOtherPath");
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AerospikeSession", "testSessionGOtherPath");
+--EXPECT--
+OK
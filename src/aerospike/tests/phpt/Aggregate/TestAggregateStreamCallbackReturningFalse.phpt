@@ -0,0 +1,9 @@
+--TEST--
+AggregateStream - Callback returning false
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Aggregate", "testAggregateStreamCallbackReturningFalse");
+--EXPECT--
+OK
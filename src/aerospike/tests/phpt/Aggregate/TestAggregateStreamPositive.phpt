@@ -0,0 +1,9 @@
+--TEST--
+AggregateStream - Positive
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Aggregate", "testAggregateStreamPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+AggregateNative - Query with a predicate
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AggregateNative", "testAggregateNativeQueryPositive");
+--EXPECT--
+OK
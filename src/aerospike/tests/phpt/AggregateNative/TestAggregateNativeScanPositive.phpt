@@ -0,0 +1,9 @@
+--TEST--
+AggregateNative - Scan with all aggregates
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AggregateNative", "testAggregateNativeScanPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+AggregateNative - Negative integer sum overflow
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AggregateNative", "testAggregateNativeSumOverflowNegative");
+--EXPECT--
+ERR_CLIENT
@@ -0,0 +1,9 @@
+--TEST--
+AggregateNative - Negative unknown aggregate
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("AggregateNative", "testAggregateNativeUnknownAggregateNegative");
+--EXPECT--
+ERR_PARAM
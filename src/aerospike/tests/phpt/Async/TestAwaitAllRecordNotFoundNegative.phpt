@@ -0,0 +1,9 @@
+--TEST--
+Async - Negative awaitAll() with a record not found
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testAwaitAllRecordNotFoundNegative");
+--EXPECT--
+ERR_RECORD_NOT_FOUND
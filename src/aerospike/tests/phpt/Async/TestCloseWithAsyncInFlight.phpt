@@ -0,0 +1,9 @@
+--TEST--
+Async - close() with async commands still in flight
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testCloseWithAsyncInFlight");
+--EXPECT--
+OK
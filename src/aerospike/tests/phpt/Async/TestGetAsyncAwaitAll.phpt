@@ -0,0 +1,9 @@
+--TEST--
+Async - getAsync() of several records awaited with awaitAll()
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testGetAsyncAwaitAll");
+--EXPECT--
+OK
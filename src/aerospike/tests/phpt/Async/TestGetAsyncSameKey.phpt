@@ -0,0 +1,9 @@
+--TEST--
+Async - getAsync() of a record already being read, then after a write of it
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testGetAsyncSameKey");
+--EXPECT--
+OK
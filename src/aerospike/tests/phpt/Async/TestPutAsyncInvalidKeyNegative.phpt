@@ -0,0 +1,9 @@
+--TEST--
+Async - Negative putAsync() with an invalid key
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testPutAsyncInvalidKeyNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Async - putAsync() and operateAsync() waited for one by one
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testPutOperateAsync");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Async - then() with an argument which is not callable
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testThenNotCallableNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Async - then() callbacks invoked by pollAsync() once the event stream is readable
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testThenPollAsync");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+ Get a record with a fixed read hedge delay passed in options.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGetWithReadHedgeDelay");
+--EXPECT--
+OK
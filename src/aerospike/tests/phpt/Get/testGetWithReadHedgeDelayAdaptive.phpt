@@ -0,0 +1,9 @@
+--TEST--
+ Get selected bins of a record with an adaptive read hedge delay.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGetWithReadHedgeDelayAdaptive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+ Get a record with a read hedge delay of an invalid type.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGetWithReadHedgeDelayInvalidNegative");
+--EXPECT--
+ERR_PARAM
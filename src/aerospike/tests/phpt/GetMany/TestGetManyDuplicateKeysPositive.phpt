@@ -0,0 +1,10 @@
+--TEST--
+GetMany - keys given more than once
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetMany", "testGetManyDuplicateKeysPositive");
+--EXPECT--
+OK
+
@@ -0,0 +1,9 @@
+--TEST--
+GetSlowLog - Positive test
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetSlowLog", "testGetSlowLogPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+GetSlowLog - Negative test with parameter
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetSlowLog", "testGetSlowLogWithParameter");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+GetStats - Memory profiling of a batch read
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetStats", "testGetStatsMemoryProfiling");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+GetStats - Positive test
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetStats", "testGetStatsPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+GetStats - Negative test with parameter
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetStats", "testGetStatsWithParameter");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+IncrementBuffering - Buffered increments of several bins written by flush()
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("IncrementBuffering", "testBufferedIncrementsFlush");
+--EXPECT--
+OK
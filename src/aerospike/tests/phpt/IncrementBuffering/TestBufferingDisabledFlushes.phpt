@@ -0,0 +1,9 @@
+--TEST--
+IncrementBuffering - Disabling the buffering flushes the buffered increments
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("IncrementBuffering", "testBufferingDisabledFlushes");
+--EXPECT--
+OK
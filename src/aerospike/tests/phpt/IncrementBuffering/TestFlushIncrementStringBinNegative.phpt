@@ -0,0 +1,9 @@
+--TEST--
+IncrementBuffering - flush() of increments of a string bin
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("IncrementBuffering", "testFlushIncrementStringBinNegative");
+--EXPECT--
+ERR_BIN_INCOMPATIBLE_TYPE
@@ -0,0 +1,9 @@
+--TEST--
+IncrementBuffering - increment() with options while buffering is written right away
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("IncrementBuffering", "testIncrementWithOptionsNotBuffered");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+LoadFile - lines which cannot be written
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("LoadFile", "testLoadFileFailures");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+LoadFile - msgpack exported by scanToFile
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("LoadFile", "testLoadFileMsgpackRoundTrip");
+--EXPECT--
+OK
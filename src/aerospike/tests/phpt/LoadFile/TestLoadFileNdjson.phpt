@@ -0,0 +1,9 @@
+--TEST--
+LoadFile - NDJSON objects of bins
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("LoadFile", "testLoadFileNdjson");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+LoadFile - NDJSON exported by scanToFile with integral doubles
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("LoadFile", "testLoadFileNdjsonDoubleRoundTrip");
+--EXPECT--
+OK
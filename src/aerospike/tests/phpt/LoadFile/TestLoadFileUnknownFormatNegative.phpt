@@ -0,0 +1,9 @@
+--TEST--
+LoadFile - Negative unknown format
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("LoadFile", "testLoadFileUnknownFormatNegative");
+--EXPECT--
+ERR_PARAM
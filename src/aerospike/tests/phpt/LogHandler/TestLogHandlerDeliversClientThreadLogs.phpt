@@ -0,0 +1,9 @@
+--TEST--
+LogHandler - Records logged by the C client threads are delivered at drain points
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("LogHandler", "testLogHandlerDeliversClientThreadLogs");
+--EXPECT--
+OK
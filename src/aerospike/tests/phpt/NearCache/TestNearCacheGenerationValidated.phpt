@@ -0,0 +1,13 @@
+--TEST--
+NearCache - Past aerospike.near_cache_fresh_ms a record is validated by its generation
+
+--INI--
+aerospike.near_cache_size=1048576
+aerospike.near_cache_sets=test.near_cache
+aerospike.near_cache_fresh_ms=0
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("NearCache", "testNearCacheGenerationValidated");
+--EXPECT--
+OK
@@ -0,0 +1,13 @@
+--TEST--
+NearCache - A write drops the record from the near cache
+
+--INI--
+aerospike.near_cache_size=1048576
+aerospike.near_cache_sets=test.near_cache
+aerospike.near_cache_fresh_ms=60000
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("NearCache", "testNearCacheWriteInvalidates");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+PolicyProfile - Policy profile for a namespace
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("PolicyProfile", "testPolicyProfileForNamespace");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+PolicyProfile - Policy profile for a set applies to put
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("PolicyProfile", "testPolicyProfileForSetExistsCreate");
+--EXPECT--
+ERR_RECORD_EXISTS
@@ -0,0 +1,9 @@
+--TEST--
+PolicyProfile - Policy profile with an invalid option
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("PolicyProfile", "testPolicyProfileInvalidOption");
+--EXPECT--
+ERR_PARAM
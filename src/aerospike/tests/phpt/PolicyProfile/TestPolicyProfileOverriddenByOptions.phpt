@@ -0,0 +1,9 @@
+--TEST--
+PolicyProfile - Call options override the policy profile
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("PolicyProfile", "testPolicyProfileOverriddenByOptions");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+PolicyProfile - Policy profile removed
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("PolicyProfile", "testPolicyProfileRemoved");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+ Put a record with a read hedge delay, which only applies to reads.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Put", "testPutWithReadHedgeDelayNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+ReadMemoization - get() of different bin selections of a record is memoized separately
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ReadMemoization", "testMemoizedBinSelections");
+--EXPECT--
+ERR_RECORD_NOT_FOUND
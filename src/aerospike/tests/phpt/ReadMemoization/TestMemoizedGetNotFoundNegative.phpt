@@ -0,0 +1,9 @@
+--TEST--
+ReadMemoization - A get() which did not find the record is memoized
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ReadMemoization", "testMemoizedGetNotFoundNegative");
+--EXPECT--
+ERR_RECORD_NOT_FOUND
@@ -0,0 +1,9 @@
+--TEST--
+ReadMemoization - A memoized get() does not see the writes of another client until this object writes
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ReadMemoization", "testMemoizedGetWriteInvalidates");
+--EXPECT--
+OK
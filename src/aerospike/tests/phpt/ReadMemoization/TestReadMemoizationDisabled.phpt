@@ -0,0 +1,9 @@
+--TEST--
+ReadMemoization - Disabling the memoization drops the memoized reads
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ReadMemoization", "testReadMemoizationDisabled");
+--EXPECT--
+OK
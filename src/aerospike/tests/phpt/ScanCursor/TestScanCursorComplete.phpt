@@ -0,0 +1,9 @@
+--TEST--
+ScanCursor - Whole set
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanCursor", "testScanCursorComplete");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+ScanCursor - Negative invalid partition range
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanCursor", "testScanCursorInvalidPartitionRangeNegative");
+--EXPECT--
+ERR_PARAM
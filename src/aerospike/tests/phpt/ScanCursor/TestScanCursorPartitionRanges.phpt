@@ -0,0 +1,9 @@
+--TEST--
+ScanCursor - Split into partition ranges
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanCursor", "testScanCursorPartitionRanges");
+--EXPECT--
+OK
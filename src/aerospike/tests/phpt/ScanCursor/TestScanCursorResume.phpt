@@ -0,0 +1,9 @@
+--TEST--
+ScanCursor - Stopped and resumed
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanCursor", "testScanCursorResume");
+--EXPECT--
+OK
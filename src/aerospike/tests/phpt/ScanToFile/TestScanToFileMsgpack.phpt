@@ -0,0 +1,9 @@
+--TEST--
+ScanToFile - Export to msgpack
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanToFile", "testScanToFileMsgpack");
+--EXPECT--
+OK
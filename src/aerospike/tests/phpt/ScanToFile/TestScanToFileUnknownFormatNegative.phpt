@@ -0,0 +1,9 @@
+--TEST--
+ScanToFile - Negative unknown format
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanToFile", "testScanToFileUnknownFormatNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Re-registering a changed UDF module uploads it.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Udf", "testUdfPositiveRegisterChangedModuleUploads");
+--EXPECT--
+OK
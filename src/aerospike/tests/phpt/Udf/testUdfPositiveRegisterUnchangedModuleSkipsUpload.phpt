@@ -0,0 +1,9 @@
+--TEST--
+Re-registering an unchanged UDF module skips its upload.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Udf", "testUdfPositiveRegisterUnchangedModuleSkipsUpload");
+--EXPECT--
+OK
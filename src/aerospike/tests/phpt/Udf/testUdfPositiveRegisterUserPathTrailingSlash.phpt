@@ -0,0 +1,9 @@
+--TEST--
+Registers a UDF module with a lua_user_path ending with a slash.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Udf", "testUdfPositiveRegisterUserPathTrailingSlash");
+--EXPECT--
+OK